@@ -5,10 +5,66 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+namespace {
+// Each write becomes one HTTP chunk of a response started with CONTENT_LENGTH_UNKNOWN
+class ChunkedResponse : public Print {
+public:
+    explicit ChunkedResponse(WebServer& server) : server(server) {}
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (size > 0) {
+            server.sendContent(reinterpret_cast<const char*>(buffer), size);
+        }
+        return size;
+    }
+
+private:
+    WebServer& server;
+};
+
+class VectorOut : public Print {
+public:
+    explicit VectorOut(std::vector<uint8_t>& bytes) : bytes(bytes) {}
+
+    size_t write(uint8_t c) override {
+        bytes.push_back(c);
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        bytes.insert(bytes.end(), buffer, buffer + size);
+        return size;
+    }
+
+private:
+    std::vector<uint8_t>& bytes;
+};
+
+// since=<seq>&limit=<n> of the log endpoints; no limit (or one <= 0) means all lines
+void parseLogCursor(WebServer& server, uint32_t& since, size_t& limit) {
+    since = 0;
+    if (server.hasArg("since")) {
+        since = strtoul(server.arg("since").c_str(), nullptr, 10);
+    }
+    limit = SIZE_MAX;
+    if (server.hasArg("limit")) {
+        long value = server.arg("limit").toInt();
+        if (value > 0) {
+            limit = value;
+        }
+    }
+}
+}
+
 APIManager::APIManager() : 
     server(nullptr),
     motorController(nullptr),
     basePrinter(nullptr),
+    logSpill(nullptr),
     authEnabled(false),
     requestCount(0),
     lastRequestTime(0) {
@@ -39,6 +95,10 @@ bool APIManager::init(MotorController* motorCtrl, BasePrinter* basePrinter) {
         otaInitialized = true;
     }
     
+    // Authorization is always collected; Accept picks the /status encoding
+    const char* requestHeaders[] = {"Authorization", "Accept"};
+    server->collectHeaders(requestHeaders, 2);
+
     server->onNotFound([this]() {
         sendErrorResponse(404, "Endpoint not found");
     });
@@ -66,19 +126,12 @@ void APIManager::setupRoutes() {
     server->on("/status", HTTP_GET, [this]() { handleStatus(); });
     server->on("/system", HTTP_GET, [this]() { handleSystemInfo(); });
     server->on("/logs", HTTP_GET, [this]() { handleLogs(); });
+    server->on("/logs/history", HTTP_GET, [this]() { handleLogHistory(); });
     server->on("/logs/clear", HTTP_POST, [this]() {
         logRequest();
+        // Spills to flash first; runs on this task's stack, as /logs?clear=1 does
+        Logger::clearLogs();
         sendSuccessResponse("{\"status\":\"cleared\"}");
-        xTaskCreate(
-            [](void*) {
-                Logger::clearLogs();
-                vTaskDelete(nullptr);
-            },
-            "logclr",
-            2048,
-            nullptr,
-            1,
-            nullptr);
     });
     // Allow reassignment of application firmware in app mode as well
     server->on("/assign-app", HTTP_POST, [this]() { handleOTAUpdate(); });
@@ -131,9 +184,26 @@ void APIManager::sendSuccessResponse(const String& data) {
     sendResponse(200, "", data);
 }
 
+/**
+ * @brief Handles GET /status; MessagePack when the request's Accept header names it
+ */
 void APIManager::handleStatus() {
     logRequest();
-    sendSuccessResponse(createStatusResponse());
+    if (!acceptsMessagePack(server->header("Accept"))) {
+        sendSuccessResponse(createStatusResponse());
+        return;
+    }
+
+    JsonDocument doc; // ArduinoJson v7
+    buildStatus(doc);
+    std::vector<uint8_t> packed;
+    packed.reserve(measureMsgPack(doc));
+    VectorOut out(packed);
+    serializeMsgPack(doc, out);
+    server->send_P(200, payloadContentType(PayloadEncoding::MESSAGE_PACK),
+                   reinterpret_cast<const char*>(packed.data()), packed.size());
+    requestCount++;
+    lastRequestTime = millis();
 }
 
 void APIManager::handleBaseSystemInfo() {
@@ -146,6 +216,14 @@ void APIManager::handleSystemInfo() {
     sendSuccessResponse(createSystemInfoResponse());
 }
 
+/**
+ * @brief Handles the log fetch endpoint: GET /logs?since=<seq>&limit=<n>&clear=1
+ * 
+ * @details Streams the stored lines with sequence >= since as chunked JSON, without
+ * building the document in memory. Pass the response's "next" back as since to fetch
+ * only new lines; "missed" counts lines overwritten before the cursor reached them.
+ * clear drops the lines that were sent.
+ */
 void APIManager::handleLogs() {
     logRequest();
     bool shouldClear = false;
@@ -154,21 +232,47 @@ void APIManager::handleLogs() {
         val.toLowerCase();
         shouldClear = (val == "1" || val == "true" || val == "yes");
     }
+    uint32_t since;
+    size_t limit;
+    parseLogCursor(*server, since, limit);
+
+    server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server->send(200, "application/json", "");
+    ChunkedResponse out(*server);
+    uint32_t next = Logger::writeLogsJson(out, since, limit);
+    server->sendContent("");
+    requestCount++;
+    lastRequestTime = millis();
 
-    String logs = Logger::getLogsAsJson();
-    sendSuccessResponse(logs);
     if (shouldClear) {
-        xTaskCreate(
-            [](void*) {
-                Logger::clearLogs();
-                vTaskDelete(nullptr);
-            },
-            "logclr",
-            2048,
-            nullptr,
-            1,
-            nullptr);
+        Logger::clearLogsThrough(next - 1);
+    }
+}
+
+/**
+ * @brief Handles the persisted log endpoint: GET /logs/history?since=<seq>&limit=<n>
+ * 
+ * @details Same document and cursor as /logs, read from the spill segments on flash,
+ * so it reaches back past the last reboot. Lines still waiting for the next spill
+ * are only in /logs.
+ */
+void APIManager::handleLogHistory() {
+    logRequest();
+    if (!logSpill) {
+        sendErrorResponse(503, "Log history not available");
+        return;
     }
+    uint32_t since;
+    size_t limit;
+    parseLogCursor(*server, since, limit);
+
+    server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server->send(200, "application/json", "");
+    ChunkedResponse out(*server);
+    logSpill->writeJson(out, since, limit);
+    server->sendContent("");
+    requestCount++;
+    lastRequestTime = millis();
 }
 
 
@@ -248,8 +352,13 @@ void APIManager::handleMotorControl() {
         int s = doc["speed"].as<int>();
         if (s > 0) speed = static_cast<float>(s);
     }
-    motorController->moveToPosition(position, speed);
-    sendSuccessResponse("{\"status\":\"Motor moved to position " + String(position) + " at speed " + String(speed) + "\"}");
+    uint32_t expectedMs = motorController->estimateMoveMs(position, speed);
+    if (!motorController->moveToPosition(position, speed)) {
+        sendErrorResponse(503, "Motor command queue full");
+        return;
+    }
+    sendSuccessResponse("{\"status\":\"Motor moved to position " + String(position) + " at speed " + String(speed) +
+                        "\",\"expected_ms\":" + String(expectedMs) + "}");
 }
 
 void APIManager::handleEmergencyStop() {
@@ -261,9 +370,10 @@ void APIManager::handleEmergencyStop() {
     logRequest();
     LOG_W("API", "Emergency stop requested");
     
-    if (motorController) {
-        motorController->stop();
+    if (motorController && motorController->stop()) {
         sendSuccessResponse("{\"status\":\"Emergency stop activated\"}");
+    } else if (motorController) {
+        sendErrorResponse(503, "Motor command queue full");
     } else {
         sendErrorResponse(503, "Motor controller not available");
     }
@@ -278,7 +388,13 @@ void APIManager::logRequest() {
 
 String APIManager::createStatusResponse() {
     JsonDocument doc; // ArduinoJson v7
-    
+    buildStatus(doc);
+    String response;
+    serializeJson(doc, response);
+    return response;
+}
+
+void APIManager::buildStatus(JsonDocument& doc) {
     doc["device_id"] = Utils::generateDeviceId();
     doc["firmware_version"] = FIRMWARE_VERSION;
     doc["uptime"] = millis();
@@ -287,13 +403,26 @@ String APIManager::createStatusResponse() {
     doc["wifi_rssi"] = WiFi.RSSI();
     doc["api_requests"] = requestCount;
     if (motorController) {
+        MotorController::LoopStats stats = motorController->getLoopStats();
         doc["motor_state"] = motorController->getState();
-        doc["motor_position"] = motorController->getCurrentPosition();
+        doc["motor_position"] = motorController->getLastKnownPosition();
+        doc["motor_loop_max_us"] = stats.maxIntervalUs;
+        doc["motor_loop_last_us"] = stats.lastIntervalUs;
+        doc["motor_loop_samples"] = stats.samples;
+
+        MotorController::MoveReport move = motorController->getLastMove();
+        if (move.to > 0) {
+            JsonObject lastMove = doc["last_move"].to<JsonObject>();
+            lastMove["from"] = move.from;
+            lastMove["to"] = move.to;
+            lastMove["direction"] = move.forward ? "forward" : "backward";
+            lastMove["estimated_steps"] = move.estimatedSteps;
+            lastMove["actual_steps"] = move.actualSteps;
+            lastMove["expected_ms"] = move.expectedMs;
+            lastMove["actual_ms"] = move.actualMs;
+            lastMove["completed"] = move.completed;
+        }
     }
-    
-    String response;
-    serializeJson(doc, response);
-    return response;
 }
 
 String APIManager::createSystemBaseInfoResponse() {
@@ -3,7 +3,9 @@
 #include <WebServer.h>
 #include <ArduinoJson.h>
 #include <Config.h>
+#include <PayloadEncoding.h>
 #include <Logger.h>
+#include <LogSpill.h>
 #include <MotorController.h>
 #include <OTAManager.h>
 
@@ -21,6 +23,7 @@ private:
     WebServer* server;
     MotorController* motorController;
     BasePrinter* basePrinter;
+    LogSpill* logSpill;
     
     String apiKey;
     bool authEnabled;
@@ -42,6 +45,7 @@ public:
     
     void setMotorController(MotorController* motorCtrl) { this->motorController = motorCtrl; }
     void setBasePrinter(BasePrinter* basePrinter) { this->basePrinter = basePrinter; }
+    void setLogSpill(LogSpill* logSpill) { this->logSpill = logSpill; }
     
     String generateAPIKey();
     void setAPIKey(const String& key) { apiKey = key; }
@@ -62,6 +66,7 @@ private:
     void handleBaseSystemInfo();
     void handleSystemInfo();
     void handleLogs();
+    void handleLogHistory();
     void handleMotorControl();
     void handleSpoolMapping();
     void handlePrinterStatus();
@@ -74,6 +79,7 @@ private:
     
     void logRequest();
     String createStatusResponse();
+    void buildStatus(JsonDocument& doc);
     String createSystemBaseInfoResponse();
     String createSystemInfoResponse();
     // Removed legacy spool mapping parser signature; will reintroduce with a defined type later.
@@ -1,6 +1,7 @@
 #include "ApplicationManager.h"
 #include <Utils.h>
 #include <ArduinoJson.h>
+#include <SPIFFS.h>
 
 ApplicationManager::ApplicationManager(BasePrinter* printer, MotorController* motor) :
     wifiManager(nullptr),
@@ -8,6 +9,7 @@ ApplicationManager::ApplicationManager(BasePrinter* printer, MotorController* mo
     apiManager(nullptr),
     updateClient(nullptr),
     printer(printer),
+    logSpill(nullptr),
     currentState(ApplicationState::INITIALIZING),
     stateChangeTime(0),
     initialized(false),
@@ -17,7 +19,11 @@ ApplicationManager::ApplicationManager(BasePrinter* printer, MotorController* mo
     lastPrinterCheck(0),
     lastStatusEnqueue(0),
     wifiPreviouslyConnected(false),
-    fallbackServerActive(false) {
+    fallbackServerActive(false),
+    networkTaskHandle(nullptr),
+    motionTaskHandle(nullptr),
+    logHandoffMutex(xSemaphoreCreateMutex()),
+    logBatchesDropped(0) {
 
     // Initialize app config
     appConfig.apiEndpoint = "";
@@ -25,6 +31,7 @@ ApplicationManager::ApplicationManager(BasePrinter* printer, MotorController* mo
     appConfig.firmwareUrl = "";
     appConfig.firmwareMD5 = "";
     appConfig.firmwareSize = 0;
+    appConfig.payloadEncoding = PayloadEncoding::JSON;
     appConfig.assigned = false;
 }
 
@@ -34,6 +41,7 @@ ApplicationManager::~ApplicationManager() {
     delete apiManager;
     delete updateClient;
     delete printer;
+    vSemaphoreDelete(logHandoffMutex);
 }
 
 bool ApplicationManager::init(const String& printerType) {
@@ -112,14 +120,77 @@ bool ApplicationManager::init(const String& printerType) {
 }
 
 void ApplicationManager::loop() {
-    unsigned long currentTime = millis();
-    // Periodically rotate the in-memory logs to cap heap usage
-    static unsigned long lastLogRotation = 0;
-    if (currentTime - lastLogRotation > 15UL * 60UL * 1000UL) { // every 15 minutes
-        Logger::clearLogs();
-        LOG_I("App", "Log buffer rotated (periodic cleanup)");
-        lastLogRotation = currentTime;
+    networkLoop();
+    motionLoop();
+}
+
+bool ApplicationManager::startTasks() {
+    if (tasksRunning()) {
+        return true;
+    }
+
+    BaseType_t motionCreated = xTaskCreatePinnedToCore(
+        motionTask, "motion", MOTION_TASK_STACK, this,
+        MOTION_TASK_PRIORITY, &motionTaskHandle, MOTION_TASK_CORE);
+    if (motionCreated != pdPASS) {
+        motionTaskHandle = nullptr;
+        LOG_E("App", "Failed to create motion task");
+        return false;
+    }
+
+    if (motorController) {
+        motorController->setWakeTask(motionTaskHandle);
+    }
+
+    BaseType_t networkCreated = xTaskCreatePinnedToCore(
+        networkTask, "network", NETWORK_TASK_STACK, this,
+        NETWORK_TASK_PRIORITY, &networkTaskHandle, NETWORK_TASK_CORE);
+    if (networkCreated != pdPASS) {
+        networkTaskHandle = nullptr;
+        if (motorController) {
+            motorController->setWakeTask(nullptr);
+        }
+        vTaskDelete(motionTaskHandle);
+        motionTaskHandle = nullptr;
+        LOG_E("App", "Failed to create network task");
+        return false;
+    }
+
+    LOG_I("App", "Tasks started: network on core " + String(NETWORK_TASK_CORE) +
+                 ", motion on core " + String(MOTION_TASK_CORE));
+    return true;
+}
+
+void ApplicationManager::networkTask(void* param) {
+    ApplicationManager* self = static_cast<ApplicationManager*>(param);
+    for (;;) {
+        self->networkLoop();
+        vTaskDelay(pdMS_TO_TICKS(NETWORK_TASK_PERIOD_MS));
+    }
+}
+
+void ApplicationManager::motionTask(void* param) {
+    ApplicationManager* self = static_cast<ApplicationManager*>(param);
+    for (;;) {
+        self->motionLoop();
+        // Steps come from the hardware timer, but arrival is detected here: the motor
+        // controller notifies this task on a sensor edge, the end of a ramp or a new
+        // command, so it blocks instead of spinning and leaves core 1 to lower-priority
+        // tasks. The tick timeout is only a fallback. Logging from here only queues the
+        // line, but keep this loop quiet anyway: it runs between steps.
+        ulTaskNotifyTake(pdTRUE, 1);
+    }
+}
+
+void ApplicationManager::motionLoop() {
+    if (motorController) {
+        motorController->loop();
     }
+}
+
+void ApplicationManager::networkLoop() {
+    unsigned long currentTime = millis();
+    forwardPendingLogs();
     
     switch (currentState) {
         case ApplicationState::RUNNING:
@@ -157,9 +228,7 @@ void ApplicationManager::loop() {
         wifiManager->loop();
     }
     
-    if (motorController) {
-        motorController->loop();
-    }
+    processMotorEvents();
     
     if (apiManager) {
         apiManager->loop();
@@ -176,8 +245,26 @@ void ApplicationManager::loop() {
     evaluateUpdateHealth();
 }
 
+void ApplicationManager::processMotorEvents() {
+    if (!motorController) {
+        return;
+    }
+
+    MotorController::Event event;
+    while (motorController->pollEvent(event)) {
+        if (event.type == MotorController::Event::ARRIVED) {
+            LOG_I("Motor", "Reached position " + String(event.position) + " in " + String(event.moveMs) +
+                           " ms (expected " + String(event.expectedMs) + " ms)");
+        } else {
+            LOG_D("Motor", "State " + String(static_cast<int>(event.state)) + " at position " + String(event.position));
+        }
+    }
+}
+
 bool ApplicationManager::initializeComponents() {
     LOG_I("App", "Initializing components");
+
+    startLogSpill();
     
     // Initialize WiFi Manager
     wifiManager = new WiFiManager();
@@ -190,12 +277,28 @@ bool ApplicationManager::initializeComponents() {
     if (!motorController) {
         motorController = new MotorController();
     }
-    motorController->begin();
+    if (!motorController->begin()) {
+        LOG_E("App", "Failed to start motor position sensing");
+    }
     
     LOG_I("App", "Base components initialized successfully");
     return true;
 }
 
+void ApplicationManager::startLogSpill() {
+    // Formats on the first boot after flashing; the partition is otherwise unused
+    if (!SPIFFS.begin(true)) {
+        LOG_W("App", "SPIFFS mount failed - logs are kept in RAM only");
+        return;
+    }
+    logSpill = new LogSpill(SPIFFS);
+    uint32_t next = logSpill->begin();
+    Logger::attachSink(logSpill, next);
+    LOG_IF("App", "Log history on flash: %u segments, lines %u..%u",
+           static_cast<unsigned>(logSpill->getSegmentCount()),
+           static_cast<unsigned>(logSpill->getOldestSequence()), static_cast<unsigned>(next));
+}
+
 bool ApplicationManager::connectToWiFi() {
     LOG_I("App", "Connecting to WiFi using WiFiManager");
     
@@ -231,6 +334,7 @@ bool ApplicationManager::connectPrinter() {
                 printer->printer_model,
                 printer->printer_name
             );
+            updateSessionInfo();
             enqueueStatusUpdate(true);
         }
         return true;
@@ -245,6 +349,11 @@ bool ApplicationManager::startServices() {
 
     if (!appConfig.apiEndpoint.isEmpty()) {
         updateClient = new UpdateClient();
+        if (logSpill) {
+            // Same partition as the log history, mounted by startLogSpill()
+            updateClient->attachStorage(SPIFFS);
+        }
+        updateClient->setPayloadEncoding(appConfig.payloadEncoding);
         if (updateClient->init(appConfig.apiEndpoint, appConfig.apiToken, deviceId)) {
             if (printer) {
                 updateClient->setPrinterMetadata(
@@ -254,6 +363,8 @@ bool ApplicationManager::startServices() {
                     printer->printer_name
                 );
             }
+            updateClient->attachBroker(appConfig.telemetryBroker);
+            updateSessionInfo();
             enqueueStatusUpdate(true);
             LOG_I("App", "UpdateClient initialized with push endpoint");
         } else {
@@ -280,7 +391,10 @@ void ApplicationManager::handleRunning() {
         LOG_I("App", "Free heap: " + String(Utils::getFreeHeapPercentage(), 1) + "%");
         
         if (motorController) {
-            LOG_I("App", "Motor position: " + String(motorController->getCurrentPosition()));
+            MotorController::LoopStats stats = motorController->getLoopStats();
+            LOG_I("App", "Motor position: " + String(motorController->getLastKnownPosition()));
+            LOG_I("App", "Motor loop jitter: max " + String(stats.maxIntervalUs) + " us over " +
+                         String(stats.samples) + " seeking loops");
         }
         
         if (printer && printer->isConnected()) {
@@ -346,6 +460,7 @@ void ApplicationManager::checkWiFiConnection() {
         WiFi.reconnect();
     } else if (isConnected && !wifiPreviouslyConnected) {
         LOG_I("WiFi", "Connection restored");
+        updateSessionInfo();
     }
 
     if (isConnected != wifiPreviouslyConnected) {
@@ -392,14 +507,35 @@ void ApplicationManager::setupLogTransmission() {
         // Avoid Logger usage here to prevent recursive transmit
         Serial.println(String("[INFO] App: Transmitting logs (size: ") + String(logs.length()) + " bytes)");
 
-        if (updateClient) {
-            updateClient->queueLogs(logs);
-        } else {
-            ensureFallbackServer();
+        // Called from the log task: the upload itself belongs to the network task
+        xSemaphoreTake(logHandoffMutex, portMAX_DELAY);
+        if (pendingLogs.size() >= LOG_HANDOFF_BATCHES) {
+            pendingLogs.erase(pendingLogs.begin());
+            logBatchesDropped++;
         }
+        pendingLogs.push_back(logs);
+        xSemaphoreGive(logHandoffMutex);
     });
 }
 
+void ApplicationManager::forwardPendingLogs() {
+    std::vector<String> batches;
+    xSemaphoreTake(logHandoffMutex, portMAX_DELAY);
+    batches.swap(pendingLogs);
+    xSemaphoreGive(logHandoffMutex);
+
+    if (batches.empty()) {
+        return;
+    }
+    if (updateClient) {
+        for (const String& logs : batches) {
+            updateClient->queueLogs(logs);
+        }
+    } else {
+        ensureFallbackServer();
+    }
+}
+
 void ApplicationManager::handlePrinterAlert(BasePrinter::AlertLevel level, 
                                            const String& message, 
                                            const String& details) {
@@ -467,17 +603,36 @@ void ApplicationManager::enqueueStatusUpdate(bool force, const BasePrinter::Prin
         return;
     }
 
+    // Only what changes while running; identity and time are added by the status channel
     JsonDocument doc; // ArduinoJson v7
     unsigned long now = millis();
 
-    doc["device_id"] = deviceId;
-    doc["timestamp"] = now;
     doc["state"] = getStateString(currentState);
-    doc["uptime_ms"] = now;
-    doc["free_heap_percent"] = Utils::getFreeHeapPercentage();
+    doc["free_heap_percent"] = roundf(Utils::getFreeHeapPercentage());
     doc["connected"] = (WiFi.status() == WL_CONNECTED);
-    doc["ip_address"] = WiFi.localIP().toString();
-    doc["assigned"] = appConfig.assigned;
+
+    if (motorController) {
+        MotorController::LoopStats stats = motorController->getLoopStats();
+        doc["motor_state"] = static_cast<int>(motorController->getState());
+        doc["motor_position"] = motorController->getLastKnownPosition();
+        doc["motor_loop_max_us"] = stats.maxIntervalUs;
+        doc["motor_loop_last_us"] = stats.lastIntervalUs;
+    }
+
+    UpdateClient::ConnectionStats http = updateClient->getConnectionStats();
+    doc["http_requests"] = http.requests;
+    doc["http_reused"] = http.reusedConnections;
+    doc["http_latency_ms"] = http.lastLatencyMs;
+    doc["http_latency_max_ms"] = http.maxLatencyMs;
+    TelemetryQueue::Stats queued = updateClient->getQueueStats();
+    doc["queued_alerts"] = updateClient->getQueuedAlerts();
+    doc["alerts_dropped"] = queued.alertsDropped;
+    doc["log_chunks_dropped"] = queued.logChunksDropped;
+    doc["log_batches_dropped"] = logBatchesDropped;
+    StatusChannel::Stats frames = updateClient->getStatusStats();
+    doc["status_keyframes"] = frames.keyframes;
+    doc["status_gaps"] = frames.gaps;
+    doc["telemetry_transport"] = updateClient->isPublishing() ? "mqtt" : "http";
 
     if (printer) {
         BasePrinter::PrintStatus snapshot = statusOverride ? *statusOverride : printer->getPrintStatus();
@@ -492,16 +647,34 @@ void ApplicationManager::enqueueStatusUpdate(bool force, const BasePrinter::Prin
             doc["error_message"] = snapshot.errorMessage;
         }
         doc["printer_connected"] = printer->isConnected();
-        if (!printer->printer_id.isEmpty()) doc["printer_id"] = printer->printer_id;
-        if (!printer->printer_brand.isEmpty()) doc["printer_brand"] = printer->printer_brand;
-        if (!printer->printer_model.isEmpty()) doc["printer_model"] = printer->printer_model;
-        if (!printer->printer_name.isEmpty()) doc["printer_name"] = printer->printer_name;
+        AlertEngine::Stats alerts = printer->getAlertStats();
+        doc["alerts_suppressed"] = alerts.duplicates + alerts.flapped;
+        doc["alerts_rate_limited"] = alerts.rateLimited;
     }
 
     updateClient->queueStatusUpdate(doc, force);
     lastStatusEnqueue = now;
 }
 
+void ApplicationManager::updateSessionInfo() {
+    if (!updateClient) {
+        return;
+    }
+
+    JsonDocument session;
+    session["device_id"] = deviceId;
+    session["firmware_version"] = FIRMWARE_VERSION;
+    session["ip_address"] = WiFi.localIP().toString();
+    session["assigned"] = appConfig.assigned;
+    if (printer) {
+        if (!printer->printer_id.isEmpty()) session["printer_id"] = printer->printer_id;
+        if (!printer->printer_brand.isEmpty()) session["printer_brand"] = printer->printer_brand;
+        if (!printer->printer_model.isEmpty()) session["printer_model"] = printer->printer_model;
+        if (!printer->printer_name.isEmpty()) session["printer_name"] = printer->printer_name;
+    }
+    updateClient->setSessionInfo(session);
+}
+
 void ApplicationManager::ensureFallbackServer() {
     if (fallbackServerActive) {
         return;
@@ -513,6 +686,7 @@ void ApplicationManager::ensureFallbackServer() {
 
     if (!apiManager) {
         apiManager = new APIManager();
+        apiManager->setLogSpill(logSpill);
         if (!apiManager->init(motorController, printer)) {
             LOG_E("App", "Failed to initialize fallback API manager");
             delete apiManager;
@@ -601,6 +775,8 @@ bool ApplicationManager::loadApplicationConfig() {
     appConfig.firmwareSize = prefs.getULong("firmware_size", 0);
     appConfig.apiEndpoint = prefs.getString("api_endpoint", "");
     appConfig.apiToken = prefs.getString("update_token", "");
+    appConfig.payloadEncoding = parsePayloadEncoding(prefs.getString(NVS_PAYLOAD_ENCODING, "json"));
+    appConfig.telemetryBroker = prefs.getString(NVS_TELEMETRY_BROKER, "");
     appConfig.assigned = prefs.getBool("assigned", false);
 
     prefs.end();
@@ -609,6 +785,7 @@ bool ApplicationManager::loadApplicationConfig() {
     LOG_I("App", "Application config read (assigned=" + String(appConfig.assigned ? "true" : "false") + ")");
     LOG_I("App", "  API Endpoint: " + (appConfig.apiEndpoint.isEmpty() ? String("<empty>") : appConfig.apiEndpoint));
     LOG_I("App", "  API Token: " + (appConfig.apiToken.isEmpty() ? String("<empty>") : String("<redacted>")));
+    LOG_I("App", "  Telemetry Broker: " + (appConfig.telemetryBroker.isEmpty() ? String("<none>") : appConfig.telemetryBroker));
     LOG_I("App", "  Firmware URL: " + (appConfig.firmwareUrl.isEmpty() ? String("<empty>") : appConfig.firmwareUrl));
     LOG_I("App", "  Firmware Size: " + String(appConfig.firmwareSize));
 
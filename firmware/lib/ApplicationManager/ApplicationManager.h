@@ -6,8 +6,10 @@
 #include <MotorController.h>
 #include <APIManager.h>
 #include <UpdateClient.h>
+#include <LogSpill.h>
 #include <Preferences.h>
 #include <BasePrinter.h>
+#include <vector>
 
 
 
@@ -18,6 +20,8 @@ struct ApplicationConfig {
     String firmwareUrl;
     String firmwareMD5;
     size_t firmwareSize;
+    PayloadEncoding payloadEncoding;
+    String telemetryBroker;
     bool assigned;
 };
 
@@ -38,6 +42,7 @@ private:
     APIManager* apiManager;
     UpdateClient* updateClient;
     BasePrinter* printer;
+    LogSpill* logSpill;
 
     ApplicationState currentState;
     unsigned long stateChangeTime;
@@ -52,12 +57,34 @@ private:
     bool wifiPreviouslyConnected;
     bool fallbackServerActive;
 
+    TaskHandle_t networkTaskHandle;
+    TaskHandle_t motionTaskHandle;
+
+    // Log batches handed over by Logger's transmit callback, uploaded by the network task
+    SemaphoreHandle_t logHandoffMutex;
+    std::vector<String> pendingLogs;
+    uint32_t logBatchesDropped;
+
 public:
     ApplicationManager(BasePrinter* printer, MotorController* motorController = nullptr);
     ~ApplicationManager();
     
     bool init(const String& printerType);
+
+    /**
+     * @brief Run one network pass and one motion pass from the caller's task.
+     *        Only used when the pinned tasks are not running.
+     */
     void loop();
+
+    /**
+     * @brief Move the network and motion loops into their own pinned tasks.
+     *        Network I/O (WiFi, MQTT, HTTP) runs on NETWORK_TASK_CORE and the motor
+     *        loop on MOTION_TASK_CORE; they only talk through MotorController's queues.
+     * @return true if both tasks are running
+     */
+    bool startTasks();
+    bool tasksRunning() const { return networkTaskHandle != nullptr && motionTaskHandle != nullptr; }
     
     ApplicationState getState() const { return currentState; }
     bool isRunning() const { return currentState == ApplicationState::RUNNING; }
@@ -66,7 +93,14 @@ public:
     APIManager* getAPIManager() const { return apiManager; }
     
 private:
+    void networkLoop();
+    void motionLoop();
+    void processMotorEvents();
+    static void networkTask(void* param);
+    static void motionTask(void* param);
+
     bool initializeComponents();
+    void startLogSpill();
     bool connectToWiFi();
     bool connectPrinter();
     bool startServices();
@@ -76,12 +110,14 @@ private:
     void performHeartbeat();
     void checkWiFiConnection();
     void setupLogTransmission();
+    void forwardPendingLogs();
     String getStateString(ApplicationState state) const;
     void printApplicationInfo();
     void handlePrinterAlert(BasePrinter::AlertLevel level, const String& msg, const String& details);
     void checkPrinterConnection();
     bool savePrinterConfig(const String& configJson);
     void enqueueStatusUpdate(bool force = false, const BasePrinter::PrintStatus* statusOverride = nullptr);
+    void updateSessionInfo();
     void ensureFallbackServer();
     void evaluateUpdateHealth();
     void handlePrinterStatusEvent(const BasePrinter::PrintStatus& status);
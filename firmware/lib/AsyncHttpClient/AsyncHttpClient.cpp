@@ -0,0 +1,242 @@
+#include "AsyncHttpClient.h"
+#include <Logger.h>
+#include <algorithm>
+
+String AsyncHttpClient::Response::header(const char* name) const {
+    for (const Header& header : headers) {
+        if (header.name.equalsIgnoreCase(name)) {
+            return header.value;
+        }
+    }
+    return String();
+}
+
+AsyncHttpClient::AsyncHttpClient()
+    : slots()
+    , nextId(1)
+    , dropRequested(false)
+    , mutex(xSemaphoreCreateMutex())
+    , wake(xSemaphoreCreateBinary())
+    , exited(xSemaphoreCreateBinary())
+    , taskHandle(nullptr)
+    , stopping(false) {
+    http.setReuse(true);
+}
+
+AsyncHttpClient::~AsyncHttpClient() {
+    if (taskHandle) {
+        // Lets a request on the wire run into its deadline first
+        stopping = true;
+        xSemaphoreGive(wake);
+        xSemaphoreTake(exited, portMAX_DELAY);
+    }
+    vSemaphoreDelete(mutex);
+    vSemaphoreDelete(wake);
+    vSemaphoreDelete(exited);
+}
+
+bool AsyncHttpClient::start() {
+    if (taskHandle) return true;
+
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(task, "http", HTTP_TASK_STACK, this,
+                                HTTP_TASK_PRIORITY, &handle, HTTP_TASK_CORE) != pdPASS) {
+        LOG_W("Http", "Failed to create HTTP task, sending from the network loop");
+        return false;
+    }
+    taskHandle = handle;
+    return true;
+}
+
+void AsyncHttpClient::collectHeaders(const char* names[], size_t count) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    collectNames.assign(names, names + count);
+    xSemaphoreGive(mutex);
+}
+
+uint32_t AsyncHttpClient::submit(Request& request, uint32_t timeoutMs, Callback callback) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    Slot* slot = nullptr;
+    for (Slot& candidate : slots) {
+        if (candidate.state == SLOT_FREE) {
+            slot = &candidate;
+            break;
+        }
+    }
+    if (!slot) {
+        xSemaphoreGive(mutex);
+        return 0;
+    }
+
+    uint32_t id = nextId++;
+    if (nextId == 0) nextId = 1;
+    slot->id = id;
+    slot->request = std::move(request);
+    slot->callback = std::move(callback);
+    slot->submittedAt = millis();
+    slot->deadline = slot->submittedAt + timeoutMs;
+    slot->response = Response();
+    slot->state = SLOT_QUEUED;
+    xSemaphoreGive(mutex);
+
+    xSemaphoreGive(wake);
+    return id;
+}
+
+void AsyncHttpClient::poll() {
+    if (!taskHandle) {
+        Slot* slot = takeQueued();
+        if (slot) {
+            send(*slot);
+        }
+    }
+
+    // Oldest first, and with the slot already free so the callback can submit again
+    for (;;) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        Slot* done = nullptr;
+        for (Slot& slot : slots) {
+            if (slot.state == SLOT_DONE && (!done || static_cast<int32_t>(slot.id - done->id) < 0)) {
+                done = &slot;
+            }
+        }
+        if (!done) {
+            xSemaphoreGive(mutex);
+            return;
+        }
+        Callback callback = std::move(done->callback);
+        Response response = std::move(done->response);
+        done->callback = nullptr;
+        done->state = SLOT_FREE;
+        xSemaphoreGive(mutex);
+
+        if (callback) {
+            callback(response);
+        }
+    }
+}
+
+void AsyncHttpClient::dropConnection() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    dropRequested = true;
+    xSemaphoreGive(mutex);
+}
+
+size_t AsyncHttpClient::getInFlight() const {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    size_t count = 0;
+    for (const Slot& slot : slots) {
+        count += slot.state != SLOT_FREE ? 1 : 0;
+    }
+    xSemaphoreGive(mutex);
+    return count;
+}
+
+void AsyncHttpClient::task(void* param) {
+    AsyncHttpClient* self = static_cast<AsyncHttpClient*>(param);
+    while (!self->stopping) {
+        Slot* slot = self->takeQueued();
+        if (slot) {
+            self->send(*slot);
+            continue;
+        }
+        xSemaphoreTake(self->wake, pdMS_TO_TICKS(1000));
+    }
+    self->closeConnection();
+    xSemaphoreGive(self->exited);
+    vTaskDelete(nullptr);
+}
+
+// The oldest queued request, now SENDING
+AsyncHttpClient::Slot* AsyncHttpClient::takeQueued() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    Slot* next = nullptr;
+    for (Slot& slot : slots) {
+        if (slot.state == SLOT_QUEUED && (!next || static_cast<int32_t>(slot.id - next->id) < 0)) {
+            next = &slot;
+        }
+    }
+    if (next) {
+        next->state = SLOT_SENDING;
+    }
+    xSemaphoreGive(mutex);
+    return next;
+}
+
+void AsyncHttpClient::send(Slot& slot) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    std::vector<String> collect = collectNames;
+    bool drop = dropRequested;
+    dropRequested = false;
+    xSemaphoreGive(mutex);
+    if (drop) {
+        closeConnection();
+    }
+
+    Response& response = slot.response;
+    response.queuedMs = millis() - slot.submittedAt;
+    bool reused = false;
+    int code = post(slot, collect, reused);
+    if (code <= 0 && reused) {
+        // The server closed the idle connection under us and the request got no answer:
+        // send it once more on a fresh one, if there is time left
+        response.retried = true;
+        code = post(slot, collect, reused);
+    }
+    response.code = code;
+    response.reused = reused;
+
+    // The body can be large; let it go now rather than when the slot is reused
+    std::vector<uint8_t>().swap(slot.request.body);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    slot.state = SLOT_DONE;
+    xSemaphoreGive(mutex);
+}
+
+int AsyncHttpClient::post(Slot& slot, const std::vector<String>& collect, bool& reused) {
+    long remaining = static_cast<long>(slot.deadline - millis());
+    if (remaining <= 0) {
+        return HTTPC_ERROR_READ_TIMEOUT;
+    }
+    if (!http.begin(slot.request.url)) {
+        LOG_W("Http", "Failed to initialize HTTP client for " + slot.request.url);
+        return HTTPC_ERROR_NOT_CONNECTED;
+    }
+    // Still open from the previous request, which left it to us
+    reused = http.connected();
+
+    for (const Header& header : slot.request.headers) {
+        http.addHeader(header.name, header.value);
+    }
+    std::vector<const char*> names;
+    for (const String& name : collect) {
+        names.push_back(name.c_str());
+    }
+    http.collectHeaders(names.data(), names.size());
+    http.setConnectTimeout(remaining);
+    http.setTimeout(static_cast<uint16_t>(std::min<long>(remaining, UINT16_MAX)));
+
+    unsigned long start = millis();
+    int code = http.POST(slot.request.body.data(), slot.request.body.size());
+    if (code <= 0) {
+        closeConnection();
+        return code;
+    }
+    slot.response.latencyMs = millis() - start;
+    slot.response.headers.clear();
+    for (const String& name : collect) {
+        if (http.hasHeader(name.c_str())) {
+            slot.response.headers.push_back({name, http.header(name.c_str())});
+        }
+    }
+
+    // Leaves the connection open unless the server asked to close it
+    http.end();
+    return code;
+}
+
+void AsyncHttpClient::closeConnection() {
+    http.setReuse(false);
+    http.end();
+    http.setReuse(true);
+}
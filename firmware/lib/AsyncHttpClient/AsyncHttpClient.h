@@ -0,0 +1,120 @@
+#pragma once
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <functional>
+#include <vector>
+#include "Config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+/**
+ * @brief POSTs sent from a task of their own, so a slow or unreachable server costs the
+ *        caller a poll() rather than the connect and read timeouts
+ *
+ * submit() moves a request into one of HTTP_MAX_IN_FLIGHT slots and returns at once; the
+ * task sends queued requests in submission order on one kept-alive connection. poll(),
+ * from the caller's loop, hands finished responses to their callbacks, so callbacks run
+ * on the caller's task and may submit again. A request that is still waiting when its
+ * deadline passes fails with HTTPC_ERROR_READ_TIMEOUT without being sent; one that is
+ * sent gets connect and read timeouts cut to what is left of it.
+ *
+ * If the task can't be created, poll() sends one queued request itself, as before.
+ */
+class AsyncHttpClient {
+public:
+    struct Header {
+        String name;
+        String value;
+    };
+
+    struct Request {
+        String url;
+        std::vector<Header> headers;
+        std::vector<uint8_t> body;
+    };
+
+    struct Response {
+        int code;                     // HTTP status, or HTTPC_ERROR_* when <= 0
+        bool reused;                  // Sent on the connection the previous request left open
+        bool retried;                 // That connection had been closed; sent again on a new one
+        uint32_t queuedMs;            // Submit to the task picking it up
+        uint32_t latencyMs;           // Request sent to response head read
+        std::vector<Header> headers;  // Collected response headers that were present
+
+        String header(const char* name) const;
+    };
+
+    typedef std::function<void(const Response&)> Callback;
+
+    AsyncHttpClient();
+    ~AsyncHttpClient();
+
+    /**
+     * @brief Start the request task; false (and requests sent from poll()) if it can't be
+     */
+    bool start();
+
+    /**
+     * @brief Response headers to keep, as HTTPClient::collectHeaders; applies to requests
+     *        sent from now on
+     */
+    void collectHeaders(const char* names[], size_t count);
+
+    /**
+     * @brief Queue a POST; request is moved from
+     * @return Request id, or 0 when all HTTP_MAX_IN_FLIGHT slots are taken
+     */
+    uint32_t submit(Request& request, uint32_t timeoutMs, Callback callback);
+
+    /**
+     * @brief Run the callbacks of finished requests
+     */
+    void poll();
+
+    /**
+     * @brief Close the kept connection before the next request
+     */
+    void dropConnection();
+
+    size_t getInFlight() const;
+    bool isAsync() const { return taskHandle != nullptr; }
+
+private:
+    enum SlotState : uint8_t {
+        SLOT_FREE,
+        SLOT_QUEUED,
+        SLOT_SENDING,
+        SLOT_DONE
+    };
+
+    // Only the task touches a SENDING slot, only the caller a FREE or DONE one
+    struct Slot {
+        SlotState state;
+        uint32_t id;
+        Request request;
+        Callback callback;
+        unsigned long submittedAt;
+        unsigned long deadline;
+        Response response;
+    };
+
+    Slot slots[HTTP_MAX_IN_FLIGHT];
+    uint32_t nextId;
+    std::vector<String> collectNames;  // Under mutex; copied by the task per request
+
+    HTTPClient http;                   // Used by the task only (or by poll() without one)
+    bool dropRequested;                // Under mutex
+
+    SemaphoreHandle_t mutex;
+    SemaphoreHandle_t wake;            // Given on submit
+    SemaphoreHandle_t exited;          // Given by the task as it stops
+    TaskHandle_t taskHandle;
+    volatile bool stopping;
+
+    static void task(void* param);
+    Slot* takeQueued();
+    void send(Slot& slot);
+    int post(Slot& slot, const std::vector<String>& collect, bool& reused);
+    void closeConnection();
+};
@@ -0,0 +1,202 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-size queue of timer-driven actions for printer command sequencing
+ *
+ * Command handlers run inside the MQTT callback, so they must not delay(). Instead they
+ * schedule the follow-up step here and return; run() is called from the printer's loop()
+ * and fires whatever is due. Actions can be chained (then()), cancelled individually or
+ * by tag, and the clock is injectable so sequences can be tested against a virtual one.
+ */
+class ActionQueue {
+public:
+    typedef std::function<void()> Action;
+    typedef unsigned long (*Clock)();
+    typedef uint16_t Handle;
+
+    static const Handle kInvalidHandle = 0;
+    static const size_t kCapacity = 8;
+
+    explicit ActionQueue(Clock clock = millis) : nextHandle(1), clock(clock) {}
+
+    void setClock(Clock newClock) { clock = newClock; }
+    unsigned long now() const { return clock(); }
+
+    /**
+     * @brief Run an action once delayMs have elapsed
+     * @param tag Caller-defined group, see cancelTagged()
+     * @return Handle for cancel()/then(), or kInvalidHandle if the queue is full
+     */
+    Handle schedule(unsigned long delayMs, Action action, uint8_t tag = 0) {
+        return add(kInvalidHandle, delayMs, action, tag);
+    }
+
+    /**
+     * @brief Run an action delayMs after another one has fired
+     *
+     * The chained action inherits the tag of its predecessor and is cancelled with it.
+     * @return kInvalidHandle if the predecessor is no longer pending, since there is no
+     *         tag left to inherit; use the tagged overload when that can happen
+     */
+    Handle then(Handle after, unsigned long delayMs, Action action) {
+        Slot* parent = find(after);
+        return parent ? add(after, delayMs, action, parent->tag) : kInvalidHandle;
+    }
+
+    /**
+     * @brief Run an action delayMs after another one has fired, in the given tag
+     *
+     * The chained action is cancelled with its predecessor and by cancelTagged(tag).
+     * If the predecessor already fired, the delay counts from now.
+     */
+    Handle then(Handle after, unsigned long delayMs, Action action, uint8_t tag) {
+        if (after == kInvalidHandle) {
+            return kInvalidHandle;
+        }
+        return add(find(after) ? after : kInvalidHandle, delayMs, action, tag);
+    }
+
+    /**
+     * @brief Cancel a pending action and everything chained after it
+     * @return true if the action was still pending
+     */
+    bool cancel(Handle handle) {
+        Slot* slot = find(handle);
+        if (!slot) {
+            return false;
+        }
+        release(*slot);
+        for (size_t i = 0; i < kCapacity; i++) {
+            if (slots[i].handle != kInvalidHandle && slots[i].parent == handle) {
+                cancel(slots[i].handle);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Cancel every pending action scheduled with the given tag
+     * @return Number of actions cancelled (chained ones included)
+     */
+    size_t cancelTagged(uint8_t tag) {
+        size_t cancelled = 0;
+        for (size_t i = 0; i < kCapacity; i++) {
+            if (slots[i].handle != kInvalidHandle && slots[i].tag == tag) {
+                release(slots[i]);
+                cancelled++;
+            }
+        }
+        return cancelled;
+    }
+
+    /**
+     * @brief Fire every action that is due. Call this from loop()
+     *
+     * Only actions due when run() starts are fired, in due-time order, so an action that
+     * schedules another zero-delay action cannot starve the caller.
+     */
+    void run() {
+        unsigned long current = clock();
+        Handle due[kCapacity];
+        size_t dueCount = 0;
+        for (size_t i = 0; i < kCapacity; i++) {
+            const Slot& slot = slots[i];
+            if (slot.handle != kInvalidHandle && slot.armed && (long)(current - slot.dueAt) >= 0) {
+                // Insertion sort by due time; the queue is tiny
+                size_t pos = dueCount++;
+                while (pos > 0 && (long)(find(due[pos - 1])->dueAt - slot.dueAt) > 0) {
+                    due[pos] = due[pos - 1];
+                    pos--;
+                }
+                due[pos] = slot.handle;
+            }
+        }
+
+        for (size_t i = 0; i < dueCount; i++) {
+            Slot* slot = find(due[i]);
+            if (!slot) {
+                continue; // Cancelled by an action that fired before it
+            }
+            Action action = slot->action;
+            Handle fired = slot->handle;
+            release(*slot);
+            for (size_t j = 0; j < kCapacity; j++) {
+                if (slots[j].handle != kInvalidHandle && slots[j].parent == fired) {
+                    slots[j].parent = kInvalidHandle;
+                    slots[j].armed = true;
+                    slots[j].dueAt = current + slots[j].delayMs;
+                }
+            }
+            action();
+        }
+    }
+
+    bool isPending(Handle handle) const {
+        for (size_t i = 0; i < kCapacity; i++) {
+            if (handle != kInvalidHandle && slots[i].handle == handle) return true;
+        }
+        return false;
+    }
+
+    size_t pending() const {
+        size_t count = 0;
+        for (size_t i = 0; i < kCapacity; i++) {
+            if (slots[i].handle != kInvalidHandle) count++;
+        }
+        return count;
+    }
+
+private:
+    struct Slot {
+        Handle handle = kInvalidHandle;
+        Handle parent = kInvalidHandle;
+        unsigned long dueAt = 0;
+        unsigned long delayMs = 0;
+        uint8_t tag = 0;
+        bool armed = false;
+        Action action;
+    };
+
+    Slot slots[kCapacity];
+    Handle nextHandle;
+    Clock clock;
+
+    Handle add(Handle parent, unsigned long delayMs, const Action& action, uint8_t tag) {
+        for (size_t i = 0; i < kCapacity; i++) {
+            Slot& slot = slots[i];
+            if (slot.handle != kInvalidHandle) {
+                continue;
+            }
+            slot.handle = nextHandle++;
+            if (nextHandle == kInvalidHandle) {
+                nextHandle = 1;
+            }
+            slot.parent = parent;
+            slot.delayMs = delayMs;
+            slot.tag = tag;
+            slot.armed = (parent == kInvalidHandle);
+            slot.dueAt = clock() + delayMs;
+            slot.action = action;
+            return slot.handle;
+        }
+        return kInvalidHandle;
+    }
+
+    Slot* find(Handle handle) {
+        if (handle == kInvalidHandle) return nullptr;
+        for (size_t i = 0; i < kCapacity; i++) {
+            if (slots[i].handle == handle) return &slots[i];
+        }
+        return nullptr;
+    }
+
+    void release(Slot& slot) {
+        slot.handle = kInvalidHandle;
+        slot.parent = kInvalidHandle;
+        slot.armed = false;
+        slot.action = nullptr;
+    }
+};
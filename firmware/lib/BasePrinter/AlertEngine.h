@@ -0,0 +1,264 @@
+#pragma once
+#include <Arduino.h>
+#include <stdint.h>
+#include "Config.h"
+
+/**
+ * @brief Turns repeated observations of printer conditions into alerts on transitions
+ *
+ * A condition is keyed by (source, code, slot) and observed with a severity, 0 meaning
+ * clear. It takes ALERT_RAISE_SAMPLES observations in a row at a severity to move there
+ * and ALERT_CLEAR_SAMPLES clear ones to clear; hysteresis on the measured value itself
+ * is fallingSeverity()'s. observe() only reports transitions:
+ *
+ * - RAISED: was clear; unless the key was sent less than ALERT_SUPPRESS_MS ago at the
+ *   same severity or worse, in which case it flapped and the raise is suppressed
+ * - ESCALATED: worse than what was last sent
+ * - CLEARED: was set and is now clear
+ *
+ * Observations of an already-reported state are counted per key and in total, never
+ * sent. Raises and escalations share a budget of ALERT_RATE_PER_MINUTE; one over it stays
+ * pending and goes out on a later observation of its key.
+ *
+ * Sources that report the full list of what is active (HMS) bracket it with
+ * beginSweep()/endSweep(), which clears whatever the list no longer holds.
+ */
+class AlertEngine {
+public:
+    enum Source : uint8_t {
+        SOURCE_FILAMENT,
+        SOURCE_AMS,
+        SOURCE_HMS,
+        SOURCE_PRINT_ERROR,
+        SOURCE_CONNECTION
+    };
+
+    enum Transition : uint8_t {
+        NONE,
+        RAISED,
+        ESCALATED,
+        CLEARED
+    };
+
+    struct Key {
+        uint8_t source;
+        uint32_t code;
+        int8_t slot;        // -1 when the condition isn't tied to a slot
+    };
+
+    struct Stats {
+        uint32_t sent;             // Raises and escalations let through
+        uint32_t cleared;
+        uint32_t duplicates;       // Observations of a state already reported
+        uint32_t flapped;          // Raises suppressed inside the window
+        uint32_t rateLimited;      // Observations held back by the budget
+        uint32_t untracked;        // Raises dropped with every key slot taken
+    };
+
+    typedef unsigned long (*Clock)();
+
+    static const size_t kCapacity = ALERT_ENGINE_KEYS;
+
+    explicit AlertEngine(Clock clock = millis)
+        : clock(clock), tokens(ALERT_RATE_PER_MINUTE), refilledAt(0), stats() {
+        for (Entry& entry : entries) {
+            entry.used = false;
+        }
+    }
+
+    void setClock(Clock newClock) { clock = newClock; }
+
+    Transition observe(const Key& key, uint8_t severity) {
+        Entry* entry = find(key);
+        if (!entry) {
+            if (severity == 0) {
+                return NONE;
+            }
+            entry = allocate(key);
+            if (!entry) {
+                stats.untracked++;
+                return NONE;
+            }
+        }
+        entry->seen = true;
+
+        if (severity == entry->candidate) {
+            if (entry->samples < UINT8_MAX) entry->samples++;
+        } else {
+            entry->candidate = severity;
+            entry->samples = 1;
+        }
+        uint8_t needed = severity == 0 ? ALERT_CLEAR_SAMPLES : ALERT_RAISE_SAMPLES;
+        if (entry->samples >= needed) {
+            entry->state = severity;
+        }
+
+        if (entry->state == 0) {
+            if (entry->reported == 0) {
+                return NONE;
+            }
+            entry->reported = 0;
+            stats.cleared++;
+            return CLEARED;
+        }
+        if (entry->state <= entry->reported) {
+            // Eased off without clearing: getting worse again is an escalation
+            entry->reported = entry->state;
+            entry->repeats++;
+            stats.duplicates++;
+            return NONE;
+        }
+
+        unsigned long now = clock();
+        bool raise = entry->reported == 0;
+        if (raise && entry->sentAt != 0 && now - entry->sentAt < ALERT_SUPPRESS_MS && entry->state <= entry->peak) {
+            entry->reported = entry->state;
+            entry->repeats++;
+            stats.flapped++;
+            return NONE;
+        }
+        if (!takeToken(now)) {
+            stats.rateLimited++;
+            return NONE;
+        }
+        entry->reported = entry->state;
+        entry->peak = raise ? entry->state : max(entry->peak, entry->state);
+        entry->sentAt = now != 0 ? now : 1;
+        entry->repeats = 0;
+        stats.sent++;
+        return raise ? RAISED : ESCALATED;
+    }
+
+    void beginSweep(uint8_t source) {
+        for (Entry& entry : entries) {
+            if (entry.used && entry.key.source == source) {
+                entry.seen = false;
+            }
+        }
+    }
+
+    /**
+     * @brief Observe every key of source not seen since beginSweep() as clear
+     * @param onTransition Called as (const Key&, Transition) for each that cleared
+     */
+    template <typename Callback>
+    void endSweep(uint8_t source, Callback onTransition) {
+        for (Entry& entry : entries) {
+            if (!entry.used || entry.key.source != source || entry.seen) continue;
+            Key key = entry.key;
+            Transition transition = observe(key, 0);
+            if (transition != NONE) {
+                onTransition(key, transition);
+            }
+        }
+    }
+
+    uint8_t getSeverity(const Key& key) const {
+        const Entry* entry = find(key);
+        return entry ? entry->state : 0;
+    }
+
+    /**
+     * @brief Observations of the key's current state since it was last sent
+     */
+    uint32_t getRepeats(const Key& key) const {
+        const Entry* entry = find(key);
+        return entry ? entry->repeats : 0;
+    }
+
+    Stats getStats() const { return stats; }
+
+    /**
+     * @brief Severity of a level that gets worse as it falls
+     *
+     * Severity s applies below thresholds[s - 1] (descending), and is only left once the
+     * value is back at thresholds[s - 1] + margin or above.
+     */
+    static uint8_t fallingSeverity(int value, const int* thresholds, uint8_t count, uint8_t current, int margin) {
+        uint8_t raw = 0;
+        uint8_t held = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            if (value < thresholds[i]) raw = i + 1;
+            if (value < thresholds[i] + margin) held = i + 1;
+        }
+        return max(raw, min(current, held));
+    }
+
+private:
+    struct Entry {
+        bool used;
+        bool seen;              // Observed since the last beginSweep()
+        Key key;
+        uint8_t state;          // Debounced severity
+        uint8_t reported;       // Severity the desktop was last told about, 0 after a clear
+        uint8_t peak;           // Highest severity sent since the last raise
+        uint8_t candidate;      // Severity being debounced
+        uint8_t samples;
+        unsigned long sentAt;   // 0: never sent
+        uint32_t repeats;
+    };
+
+    Entry entries[kCapacity];
+    Clock clock;
+    uint8_t tokens;
+    unsigned long refilledAt;
+    Stats stats;
+
+    static bool sameKey(const Key& a, const Key& b) {
+        return a.source == b.source && a.code == b.code && a.slot == b.slot;
+    }
+
+    Entry* find(const Key& key) {
+        for (Entry& entry : entries) {
+            if (entry.used && sameKey(entry.key, key)) return &entry;
+        }
+        return nullptr;
+    }
+
+    const Entry* find(const Key& key) const {
+        return const_cast<AlertEngine*>(this)->find(key);
+    }
+
+    // A free slot, else the clear key sent longest ago (only its flap window is lost)
+    Entry* allocate(const Key& key) {
+        Entry* chosen = nullptr;
+        for (Entry& entry : entries) {
+            if (!entry.used) {
+                chosen = &entry;
+                break;
+            }
+            if (entry.state == 0 && entry.reported == 0 && (!chosen || entry.sentAt < chosen->sentAt)) {
+                chosen = &entry;
+            }
+        }
+        if (!chosen) return nullptr;
+
+        chosen->used = true;
+        chosen->seen = true;
+        chosen->key = key;
+        chosen->state = 0;
+        chosen->reported = 0;
+        chosen->peak = 0;
+        chosen->candidate = 0;
+        chosen->samples = 0;
+        chosen->sentAt = 0;
+        chosen->repeats = 0;
+        return chosen;
+    }
+
+    bool takeToken(unsigned long now) {
+        const unsigned long interval = 60000UL / ALERT_RATE_PER_MINUTE;
+        if (tokens >= ALERT_RATE_PER_MINUTE) {
+            refilledAt = now;
+        }
+        while (tokens < ALERT_RATE_PER_MINUTE && now - refilledAt >= interval) {
+            tokens++;
+            refilledAt += interval;
+        }
+        if (tokens == 0) {
+            return false;
+        }
+        tokens--;
+        return true;
+    }
+};
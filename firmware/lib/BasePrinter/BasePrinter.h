@@ -3,7 +3,9 @@
 #include <Config.h>
 #include <Logger.h>
 #include <ArduinoJson.h>
-#include <map>
+#include <CommandTable.h>
+#include <ActionQueue.h>
+#include <AlertEngine.h>
 #include <functional>
 
 /**
@@ -81,9 +83,7 @@ public:
     BasePrinter() : 
         connectionState(ConnectionState::DISCONNECTED),
         lastStatusUpdate(0),
-        alertCallback(nullptr) {
-        initializeCommandHandlers();
-    }
+        alertCallback(nullptr) {}
     
     virtual ~BasePrinter() = default;
 
@@ -234,7 +234,13 @@ public:
      * @param newState New state
      */
     virtual void onStateChange(PrinterState oldState, PrinterState newState) {
-        LOG_I("Printer", "State changed: " + stateToString(oldState) + " -> " + stateToString(newState));
+        LOG_IF("Printer", "State changed: %s -> %s", stateToString(oldState).c_str(), stateToString(newState).c_str());
+        if (printEnded(newState)) {
+            size_t cancelled = deferredActions.cancelTagged(ACTION_PRINT_SEQUENCE);
+            if (cancelled > 0) {
+                LOG_IF("Printer", "Cancelled %u pending print action(s)", static_cast<unsigned>(cancelled));
+            }
+        }
         publishStatusSnapshot(true);
     }
     
@@ -244,7 +250,7 @@ public:
      * @param errorMessage Human-readable error message
      */
     virtual void onError(int errorCode, const String& errorMessage) {
-        LOG_E("Printer", "Error " + String(errorCode) + ": " + errorMessage);
+        LOG_EF("Printer", "Error %d: %s", errorCode, errorMessage.c_str());
         publishStatusSnapshot(true);
     }
     
@@ -255,7 +261,7 @@ public:
      * @param slotId Slot/extruder ID
      */
     virtual void onFilamentChange(const String& oldMaterial, const String& newMaterial, int slotId) {
-        LOG_I("Printer", "Filament change: " + oldMaterial + " -> " + newMaterial + " (Slot " + String(slotId) + ")");
+        LOG_IF("Printer", "Filament change: %s -> %s (Slot %d)", oldMaterial.c_str(), newMaterial.c_str(), slotId);
     }
     
     /**
@@ -263,7 +269,7 @@ public:
      * @param layer Current layer number
      */
     virtual void onLayerChange(int layer) {
-        LOG_D("Printer", "Layer changed to: " + String(layer));
+        LOG_DF("Printer", "Layer changed to: %d", layer);
     }
 
     // Alert & status callback system
@@ -283,6 +289,7 @@ public:
     
     ConnectionState getConnectionState() const { return connectionState; }
     CommandState getCommandState() const { return commandState; }
+    AlertEngine::Stats getAlertStats() const { return alertEngine.getStats(); }
     
     String stateToString(PrinterState state) const {
         switch(state) {
@@ -309,8 +316,17 @@ public:
     }
 
 protected:
+    // Tags for deferredActions; print-sequence actions are dropped when the print ends
+    enum ActionTag : uint8_t {
+        ACTION_GENERAL = 0,
+        ACTION_PRINT_SEQUENCE
+    };
+
     ConnectionState connectionState;
     CommandState commandState;
+    ActionQueue deferredActions;
+    AlertEngine alertEngine;
+    ActionQueue::Handle pendingResume = ActionQueue::kInvalidHandle;
     unsigned long lastStatusUpdate;
     StatusCallback statusCallback;
     PrintStatus lastPublishedStatus;
@@ -318,39 +334,6 @@ protected:
     unsigned long lastStatusEmit = 0;
     AlertCallback alertCallback;
     
-    // Command handlers map - derived classes can add their own
-    std::map<String, std::function<void(const String&)>> commandHandlers;
-    
-    /**
-     * @brief Initialize standard ESP32 command handlers
-     * Derived classes should call this in their constructor and can add more handlers
-     */
-    void initializeCommandHandlers() {
-        // Register standard command handlers
-        commandHandlers["FILAMENT_CHANGE_START"] = [this](const String& p) { cmdFilamentChangeStart(p); };
-        commandHandlers["STARTING_PURGE"] = [this](const String& p) { cmdStartingPurge(p); };
-        commandHandlers["WASTE_BALL_COMPLETE"] = [this](const String& p) { cmdWasteBallComplete(p); };
-        commandHandlers["CLEAN_BALL_COMPLETE"] = [this](const String& p) { cmdCleanBallComplete(p); };
-        commandHandlers["MOVING_TO_WIPE"] = [this](const String& p) { cmdMovingToWipe(p); };
-        commandHandlers["WIPE_COMPLETE"] = [this](const String& p) { cmdWipeComplete(p); };
-        commandHandlers["RESUMING_PRINT"] = [this](const String& p) { cmdResumingPrint(p); };
-        commandHandlers["PAUSE_FOR_ESP"] = [this](const String& p) { cmdPauseForESP(p); };
-        commandHandlers["PRINT_START"] = [this](const String& p) { cmdPrintStart(p); };
-        commandHandlers["LAYER_CHANGE"] = [this](const String& p) { cmdLayerChange(p); };
-        commandHandlers["PRINT_PAUSE"] = [this](const String& p) { cmdPrintPause(p); };
-        commandHandlers["PRINT_RESUME"] = [this](const String& p) { cmdPrintResume(p); };
-        commandHandlers["PRINT_COMPLETE"] = [this](const String& p) { cmdPrintComplete(p); };
-        commandHandlers["PRINT_CANCEL"] = [this](const String& p) { cmdPrintCancel(p); };
-        commandHandlers["ERROR_DETECTED"] = [this](const String& p) { cmdErrorDetected(p); };
-        commandHandlers["RECOVERY_START"] = [this](const String& p) { cmdRecoveryStart(p); };
-        commandHandlers["RECOVERY_SUCCESS"] = [this](const String& p) { cmdRecoverySuccess(p); };
-        commandHandlers["MANUAL_INTERVENTION"] = [this](const String& p) { cmdManualIntervention(p); };
-        commandHandlers["CALIBRATION_START"] = [this](const String& p) { cmdCalibrationStart(p); };
-        commandHandlers["CALIBRATION_COMPLETE"] = [this](const String& p) { cmdCalibrationComplete(p); };
-        commandHandlers["MAINTENANCE_MODE"] = [this](const String& p) { cmdMaintenanceMode(p); };
-        commandHandlers["SYSTEM_CHECK"] = [this](const String& p) { cmdSystemCheck(p); };
-    }
-
     void notifyStatusUpdate(const PrintStatus& status, bool force = false) {
         if (!statusCallback) {
             return;
@@ -391,151 +374,190 @@ protected:
      * @param command Command name (without ESP32: prefix)
      * @param params Command parameters
      */
-    void processESP32Command(const String& command, const String& params = "") {
-        auto it = commandHandlers.find(command);
-        if (it != commandHandlers.end()) {
+    void processESP32Command(const CommandArg& command, const CommandArg& params = CommandArg()) {
+        static constexpr CommandEntry<BasePrinter> kCommands[] = {
+            ESP32_COMMAND("FILAMENT_CHANGE_START", &BasePrinter::cmdFilamentChangeStart),
+            ESP32_COMMAND("STARTING_PURGE", &BasePrinter::cmdStartingPurge),
+            ESP32_COMMAND("WASTE_BALL_COMPLETE", &BasePrinter::cmdWasteBallComplete),
+            ESP32_COMMAND("CLEAN_BALL_COMPLETE", &BasePrinter::cmdCleanBallComplete),
+            ESP32_COMMAND("MOVING_TO_WIPE", &BasePrinter::cmdMovingToWipe),
+            ESP32_COMMAND("WIPE_COMPLETE", &BasePrinter::cmdWipeComplete),
+            ESP32_COMMAND("RESUMING_PRINT", &BasePrinter::cmdResumingPrint),
+            ESP32_COMMAND("PAUSE_FOR_ESP", &BasePrinter::cmdPauseForESP),
+            ESP32_COMMAND("PRINT_START", &BasePrinter::cmdPrintStart),
+            ESP32_COMMAND("LAYER_CHANGE", &BasePrinter::cmdLayerChange),
+            ESP32_COMMAND("PRINT_PAUSE", &BasePrinter::cmdPrintPause),
+            ESP32_COMMAND("PRINT_RESUME", &BasePrinter::cmdPrintResume),
+            ESP32_COMMAND("PRINT_COMPLETE", &BasePrinter::cmdPrintComplete),
+            ESP32_COMMAND("PRINT_CANCEL", &BasePrinter::cmdPrintCancel),
+            ESP32_COMMAND("ERROR_DETECTED", &BasePrinter::cmdErrorDetected),
+            ESP32_COMMAND("RECOVERY_START", &BasePrinter::cmdRecoveryStart),
+            ESP32_COMMAND("RECOVERY_SUCCESS", &BasePrinter::cmdRecoverySuccess),
+            ESP32_COMMAND("MANUAL_INTERVENTION", &BasePrinter::cmdManualIntervention),
+            ESP32_COMMAND("CALIBRATION_START", &BasePrinter::cmdCalibrationStart),
+            ESP32_COMMAND("CALIBRATION_COMPLETE", &BasePrinter::cmdCalibrationComplete),
+            ESP32_COMMAND("MAINTENANCE_MODE", &BasePrinter::cmdMaintenanceMode),
+            ESP32_COMMAND("SYSTEM_CHECK", &BasePrinter::cmdSystemCheck),
+        };
+        static constexpr auto kCommandTable = makeCommandTable(kCommands);
+        static_assert(kCommandTable.seed != command_table::kNoSeed, "No perfect hash seed for ESP32 commands");
+
+        // Handlers are virtual, so driver overrides of the standard commands still apply
+        if (dispatchDriverCommand(command, params) || kCommandTable.dispatch(*this, command, params)) {
             commandState.lastCommandTime = millis();
-            it->second(params);
-        } else {
-            LOG_W("Printer", "Unknown ESP32 command: " + command);
+            return;
         }
+        LOG_WF("Printer", "Unknown ESP32 command: %.*s", static_cast<int>(command.length), command.data);
+    }
+
+    /**
+     * @brief Dispatch driver-specific ESP32 commands
+     *
+     * Drivers with extra commands keep their own static constexpr CommandTable and
+     * look the command up here; it is consulted before the standard command table.
+     * @return true if the command was handled
+     */
+    virtual bool dispatchDriverCommand(const CommandArg& command, const CommandArg& params) {
+        return false;
     }
     
     /**
      * @brief Parse ESP32 commands from messages (e.g., M117)
-     * @param message Message content
+     * @param message Message content; command and params are views into it
      * @return true if ESP32 command was found and processed
      */
-    bool parseESP32CommandFromMessage(const String& message) {
+    bool parseESP32CommandFromMessage(const CommandArg& message) {
         if (message.startsWith("ESP32:")) {
-            int colonPos = message.indexOf(':', 6);
+            CommandArg body = message.substring(6);
+            int colonPos = body.indexOf(':');
             if (colonPos > 0) {
-                String command = message.substring(6, colonPos);
-                String params = message.substring(colonPos + 1);
-                processESP32Command(command, params);
+                processESP32Command(body.substring(0, colonPos), body.substring(colonPos + 1));
             } else {
-                String command = message.substring(6);
-                processESP32Command(command, "");
+                processESP32Command(body);
             }
             return true;
         }
         return false;
     }
+
+    bool parseESP32CommandFromMessage(const String& message) {
+        return parseESP32CommandFromMessage(CommandArg(message));
+    }
     
     // Default command implementations - derived classes can override
     
-    virtual void cmdFilamentChangeStart(const String& params) {
+    virtual void cmdFilamentChangeStart(const CommandArg& params) {
         logAction("Starting filament change sequence");
         commandState.isChangingFilament = true;
         commandState.changeStartTime = millis();
         commandState.previousMaterial = commandState.currentMaterial;
     }
     
-    virtual void cmdStartingPurge(const String& params) {
+    virtual void cmdStartingPurge(const CommandArg& params) {
         logAction("Purge started - will unpause printer in 1 second");
         commandState.isPurging = true;
         // Derived classes should handle unpause with their specific timing
     }
     
-    virtual void cmdWasteBallComplete(const String& params) {
+    virtual void cmdWasteBallComplete(const CommandArg& params) {
         logAction("Waste ball complete");
         // Derived classes handle routing
     }
     
-    virtual void cmdCleanBallComplete(const String& params) {
+    virtual void cmdCleanBallComplete(const CommandArg& params) {
         logAction("Clean ball complete");
         // Derived classes handle routing
     }
     
-    virtual void cmdMovingToWipe(const String& params) {
+    virtual void cmdMovingToWipe(const CommandArg& params) {
         logAction("Moving to wipe position");
     }
     
-    virtual void cmdWipeComplete(const String& params) {
+    virtual void cmdWipeComplete(const CommandArg& params) {
         logAction("Wipe complete");
         commandState.isPurging = false;
     }
     
-    virtual void cmdResumingPrint(const String& params) {
+    virtual void cmdResumingPrint(const CommandArg& params) {
         logAction("Filament change complete - resuming print");
         resetFilamentChangeState();
     }
     
-    virtual void cmdPauseForESP(const String& params) {
+    virtual void cmdPauseForESP(const CommandArg& params) {
         logAction("Printer paused for ESP32");
         commandState.isPaused = true;
         // Derived classes handle unpause logic
     }
     
-    virtual void cmdPrintStart(const String& params) {
+    virtual void cmdPrintStart(const CommandArg& params) {
         logAction("Print job started - monitoring enabled");
         resetFilamentChangeState();
     }
     
-    virtual void cmdLayerChange(const String& params) {
+    virtual void cmdLayerChange(const CommandArg& params) {
         int layer = params.toInt();
         logAction("Layer " + String(layer) + " started");
         onLayerChange(layer);
     }
     
-    virtual void cmdPrintPause(const String& params) {
+    virtual void cmdPrintPause(const CommandArg& params) {
         logAction("Print paused");
         commandState.isPaused = true;
     }
     
-    virtual void cmdPrintResume(const String& params) {
+    virtual void cmdPrintResume(const CommandArg& params) {
         logAction("Print resumed");
         commandState.isPaused = false;
     }
     
-    virtual void cmdPrintComplete(const String& params) {
+    virtual void cmdPrintComplete(const CommandArg& params) {
         logAction("Print completed successfully");
         resetFilamentChangeState();
     }
     
-    virtual void cmdPrintCancel(const String& params) {
+    virtual void cmdPrintCancel(const CommandArg& params) {
         logAction("Print cancelled");
         resetFilamentChangeState();
     }
     
-    virtual void cmdErrorDetected(const String& params) {
-        logAction("Print error detected - Code " + params);
-        sendAlert(AlertLevel::ALERT_HIGH, "Print error detected", "Error code: " + params);
+    virtual void cmdErrorDetected(const CommandArg& params) {
+        logAction("Print error detected - Code " + params.toString());
+        sendAlert(AlertLevel::ALERT_HIGH, "Print error detected", "Error code: " + params.toString());
     }
     
-    virtual void cmdRecoveryStart(const String& params) {
+    virtual void cmdRecoveryStart(const CommandArg& params) {
         logAction("Error recovery started");
     }
     
-    virtual void cmdRecoverySuccess(const String& params) {
+    virtual void cmdRecoverySuccess(const CommandArg& params) {
         logAction("Error recovery successful");
     }
     
-    virtual void cmdManualIntervention(const String& params) {
+    virtual void cmdManualIntervention(const CommandArg& params) {
         logAction("Manual intervention required");
         sendAlert(AlertLevel::ALERT_HIGH, "Manual intervention required", "Please check the printer");
     }
     
-    virtual void cmdCalibrationStart(const String& params) {
+    virtual void cmdCalibrationStart(const CommandArg& params) {
         logAction("Printer calibration started");
     }
     
-    virtual void cmdCalibrationComplete(const String& params) {
+    virtual void cmdCalibrationComplete(const CommandArg& params) {
         logAction("Calibration completed");
     }
     
-    virtual void cmdMaintenanceMode(const String& params) {
+    virtual void cmdMaintenanceMode(const CommandArg& params) {
         logAction("Maintenance mode activated");
     }
     
-    virtual void cmdSystemCheck(const String& params) {
+    virtual void cmdSystemCheck(const CommandArg& params) {
         logAction("Performing system health check");
     }
     
     // Helper functions for derived classes
     
     void logAction(const String& action) {
-        LOG_I("Printer", "ACTION: " + action);
+        LOG_IF("Printer", "ACTION: %s", action.c_str());
     }
     
     void sendAlert(AlertLevel level, const String& message, const String& details) {
@@ -547,13 +569,70 @@ protected:
             case AlertLevel::ALERT_LOW: levelStr = "LOW"; break;
         }
         
-        LOG_W("Alert", levelStr + ": " + message + " - " + details);
+        LOG_WF("Alert", "%s: %s - %s", levelStr.c_str(), message.c_str(), details.c_str());
         
         if (alertCallback) {
             alertCallback(level, message, details);
         }
     }
     
+    /**
+     * @brief Observe a condition the driver sees at level
+     * @return true if it is new or worse and the alert should be sent now
+     */
+    bool alertRaised(const AlertEngine::Key& key, AlertLevel level) {
+        AlertEngine::Transition transition = alertEngine.observe(key, static_cast<uint8_t>(level) + 1);
+        return transition == AlertEngine::RAISED || transition == AlertEngine::ESCALATED;
+    }
+
+    /**
+     * @brief Observe that a condition is no longer present
+     */
+    void alertAbsent(const AlertEngine::Key& key) {
+        if (alertEngine.observe(key, 0) == AlertEngine::CLEARED) {
+            logAlertCleared(key);
+        }
+    }
+
+    void logAlertCleared(const AlertEngine::Key& key) {
+        LOG_IF("Alert", "Cleared: source %u code %lu slot %d (%lu repeat(s) suppressed)",
+               key.source, static_cast<unsigned long>(key.code), key.slot,
+               static_cast<unsigned long>(alertEngine.getRepeats(key)));
+    }
+
+    /**
+     * @brief Fire due deferred actions; drivers call this from loop()
+     */
+    void runDeferredActions() {
+        deferredActions.run();
+    }
+
+    /**
+     * @brief Resume the print after delayMs without blocking the caller
+     *
+     * Replaces any resume that is still pending, so repeated pause commands in
+     * consecutive reports only resume once.
+     * @param onResumed Optional step to run right after the resume is sent
+     */
+    void scheduleResume(unsigned long delayMs, ActionQueue::Action onResumed = nullptr) {
+        deferredActions.cancel(pendingResume);
+        pendingResume = deferredActions.schedule(delayMs, [this]() { resumePrint(); }, ACTION_PRINT_SEQUENCE);
+        if (pendingResume == ActionQueue::kInvalidHandle) {
+            LOG_W("Printer", "Deferred action queue full, resuming immediately");
+            resumePrint();
+            if (onResumed) onResumed();
+            return;
+        }
+        if (onResumed) {
+            deferredActions.then(pendingResume, 0, onResumed, ACTION_PRINT_SEQUENCE);
+        }
+    }
+
+    static bool printEnded(PrinterState state) {
+        return state == PrinterState::IDLE || state == PrinterState::ERROR ||
+               state == PrinterState::FINISHED || state == PrinterState::CANCELLED;
+    }
+
     void resetFilamentChangeState() {
         commandState.isChangingFilament = false;
         commandState.isPurging = false;
@@ -561,11 +640,11 @@ protected:
         commandState.previousMaterial = "";
     }
     
-    String parseMaterialChangeParams(const String& params, String& oldMaterial, String& newMaterial) {
+    String parseMaterialChangeParams(const CommandArg& params, String& oldMaterial, String& newMaterial) {
         int colonPos = params.indexOf(':');
         if (colonPos > 0) {
-            oldMaterial = params.substring(0, colonPos);
-            newMaterial = params.substring(colonPos + 1);
+            oldMaterial = params.substring(0, colonPos).toString();
+            newMaterial = params.substring(colonPos + 1).toString();
             return newMaterial;
         }
         return "";
@@ -0,0 +1,233 @@
+#pragma once
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Non-owning view into command text (e.g. the "msg" field of a printer report)
+ *
+ * ESP32: command names and parameters are sliced out of the incoming buffer without
+ * copying; the view is only valid while that buffer is.
+ */
+struct CommandArg {
+    const char* data;
+    size_t length;
+
+    constexpr CommandArg() : data(""), length(0) {}
+    constexpr CommandArg(const char* str, size_t len) : data(str), length(len) {}
+    explicit CommandArg(const char* str) : data(str ? str : ""), length(str ? strlen(str) : 0) {}
+    explicit CommandArg(const String& str) : data(str.c_str()), length(str.length()) {}
+
+    bool isEmpty() const { return length == 0; }
+
+    bool startsWith(const char* prefix) const {
+        size_t n = strlen(prefix);
+        return n <= length && memcmp(data, prefix, n) == 0;
+    }
+
+    bool equals(const char* other) const {
+        return strlen(other) == length && memcmp(data, other, length) == 0;
+    }
+
+    int indexOf(char c, size_t from = 0) const {
+        for (size_t i = from; i < length; i++) {
+            if (data[i] == c) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    int indexOf(const char* needle) const {
+        size_t n = strlen(needle);
+        for (size_t i = 0; n <= length && i <= length - n; i++) {
+            if (memcmp(data + i, needle, n) == 0) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    CommandArg substring(size_t from) const {
+        return from >= length ? CommandArg(data + length, 0) : CommandArg(data + from, length - from);
+    }
+
+    CommandArg substring(size_t from, size_t to) const {
+        if (to > length) to = length;
+        return from >= to ? CommandArg(data + to, 0) : CommandArg(data + from, to - from);
+    }
+
+    /**
+     * @brief Parse a leading decimal integer, with the same leniency as String::toInt()
+     */
+    long toInt() const {
+        size_t i = 0;
+        while (i < length && (data[i] == ' ' || data[i] == '\t')) i++;
+        bool negative = false;
+        if (i < length && (data[i] == '-' || data[i] == '+')) {
+            negative = data[i] == '-';
+            i++;
+        }
+        long value = 0;
+        for (; i < length && data[i] >= '0' && data[i] <= '9'; i++) {
+            value = value * 10 + (data[i] - '0');
+        }
+        return negative ? -value : value;
+    }
+
+    /**
+     * @brief Copy the viewed text into a String (allocates; use for storage or logging only)
+     */
+    String toString() const {
+        String out;
+        out.reserve(length);
+        for (size_t i = 0; i < length; i++) {
+            out += data[i];
+        }
+        return out;
+    }
+};
+
+/**
+ * @brief One ESP32: command name bound to a handler of the owning printer class
+ */
+template <typename Owner>
+struct CommandEntry {
+    typedef void (Owner::*Handler)(const CommandArg& params);
+
+    const char* name;
+    size_t length;
+    Handler handler;
+};
+
+namespace command_table {
+
+constexpr size_t kNoSlot = 0xFF;
+constexpr uint32_t kNoSeed = 0xFFFFFFFFUL;
+constexpr uint32_t kMaxSeed = 256;
+
+constexpr size_t length(const char* s) {
+    return *s ? 1 + length(s + 1) : 0;
+}
+
+// FNV-1a with the seed folded into the offset basis, followed by a murmur3 finalizer
+// so the low bits used for bucketing depend on every input byte
+constexpr uint32_t fnv1a(uint32_t h, const char* s, size_t n) {
+    return n == 0 ? h : fnv1a((h ^ static_cast<uint8_t>(*s)) * 16777619UL, s + 1, n - 1);
+}
+
+constexpr uint32_t fmix3(uint32_t h) { return h ^ (h >> 16); }
+constexpr uint32_t fmix2(uint32_t h) { return fmix3((h ^ (h >> 13)) * 0xC2B2AE35UL); }
+constexpr uint32_t fmix1(uint32_t h) { return fmix2((h ^ (h >> 16)) * 0x85EBCA6BUL); }
+
+constexpr uint32_t hash(uint32_t seed, const char* s, size_t n) {
+    return fmix1(fnv1a(2166136261UL ^ (seed * 0x9E3779B9UL), s, n));
+}
+
+// Bucket count: smallest power of two holding at least 4 buckets per command,
+// which keeps a collision-free seed within a few dozen tries for tables this size
+constexpr size_t buckets(size_t n, size_t b = 8) {
+    return b >= 4 * n ? b : buckets(n, b * 2);
+}
+
+template <typename Owner>
+constexpr uint32_t bucketOf(const CommandEntry<Owner>& e, uint32_t seed, size_t mask) {
+    return hash(seed, e.name, e.length) & mask;
+}
+
+template <typename Owner>
+constexpr bool collides(const CommandEntry<Owner>* e, size_t n, size_t i, size_t j, uint32_t seed, size_t mask) {
+    return j >= n ? false
+         : (bucketOf(e[i], seed, mask) == bucketOf(e[j], seed, mask) || collides(e, n, i, j + 1, seed, mask));
+}
+
+template <typename Owner>
+constexpr bool isPerfect(const CommandEntry<Owner>* e, size_t n, uint32_t seed, size_t mask, size_t i = 0) {
+    return i >= n ? true : (!collides(e, n, i, i + 1, seed, mask) && isPerfect(e, n, seed, mask, i + 1));
+}
+
+template <typename Owner>
+constexpr uint32_t findSeed(const CommandEntry<Owner>* e, size_t n, size_t mask, uint32_t seed = 0) {
+    return seed >= kMaxSeed ? kNoSeed
+         : isPerfect(e, n, seed, mask) ? seed
+         : findSeed(e, n, mask, seed + 1);
+}
+
+template <typename Owner>
+constexpr uint8_t slotFor(const CommandEntry<Owner>* e, size_t n, uint32_t seed, size_t mask, size_t bucket, size_t i = 0) {
+    return i >= n ? kNoSlot
+         : bucketOf(e[i], seed, mask) == bucket ? static_cast<uint8_t>(i)
+         : slotFor(e, n, seed, mask, bucket, i + 1);
+}
+
+template <size_t... I> struct IndexSeq {};
+template <size_t N, size_t... I> struct MakeIndexSeq : MakeIndexSeq<N - 1, N - 1, I...> {};
+template <size_t... I> struct MakeIndexSeq<0, I...> { typedef IndexSeq<I...> type; };
+
+} // namespace command_table
+
+/**
+ * @brief Compile-time perfect-hash table of ESP32: commands for one printer class
+ *
+ * Build it with makeCommandTable() from a static constexpr CommandEntry array; the seed
+ * is searched at compile time so every name lands in its own bucket, and a lookup costs
+ * one hash of the name plus one memcmp. Drivers keep their own table and consult it
+ * before the BasePrinter one (see BasePrinter::dispatchDriverCommand()).
+ */
+template <typename Owner, size_t N>
+struct CommandTable {
+    static constexpr size_t kBuckets = command_table::buckets(N);
+
+    const CommandEntry<Owner>* entries;
+    uint32_t seed;
+    uint8_t slots[kBuckets];
+
+    /**
+     * @brief Run the handler registered for a command
+     * @return false if the command is not in this table
+     */
+    bool dispatch(Owner& owner, const CommandArg& command, const CommandArg& params) const {
+        const CommandEntry<Owner>* entry = find(command);
+        if (!entry) {
+            return false;
+        }
+        (owner.*(entry->handler))(params);
+        return true;
+    }
+
+    const CommandEntry<Owner>* find(const CommandArg& command) const {
+        uint32_t bucket = command_table::hash(seed, command.data, command.length) & (kBuckets - 1);
+        uint8_t slot = slots[bucket];
+        if (slot == command_table::kNoSlot) {
+            return nullptr;
+        }
+        const CommandEntry<Owner>& entry = entries[slot];
+        if (entry.length != command.length || memcmp(entry.name, command.data, command.length) != 0) {
+            return nullptr;
+        }
+        return &entry;
+    }
+};
+
+template <typename Owner, size_t N>
+constexpr size_t CommandTable<Owner, N>::kBuckets;
+
+namespace command_table {
+
+template <typename Owner, size_t N, size_t... B>
+constexpr CommandTable<Owner, N> build(const CommandEntry<Owner> (&entries)[N], uint32_t seed, IndexSeq<B...>) {
+    return CommandTable<Owner, N>{ entries, seed, { slotFor(entries, N, seed, buckets(N) - 1, B)... } };
+}
+
+} // namespace command_table
+
+/**
+ * @brief Build a perfect-hash CommandTable over a static constexpr entry array
+ *
+ * Check the result with static_assert(table.seed != command_table::kNoSeed, ...).
+ */
+template <typename Owner, size_t N>
+constexpr CommandTable<Owner, N> makeCommandTable(const CommandEntry<Owner> (&entries)[N]) {
+    return command_table::build(entries,
+                                command_table::findSeed(entries, N, command_table::buckets(N) - 1),
+                                typename command_table::MakeIndexSeq<command_table::buckets(N)>::type());
+}
+
+#define ESP32_COMMAND(name, handler) { name, command_table::length(name), handler }
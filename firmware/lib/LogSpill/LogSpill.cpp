@@ -0,0 +1,287 @@
+#include "LogSpill.h"
+#include "Crc32.h"
+#include "LogJson.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+const char* kSegmentPrefix = "log_";
+const char* kSegmentSuffix = ".seg";
+
+// A record read back from a segment, in the shape LogJsonBatch::appendRecord expects
+struct SpilledRecord {
+    uint32_t sequence;
+    uint32_t timestamp;
+    uint8_t level;
+    char component[Logger::Ring::kComponentNameBytes];
+    char message[Logger::Ring::kMaxMessage + 1];
+};
+
+enum ReadResult {
+    READ_OK,
+    READ_END,
+    READ_CORRUPT
+};
+
+void putU32(uint8_t* out, uint32_t value) {
+    out[0] = value;
+    out[1] = value >> 8;
+    out[2] = value >> 16;
+    out[3] = value >> 24;
+}
+
+uint32_t getU32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+ReadResult readRecord(File& file, SpilledRecord& record) {
+    uint8_t header[16];
+    size_t got = file.read(header, sizeof(header));
+    if (got == 0) return READ_END;
+    if (got != sizeof(header)) return READ_CORRUPT;
+
+    uint8_t componentLength = header[9];
+    uint16_t messageLength = header[10] | (header[11] << 8);
+    if (componentLength >= sizeof(record.component) || messageLength >= sizeof(record.message)) {
+        return READ_CORRUPT;
+    }
+    if (file.read(reinterpret_cast<uint8_t*>(record.component), componentLength) != componentLength ||
+        file.read(reinterpret_cast<uint8_t*>(record.message), messageLength) != messageLength) {
+        return READ_CORRUPT;
+    }
+
+    uint32_t stored = getU32(header + 12);
+    putU32(header + 12, 0);
+    uint32_t crc = crc32(0, header, sizeof(header));
+    crc = crc32(crc, reinterpret_cast<const uint8_t*>(record.component), componentLength);
+    crc = crc32(crc, reinterpret_cast<const uint8_t*>(record.message), messageLength);
+    if (crc != stored) return READ_CORRUPT;
+
+    record.sequence = getU32(header);
+    record.timestamp = getU32(header + 4);
+    record.level = header[8];
+    record.component[componentLength] = '\0';
+    record.message[messageLength] = '\0';
+    return READ_OK;
+}
+}
+
+LogSpill::LogSpill(fs::FS& fs)
+    : fs(fs), mutex(xSemaphoreCreateMutex()), segmentCount(0), startNewSegment(true), nextSequence(0),
+      batchUsed(0), batchFirst(0), batchNext(0), writeFailures(0), corruptRecords(0) {}
+
+LogSpill::~LogSpill() {
+    if (mutex) {
+        vSemaphoreDelete(mutex);
+    }
+}
+
+void LogSpill::segmentPath(uint32_t first, char* path, size_t size) {
+    snprintf(path, size, "/%s%08x%s", kSegmentPrefix, static_cast<unsigned>(first), kSegmentSuffix);
+}
+
+bool LogSpill::parseSegmentName(const char* name, uint32_t& first) {
+    // Arduino-ESP32 1.x returns the full path, 2.x only the name
+    if (name[0] == '/') name++;
+    size_t prefix = strlen(kSegmentPrefix);
+    if (strncmp(name, kSegmentPrefix, prefix) != 0 || strlen(name) != prefix + 8 + strlen(kSegmentSuffix) ||
+        strcmp(name + prefix + 8, kSegmentSuffix) != 0) {
+        return false;
+    }
+    char* end = nullptr;
+    first = strtoul(name + prefix, &end, 16);
+    return end == name + prefix + 8;
+}
+
+uint32_t LogSpill::scanSegment(const Segment& segment, uint32_t& bytes) {
+    char path[32];
+    segmentPath(segment.first, path, sizeof(path));
+    File file = fs.open(path, FILE_READ);
+    bytes = file ? file.size() : 0;
+
+    SpilledRecord record;
+    uint32_t next = segment.first;
+    ReadResult result = READ_END;
+    while (file && (result = readRecord(file, record)) == READ_OK) {
+        next = record.sequence + 1;
+    }
+    if (file && result == READ_CORRUPT) {
+        corruptRecords++;
+    }
+    return next;
+}
+
+uint32_t LogSpill::begin() {
+    std::vector<Segment> found;
+    File root = fs.open("/");
+    for (File file = root.openNextFile(); file; file = root.openNextFile()) {
+        uint32_t first;
+        if (!file.isDirectory() && parseSegmentName(file.name(), first)) {
+            found.push_back({first, static_cast<uint32_t>(file.size())});
+        }
+    }
+    root.close();
+
+    // Listing order is not guaranteed; keep the newest LOG_SPILL_SEGMENTS
+    std::sort(found.begin(), found.end(), [](const Segment& a, const Segment& b) { return a.first < b.first; });
+    while (found.size() > LOG_SPILL_SEGMENTS) {
+        char path[32];
+        segmentPath(found.front().first, path, sizeof(path));
+        fs.remove(path);
+        found.erase(found.begin());
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    segmentCount = found.size();
+    std::copy(found.begin(), found.end(), segments);
+    nextSequence = 0;
+    while (segmentCount > 0) {
+        Segment& newest = segments[segmentCount - 1];
+        nextSequence = scanSegment(newest, newest.bytes);
+        if (nextSequence != newest.first) break;
+        // Nothing readable in it; drop it so the next segment can reuse the name
+        char path[32];
+        segmentPath(newest.first, path, sizeof(path));
+        fs.remove(path);
+        segmentCount--;
+    }
+    startNewSegment = true;
+    uint32_t next = nextSequence;
+    xSemaphoreGive(mutex);
+    return next;
+}
+
+bool LogSpill::write(const Logger::Ring::Record& record) {
+    size_t componentLength = strnlen(record.component, Logger::Ring::kComponentNameBytes - 1);
+    size_t size = kHeaderBytes + componentLength + record.length;
+    if (batchUsed + size > sizeof(batch)) {
+        return false;
+    }
+
+    uint8_t* out = batch + batchUsed;
+    putU32(out, record.sequence);
+    putU32(out + 4, record.timestamp);
+    out[8] = record.level;
+    out[9] = static_cast<uint8_t>(componentLength);
+    out[10] = record.length & 0xFF;
+    out[11] = record.length >> 8;
+    putU32(out + 12, 0);
+    memcpy(out + kHeaderBytes, record.component, componentLength);
+    memcpy(out + kHeaderBytes + componentLength, record.message, record.length);
+    putU32(out + 12, crc32(0, out, size));
+
+    if (batchUsed == 0) {
+        batchFirst = record.sequence;
+    }
+    batchUsed += size;
+    batchNext = record.sequence + 1;
+    return true;
+}
+
+void LogSpill::commit() {
+    if (batchUsed == 0) return;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    char path[32];
+    if (startNewSegment || segmentCount == 0 ||
+        segments[segmentCount - 1].bytes + batchUsed > LOG_SPILL_SEGMENT_BYTES) {
+        if (segmentCount == LOG_SPILL_SEGMENTS) {
+            segmentPath(segments[0].first, path, sizeof(path));
+            fs.remove(path);
+            std::copy(segments + 1, segments + segmentCount, segments);
+            segmentCount--;
+        }
+        segments[segmentCount].first = batchFirst;
+        segments[segmentCount].bytes = 0;
+        segmentCount++;
+        startNewSegment = false;
+    }
+
+    Segment& current = segments[segmentCount - 1];
+    segmentPath(current.first, path, sizeof(path));
+    File file = fs.open(path, FILE_APPEND);
+    size_t written = file ? file.write(batch, batchUsed) : 0;
+    file.close();
+
+    if (written == batchUsed) {
+        current.bytes += written;
+    } else {
+        // Whatever made it out is a torn record as far as readers are concerned; the
+        // batch is lost, and the next one starts a clean segment
+        writeFailures++;
+        current.bytes += written;
+        startNewSegment = true;
+    }
+    nextSequence = batchNext;
+    batchUsed = 0;
+    xSemaphoreGive(mutex);
+}
+
+uint32_t LogSpill::writeJson(Print& out, uint32_t since, size_t limit) {
+    // Work from a snapshot of the table so commit() is never held up by a slow reader; a
+    // segment deleted meanwhile simply fails to open
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    Segment snapshot[LOG_SPILL_SEGMENTS];
+    size_t count = segmentCount;
+    std::copy(segments, segments + count, snapshot);
+    uint32_t oldest = count > 0 ? snapshot[0].first : nextSequence;
+    xSemaphoreGive(mutex);
+
+    LogJsonBatch json;
+    json.beginDocument(since, oldest);
+
+    // The newest segment starting at or before since holds it
+    size_t start = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (static_cast<int32_t>(snapshot[i].first - since) <= 0) start = i;
+    }
+
+    uint32_t cursor = static_cast<int32_t>(oldest - since) > 0 ? oldest : since;
+    size_t written = 0;
+    SpilledRecord record;
+    for (size_t i = start; i < count && written < limit; i++) {
+        char path[32];
+        segmentPath(snapshot[i].first, path, sizeof(path));
+        File file = fs.open(path, FILE_READ);
+        if (!file) continue;
+
+        ReadResult result = READ_END;
+        while (written < limit && (result = readRecord(file, record)) == READ_OK) {
+            if (static_cast<int32_t>(record.sequence - cursor) < 0) continue;
+            if (!json.appendRecord(record, written > 0)) {
+                json.flushTo(out);
+                json.appendRecord(record, written > 0);
+            }
+            cursor = record.sequence + 1;
+            written++;
+        }
+        if (result == READ_CORRUPT) {
+            corruptRecords++;
+        }
+    }
+
+    json.endDocument(written, cursor, Logger::getDroppedCount());
+    json.flushTo(out);
+    return cursor;
+}
+
+uint32_t LogSpill::getOldestSequence() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t oldest = segmentCount > 0 ? segments[0].first : nextSequence;
+    xSemaphoreGive(mutex);
+    return oldest;
+}
+
+uint32_t LogSpill::getNextSequence() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t next = nextSequence;
+    xSemaphoreGive(mutex);
+    return next;
+}
+
+size_t LogSpill::getSegmentCount() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    size_t count = segmentCount;
+    xSemaphoreGive(mutex);
+    return count;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+#include "Config.h"
+#include "Logger.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/**
+ * @brief Log history on flash: Logger's lines, spilled into rotating append-only segments
+ *
+ * Each segment is a file named after its first sequence number ("/log_0000012c.seg")
+ * holding up to LOG_SPILL_SEGMENT_BYTES of records:
+ *
+ *   sequence u32 | timestamp u32 | level u8 | component length u8 | message length u16 |
+ *   crc32 u32 | component | message
+ *
+ * The CRC covers the header (with the crc field zeroed) and both strings. Readers stop a
+ * segment at the first record that fails it, i.e. a write torn by a reset. For the same
+ * reason every boot starts a new segment instead of appending after a possibly torn
+ * tail. Once LOG_SPILL_SEGMENTS exist the oldest is deleted.
+ *
+ * Records arrive through LogSink::write() and are staged in RAM; commit() appends the
+ * whole batch with one open/write/close, so flash sees one write per batch. A batch is
+ * committed once LOG_SPILL_BATCH_BYTES are staged, when Logger's ring fills, or after
+ * LOG_SPILL_INTERVAL_MS.
+ */
+class LogSpill : public LogSink {
+public:
+    explicit LogSpill(fs::FS& fs);
+    ~LogSpill();
+
+    /**
+     * @brief Index the segments on the (mounted) filesystem and recover the newest sequence
+     * @return One past the last persisted sequence, for Logger::attachSink()
+     */
+    uint32_t begin();
+
+    bool write(const Logger::Ring::Record& record) override;
+    void commit() override;
+
+    /**
+     * @brief Write persisted lines with sequence >= since, at most limit of them, as the
+     *        /logs JSON document. Starts at the segment holding since.
+     * @return The cursor for the next call
+     */
+    uint32_t writeJson(Print& out, uint32_t since = 0, size_t limit = SIZE_MAX);
+
+    uint32_t getOldestSequence();
+    uint32_t getNextSequence();
+    size_t getSegmentCount();
+    uint32_t getWriteFailures() const { return writeFailures; }
+    uint32_t getCorruptRecords() const { return corruptRecords; }
+
+private:
+    struct Segment {
+        uint32_t first;
+        uint32_t bytes;
+    };
+
+    static const size_t kHeaderBytes = 16;
+
+    fs::FS& fs;
+    SemaphoreHandle_t mutex;            // Guards the segment table and nextSequence
+
+    Segment segments[LOG_SPILL_SEGMENTS];  // Oldest first
+    size_t segmentCount;
+    bool startNewSegment;
+    uint32_t nextSequence;
+
+    uint8_t batch[LOG_SPILL_BATCH_BYTES];  // Only touched by write() and commit()
+    size_t batchUsed;
+    uint32_t batchFirst;
+    uint32_t batchNext;
+
+    uint32_t writeFailures;
+    uint32_t corruptRecords;
+
+    static void segmentPath(uint32_t first, char* path, size_t size);
+    static bool parseSegmentName(const char* name, uint32_t& first);
+    uint32_t scanSegment(const Segment& segment, uint32_t& bytes);
+};
@@ -0,0 +1,246 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <soc/gpio_struct.h>
+#endif
+
+/**
+ * @brief Background scanner for a Rows x Cols limit-switch matrix.
+ *
+ * A periodic esp_timer drives one row per tick. Each tick reads every column of the
+ * row raised on the previous tick with a single GPIO input-register read, lowers it
+ * and raises the next row. The row settles for a whole tick period, so nothing
+ * busy-waits. A position must be seen in debounceScans consecutive full scans before
+ * it is published. Readers get the cached result without touching the pins.
+ *
+ * Positions are numbered 1..Rows*Cols, row-major; -1 means no switch is closed. If
+ * several switches are closed, the lowest position wins.
+ */
+template <uint8_t Rows, uint8_t Cols>
+class MatrixScanner {
+    static_assert(Rows >= 1 && Cols >= 1, "Matrix needs at least one row and column");
+    static_assert(Rows * Cols <= 127, "Positions must fit in an int8_t");
+
+public:
+    static const int kPositions = Rows * Cols;
+
+    /**
+     * @brief A published position and when it was confirmed.
+     */
+    struct Reading {
+        int position;       // 1..kPositions, or -1 if no switch is closed
+        uint32_t changedUs; // micros() when this position was confirmed
+        uint32_t scans;     // Full scans completed so far; stops advancing if the scanner stalls
+    };
+
+    MatrixScanner(const uint8_t rowPins[Rows], const uint8_t colPins[Cols],
+                  uint32_t rowPeriodUs, uint8_t debounceScans)
+        : rowPeriodUs(rowPeriodUs),
+          debounceScans(debounceScans ? debounceScans : 1),
+          activeRow(0),
+          scanCandidate(-1),
+          candidate(-1),
+          stableScans(0),
+          timer(nullptr),
+          listener(nullptr),
+          listenerArg(nullptr),
+          sequence(0),
+          position(-1),
+          changedUs(0),
+          scans(0) {
+        for (uint8_t r = 0; r < Rows; r++) {
+            this->rowPins[r] = rowPins[r];
+        }
+        for (uint8_t c = 0; c < Cols; c++) {
+            this->colPins[c] = colPins[c];
+            colMask[c] = 1UL << (colPins[c] & 31);
+            colHighBank[c] = colPins[c] >= 32;
+        }
+    }
+
+    ~MatrixScanner() { end(); }
+
+    /**
+     * @brief Configure the pins and start the periodic scan. Call once from setup().
+     * @return false if the timer could not be created
+     */
+    bool begin() {
+#ifdef ARDUINO
+        for (uint8_t r = 0; r < Rows; r++) {
+            pinMode(rowPins[r], OUTPUT);
+            digitalWrite(rowPins[r], LOW);
+        }
+        for (uint8_t c = 0; c < Cols; c++) {
+            pinMode(colPins[c], INPUT_PULLDOWN);
+        }
+
+        activeRow = 0;
+        writeRow(activeRow, true);
+
+        esp_timer_create_args_t args = {};
+        args.callback = &MatrixScanner::onTimer;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "matrix_scan";
+        if (esp_timer_create(&args, &timer) != ESP_OK) {
+            timer = nullptr;
+            return false;
+        }
+        return esp_timer_start_periodic(timer, rowPeriodUs) == ESP_OK;
+#else
+        return true;
+#endif
+    }
+
+    void end() {
+#ifdef ARDUINO
+        if (timer) {
+            esp_timer_stop(timer);
+            esp_timer_delete(timer);
+            timer = nullptr;
+            writeRow(activeRow, false);
+        }
+#endif
+    }
+
+    /**
+     * @brief Called from the scan (timer task context) each time a new position is
+     *        published. Set before begin().
+     */
+    void setListener(void (*callback)(void*), void* arg) {
+        listener = callback;
+        listenerArg = arg;
+    }
+
+    /**
+     * @brief Latest debounced position. Safe to call from any task; never touches the pins.
+     */
+    int getPosition() const { return position.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Latest debounced position with its timestamp, read consistently.
+     */
+    Reading read() const {
+        Reading reading;
+        uint32_t before;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            reading.position = position.load(std::memory_order_relaxed);
+            reading.changedUs = changedUs.load(std::memory_order_relaxed);
+            reading.scans = scans.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((before & 1) || before != sequence.load(std::memory_order_relaxed));
+        return reading;
+    }
+
+    /**
+     * @brief Microseconds for a full scan of the matrix.
+     */
+    uint32_t getScanPeriodUs() const { return rowPeriodUs * Rows; }
+
+    /**
+     * @brief Feed one row's sample. Called by the timer with the raw input registers;
+     *        exposed so the debounce can be exercised without hardware.
+     * @param row Row whose columns were sampled
+     * @param inLow GPIO input register for pins 0-31
+     * @param inHigh GPIO input register for pins 32-39
+     * @param nowUs micros() at the sample
+     */
+    void sampleRow(uint8_t row, uint32_t inLow, uint32_t inHigh, uint32_t nowUs) {
+        if (scanCandidate < 0) {
+            for (uint8_t c = 0; c < Cols; c++) {
+                uint32_t bits = colHighBank[c] ? inHigh : inLow;
+                if (bits & colMask[c]) {
+                    scanCandidate = row * Cols + c + 1;
+                    break;
+                }
+            }
+        }
+        if (row == Rows - 1) {
+            endScan(nowUs);
+        }
+    }
+
+private:
+#ifdef ARDUINO
+    static void onTimer(void* arg) {
+        static_cast<MatrixScanner*>(arg)->tick();
+    }
+
+    void tick() {
+        uint32_t inLow = GPIO.in;
+        uint32_t inHigh = GPIO.in1.data;
+        uint8_t sampled = activeRow;
+        writeRow(sampled, false);
+        activeRow = (activeRow + 1) % Rows;
+        writeRow(activeRow, true); // Settles for a full period before it is sampled
+        sampleRow(sampled, inLow, inHigh, micros());
+    }
+
+    void writeRow(uint8_t row, bool high) {
+        uint8_t pin = rowPins[row];
+        uint32_t mask = 1UL << (pin & 31);
+        if (pin >= 32) {
+            if (high) GPIO.out1_w1ts.val = mask;
+            else GPIO.out1_w1tc.val = mask;
+        } else {
+            if (high) GPIO.out_w1ts = mask;
+            else GPIO.out_w1tc = mask;
+        }
+    }
+#endif
+
+    void endScan(uint32_t nowUs) {
+        if (scanCandidate == candidate) {
+            if (stableScans < debounceScans) stableScans++;
+        } else {
+            candidate = scanCandidate;
+            stableScans = 1;
+        }
+        scanCandidate = -1;
+
+        // Single writer: a seqlock keeps position and timestamp consistent for readers
+        sequence.fetch_add(1, std::memory_order_acq_rel);
+        bool changed = stableScans >= debounceScans && candidate != position.load(std::memory_order_relaxed);
+        if (changed) {
+            position.store(candidate, std::memory_order_relaxed);
+            changedUs.store(nowUs, std::memory_order_relaxed);
+        }
+        scans.fetch_add(1, std::memory_order_relaxed);
+        sequence.fetch_add(1, std::memory_order_release);
+
+        if (changed && listener) {
+            listener(listenerArg);
+        }
+    }
+
+    uint8_t rowPins[Rows];
+    uint8_t colPins[Cols];
+    uint32_t colMask[Cols];
+    bool colHighBank[Cols];   // Column pin is GPIO32+ (second input register)
+    uint32_t rowPeriodUs;
+    uint8_t debounceScans;
+
+    // Scan state, touched only by the timer callback
+    uint8_t activeRow;
+    int scanCandidate;        // Lowest closed position seen so far in this scan
+    int candidate;            // Position seen in the last stableScans scans
+    uint8_t stableScans;
+#ifdef ARDUINO
+    esp_timer_handle_t timer;
+#else
+    void* timer;
+#endif
+    void (*listener)(void*);
+    void* listenerArg;
+
+    // Published result
+    std::atomic<uint32_t> sequence;
+    std::atomic<int> position;
+    std::atomic<uint32_t> changedUs;
+    std::atomic<uint32_t> scans;
+};
@@ -1,97 +1,344 @@
 #include "MotorController.h"
 #include <Arduino.h>
 
+// Guards the position model and the last move report, which the network task reads
+static portMUX_TYPE modelMux = portMUX_INITIALIZER_UNLOCKED;
+
 MotorController::MotorController(uint8_t stepPin, uint8_t dirPin, const uint8_t rowPins[MOTOR_ROWS], const uint8_t colPins[MOTOR_COLS])
-    : _stepper(AccelStepper::DRIVER, stepPin, dirPin),
-      _rowPins(rowPins),
-      _colPins(colPins),
+    : _stepper(stepPin, dirPin),
+      _scanner(rowPins, colPins, MATRIX_ROW_PERIOD_US, MATRIX_DEBOUNCE_SCANS),
       _currentState(IDLE),
       _targetPosition(-1),
-      _lastKnownPosition(-1) {}
-
-void MotorController::begin() {
-    _stepper.setMaxSpeed(2000.0);
-    // Note: We use runSpeed(), so acceleration is not used.
-    // _stepper.setAcceleration(1000.0);
+      _speed(MOTOR_SPEED),
+      _lastKnownPosition(-1),
+      _model(MOTOR_STEPS_PER_SLOT, MOTOR_APPROACH_STEPS),
+      _phase(SEEK_BLIND),
+      _needsPlan(false),
+      _runForward(true),
+      _lastSensed(-1),
+      _odometerBase(0),
+      _moveOpen(false),
+      _moveStartMs(0),
+      _moveStartOdometer(0),
+      _queuedMoves(0),
+      _wakeTask(nullptr),
+      _lastLoopUs(0),
+      _wasSeeking(false),
+      _loopSamples(0),
+      _lastIntervalUs(0),
+      _maxIntervalUs(0) {
+    _currentMove = MoveReport();
+    _lastMove = MoveReport();
+}
 
-    for (int i = 0; i < MOTOR_ROWS; i++) {
-        pinMode(_rowPins[i], OUTPUT);
-        digitalWrite(_rowPins[i], LOW);
-    }
+bool MotorController::begin() {
+    _stepper.begin();
+    _stepper.setAcceleration(MOTOR_ACCELERATION);
+    _scanner.setListener(&MotorController::onSensorChange, this);
+    return _scanner.begin();
+}
 
-    for (int i = 0; i < MOTOR_COLS; i++) {
-        pinMode(_colPins[i], INPUT_PULLDOWN);
-    }
+void MotorController::setWakeTask(TaskHandle_t task) {
+    _wakeTask = task;
+    _stepper.setNotifyTask(task);
 }
 
 void MotorController::loop() {
+    recordLoopTiming();
+    applyCommands();
+
     // This function implements the state machine
-    switch (_currentState) {
+    switch (_currentState.load()) {
         case IDLE:
             // Do nothing while idle.
             break;
 
         case SEEKING: {
-            // Check if we have arrived at the target.
-            int currentPos = getCurrentPosition();
-            if (currentPos == _targetPosition) {
-                _stepper.stop();       // Stop motor movement
-                _currentState = HOLDING; // Transition to HOLDING state
-                _lastKnownPosition = currentPos;
-            } else {
-                // If not at the target, keep running the motor.
-                _stepper.runSpeed();
+            int sensed = sensePosition();
+            if (sensed == _targetPosition) {
+                _stepper.abort();      // Stop motor movement
+                setState(HOLDING);     // Transition to HOLDING state
+                finishMove(true);
+            } else if (_needsPlan) {
+                planAndStart();
+            } else if (!_stepper.isRunning()) {
+                // The ramp came to rest short of the target: creep the rest of the way
+                startRun(_runForward, MOTOR_CREEP_SPEED, StepProfile::kContinuous);
+                _phase = SEEK_CREEP;
             }
             break;
         }
 
         case HOLDING: {
             // While holding, check if the motor has been pushed off its position.
-            int currentPos = getCurrentPosition();
+            int currentPos = sensePosition();
             if (currentPos != _targetPosition) {
                 // If the motor is no longer at the target, start seeking again.
                 // This creates a "closed-loop" correction behavior.
-                _currentState = SEEKING;
-                // Note: The motor speed is already set from the last moveToPosition command.
+                _needsPlan = true;
+                setState(SEEKING);
             }
             break;
         }
     }
 }
 
-//TODO: make it move in the shortest direction using the _lastKnownPosition
-void MotorController::moveToPosition(int targetPosition, float speed) {
-    if (targetPosition < 1 || targetPosition > (MOTOR_ROWS * MOTOR_COLS)) {
-        return; // Invalid target
+bool MotorController::moveToPosition(int targetPosition, float speed) {
+    if (targetPosition < 1 || targetPosition > Scanner::kPositions) {
+        return false; // Invalid target
     }
 
-    _targetPosition = targetPosition;
-    _stepper.setSpeed(speed);
-    _currentState = SEEKING; // Set the state to start the process in the loop()
+    // Applied by loop(), which owns the stepper and the state machine; counted first so
+    // isBusy() never misses it
+    Command command = { Command::MOVE, targetPosition, speed };
+    _queuedMoves++;
+    if (!_commands.push(command)) {
+        _queuedMoves--;
+        return false;
+    }
+    wake();
+    return true;
+}
+
+bool MotorController::stop() {
+    Command command = { Command::STOP, -1, 0.0f };
+    if (!_commands.push(command)) {
+        return false;
+    }
+    wake();
+    return true;
+}
+
+void MotorController::wake() {
+    TaskHandle_t task = _wakeTask.load();
+    if (task) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void MotorController::onSensorChange(void* controller) {
+    static_cast<MotorController*>(controller)->wake();
+}
+
+uint32_t MotorController::estimateMoveMs(int targetPosition, float speed) const {
+    int from = _lastKnownPosition.load();
+    if (!Model::isValid(from) || !Model::isValid(targetPosition)) {
+        return 0;
+    }
+    portENTER_CRITICAL(&modelMux);
+    Model::Plan plan = _model.plan(from, targetPosition);
+    portEXIT_CRITICAL(&modelMux);
+    return Model::expectedMoveMs(plan, cruiseSpeed(speed), MOTOR_ACCELERATION, MOTOR_CREEP_SPEED);
 }
 
-void MotorController::stop() {
-    _stepper.stop();
-    _currentState = IDLE;
-    _targetPosition = -1;
+MotorController::MoveReport MotorController::getLastMove() const {
+    portENTER_CRITICAL(&modelMux);
+    MoveReport report = _lastMove;
+    portEXIT_CRITICAL(&modelMux);
+    return report;
 }
 
-int MotorController::getCurrentPosition() {
-    for (int r = 0; r < MOTOR_ROWS; r++) {
-        digitalWrite(_rowPins[r], HIGH);
-        // A small delay can help stabilize readings on some hardware.
-        delayMicroseconds(50); 
-        for (int c = 0; c < MOTOR_COLS; c++) {
-            if (digitalRead(_colPins[c]) == HIGH) {
-                digitalWrite(_rowPins[r], LOW);
-                return (r * MOTOR_COLS) + c + 1; // Position 1-20
+void MotorController::applyCommands() {
+    Command command;
+    while (_commands.pop(command)) {
+        switch (command.type) {
+            case Command::MOVE:
+                finishMove(false); // Superseded before it arrived
+                _targetPosition = command.position;
+                _speed = command.speed;
+                _moveOpen = false;
+                _needsPlan = true;
+                setState(SEEKING); // Set the state to start the process in the loop()
+                _queuedMoves--;
+                break;
+
+            case Command::STOP:
+                _stepper.abort();
+                _model.forgetEdge();
+                finishMove(false);
+                _targetPosition = -1;
+                setState(IDLE);
+                break;
+        }
+    }
+}
+
+void MotorController::planAndStart() {
+    _needsPlan = false;
+    _stepper.abort();
+    int from = _lastKnownPosition.load();
+    uint32_t cruise = cruiseSpeed(_speed);
+
+    if (!Model::isValid(from)) {
+        // No position yet: seek blind in the commanded direction until a sensor trips
+        openMove(-1, nullptr, cruise);
+        startRun(_speed >= 0, cruise, StepProfile::kContinuous);
+        _phase = SEEK_BLIND;
+        return;
+    }
+
+    portENTER_CRITICAL(&modelMux);
+    Model::Plan plan = _model.plan(from, _targetPosition);
+    portEXIT_CRITICAL(&modelMux);
+    openMove(from, &plan, cruise); // Replans keep the original report
+
+    if (plan.slots == 0) {
+        // The model says we are there but the sensor disagrees: we overshot, so back up slowly
+        startRun(!_runForward, MOTOR_CREEP_SPEED, StepProfile::kContinuous);
+        _phase = SEEK_CREEP;
+    } else if (plan.rampSteps > 0) {
+        startRun(plan.forward, cruise, plan.rampSteps);
+        _phase = SEEK_RAMP;
+    } else {
+        startRun(plan.forward, MOTOR_CREEP_SPEED, StepProfile::kContinuous);
+        _phase = SEEK_CREEP;
+    }
+}
+
+void MotorController::startRun(bool forward, uint32_t speed, uint32_t steps) {
+    if (forward != _runForward) {
+        _model.forgetEdge();
+    }
+    _odometerBase += _stepper.getStepsTaken();
+    _runForward = forward;
+    _stepper.start(forward, speed, steps);
+}
+
+void MotorController::openMove(int from, const Model::Plan* plan, uint32_t cruise) {
+    if (_moveOpen) {
+        return;
+    }
+    _moveOpen = true;
+    _moveStartMs = millis();
+    _moveStartOdometer = odometer();
+    _currentMove = MoveReport();
+    _currentMove.from = from;
+    _currentMove.to = _targetPosition;
+    if (plan) {
+        _currentMove.forward = plan->forward;
+        _currentMove.slots = plan->slots;
+        _currentMove.estimatedSteps = plan->estimatedSteps;
+        _currentMove.expectedMs = Model::expectedMoveMs(*plan, cruise, MOTOR_ACCELERATION, MOTOR_CREEP_SPEED);
+    } else {
+        _currentMove.forward = _speed >= 0;
+    }
+}
+
+void MotorController::finishMove(bool completed) {
+    if (!_moveOpen) {
+        if (!completed) {
+            return;
+        }
+        openMove(_targetPosition, nullptr, 0); // Already on target when the move was applied
+    }
+    _moveOpen = false;
+    _currentMove.completed = completed;
+    _currentMove.actualSteps = odometer() - _moveStartOdometer;
+    _currentMove.actualMs = millis() - _moveStartMs;
+
+    portENTER_CRITICAL(&modelMux);
+    _lastMove = _currentMove;
+    portEXIT_CRITICAL(&modelMux);
+
+    if (completed) {
+        Event arrived = { Event::ARRIVED, HOLDING, _currentMove.to, millis(),
+                          _currentMove.actualMs, _currentMove.expectedMs };
+        _events.push(arrived);
+    }
+}
+
+int MotorController::sensePosition() {
+    int sensed = _scanner.getPosition();
+    if (sensed > 0) {
+        _lastKnownPosition.store(sensed);
+        if (sensed != _lastSensed && _stepper.isRunning()) {
+            // A new sensor edge while moving refines the gap it closes
+            portENTER_CRITICAL(&modelMux);
+            _model.observe(sensed, odometer(), _runForward);
+            portEXIT_CRITICAL(&modelMux);
+
+            // Passing a sensor that is not the target while creeping (or while
+            // seeking blind) means the plan is off: replan from this position
+            if (sensed != _targetPosition && _phase != SEEK_RAMP) {
+                _needsPlan = true;
             }
         }
-        digitalWrite(_rowPins[r], LOW);
     }
-    return _lastKnownPosition; // No position detected
+    _lastSensed = sensed;
+    return sensed > 0 ? sensed : _lastKnownPosition.load();
+}
+
+uint32_t MotorController::odometer() const {
+    return _odometerBase + _stepper.getStepsTaken();
+}
+
+uint32_t MotorController::cruiseSpeed(float speed) {
+    float magnitude = speed < 0 ? -speed : speed;
+    if (magnitude > MOTOR_MAX_SPEED) {
+        magnitude = MOTOR_MAX_SPEED;
+    }
+    if (magnitude < MOTOR_CREEP_SPEED) {
+        magnitude = MOTOR_CREEP_SPEED;
+    }
+    return static_cast<uint32_t>(magnitude);
+}
+
+void MotorController::setState(MotorState state) {
+    if (_currentState.exchange(state) != state) {
+        Event changed = { Event::STATE_CHANGED, state, _lastKnownPosition.load(), millis(), 0, 0 };
+        _events.push(changed);
+    }
+}
+
+void MotorController::recordLoopTiming() {
+    unsigned long now = micros();
+    if (_wasSeeking) {
+        uint32_t interval = now - _lastLoopUs;
+        _lastIntervalUs.store(interval, std::memory_order_relaxed);
+        if (interval > _maxIntervalUs.load(std::memory_order_relaxed)) {
+            _maxIntervalUs.store(interval, std::memory_order_relaxed);
+        }
+        _loopSamples.fetch_add(1, std::memory_order_relaxed);
+    }
+    _lastLoopUs = now;
+    _wasSeeking = (_currentState.load() == SEEKING);
+}
+
+int MotorController::getCurrentPosition() const {
+    int position = _scanner.getPosition();
+    return position > 0 ? position : _lastKnownPosition.load(); // Last known if no sensor is active
+}
+
+MotorController::Scanner::Reading MotorController::getSensorReading() const {
+    return _scanner.read();
+}
+
+int MotorController::getLastKnownPosition() const {
+    return _lastKnownPosition.load();
 }
 
 MotorController::MotorState MotorController::getState() {
-    return _currentState;
+    return _currentState.load();
+}
+
+bool MotorController::isBusy() {
+    // loop() sets SEEKING before it retires the command, so one of the two always shows
+    return _queuedMoves.load() > 0 || _currentState.load() == SEEKING;
+}
+
+bool MotorController::pollEvent(Event& event) {
+    return _events.pop(event);
+}
+
+MotorController::LoopStats MotorController::getLoopStats() const {
+    LoopStats stats;
+    stats.samples = _loopSamples.load(std::memory_order_relaxed);
+    stats.lastIntervalUs = _lastIntervalUs.load(std::memory_order_relaxed);
+    stats.maxIntervalUs = _maxIntervalUs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MotorController::resetLoopStats() {
+    _loopSamples.store(0, std::memory_order_relaxed);
+    _maxIntervalUs.store(0, std::memory_order_relaxed);
 }
@@ -1,7 +1,12 @@
 #pragma once
 
-#include <AccelStepper.h>
+#include <Arduino.h>
 #include <Config.h>
+#include "StepGenerator.h"
+#include "PositionModel.h"
+#include "MatrixScanner.h"
+#include <LockFreeQueue.h>
+#include <atomic>
 
 class MotorController {
 public:
@@ -14,6 +19,48 @@ public:
         HOLDING     // Motor has reached the target and is actively maintaining its position.
     };
 
+    /**
+     * @brief Notifications published by loop() for the network side to consume.
+     */
+    struct Event {
+        enum Type : uint8_t {
+            STATE_CHANGED,  // state now holds the new state
+            ARRIVED         // position reached the commanded target
+        };
+        Type type;
+        MotorState state;
+        int position;
+        unsigned long timestampMs;
+        uint32_t moveMs;        // ARRIVED: wall time of the move
+        uint32_t expectedMs;    // ARRIVED: what the position model predicted (0 if unknown)
+    };
+
+    /**
+     * @brief Outcome of the last move, for comparing the model against reality.
+     */
+    struct MoveReport {
+        int from;                // -1 if the start position was unknown
+        int to;
+        bool forward;
+        uint8_t slots;
+        uint32_t estimatedSteps; // Model estimate for the path
+        uint32_t actualSteps;    // Steps actually issued, including any correction
+        uint32_t expectedMs;
+        uint32_t actualMs;
+        bool completed;          // false if stopped or superseded before arriving
+    };
+
+    /**
+     * @brief Timing of consecutive loop() calls while SEEKING, in microseconds.
+     *        Steps come from the hardware timer, but arrival is detected from loop(); with
+     *        a wake task set, loop() runs on each sensor edge rather than on a schedule.
+     */
+    struct LoopStats {
+        uint32_t samples;
+        uint32_t lastIntervalUs;
+        uint32_t maxIntervalUs;
+    };
+
     /**
      * @brief Construct a new Motor Controller object.
      *
@@ -28,54 +75,171 @@ public:
         const uint8_t rowPins[] = MOTOR_ROW_PINS, 
         const uint8_t colPins[] = MOTOR_COL_PINS);
 
+    typedef MatrixScanner<MOTOR_ROWS, MOTOR_COLS> Scanner;
+
     /**
-     * @brief Initializes the motor and GPIO pins. Call this in your global setup().
+     * @brief Initializes the motor and GPIO pins and starts the background matrix scan.
+     *        Call this in your global setup().
+     *
+     * @return false if the matrix scanner could not be started.
      */
-    void begin();
+    bool begin();
 
     /**
      * @brief The main update loop for the motor controller.
-     *        This function must be called continuously from the main program loop()
-     *        to manage motor state and movement. It is non-blocking.
+     *        This function must be called continuously, from a single task (the motion
+     *        task when the application runs split across cores), to manage motor state
+     *        and movement. It is non-blocking.
      */
     void loop();
 
+    /**
+     * @brief Task to notify (xTaskNotifyGive) whenever loop() has something to do: a
+     *        queued command, a newly scanned position or a run that came to rest. The
+     *        task can then block in ulTaskNotifyTake() between calls instead of polling.
+     */
+    void setWakeTask(TaskHandle_t task);
+
     /**
      * @brief Commands the motor to start moving towards a target position.
-     *        This is an asynchronous command that changes the motor's state to SEEKING.
+     *        This is an asynchronous command: it is queued and picked up by the next
+     *        loop(), which changes the motor's state to SEEKING. Safe to call from any task.
+     *
+     *        Once a position is known the move goes the shorter way round: a ramp sized
+     *        from the learned step counts between positions, then a creep onto the sensor.
      *
      * @param targetPosition The desired position (1-20).
-     * @param speed The speed in steps per second. Positive moves forward, negative moves backward.
+     * @param speed The cruise speed in steps per second. Its sign only picks the direction
+     *              while the current position is still unknown.
+     * @return false if the position is invalid or the command queue is full.
      */
-    void moveToPosition(int targetPosition, float speed = 800.0);
+    bool moveToPosition(int targetPosition, float speed = 800.0);
 
     /**
-     * @brief Stops the motor immediately and sets its state to IDLE.
+     * @brief Stops the motor and sets its state to IDLE on the next loop().
+     *        Safe to call from any task.
+     *
+     * @return false if the command queue is full.
      */
-    void stop();
+    bool stop();
     
     /**
-     * @brief Scans the 4x5 matrix to get the motor's current position.
+     * @brief Gets the motor's current position from the background matrix scan.
+     *        Never touches the pins, so it is cheap and safe to call from any task.
+     *
+     * @return The current position (1-20), or the last known position if no sensor is active.
+     */
+    int getCurrentPosition() const;
+
+    /**
+     * @brief Debounced sensor state with the time it last changed. Safe to call from any task.
+     */
+    Scanner::Reading getSensorReading() const;
+
+    /**
+     * @brief Last position seen by loop(). Safe to call from any task.
      *
-     * @return The current position (1-20), or -1 if no sensor is active.
+     * @return The last scanned position (1-20), or -1 before the first detection.
      */
-    int getCurrentPosition();
+    int getLastKnownPosition() const;
 
     /**
-     * @brief Gets the current state of the motor.
+     * @brief Gets the current state of the motor. Safe to call from any task.
      *
      * @return The current MotorState (IDLE, SEEKING, or HOLDING).
      */
     MotorState getState();
 
+    /**
+     * @brief true while a move is under way or queued but not yet picked up by loop(),
+     *        when getState() may still report IDLE. Safe to call from any task.
+     */
+    bool isBusy();
+
+    /**
+     * @brief Takes the oldest pending event. Call from a single consumer task.
+     *
+     * @return false if no event is pending.
+     */
+    bool pollEvent(Event& event);
+
+    /**
+     * @brief Predicted duration of a move from the last known position. Safe to call from any task.
+     *
+     * @return Milliseconds, or 0 if the current position is unknown.
+     */
+    uint32_t estimateMoveMs(int targetPosition, float speed = 800.0) const;
+
+    /**
+     * @brief The most recently finished move. Safe to call from any task.
+     */
+    MoveReport getLastMove() const;
+
+    LoopStats getLoopStats() const;
+    void resetLoopStats();
+
 private:
-    AccelStepper _stepper;
-    const uint8_t* _rowPins;
-    const uint8_t* _colPins;
+    struct Command {
+        enum Type : uint8_t { MOVE, STOP };
+        Type type;
+        int position;
+        float speed;
+    };
+
+    enum SeekPhase : uint8_t {
+        SEEK_BLIND,  // Position unknown: run in the commanded direction until a sensor trips
+        SEEK_RAMP,   // Trapezoidal run ending MOTOR_APPROACH_STEPS short of the target
+        SEEK_CREEP   // Constant slow speed until the target sensor trips
+    };
 
-    // State machine variables
-    MotorState _currentState;
+    typedef PositionModel<Scanner::kPositions> Model;
+
+    StepGenerator _stepper;
+    Scanner _scanner;
+
+    // State machine variables (written by loop() only)
+    std::atomic<MotorState> _currentState;
     int _targetPosition;
-    int _lastKnownPosition;
+    float _speed;
+    std::atomic<int> _lastKnownPosition;
+
+    // Move planning (loop() only, except the model and _lastMove, which are guarded)
+    Model _model;
+    SeekPhase _phase;
+    bool _needsPlan;
+    bool _runForward;
+    int _lastSensed;
+    uint32_t _odometerBase;  // Steps issued by earlier runs
+    bool _moveOpen;
+    unsigned long _moveStartMs;
+    uint32_t _moveStartOdometer;
+    MoveReport _currentMove;
+    MoveReport _lastMove;
+
+    // Cross-task plumbing: commands in from any task, events out to one consumer
+    MpscQueue<Command, 8> _commands;
+    SpscQueue<Event, 16> _events;
+    std::atomic<int> _queuedMoves;            // MOVE commands not yet applied
+    std::atomic<TaskHandle_t> _wakeTask;
+
+    // Loop timing, updated by loop() and read from other tasks
+    unsigned long _lastLoopUs;
+    bool _wasSeeking;
+    std::atomic<uint32_t> _loopSamples;
+    std::atomic<uint32_t> _lastIntervalUs;
+    std::atomic<uint32_t> _maxIntervalUs;
+
+    void applyCommands();
+    void planAndStart();
+    void startRun(bool forward, uint32_t speed, uint32_t steps);
+    void openMove(int from, const Model::Plan* plan, uint32_t cruise);
+    void finishMove(bool completed);
+    int sensePosition();
+    uint32_t odometer() const;
+    static uint32_t cruiseSpeed(float speed);
+    void setState(MotorState state);
+    void recordLoopTiming();
+    void wake();
+    static void onSensorChange(void* controller);
 };
 
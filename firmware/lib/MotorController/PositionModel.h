@@ -0,0 +1,120 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "StepProfile.h"
+
+/**
+ * @brief Kinematic model of the valve carousel: Slots positions on a ring, numbered
+ *        1..Slots, with forward (DIR high) travel going 1 -> 2 -> ... -> Slots -> 1.
+ *
+ * Keeps a step-count estimate for every gap between neighbouring positions, refined
+ * from the odometer each time a sensor edge is seen while moving, and plans moves in
+ * the shorter direction: a trapezoidal ramp that comes to rest approachSteps short of
+ * the target, followed by a slow creep until the target sensor trips.
+ */
+template <size_t Slots>
+class PositionModel {
+public:
+    struct Plan {
+        bool forward;
+        uint8_t slots;           // Positions to travel (0: already there per the model)
+        uint32_t estimatedSteps; // Sum of the gap estimates along the path
+        uint32_t rampSteps;      // Steps for the ramped part of the move
+        uint32_t creepSteps;     // Expected steps at creep speed before the sensor trips
+    };
+
+    explicit PositionModel(uint32_t stepsPerSlot, uint32_t approachSteps)
+        : approachSteps(approachSteps), lastSensor(-1), lastOdometer(0), lastForward(true) {
+        for (size_t i = 0; i < Slots; i++) {
+            gaps[i] = stepsPerSlot;
+        }
+    }
+
+    static bool isValid(int position) { return position >= 1 && position <= static_cast<int>(Slots); }
+
+    static int next(int position, bool forward) {
+        if (forward) return position == static_cast<int>(Slots) ? 1 : position + 1;
+        return position == 1 ? static_cast<int>(Slots) : position - 1;
+    }
+
+    /**
+     * @brief Steps between a position and its neighbour in the given direction
+     */
+    uint32_t gapSteps(int position, bool forward) const {
+        return gaps[gapIndex(position, forward)];
+    }
+
+    /**
+     * @brief Plan the shorter way round from one position to another (ties go forward)
+     * @param from Current position; must be valid
+     */
+    Plan plan(int from, int to) const {
+        Plan result;
+        int forwardSlots = (to - from + static_cast<int>(Slots)) % static_cast<int>(Slots);
+        int backwardSlots = (static_cast<int>(Slots) - forwardSlots) % static_cast<int>(Slots);
+        result.forward = forwardSlots <= backwardSlots;
+        result.slots = static_cast<uint8_t>(result.forward ? forwardSlots : backwardSlots);
+        result.estimatedSteps = 0;
+        for (int p = from, n = 0; n < result.slots; n++, p = next(p, result.forward)) {
+            result.estimatedSteps += gapSteps(p, result.forward);
+        }
+        result.creepSteps = result.estimatedSteps < approachSteps ? result.estimatedSteps : approachSteps;
+        result.rampSteps = result.estimatedSteps - result.creepSteps;
+        return result;
+    }
+
+    /**
+     * @brief Expected wall time for a plan: the ramped part plus the creep
+     */
+    static uint32_t expectedMoveMs(const Plan& plan, uint32_t speedSps, uint32_t accelSps2, uint32_t creepSps) {
+        uint32_t rampUs = StepProfile::estimateMoveUs(plan.rampSteps, speedSps, accelSps2);
+        uint32_t creepUs = creepSps ? static_cast<uint32_t>((uint64_t)plan.creepSteps * 1000000ULL / creepSps) : 0;
+        return (rampUs + creepUs + 500) / 1000;
+    }
+
+    /**
+     * @brief Record a sensor edge seen while moving
+     *
+     * If the previous edge was the neighbouring position in the same direction, the
+     * odometer difference refines that gap's estimate. Outliers (missed sensors,
+     * slipped belt) outside half to double the current estimate are ignored.
+     * @param position Position whose sensor just tripped
+     * @param odometer Monotonic step count of the motor
+     * @param forward Direction of travel
+     */
+    void observe(int position, uint32_t odometer, bool forward) {
+        if (!isValid(position)) {
+            return;
+        }
+        if (isValid(lastSensor) && forward == lastForward && position == next(lastSensor, forward)) {
+            uint32_t measured = odometer - lastOdometer;
+            uint32_t& estimate = gaps[gapIndex(lastSensor, forward)];
+            if (measured >= estimate / 2 && measured <= estimate * 2) {
+                estimate = (3 * estimate + measured + 2) / 4;
+            }
+        }
+        lastSensor = position;
+        lastOdometer = odometer;
+        lastForward = forward;
+    }
+
+    /**
+     * @brief Drop the last edge, e.g. after a stop or direction change
+     */
+    void forgetEdge() { lastSensor = -1; }
+
+    uint32_t getApproachSteps() const { return approachSteps; }
+
+private:
+    // Gap i lies between position i+1 and its forward neighbour
+    static size_t gapIndex(int position, bool forward) {
+        int from = forward ? position : next(position, false);
+        return static_cast<size_t>(from - 1);
+    }
+
+    uint32_t gaps[Slots];
+    uint32_t approachSteps;
+    int lastSensor;
+    uint32_t lastOdometer;
+    bool lastForward;
+};
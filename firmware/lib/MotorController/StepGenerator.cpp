@@ -0,0 +1,137 @@
+#include "StepGenerator.h"
+#include <soc/gpio_struct.h>
+
+StepGenerator* StepGenerator::_instance = nullptr;
+static portMUX_TYPE stepMux = portMUX_INITIALIZER_UNLOCKED;
+
+StepGenerator::StepGenerator(uint8_t stepPin, uint8_t dirPin, uint8_t timerIndex)
+    : _stepPin(stepPin),
+      _dirPin(dirPin),
+      _timerIndex(timerIndex),
+      _stepMask(1UL << (stepPin & 31)),
+      _stepHighBank(stepPin >= 32),
+      _timer(nullptr),
+      _acceleration(MOTOR_ACCELERATION),
+      _lowTimeUs(0),
+      _pulseHigh(false),
+      _running(false),
+      _forward(true),
+      _notifyTask(nullptr) {}
+
+StepGenerator::~StepGenerator() {
+    if (_timer) {
+        timerAlarmDisable(_timer);
+        timerDetachInterrupt(_timer);
+        timerEnd(_timer);
+    }
+    if (_instance == this) {
+        _instance = nullptr;
+    }
+}
+
+void StepGenerator::begin() {
+    pinMode(_stepPin, OUTPUT);
+    pinMode(_dirPin, OUTPUT);
+    digitalWrite(_stepPin, LOW);
+    digitalWrite(_dirPin, HIGH);
+
+    _instance = this;
+    // 80 MHz APB / 80 = 1 MHz: one timer tick per microsecond
+    _timer = timerBegin(_timerIndex, 80, true);
+    timerAttachInterrupt(_timer, &StepGenerator::onTimer, true);
+}
+
+void StepGenerator::start(bool forward, uint32_t speedSps, uint32_t steps) {
+    if (!_timer) {
+        return;
+    }
+
+    abort();
+    if (_forward != forward) {
+        digitalWrite(_dirPin, forward ? HIGH : LOW);
+        _forward = forward;
+        delayMicroseconds(MOTOR_DIR_SETUP_US); // Driver DIR setup time before the first edge
+    }
+
+    portENTER_CRITICAL(&stepMux);
+    _profile.configure(speedSps, _acceleration);
+    _profile.start(steps);
+    _pulseHigh = false;
+    _running = true;
+    portEXIT_CRITICAL(&stepMux);
+
+    // First alarm fires almost immediately and schedules the first step from the profile
+    timerWrite(_timer, 0);
+    timerAlarmWrite(_timer, 1, true);
+    timerAlarmEnable(_timer);
+}
+
+void StepGenerator::decelerate() {
+    portENTER_CRITICAL(&stepMux);
+    _profile.stop();
+    portEXIT_CRITICAL(&stepMux);
+}
+
+void StepGenerator::abort() {
+    if (!_timer) {
+        return;
+    }
+    timerAlarmDisable(_timer);
+    portENTER_CRITICAL(&stepMux);
+    _profile.abort();
+    _running = false;
+    if (_pulseHigh) {
+        digitalWrite(_stepPin, LOW);
+        _pulseHigh = false;
+    }
+    portEXIT_CRITICAL(&stepMux);
+}
+
+uint32_t StepGenerator::getStepsTaken() const {
+    return _profile.getStepsTaken();
+}
+
+uint32_t StepGenerator::getCurrentSpeed() const {
+    return _running ? _profile.currentSpeed() : 0;
+}
+
+void IRAM_ATTR StepGenerator::onTimer() {
+    if (_instance) {
+        _instance->handleTimer();
+    }
+}
+
+void IRAM_ATTR StepGenerator::handleTimer() {
+    bool finished = false;
+    portENTER_CRITICAL_ISR(&stepMux);
+    if (_pulseHigh) {
+        // End of the pulse: drop STEP and wait out the rest of the interval
+        if (_stepHighBank) GPIO.out1_w1tc.val = _stepMask;
+        else GPIO.out_w1tc = _stepMask;
+        _pulseHigh = false;
+        timerAlarmWrite(_timer, _lowTimeUs, true);
+    } else {
+        uint32_t interval = _profile.nextIntervalUs();
+        if (interval == 0) {
+            timerAlarmDisable(_timer);
+            _running = false;
+            finished = true;
+        } else {
+            if (_stepHighBank) GPIO.out1_w1ts.val = _stepMask;
+            else GPIO.out_w1ts = _stepMask;
+            _pulseHigh = true;
+            _lowTimeUs = interval > MOTOR_STEP_PULSE_US ? interval - MOTOR_STEP_PULSE_US : 1;
+            timerAlarmWrite(_timer, MOTOR_STEP_PULSE_US, true);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&stepMux);
+
+    TaskHandle_t task = _notifyTask;
+    if (finished && task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <Arduino.h>
+#include <Config.h>
+#include "StepProfile.h"
+
+/**
+ * @brief Hardware-timer step pulse engine for a STEP/DIR stepper driver.
+ *
+ * A hardware timer alarm drives a two-phase ISR: it raises STEP, holds it for
+ * MOTOR_STEP_PULSE_US, lowers it and waits out the rest of the interval supplied by a
+ * StepProfile. Step timing is therefore independent of how often (or how late) the
+ * motor loop runs. Only one instance can exist, as the ISR has no context argument.
+ */
+class StepGenerator {
+public:
+    StepGenerator(uint8_t stepPin, uint8_t dirPin, uint8_t timerIndex = MOTOR_STEP_TIMER);
+    ~StepGenerator();
+
+    /**
+     * @brief Configure the pins and claim the hardware timer. Call once from setup().
+     */
+    void begin();
+
+    void setAcceleration(uint32_t accelSps2) { _acceleration = accelSps2; }
+    uint32_t getAcceleration() const { return _acceleration; }
+
+    /**
+     * @brief Start a move from rest, accelerating up to speedSps.
+     *        Any move in progress is aborted first.
+     *
+     * @param forward Direction (DIR pin HIGH when true).
+     * @param speedSps Cruise speed in steps per second.
+     * @param steps Steps to run, or StepProfile::kContinuous to run until decelerate()/abort().
+     */
+    void start(bool forward, uint32_t speedSps, uint32_t steps = StepProfile::kContinuous);
+
+    /**
+     * @brief Ramp down to rest and stop.
+     */
+    void decelerate();
+
+    /**
+     * @brief Stop at the next timer tick without a ramp.
+     */
+    void abort();
+
+    /**
+     * @brief Task notified (xTaskNotifyGive) from the ISR when a run comes to rest by itself.
+     */
+    void setNotifyTask(TaskHandle_t task) { _notifyTask = task; }
+
+    bool isRunning() const { return _running; }
+    bool isForward() const { return _forward; }
+    uint32_t getStepsTaken() const;
+    uint32_t getCurrentSpeed() const;
+
+private:
+    static void IRAM_ATTR onTimer();
+    static StepGenerator* _instance;
+
+    void IRAM_ATTR handleTimer();
+
+    uint8_t _stepPin;
+    uint8_t _dirPin;
+    uint8_t _timerIndex;
+    uint32_t _stepMask;
+    bool _stepHighBank;  // STEP pin is GPIO32+ (second output register)
+    hw_timer_t* _timer;
+
+    StepProfile _profile;
+    uint32_t _acceleration;
+    volatile uint32_t _lowTimeUs;
+    volatile bool _pulseHigh;
+    volatile bool _running;
+    bool _forward;
+    TaskHandle_t volatile _notifyTask;
+};
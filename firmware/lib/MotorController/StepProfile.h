@@ -0,0 +1,152 @@
+#pragma once
+#include <math.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#define STEP_PROFILE_ISR IRAM_ATTR
+#else
+#define STEP_PROFILE_ISR
+#endif
+
+/**
+ * @brief Trapezoidal step-interval generator (D. Austin, "Generate stepper-motor
+ *        speed profiles in real time").
+ *
+ * Each call to nextIntervalUs() yields the delay before the next step pulse. Ramps use
+ * the recurrence c[n] = c[n-1] - 2*c[n-1] / (4n + 1), evaluated in 24.8 fixed point so
+ * it is cheap and FPU-free inside the step timer ISR. Moves with too few steps to reach
+ * full speed degrade to a triangular profile automatically.
+ *
+ * configure() and start() use floating point and must be called with the timer stopped
+ * (or from a critical section); nextIntervalUs() and stop() are ISR-safe.
+ */
+class StepProfile {
+public:
+    static const uint32_t kContinuous = 0;
+
+    StepProfile()
+        : minInterval(0), firstInterval(0), interval(0),
+          totalSteps(0), stepsTaken(0), rampStep(0),
+          running(false), stopping(false) {}
+
+    /**
+     * @brief Set the cruise speed and acceleration for the next start()
+     * @param maxSpeedSps Cruise speed in steps per second
+     * @param accelSps2 Acceleration and deceleration in steps per second squared
+     */
+    void configure(uint32_t maxSpeedSps, uint32_t accelSps2) {
+        if (maxSpeedSps == 0) maxSpeedSps = 1;
+        if (accelSps2 == 0) accelSps2 = 1;
+        minInterval = static_cast<uint32_t>((1000000.0 * kOne) / maxSpeedSps);
+        // 0.676 corrects the first-step error of the recurrence (Austin, eq. 15)
+        double first = 0.676 * sqrt(2.0 / accelSps2) * 1000000.0 * kOne;
+        firstInterval = first > 0x7FFFFFFFUL ? 0x7FFFFFFFUL : static_cast<uint32_t>(first);
+        if (firstInterval < minInterval) {
+            firstInterval = minInterval;
+        }
+    }
+
+    /**
+     * @brief Begin a move from rest
+     * @param steps Number of steps to run, or kContinuous to run until stop()
+     */
+    void start(uint32_t steps = kContinuous) {
+        totalSteps = steps;
+        stepsTaken = 0;
+        rampStep = 0;
+        interval = firstInterval;
+        stopping = false;
+        running = true;
+    }
+
+    /**
+     * @brief Decelerate to rest from the current speed
+     */
+    void STEP_PROFILE_ISR stop() { stopping = true; }
+
+    /**
+     * @brief Stop without a ramp; the next nextIntervalUs() returns 0
+     */
+    void STEP_PROFILE_ISR abort() { running = false; }
+
+    /**
+     * @brief Advance the profile by one step
+     * @return Microseconds from this step to the next one, or 0 when the move is over
+     *         (the caller issues no step for a 0 return)
+     */
+    uint32_t STEP_PROFILE_ISR nextIntervalUs() {
+        if (!running || (totalSteps != kContinuous && stepsTaken >= totalSteps)) {
+            running = false;
+            return 0;
+        }
+
+        uint32_t current = interval;
+        stepsTaken++;
+
+        // Steps left before the target; a continuous move never runs out
+        uint32_t remaining = totalSteps != kContinuous ? totalSteps - stepsTaken : 0xFFFFFFFFUL;
+        if (remaining == 0) {
+            // Last step: interval no longer matters
+        } else if (stopping || remaining <= rampStep) {
+            if (rampStep <= 1) {
+                if (stopping) {
+                    totalSteps = stepsTaken; // Back at rest: end after this step
+                }
+            } else {
+                interval += (2 * interval) / (4 * rampStep - 1);
+                rampStep--;
+            }
+        } else if (interval > minInterval) {
+            rampStep++;
+            interval -= (2 * interval) / (4 * rampStep + 1);
+            if (interval < minInterval) {
+                interval = minInterval;
+            }
+        }
+
+        return (current + kOne / 2) >> kFractionBits;
+    }
+
+    /**
+     * @brief Ideal duration of a move from rest to rest (trapezoid, or triangle if short)
+     */
+    static uint32_t estimateMoveUs(uint32_t steps, uint32_t maxSpeedSps, uint32_t accelSps2) {
+        if (steps == 0 || maxSpeedSps == 0 || accelSps2 == 0) {
+            return 0;
+        }
+        double speed = maxSpeedSps;
+        if (steps >= speed * speed / accelSps2) {
+            return static_cast<uint32_t>((steps / speed + speed / accelSps2) * 1e6);
+        }
+        return static_cast<uint32_t>(2.0 * sqrt(static_cast<double>(steps) / accelSps2) * 1e6);
+    }
+
+    bool isRunning() const { return running; }
+    uint32_t getStepsTaken() const { return stepsTaken; }
+
+    /**
+     * @brief Steps needed to ramp from the current speed down to rest
+     */
+    uint32_t stepsToStop() const { return rampStep; }
+
+    /**
+     * @brief Current step rate in steps per second (0 when stopped)
+     */
+    uint32_t currentSpeed() const {
+        return running && interval ? static_cast<uint32_t>((1000000ULL << kFractionBits) / interval) : 0;
+    }
+
+private:
+    static const uint32_t kFractionBits = 8;
+    static const uint32_t kOne = 1UL << kFractionBits;
+
+    uint32_t minInterval;    // Cruise interval, 24.8 us
+    uint32_t firstInterval;  // First step interval from rest, 24.8 us
+    volatile uint32_t interval;
+    volatile uint32_t totalSteps;
+    volatile uint32_t stepsTaken;
+    volatile uint32_t rampStep; // Steps taken on the current ramp; also the steps needed to stop
+    volatile bool running;
+    volatile bool stopping;
+};
@@ -4,8 +4,6 @@
 #include <mbedtls/error.h>
 #include <errno.h>
 
-MqttService* MqttService::instance = nullptr;
-
 MqttService::MqttService() :
     tls(false),
     port(0),
@@ -15,9 +13,10 @@ MqttService::MqttService() :
     lastWiFiStatus(WL_DISCONNECTED),
     wifiConnectedAt(0),
     _bufferSize(2048),
-    _keepAlive(15)
+    _keepAlive(15),
+    willRetained(false),
+    connects(0)
 {
-    instance = this;
 }
 
 MqttService::~MqttService() {
@@ -47,9 +46,9 @@ void MqttService::cleanup() {
 void MqttService::setCallback(MessageCallback cb) {
     callback = cb;
     if (client) {
-        client->setCallback([](char* topic, uint8_t* payload, unsigned int length) {
-            if (instance && instance->callback) {
-                instance->callback(topic, payload, length);
+        client->setCallback([this](char* topic, uint8_t* payload, unsigned int length) {
+            if (callback) {
+                callback(topic, payload, length);
             }
         });
     }
@@ -69,6 +68,12 @@ void MqttService::setKeepAlive(uint16_t keepAlive) {
     }
 }
 
+void MqttService::setWill(const String& topic, const String& payload, bool retained) {
+    willTopic = topic;
+    willPayload = payload;
+    willRetained = retained;
+}
+
 bool MqttService::connect(const String& h, uint16_t p,
                           const String& cid,
                           const String& user,
@@ -93,7 +98,7 @@ bool MqttService::connectInternal() {
         return false;
     }
 
-    LOG_I("MQTT", "Connecting to MQTT broker at " + host + ":" + String(port));
+    LOG_IF("MQTT", "Connecting to MQTT broker at %s:%u", host.c_str(), port);
 
     // Clean up previous client instances before creating new ones
     cleanup();
@@ -127,9 +132,10 @@ bool MqttService::connectInternal() {
     client->setServer(host.c_str(), port);
     client->setBufferSize(_bufferSize);
     client->setKeepAlive(_keepAlive);
-    client->setCallback([](char* topic, uint8_t* payload, unsigned int length) {
-        if (instance && instance->callback) {
-            instance->callback(topic, payload, length);
+    // Per instance: the printer session and the desktop session each get their own
+    client->setCallback([this](char* topic, uint8_t* payload, unsigned int length) {
+        if (callback) {
+            callback(topic, payload, length);
         }
     });
 
@@ -139,8 +145,13 @@ bool MqttService::connectInternal() {
         return false;
     }
 
-    if (client->connect(clientId.c_str(), username.c_str(), password.c_str())) {
+    bool connected = willTopic.isEmpty()
+        ? client->connect(clientId.c_str(), username.c_str(), password.c_str())
+        : client->connect(clientId.c_str(), username.c_str(), password.c_str(),
+                          willTopic.c_str(), 1, willRetained, willPayload.c_str());
+    if (connected) {
         LOG_I("MQTT", "MQTT connected successfully");
+        connects++;
         reconnectAttempts = 0;
         reconnectInterval = 5000;
         for (const auto& topic : subscriptions) {
@@ -148,13 +159,12 @@ bool MqttService::connectInternal() {
         }
         return true;
     } else {
-        LOG_E("MQTT", "MQTT connection failed, rc=" + String(client->state()) +
-                         ", WiFi status=" + String(WiFi.status()));
+        LOG_EF("MQTT", "MQTT connection failed, rc=%d, WiFi status=%d", client->state(), static_cast<int>(WiFi.status()));
         if (tls && wifiClientSecure) {
             char errBuf[128];
             int err = wifiClientSecure->lastError(errBuf, sizeof(errBuf));
             if (err != 0) {
-                LOG_E("MQTT", String("TLS lastError (") + err + ", errno=" + String(errno) + "): " + errBuf);
+                LOG_EF("MQTT", "TLS lastError (%d, errno=%d): %s", err, errno, errBuf);
             }
         }
         cleanup();
@@ -173,6 +183,13 @@ bool MqttService::publish(const String& topic, const String& payload) {
     return client->publish(topic.c_str(), payload.c_str());
 }
 
+bool MqttService::publish(const String& topic, const String& payload, bool retained) {
+    if (!client || !client->connected()) {
+        return false;
+    }
+    return client->publish(topic.c_str(), reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length(), retained);
+}
+
 bool MqttService::subscribe(const String& topic) {
     bool exists = false;
     for (const auto& t : subscriptions) {
@@ -221,6 +238,6 @@ void MqttService::attemptReconnect() {
         if (reconnectInterval < 60000UL) {
             reconnectInterval = reconnectInterval < 30000UL ? reconnectInterval * 2 : 60000UL;
         }
-        LOG_W("MQTT", "Reconnect failed; next attempt in " + String(reconnectInterval / 1000) + "s");
+        LOG_WF("MQTT", "Reconnect failed; next attempt in %lus", reconnectInterval / 1000);
     }
 }
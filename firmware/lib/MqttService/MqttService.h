@@ -17,6 +17,12 @@ public:
     void setBufferSize(uint16_t size);
     void setKeepAlive(uint16_t keepAlive);
 
+    /**
+     * @brief Message the broker publishes (QoS 1) if the session drops without a
+     *        disconnect; applies from the next connect
+     */
+    void setWill(const String& topic, const String& payload, bool retained);
+
     bool connect(const String& host, uint16_t port,
                  const String& clientId,
                  const String& username,
@@ -24,10 +30,17 @@ public:
                  bool useTLS = false);
     void disconnect();
     bool publish(const String& topic, const String& payload);
+    bool publish(const String& topic, const String& payload, bool retained);
     bool subscribe(const String& topic);
     bool isConnected() const;
     void loop();
 
+    /**
+     * @brief Sessions established so far; a change means subscriptions were renewed and
+     *        anything published on the old session may not have reached the broker
+     */
+    uint32_t getConnectCount() const { return connects; }
+
 private:
     void cleanup();
     WiFiClient* wifiClient = nullptr;
@@ -49,9 +62,12 @@ private:
     uint16_t _bufferSize;
     uint16_t _keepAlive;
     std::vector<String> subscriptions;
+    String willTopic;
+    String willPayload;
+    bool willRetained;
+    uint32_t connects;
 
     MessageCallback callback;
-    static MqttService* instance;
 
     bool connectInternal();
     void attemptReconnect();
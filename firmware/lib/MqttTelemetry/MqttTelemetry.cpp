@@ -0,0 +1,142 @@
+#include "MqttTelemetry.h"
+#include <Logger.h>
+
+namespace {
+const char kOnline[] = "{\"online\":true,\"firmware_version\":\"" FIRMWARE_VERSION "\"}";
+const char kOffline[] = "{\"online\":false}";
+
+// Fixed header (at most 5 bytes) plus the topic length field
+constexpr size_t kPublishOverhead = 7;
+}
+
+MqttTelemetry::MqttTelemetry()
+    : enabled(false)
+    , seenConnects(0)
+    , newSession(false)
+    , hasAck(false)
+    , ackedAlert(0)
+    , stats() {
+}
+
+bool MqttTelemetry::begin(const String& broker, const String& deviceId, const String& credentials) {
+    if (broker.isEmpty()) {
+        return false;
+    }
+
+    String host = broker;
+    uint16_t port = TELEMETRY_MQTT_PORT;
+    int colon = broker.lastIndexOf(':');
+    if (colon > 0) {
+        host = broker.substring(0, colon);
+        port = static_cast<uint16_t>(broker.substring(colon + 1).toInt());
+    }
+    String username = credentials;
+    String password;
+    colon = credentials.indexOf(':');
+    if (colon >= 0) {
+        username = credentials.substring(0, colon);
+        password = credentials.substring(colon + 1);
+    }
+
+    prefix = String(TELEMETRY_MQTT_TOPIC_PREFIX) + deviceId + "/";
+    enabled = true;
+    hasAck = false;
+    mqtt.setBufferSize(TELEMETRY_MQTT_BUFFER_BYTES);
+    mqtt.setKeepAlive(TELEMETRY_MQTT_KEEPALIVE_S);
+    mqtt.setWill(topic("presence"), kOffline, true);
+    mqtt.setCallback([this](char* topic, uint8_t* payload, unsigned int length) {
+        onMessage(topic, payload, length);
+    });
+    mqtt.subscribe(topic("ack"));
+
+    LOG_IF("Telemetry", "Publishing telemetry to %s:%u under %s", host.c_str(), port, prefix.c_str());
+    if (mqtt.connect(host, port, "regain3d-" + deviceId, username, password)) {
+        loop();
+    } else {
+        LOG_W("Telemetry", "Telemetry broker not reachable yet - posting over HTTP meanwhile");
+    }
+    return true;
+}
+
+void MqttTelemetry::end() {
+    if (!enabled) {
+        return;
+    }
+    // A clean disconnect doesn't fire the will
+    publish("presence", kOffline, true);
+    mqtt.disconnect();
+    enabled = false;
+}
+
+void MqttTelemetry::loop() {
+    if (!enabled) {
+        return;
+    }
+    mqtt.loop();
+
+    uint32_t connects = mqtt.getConnectCount();
+    if (connects != seenConnects && mqtt.isConnected()) {
+        seenConnects = connects;
+        stats.sessions++;
+        newSession = true;
+        publish("presence", kOnline, true);
+    }
+}
+
+bool MqttTelemetry::publishStatus(const String& json) {
+    return publish("status", json, true);
+}
+
+bool MqttTelemetry::publishAlert(uint32_t sequence, const String& json) {
+    String envelope;
+    envelope.reserve(json.length() + 28);
+    envelope = "{\"seq\":";
+    envelope += String(sequence);
+    envelope += ",\"body\":";
+    envelope += json;
+    envelope += '}';
+    return publish("alerts", envelope, false);
+}
+
+bool MqttTelemetry::publishLogs(const String& json) {
+    return publish("logs", json, false);
+}
+
+bool MqttTelemetry::fits(const char* leaf, size_t length) const {
+    // Alerts carry the seq envelope on top
+    size_t envelope = strcmp(leaf, "alerts") == 0 ? 28 : 0;
+    return kPublishOverhead + prefix.length() + strlen(leaf) + length + envelope <= TELEMETRY_MQTT_BUFFER_BYTES;
+}
+
+bool MqttTelemetry::getAckedAlert(uint32_t& sequence) const {
+    sequence = ackedAlert;
+    return hasAck;
+}
+
+bool MqttTelemetry::takeNewSession() {
+    bool result = newSession;
+    newSession = false;
+    return result;
+}
+
+bool MqttTelemetry::publish(const char* leaf, const String& payload, bool retained) {
+    if (!fits(leaf, payload.length())) {
+        stats.oversized++;
+        LOG_WF("Telemetry", "%u-byte %s payload exceeds the MQTT buffer", static_cast<unsigned>(payload.length()), leaf);
+        return false;
+    }
+    if (!mqtt.publish(topic(leaf), payload, retained)) {
+        return false;
+    }
+    stats.published++;
+    return true;
+}
+
+void MqttTelemetry::onMessage(char* messageTopic, uint8_t* payload, unsigned int length) {
+    if (topic("ack") != messageTopic || length == 0) {
+        return;
+    }
+    String text(reinterpret_cast<const char*>(payload), length);
+    ackedAlert = static_cast<uint32_t>(strtoul(text.c_str(), nullptr, 10));
+    hasAck = true;
+}
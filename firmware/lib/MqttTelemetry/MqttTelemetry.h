@@ -0,0 +1,87 @@
+#pragma once
+#include <Arduino.h>
+#include <MqttService.h>
+#include "Config.h"
+
+/**
+ * @brief Telemetry session with a broker on the desktop side, as an alternative to
+ *        posting each upload
+ *
+ * Topics, under TELEMETRY_MQTT_TOPIC_PREFIX<device id>/:
+ *
+ * - presence: {"online":true,..} retained on every connect; the last-will sets it to
+ *   {"online":false}, so the desktop learns of a dropped controller from the broker
+ * - status:   the full status document, retained, so a desktop that (re)subscribes has
+ *   the last state at once
+ * - alerts:   {"seq":S,"body":{..}}
+ * - logs:     the /logs document
+ * - ack:      subscribed; the desktop publishes the seq of the last alert it stored
+ *
+ * PubSubClient only publishes at QoS 0, so alert delivery is acknowledged end to end
+ * instead: UpdateClient keeps an alert queued until its seq is acked and publishes it
+ * again on a new session or when no ack came within TELEMETRY_MQTT_ACK_TIMEOUT_MS.
+ */
+class MqttTelemetry {
+public:
+    struct Stats {
+        uint32_t sessions;        // Connects to the broker
+        uint32_t published;
+        uint32_t oversized;       // Payloads too large for the packet buffer
+    };
+
+    MqttTelemetry();
+
+    /**
+     * @brief Connect to broker ("host" or "host:port") and keep the session up from loop()
+     * @param credentials "user:password" (the update token), or empty
+     * @return false if broker is empty; a broker that can't be reached yet is retried
+     */
+    bool begin(const String& broker, const String& deviceId, const String& credentials);
+
+    /**
+     * @brief Mark the controller offline and close the session
+     */
+    void end();
+
+    void loop();
+
+    bool isEnabled() const { return enabled; }
+    bool isConnected() const { return enabled && mqtt.isConnected(); }
+
+    bool publishStatus(const String& json);
+    bool publishAlert(uint32_t sequence, const String& json);
+    bool publishLogs(const String& json);
+
+    /**
+     * @brief Whether a payload of this size fits a publish at all; one that doesn't fails
+     *        every time, not because the session is down
+     */
+    bool fits(const char* leaf, size_t length) const;
+
+    /**
+     * @brief Last alert seq the desktop acked this session; false while there is none
+     */
+    bool getAckedAlert(uint32_t& sequence) const;
+
+    /**
+     * @brief true once per new session: what was published on the last one and not
+     *        acked may not have arrived
+     */
+    bool takeNewSession();
+
+    Stats getStats() const { return stats; }
+
+private:
+    MqttService mqtt;
+    bool enabled;
+    String prefix;
+    uint32_t seenConnects;
+    bool newSession;
+    bool hasAck;
+    uint32_t ackedAlert;
+    Stats stats;
+
+    String topic(const char* leaf) const { return prefix + leaf; }
+    bool publish(const char* leaf, const String& payload, bool retained);
+    void onMessage(char* topic, uint8_t* payload, unsigned int length);
+};
@@ -4,6 +4,180 @@
 #include <esp_partition.h>
 #include <mbedtls/md.h>
 #include <Preferences.h>
+#include <lwip/sockets.h>
+
+namespace {
+struct PipelineBuffer {
+    uint8_t* data;
+    size_t length;
+};
+
+// Download buffers on their way to flash. The downloading task takes a free buffer, fills
+// it and hands it over; the flash task writes buffers in the order they were filled and
+// hands them back. A zero-length buffer ends the stream. Without the heap for a second
+// buffer or the task, submit() writes inline.
+class FlashPipeline {
+public:
+    FlashPipeline();
+    ~FlashPipeline();
+
+    // false if not even one buffer could be allocated
+    bool begin();
+    bool isPipelined() const { return task != nullptr; }
+
+    // Next buffer to fill; blocks while every buffer is waiting to be written
+    uint8_t* acquire(unsigned long& waitedMs);
+    // Write length bytes of the buffer from acquire(); false once a write has failed
+    bool submit(size_t length);
+    // Wait until everything submitted is written; false if any write failed
+    bool finish();
+
+private:
+    PipelineBuffer buffers[OTA_BUFFER_COUNT];
+    size_t allocated;
+    size_t fillIndex;
+    size_t flashIndex;
+    SemaphoreHandle_t freeBuffers;
+    SemaphoreHandle_t filledBuffers;
+    SemaphoreHandle_t exited;
+    TaskHandle_t task;
+    volatile bool failed;
+
+    static void flashTask(void* parameter);
+    void write(const PipelineBuffer& buffer);
+};
+
+FlashPipeline::FlashPipeline()
+    : buffers()
+    , allocated(0)
+    , fillIndex(0)
+    , flashIndex(0)
+    , freeBuffers(nullptr)
+    , filledBuffers(nullptr)
+    , exited(nullptr)
+    , task(nullptr)
+    , failed(false) {
+}
+
+FlashPipeline::~FlashPipeline() {
+    finish();
+    if (freeBuffers) vSemaphoreDelete(freeBuffers);
+    if (filledBuffers) vSemaphoreDelete(filledBuffers);
+    if (exited) vSemaphoreDelete(exited);
+    for (size_t i = 0; i < allocated; i++) {
+        free(buffers[i].data);
+    }
+}
+
+bool FlashPipeline::begin() {
+    while (allocated < OTA_BUFFER_COUNT) {
+        uint8_t* data = static_cast<uint8_t*>(malloc(OTA_BUFFER_BYTES));
+        if (!data) break;
+        buffers[allocated++].data = data;
+    }
+    if (allocated == 0) {
+        LOG_E("OTA", "Failed to allocate download buffer");
+        return false;
+    }
+    if (allocated < 2) {
+        LOG_W("OTA", "Not enough heap for the download pipeline, writing flash inline");
+        return true;
+    }
+
+    freeBuffers = xSemaphoreCreateCounting(allocated, allocated);
+    filledBuffers = xSemaphoreCreateCounting(allocated, 0);
+    exited = xSemaphoreCreateBinary();
+    TaskHandle_t handle = nullptr;
+    if (!freeBuffers || !filledBuffers || !exited ||
+        xTaskCreatePinnedToCore(flashTask, "ota_flash", OTA_FLASH_TASK_STACK, this,
+                                OTA_FLASH_TASK_PRIORITY, &handle, OTA_FLASH_TASK_CORE) != pdPASS) {
+        LOG_W("OTA", "Failed to create flash task, writing flash inline");
+        return true;
+    }
+    task = handle;
+    return true;
+}
+
+uint8_t* FlashPipeline::acquire(unsigned long& waitedMs) {
+    if (!task) {
+        return buffers[0].data;
+    }
+    unsigned long start = millis();
+    xSemaphoreTake(freeBuffers, portMAX_DELAY);
+    waitedMs += millis() - start;
+    return buffers[fillIndex].data;
+}
+
+bool FlashPipeline::submit(size_t length) {
+    if (!task) {
+        buffers[0].length = length;
+        if (!failed) write(buffers[0]);
+        return !failed;
+    }
+    buffers[fillIndex].length = length;
+    fillIndex = (fillIndex + 1) % allocated;
+    xSemaphoreGive(filledBuffers);
+    return !failed;
+}
+
+bool FlashPipeline::finish() {
+    if (task) {
+        unsigned long waited = 0;
+        acquire(waited);
+        submit(0);
+        xSemaphoreTake(exited, portMAX_DELAY);
+        task = nullptr;
+    }
+    return !failed;
+}
+
+void FlashPipeline::flashTask(void* parameter) {
+    FlashPipeline* pipeline = static_cast<FlashPipeline*>(parameter);
+    for (;;) {
+        xSemaphoreTake(pipeline->filledBuffers, portMAX_DELAY);
+        const PipelineBuffer& buffer = pipeline->buffers[pipeline->flashIndex];
+        if (buffer.length == 0) {
+            break;
+        }
+        // After a failed write the rest only drains, so the download side never blocks
+        if (!pipeline->failed) {
+            pipeline->write(buffer);
+        }
+        pipeline->flashIndex = (pipeline->flashIndex + 1) % pipeline->allocated;
+        xSemaphoreGive(pipeline->freeBuffers);
+    }
+    xSemaphoreGive(pipeline->exited);
+    vTaskDelete(nullptr);
+}
+
+void FlashPipeline::write(const PipelineBuffer& buffer) {
+    size_t written = Update.write(buffer.data, buffer.length);
+    if (written != buffer.length) {
+        LOG_E("OTA", "Write failed: " + String(written) + " vs " + String(buffer.length) +
+                     ", error " + String(Update.getError()));
+        failed = true;
+    }
+}
+
+// Block until the socket has data (or has closed), rather than polling available()
+bool waitForData(WiFiClient* client, uint32_t timeoutMs) {
+    int fd = client->fd();
+    if (fd < 0) {
+        return false;
+    }
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(fd, &readable);
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    return select(fd + 1, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+float kilobytesPerSecond(size_t bytes, unsigned long elapsedMs) {
+    return elapsedMs ? (float)bytes / 1.024f / (float)elapsedMs : 0.0f;
+}
+}
 
 OTAManager::OTAManager() :
     currentState(OTAState::IDLE),
@@ -132,6 +306,7 @@ bool OTAManager::downloadApplicationFirmware(const String& firmwareUrl, const St
         setState(OTAState::DOWNLOADING);
         downloadedBytes = 0;
         totalBytes = 0;
+        downloadKBps = 0.0f;
 
         // Ensure the MD5 used by Update is the expected one for this request
         if (!expectedMD5.isEmpty()) {
@@ -193,6 +368,7 @@ String OTAManager::getStatusJson() const {
         doc["download_progress"] = getDownloadProgress();
         doc["downloaded_bytes"] = downloadedBytes;
         doc["total_bytes"] = totalBytes;
+        doc["download_kbps"] = downloadKBps;
     }
     
     String result;
@@ -243,6 +419,8 @@ bool OTAManager::parseAssignmentPayload(const String& json, OTAAssignment& out)
     if (doc["printer_model"].is<String>()) out.printerModel = doc["printer_model"].as<String>();
     if (doc["printer_id"].is<String>()) out.printerId = doc["printer_id"].as<String>();
     if (doc["printer_name"].is<String>()) out.printerName = doc["printer_name"].as<String>();
+    if (doc["payload_encoding"].is<String>()) out.payloadEncoding = doc["payload_encoding"].as<String>();
+    if (doc["telemetry_broker"].is<String>()) out.telemetryBroker = doc["telemetry_broker"].as<String>();
     if (doc["printer_connection_data"].is<JsonVariant>()) {
         String raw;
         serializeJson(doc["printer_connection_data"], raw);
@@ -268,6 +446,8 @@ bool OTAManager::saveAssignmentToNVS(const OTAAssignment& a, bool markAssigned,
     if (a.firmwareSize > 0) prefs.putULong("firmware_size", a.firmwareSize);
     if (!a.apiEndpoint.isEmpty()) prefs.putString("api_endpoint", a.apiEndpoint);
     if (!a.updateToken.isEmpty()) prefs.putString("update_token", a.updateToken);
+    if (!a.payloadEncoding.isEmpty()) prefs.putString(NVS_PAYLOAD_ENCODING, a.payloadEncoding);
+    if (!a.telemetryBroker.isEmpty()) prefs.putString(NVS_TELEMETRY_BROKER, a.telemetryBroker);
     if (markAssigned) prefs.putBool("assigned", true);
 
     // Save printer meta and connection JSON if requested
@@ -402,61 +582,90 @@ bool OTAManager::downloadFirmwareToApp1(const String& url) {
         LOG_I("OTA", "MD5 validation enabled: " + updateInfo.md5);
     }
     
-    // Get the stream and write it chunk by chunk with progress tracking
+    // The stream fills buffers for the flash task, so receiving the next block overlaps
+    // erasing and writing the last one
     WiFiClient* client = http.getStreamPtr();
-    uint8_t buffer[1024];
-    size_t totalWritten = 0;
-    unsigned long lastProgressUpdate = 0;
-    
-    while (totalWritten < contentLength) {
-        // Check if client is still connected
-        if (!client->connected()) {
-            LOG_E("OTA", "Client disconnected during download");
-            Update.abort();
-            http.end();
-            return false;
-        }
-        
-        size_t availableBytes = client->available();
-        if (availableBytes == 0) {
-            delay(10);
-            continue;
-        }
-        
-        size_t bytesToRead = min(sizeof(buffer), min(availableBytes, (size_t)(contentLength - totalWritten)));
-        size_t bytesRead = client->readBytes(buffer, bytesToRead);
-        
-        if (bytesRead > 0) {
-            size_t written = Update.write(buffer, bytesRead);
-            if (written != bytesRead) {
-                LOG_E("OTA", "Write failed: " + String(written) + " vs " + String(bytesRead));
-                Update.abort();
-                http.end();
-                return false;
+    FlashPipeline pipeline;
+    if (!pipeline.begin()) {
+        Update.abort();
+        http.end();
+        return false;
+    }
+    if (pipeline.isPipelined()) {
+        LOG_IF("OTA", "Writing flash from its own task through %u x %u KB buffers",
+               (unsigned)OTA_BUFFER_COUNT, (unsigned)(OTA_BUFFER_BYTES / 1024));
+    }
+
+    size_t totalRead = 0;
+    unsigned long started = millis();
+    unsigned long lastProgressUpdate = started;
+    unsigned long flashWaitMs = 0;    // Every buffer still being written: flash-bound
+    unsigned long networkWaitMs = 0;  // Nothing received yet: network-bound
+    bool received = true;
+
+    while (received && totalRead < (size_t)contentLength) {
+        uint8_t* buffer = pipeline.acquire(flashWaitMs);
+        size_t wanted = min((size_t)OTA_BUFFER_BYTES, (size_t)contentLength - totalRead);
+        size_t filled = 0;
+
+        while (filled < wanted) {
+            int availableBytes = client->available();
+            if (availableBytes <= 0) {
+                if (!client->connected()) {
+                    LOG_E("OTA", "Client disconnected during download");
+                    received = false;
+                    break;
+                }
+                unsigned long waitStart = millis();
+                bool readable = waitForData(client, OTA_STALL_TIMEOUT_MS);
+                networkWaitMs += millis() - waitStart;
+                if (!readable) {
+                    LOG_E("OTA", "Download stalled at " + String(totalRead + filled) + " bytes");
+                    received = false;
+                    break;
+                }
+                continue;
             }
-            
-            totalWritten += written;
-            downloadedBytes = totalWritten;
-            
-            // Log progress every 10KB or every 5 seconds
-            if (totalWritten - (totalWritten % 10240) != (totalWritten - written) - ((totalWritten - written) % 10240) ||
-                millis() - lastProgressUpdate > 5000) {
-                float progress = ((float)totalWritten / (float)contentLength) * 100.0f;
-                LOG_I("OTA", "Download progress: " + String(progress, 1) + "% (" + String(totalWritten) + "/" + String(contentLength) + " bytes)");
-                lastProgressUpdate = millis();
+
+            int bytesRead = client->read(buffer + filled, min((size_t)availableBytes, wanted - filled));
+            if (bytesRead < 0) {
+                LOG_E("OTA", "Read failed during download");
+                received = false;
+                break;
             }
+            filled += bytesRead;
+        }
+        if (!received) {
+            break;
+        }
+
+        totalRead += filled;
+        downloadedBytes = totalRead;
+        if (!pipeline.submit(filled)) {
+            received = false;
+            break;
+        }
+
+        unsigned long now = millis();
+        downloadKBps = kilobytesPerSecond(totalRead, now - started);
+        if (now - lastProgressUpdate > 5000) {
+            float progress = ((float)totalRead / (float)contentLength) * 100.0f;
+            LOG_I("OTA", "Download progress: " + String(progress, 1) + "% (" + String(totalRead) + "/" +
+                         String(contentLength) + " bytes, " + String(downloadKBps, 1) + " KB/s)");
+            lastProgressUpdate = now;
         }
-        
-        // Watchdog feed
-        delay(1);
     }
 
-    if (totalWritten != contentLength) {
-        LOG_E("OTA", "Download incomplete: " + String(totalWritten) + "/" + String(contentLength));
+    // Everything submitted is on flash once this returns
+    bool written = pipeline.finish();
+    unsigned long elapsedMs = millis() - started;
+    if (!received || !written) {
         Update.abort();
         http.end();
         return false;
     }
+    size_t totalWritten = totalRead;
+    downloadKBps = kilobytesPerSecond(totalWritten, elapsedMs);
 
     // Finalize the update. This validates and sets the next boot partition.
     if (!Update.end(true)) {
@@ -471,7 +680,8 @@ bool OTAManager::downloadFirmwareToApp1(const String& url) {
     http.end();
     lastWrittenBytes = totalWritten;
     LOG_I("OTA", "Application firmware download and commit completed successfully");
-    LOG_I("OTA", "Downloaded " + String(totalWritten) + " bytes");
+    LOG_IF("OTA", "Downloaded %u bytes in %lu ms (%.1f KB/s; waited %lu ms on flash, %lu ms on the network)",
+           (unsigned)totalWritten, elapsedMs, downloadKBps, flashWaitMs, networkWaitMs);
     
     return true;
 }
@@ -37,6 +37,8 @@ private:
     // Track the actual OTA target partition and bytes written
     const esp_partition_t* targetPartition = nullptr;
     size_t lastWrittenBytes = 0;
+    // Download rate of the current (or last) attempt
+    float downloadKBps = 0.0f;
     
 public:
     struct OTAAssignment {
@@ -50,6 +52,8 @@ public:
         String printerId;
         String printerName;
         String printerConnectionJson; // raw JSON of connection details
+        String payloadEncoding;       // "json" (default) or "msgpack" for uploads
+        String telemetryBroker;       // "host[:port]" of the desktop's MQTT broker, if any
     };
     OTAManager();
     ~OTAManager();
@@ -68,6 +72,7 @@ public:
     String getStatusJson() const;
     
     float getDownloadProgress() const;
+    float getDownloadRate() const { return downloadKBps; }
     bool isUpdateAvailable() const { return updateInfo.available; }
     bool isIdle() const { return currentState == OTAState::IDLE; }
     
@@ -0,0 +1,166 @@
+#include "StatusChannel.h"
+#include "Logger.h"
+
+StatusChannel::StatusChannel() {
+    reset();
+}
+
+void StatusChannel::reset() {
+    deltaEnabled = false;
+    keyframeDue = true;
+    sessionDue = true;
+    baseline.clear();
+    baselineSequence = 0;
+    lastSequence = 0;
+    lastKeyframeAt = 0;
+    pending.clear();
+    pendingSequence = 0;
+    pendingKeyframe = false;
+    pendingSession = false;
+    pendingAt = 0;
+    stats = Stats();
+}
+
+void StatusChannel::setSessionInfo(const JsonDocument& info) {
+    if (info.as<JsonVariantConst>() == session.as<JsonVariantConst>()) {
+        return;
+    }
+    session = info;
+    sessionDue = true;
+}
+
+String StatusChannel::encode(const String& fieldsJson, unsigned long now) {
+    JsonDocument fields;
+    if (deserializeJson(fields, fieldsJson) || !fields.is<JsonObject>()) {
+        // Not a status document we can take apart; send it as queued
+        return fieldsJson;
+    }
+    if (!deltaEnabled) {
+        pending = fields;
+        return encodeLegacy(fields, now);
+    }
+
+    bool keyframe = keyframeDue || baselineSequence == 0 || now - lastKeyframeAt >= STATUS_KEYFRAME_INTERVAL_MS;
+    JsonObjectConst current = fields.as<JsonObjectConst>();
+    JsonObjectConst before = baseline.as<JsonObjectConst>();
+
+    JsonDocument frame;
+    frame["seq"] = ++lastSequence;
+    frame["base"] = keyframe ? 0 : baselineSequence;
+    frame["keyframe"] = keyframe;
+    frame["ts"] = now;
+    JsonObject changed = frame["fields"].to<JsonObject>();
+    for (JsonPairConst field : current) {
+        if (keyframe || before[field.key().c_str()] != field.value()) {
+            changed[field.key().c_str()] = field.value();
+        }
+    }
+    if (!keyframe) {
+        JsonArray removed;
+        for (JsonPairConst field : before) {
+            if (!current[field.key().c_str()].isNull()) continue;
+            if (removed.isNull()) {
+                removed = frame["removed"].to<JsonArray>();
+            }
+            removed.add(field.key().c_str());
+        }
+    }
+    bool withSession = sessionDue && !session.isNull();
+    if (withSession) {
+        frame["session"] = session;
+    }
+
+    pending = fields;
+    pendingSequence = lastSequence;
+    pendingKeyframe = keyframe;
+    pendingSession = withSession;
+    pendingAt = now;
+
+    String body;
+    serializeJson(frame, body);
+    if (keyframe) {
+        stats.keyframes++;
+    } else {
+        stats.deltas++;
+    }
+    stats.fullBytes += measureJson(fields) + (withSession ? measureJson(session) : 0);
+    stats.sentBytes += body.length();
+    return body;
+}
+
+void StatusChannel::onResponse(bool delivered, bool carriedStatus, long desktopSequence) {
+    if (desktopSequence < 0) {
+        if (delivered && deltaEnabled) {
+            LOG_I("Update", "Desktop stopped tracking status sequences - sending full documents");
+            reset();
+        }
+        return;
+    }
+    if (!deltaEnabled) {
+        // What went out so far were full documents; start the frames with a keyframe
+        LOG_I("Update", "Desktop tracks status sequences - sending deltas");
+        deltaEnabled = true;
+        keyframeDue = true;
+        sessionDue = true;
+        return;
+    }
+    if (!delivered) {
+        return;
+    }
+
+    uint32_t applied = static_cast<uint32_t>(desktopSequence);
+    if (carriedStatus && applied == pendingSequence) {
+        baseline = pending;
+        baselineSequence = pendingSequence;
+        if (pendingKeyframe) {
+            keyframeDue = false;
+            lastKeyframeAt = pendingAt;
+        }
+        if (pendingSession) {
+            sessionDue = false;
+        }
+        return;
+    }
+
+    // Behind the frame it was just sent, or behind what it had acknowledged before
+    bool behind = carriedStatus ? applied < pendingSequence : applied < baselineSequence;
+    if (behind) {
+        if (!keyframeDue) {
+            stats.gaps++;
+            LOG_WF("Update", "Desktop is at status %u, behind %u - sending a keyframe",
+                   static_cast<unsigned>(applied), static_cast<unsigned>(carriedStatus ? pendingSequence : baselineSequence));
+        }
+        keyframeDue = true;
+        sessionDue = true;
+    }
+}
+
+String StatusChannel::getLatest() const {
+    String json;
+    serializeJson(pending, json);
+    return json;
+}
+
+// The document desktops without sequence tracking expect: fields, session and time
+String StatusChannel::encodeFull(const String& fieldsJson, unsigned long now) const {
+    JsonDocument fields;
+    if (deserializeJson(fields, fieldsJson) || !fields.is<JsonObject>()) {
+        return fieldsJson;
+    }
+    return encodeLegacy(fields, now);
+}
+
+String StatusChannel::encodeLegacy(const JsonDocument& fields, unsigned long now) const {
+    JsonDocument legacy;
+    for (JsonPairConst field : session.as<JsonObjectConst>()) {
+        legacy[field.key().c_str()] = field.value();
+    }
+    legacy["timestamp"] = now;
+    legacy["uptime_ms"] = now;
+    for (JsonPairConst field : fields.as<JsonObjectConst>()) {
+        legacy[field.key().c_str()] = field.value();
+    }
+    String body;
+    serializeJson(legacy, body);
+    return body;
+}
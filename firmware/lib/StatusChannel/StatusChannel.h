@@ -0,0 +1,93 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Config.h"
+
+/**
+ * @brief Turns successive status documents into sequence-numbered delta frames
+ *
+ * A frame carries only the fields that differ from the last one the desktop
+ * acknowledged:
+ *
+ *   {"seq":S,"base":B,"keyframe":false,"ts":T,"fields":{..changed..},"removed":[..],
+ *    "session":{..}}
+ *
+ * A keyframe (base 0, "keyframe":true) carries every field; one goes out every
+ * STATUS_KEYFRAME_INTERVAL_MS, at the start of a session, and after the desktop reports
+ * a gap. "session" holds the static metadata (device, firmware, printer identity, IP)
+ * and is only present in the first frame after it changes or the desktop lost it.
+ *
+ * The desktop answers every request with X-Status-Seq, the last sequence it applied. A
+ * frame is acknowledged when that matches its seq; a desktop behind the frame's base
+ * (restarted, or dropped one) is a gap. Field values are absolute, so a delta against an
+ * older base is still correct on a desktop that is further ahead. Desktops that never
+ * send X-Status-Seq keep getting the full legacy document.
+ */
+class StatusChannel {
+public:
+    struct Stats {
+        uint32_t keyframes;
+        uint32_t deltas;
+        uint32_t gaps;            // Resyncs the desktop asked for
+        uint32_t fullBytes;       // What the frames would have been as full documents
+        uint32_t sentBytes;
+    };
+
+    StatusChannel();
+
+    /**
+     * @brief Forget what the desktop has; the next frame is a keyframe with the session
+     */
+    void reset();
+
+    void setSessionInfo(const JsonDocument& session);
+
+    /**
+     * @brief Body for /updates (or a batch item) from the latest full status fields
+     */
+    String encode(const String& fieldsJson, unsigned long now);
+
+    /**
+     * @brief The full legacy document (session merged in) for the given fields, outside
+     *        the frame sequence; for a retained last state that must stand on its own
+     */
+    String encodeFull(const String& fieldsJson, unsigned long now) const;
+
+    /**
+     * @brief Account for a response; desktopSequence < 0 when it carried no X-Status-Seq
+     * @param carriedStatus Whether the request held the frame from the last encode()
+     */
+    void onResponse(bool delivered, bool carriedStatus, long desktopSequence);
+
+    /**
+     * @brief true after a gap, until a keyframe is delivered; getLatest() is the newest
+     *        state encoded, to resend when no newer status is waiting
+     */
+    bool needsKeyframe() const { return keyframeDue; }
+    bool hasLatest() const { return !pending.isNull(); }
+    String getLatest() const;
+
+    bool isDeltaEnabled() const { return deltaEnabled; }
+    Stats getStats() const { return stats; }
+
+private:
+    bool deltaEnabled;           // The desktop has sent X-Status-Seq
+    bool keyframeDue;
+    bool sessionDue;
+    JsonDocument session;
+
+    JsonDocument baseline;       // Fields as of the last acknowledged frame
+    uint32_t baselineSequence;
+    uint32_t lastSequence;
+    unsigned long lastKeyframeAt;
+
+    JsonDocument pending;        // Fields as of the frame (or full document) last encoded
+    uint32_t pendingSequence;
+    bool pendingKeyframe;
+    bool pendingSession;
+    unsigned long pendingAt;
+
+    Stats stats;
+
+    String encodeLegacy(const JsonDocument& fields, unsigned long now) const;
+};
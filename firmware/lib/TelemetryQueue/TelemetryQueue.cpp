@@ -0,0 +1,286 @@
+#include "TelemetryQueue.h"
+#include "Crc32.h"
+#include "Logger.h"
+#include <algorithm>
+
+namespace {
+const char* kJournalPath = "/telemetry.q";
+const char* kCompactPath = "/telemetry.tmp";
+
+enum RecordKind : uint8_t {
+    RECORD_ALERT = 1,
+    RECORD_ACK = 2
+};
+
+void putU32(uint8_t* out, uint32_t value) {
+    out[0] = value;
+    out[1] = value >> 8;
+    out[2] = value >> 16;
+    out[3] = value >> 24;
+}
+
+uint32_t getU32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+}
+
+TelemetryQueue::TelemetryQueue()
+    : fs(nullptr), statusVersion(0), nextLogSequence(0), bytes(0), nextSequence(0), journalBytes(0), stats() {}
+
+size_t TelemetryQueue::begin(fs::FS& filesystem) {
+    fs = &filesystem;
+
+    // A compaction cut short between removing the journal and renaming its replacement
+    if (!fs->exists(kJournalPath) && fs->exists(kCompactPath)) {
+        fs->rename(kCompactPath, kJournalPath);
+    }
+    fs->remove(kCompactPath);
+
+    std::vector<Alert> recovered;
+    File file = fs->open(kJournalPath, FILE_READ);
+    if (file) {
+        uint8_t header[kHeaderBytes];
+        std::vector<char> payload;
+        while (file.read(header, sizeof(header)) == sizeof(header)) {
+            uint16_t length = header[2] | (header[3] << 8);
+            payload.resize(length + 1);
+            if (file.read(reinterpret_cast<uint8_t*>(payload.data()), length) != length) break;
+            uint32_t stored = getU32(header + 8);
+            putU32(header + 8, 0);
+            uint32_t crc = crc32(crc32(0, header, sizeof(header)), reinterpret_cast<const uint8_t*>(payload.data()), length);
+            if (crc != stored) {
+                LOG_W("Queue", "Telemetry journal ends in a torn record");
+                break;
+            }
+
+            uint32_t sequence = getU32(header + 4);
+            if (header[0] == RECORD_ALERT) {
+                payload[length] = '\0';
+                recovered.push_back({sequence, String(payload.data())});
+            } else if (header[0] == RECORD_ACK) {
+                recovered.erase(std::remove_if(recovered.begin(), recovered.end(),
+                                               [sequence](const Alert& alert) { return alert.sequence <= sequence; }),
+                                recovered.end());
+            }
+            nextSequence = std::max(nextSequence, sequence + 1);
+        }
+        file.close();
+    }
+
+    // Ahead of anything queued before begin(), which is newer and gets renumbered after them
+    for (Alert& alert : alerts) {
+        alert.sequence = nextSequence++;
+    }
+    for (const Alert& alert : recovered) {
+        bytes += alert.json.length();
+    }
+    alerts.insert(alerts.begin(), recovered.begin(), recovered.end());
+    stats.alertsRecovered = recovered.size();
+
+    // Start from a journal holding exactly the live alerts
+    compactJournal();
+    makeRoom();
+    if (!recovered.empty()) {
+        LOG_IF("Queue", "Recovered %u undelivered alerts from flash", static_cast<unsigned>(recovered.size()));
+    }
+    return recovered.size();
+}
+
+void TelemetryQueue::pushAlert(const String& json) {
+    Alert alert = {nextSequence++, json};
+    if (alerts.size() >= TELEMETRY_QUEUE_ALERTS) {
+        popAlerts(1);
+        stats.alertsDropped++;
+    }
+    alerts.push_back(alert);
+    bytes += json.length();
+    appendRecord(RECORD_ALERT, alert.sequence, json);
+    makeRoom();
+}
+
+void TelemetryQueue::setStatus(const String& json) {
+    if (!status.isEmpty()) {
+        stats.statusReplaced++;
+    }
+    bytes -= status.length();
+    status = json;
+    statusVersion++;
+    bytes += status.length();
+    makeRoom();
+}
+
+void TelemetryQueue::pushLogs(const String& json) {
+    logs.push_back({nextLogSequence++, json});
+    bytes += json.length();
+    if (logs.size() > TELEMETRY_QUEUE_LOG_CHUNKS) {
+        thinLogs();
+    }
+    makeRoom();
+}
+
+void TelemetryQueue::popAlerts(size_t count) {
+    count = std::min(count, alerts.size());
+    if (count == 0) return;
+
+    uint32_t last = alerts[count - 1].sequence;
+    for (size_t i = 0; i < count; i++) {
+        bytes -= alerts[i].json.length();
+    }
+    alerts.erase(alerts.begin(), alerts.begin() + count);
+
+    if (!fs) return;
+    if (alerts.empty()) {
+        fs->remove(kJournalPath);
+        journalBytes = 0;
+    } else {
+        appendRecord(RECORD_ACK, last, String());
+    }
+}
+
+void TelemetryQueue::clearStatus() {
+    bytes -= status.length();
+    status = "";
+}
+
+void TelemetryQueue::popLogs(size_t count) {
+    count = std::min(count, logs.size());
+    for (size_t i = 0; i < count; i++) {
+        bytes -= logs[i].json.length();
+    }
+    logs.erase(logs.begin(), logs.begin() + count);
+}
+
+TelemetryQueue::Mark TelemetryQueue::mark(size_t alertCount, bool withStatus, size_t logCount) const {
+    Mark mark = {};
+    mark.alerts = std::min(alertCount, alerts.size());
+    if (mark.alerts > 0) mark.lastAlert = alerts[mark.alerts - 1].sequence;
+    mark.logs = std::min(logCount, logs.size());
+    if (mark.logs > 0) mark.lastLogs = logs[mark.logs - 1].sequence;
+    mark.status = withStatus && !status.isEmpty();
+    mark.statusVersion = statusVersion;
+    return mark;
+}
+
+// Items only leave from the front or from the middle (thinning), and new ones go at the
+// back, so whatever is left of a marked run is still at the front
+void TelemetryQueue::retire(const Mark& mark) {
+    size_t count = 0;
+    if (mark.alerts > 0) {
+        while (count < alerts.size() && static_cast<int32_t>(alerts[count].sequence - mark.lastAlert) <= 0) {
+            count++;
+        }
+    }
+    popAlerts(count);
+
+    count = 0;
+    if (mark.logs > 0) {
+        while (count < logs.size() && static_cast<int32_t>(logs[count].sequence - mark.lastLogs) <= 0) {
+            count++;
+        }
+    }
+    popLogs(count);
+
+    // A newer status replaced the one sent; it still has to go
+    if (mark.status && statusVersion == mark.statusVersion) {
+        clearStatus();
+    }
+}
+
+// Lowest class first: logs, then status, then the oldest alert; the newest alert stays
+void TelemetryQueue::makeRoom() {
+    while (bytes > TELEMETRY_QUEUE_RAM_BYTES) {
+        if (!logs.empty()) {
+            popLogs(1);
+            stats.logChunksDropped++;
+        } else if (!status.isEmpty()) {
+            clearStatus();
+            stats.statusDropped++;
+        } else if (alerts.size() > 1) {
+            popAlerts(1);
+            stats.alertsDropped++;
+        } else {
+            break;
+        }
+    }
+}
+
+// Drop every other chunk before the newest, so what's left still spans the outage
+void TelemetryQueue::thinLogs() {
+    std::vector<LogChunk> kept;
+    for (size_t i = 0; i + 1 < logs.size(); i++) {
+        if (i % 2 == 0) {
+            kept.push_back(logs[i]);
+        } else {
+            bytes -= logs[i].json.length();
+            stats.logChunksDropped++;
+        }
+    }
+    kept.push_back(logs.back());
+    logs.swap(kept);
+}
+
+bool TelemetryQueue::appendRecord(uint8_t kind, uint32_t sequence, const String& payload) {
+    if (!fs) return false;
+    if (journalBytes + kHeaderBytes + payload.length() > TELEMETRY_QUEUE_JOURNAL_BYTES) {
+        // The record just queued is among the live alerts, so compacting writes it too
+        compactJournal();
+        return true;
+    }
+
+    File file = fs->open(kJournalPath, FILE_APPEND);
+    bool written = file && writeRecord(file, kind, sequence, payload);
+    if (file) file.close();
+    if (!written) {
+        stats.journalFailures++;
+        return false;
+    }
+    journalBytes += kHeaderBytes + payload.length();
+    return true;
+}
+
+void TelemetryQueue::compactJournal() {
+    if (!fs) return;
+    if (alerts.empty()) {
+        fs->remove(kJournalPath);
+        journalBytes = 0;
+        return;
+    }
+
+    // Newest alerts that fit; anything older is only kept in RAM
+    size_t first = alerts.size();
+    size_t size = 0;
+    while (first > 0 && size + kHeaderBytes + alerts[first - 1].json.length() <= TELEMETRY_QUEUE_JOURNAL_BYTES / 2) {
+        first--;
+        size += kHeaderBytes + alerts[first].json.length();
+    }
+
+    File file = fs->open(kCompactPath, FILE_WRITE);
+    bool written = static_cast<bool>(file);
+    for (size_t i = first; written && i < alerts.size(); i++) {
+        written = writeRecord(file, RECORD_ALERT, alerts[i].sequence, alerts[i].json);
+    }
+    if (file) file.close();
+    if (!written) {
+        fs->remove(kCompactPath);
+        stats.journalFailures++;
+        return;
+    }
+    fs->remove(kJournalPath);
+    fs->rename(kCompactPath, kJournalPath);
+    journalBytes = size;
+}
+
+bool TelemetryQueue::writeRecord(File& file, uint8_t kind, uint32_t sequence, const String& payload) {
+    if (payload.length() > UINT16_MAX) return false;
+    uint8_t header[kHeaderBytes];
+    header[0] = kind;
+    header[1] = 0;
+    header[2] = payload.length() & 0xFF;
+    header[3] = payload.length() >> 8;
+    putU32(header + 4, sequence);
+    putU32(header + 8, 0);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.c_str());
+    putU32(header + 8, crc32(crc32(0, header, sizeof(header)), data, payload.length()));
+    return file.write(header, sizeof(header)) == sizeof(header) &&
+           file.write(data, payload.length()) == payload.length();
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+#include "Config.h"
+
+/**
+ * @brief Telemetry waiting for the desktop, in three priority classes
+ *
+ * - Alerts: FIFO, never given up for room while a status or log chunk is held, and
+ *   journaled to flash so they survive a desktop outage or a reboot.
+ * - Status: one slot; a newer document replaces the one waiting (it is full state).
+ * - Logs: FIFO of /logs documents, thinned to every other chunk past
+ *   TELEMETRY_QUEUE_LOG_CHUNKS; the full history stays in LogSpill.
+ *
+ * The journal ("/telemetry.q") is append-only:
+ *
+ *   kind u8 | reserved u8 | length u16 | sequence u32 | crc32 u32 | payload
+ *
+ * An alert record carries the JSON; an ack record (no payload) retires every alert up
+ * to its sequence. Replay stops at the first record failing its CRC. The file is
+ * removed once nothing is left, and rewritten with only the live alerts when it would
+ * outgrow TELEMETRY_QUEUE_JOURNAL_BYTES.
+ *
+ * Not thread-safe; UpdateClient drives it from the main loop.
+ */
+class TelemetryQueue {
+public:
+    /**
+     * @brief What a request carried, by sequence rather than position, so it can be
+     *        retired after items were queued, replaced or dropped while it was out
+     */
+    struct Mark {
+        size_t alerts;               // Leading alerts, up to and including lastAlert
+        uint32_t lastAlert;
+        size_t logs;
+        uint32_t lastLogs;
+        bool status;
+        uint32_t statusVersion;
+    };
+
+    struct Stats {
+        uint32_t alertsRecovered;    // Read back from the journal by begin()
+        uint32_t alertsDropped;      // Oldest alerts given up at the count or RAM limit
+        uint32_t statusReplaced;     // Status documents superseded before being sent
+        uint32_t statusDropped;      // Status given up for room
+        uint32_t logChunksDropped;   // Thinned or given up for room
+        uint32_t journalFailures;    // Journal writes that didn't complete
+    };
+
+    TelemetryQueue();
+
+    /**
+     * @brief Journal alerts on the (mounted) filesystem from now on, after loading the
+     *        ones a previous run didn't deliver
+     * @return Alerts recovered
+     */
+    size_t begin(fs::FS& fs);
+
+    void pushAlert(const String& json);
+    void setStatus(const String& json);
+    void pushLogs(const String& json);
+
+    size_t getAlertCount() const { return alerts.size(); }
+    const String& getAlert(size_t index) const { return alerts[index].json; }
+    uint32_t getAlertSequence(size_t index) const { return alerts[index].sequence; }
+    const String& getStatus() const { return status; }
+    size_t getLogCount() const { return logs.size(); }
+    const String& getLogs(size_t index) const { return logs[index].json; }
+
+    /**
+     * @brief Retire what was delivered: the first count alerts or log chunks, the status
+     */
+    void popAlerts(size_t count);
+    void clearStatus();
+    void popLogs(size_t count);
+
+    /**
+     * @brief Mark the first alertCount alerts, the status and the first logCount log
+     *        chunks; retire() then drops those of them still queued
+     */
+    Mark mark(size_t alertCount, bool withStatus, size_t logCount) const;
+    void retire(const Mark& mark);
+
+    bool isEmpty() const { return alerts.empty() && status.isEmpty() && logs.empty(); }
+    size_t getBytes() const { return bytes; }
+    Stats getStats() const { return stats; }
+
+private:
+    struct Alert {
+        uint32_t sequence;
+        String json;
+    };
+
+    struct LogChunk {
+        uint32_t sequence;
+        String json;
+    };
+
+    static const size_t kHeaderBytes = 12;
+
+    fs::FS* fs;
+    std::vector<Alert> alerts;   // Oldest first
+    String status;
+    uint32_t statusVersion;      // Bumped by every setStatus()
+    std::vector<LogChunk> logs;  // Oldest first
+    uint32_t nextLogSequence;
+    size_t bytes;                // Payload bytes held across all three classes
+    uint32_t nextSequence;
+    size_t journalBytes;
+    Stats stats;
+
+    void makeRoom();
+    void thinLogs();
+    bool appendRecord(uint8_t kind, uint32_t sequence, const String& payload);
+    void compactJournal();
+    bool writeRecord(File& file, uint8_t kind, uint32_t sequence, const String& payload);
+};
@@ -1,7 +1,7 @@
 #include "UpdateClient.h"
-#include <HTTPClient.h>
 #include <Logger.h>
 #include <algorithm>
+#include <new>
 #include <vector>
 
 #include <mbedtls/base64.h>
@@ -9,6 +9,28 @@
 namespace {
 constexpr unsigned long kMinBackoffMs = 1000UL;
 constexpr unsigned long kMaxBackoffMs = 60000UL;
+constexpr int kNotFound = 404;
+constexpr int kMethodNotAllowed = 405;
+constexpr int kUnsupportedMediaType = 415;
+
+// One envelope entry; body is already serialized JSON
+void appendItem(String& batch, const char* type, UpdateClient::Priority priority, const String& body) {
+    if (!batch.endsWith("[")) {
+        batch += ',';
+    }
+    batch += "{\"type\":\"";
+    batch += type;
+    batch += "\",\"priority\":";
+    batch += String(static_cast<int>(priority));
+    batch += ",\"body\":";
+    batch += body;
+    batch += '}';
+}
+
+// Envelope bytes an item adds on top of its body
+size_t itemOverhead(const char* type) {
+    return strlen(type) + 40;
+}
 }
 
 UpdateClient::UpdateClient()
@@ -19,12 +41,25 @@ UpdateClient::UpdateClient()
     , printerBrand("")
     , printerModel("")
     , printerName("")
-    , pendingStatusPayload("")
-    , pendingLogPayload("")
+    , stats()
+    , uploading(false)
+    , desktopStatusSequence(-1)
+    , alertsPublished(false)
+    , alertsPublishedThrough(0)
+    , alertsPublishedAt(0)
     , nextAttemptAt(0)
     , lastSuccessAt(0)
     , lastFailureAt(0)
-    , consecutiveFailures(0) {}
+    , consecutiveFailures(0)
+    , desktopAcceptsHeatshrink(false)
+    , desktopAcceptsBatch(true)
+    , preferredEncoding(PayloadEncoding::JSON)
+    , desktopAcceptsMessagePack(false)
+    , compressedBytesIn(0)
+    , compressedBytesOut(0) {
+    const char* responseHeaders[] = {"Accept-Encoding", "Accept-Post", "X-Status-Seq"};
+    http.collectHeaders(responseHeaders, 3);
+}
 
 bool UpdateClient::init(const String& base, const String& token, const String& device) {
     baseUrl = base;
@@ -34,7 +69,12 @@ bool UpdateClient::init(const String& base, const String& token, const String& d
     lastSuccessAt = 0;
     lastFailureAt = 0;
     consecutiveFailures = 0;
-    alertQueue.clear();
+    desktopAcceptsHeatshrink = false;
+    desktopAcceptsBatch = true;
+    desktopAcceptsMessagePack = preferredEncoding == PayloadEncoding::MESSAGE_PACK;
+    statusChannel.reset();
+    http.dropConnection();
+    rebuildStaticHeaders();
     if (baseUrl.isEmpty()) {
         LOG_W("Update", "No API endpoint configured for push updates");
         return false;
@@ -42,6 +82,7 @@ bool UpdateClient::init(const String& base, const String& token, const String& d
     if (authToken.isEmpty()) {
         LOG_W("Update", "API credentials missing - push updates will be unauthenticated");
     }
+    http.start();
     LOG_I("Update", "Configured push endpoint: " + baseUrl);
     return true;
 }
@@ -51,40 +92,42 @@ void UpdateClient::setPrinterMetadata(const String& printer, const String& brand
     printerBrand = brand;
     printerModel = model;
     printerName = name;
+    rebuildStaticHeaders();
+}
+
+void UpdateClient::setPayloadEncoding(PayloadEncoding encoding) {
+    preferredEncoding = encoding;
+    desktopAcceptsMessagePack = encoding == PayloadEncoding::MESSAGE_PACK;
 }
 
 void UpdateClient::queueStatusUpdate(const JsonDocument& doc, bool force) {
     String payload;
     serializeJson(doc, payload);
-    pendingStatusPayload = payload;
+    queue.setStatus(payload);
     if (force) {
         nextAttemptAt = 0;
     }
-    processPending();
 }
 
 void UpdateClient::queueAlert(const JsonDocument& doc) {
     String payload;
     serializeJson(doc, payload);
-    alertQueue.push_back(payload);
-    if (alertQueue.size() > 5) {
-        alertQueue.erase(alertQueue.begin());
-    }
+    queue.pushAlert(payload);
     nextAttemptAt = 0;
-    processPending();
 }
 
 void UpdateClient::queueLogs(const String& logsJson) {
-    pendingLogPayload = logsJson;
+    queue.pushLogs(logsJson);
     nextAttemptAt = 0;
-    processPending();
 }
 
 bool UpdateClient::hasPending() const {
-    return !pendingStatusPayload.isEmpty() || !pendingLogPayload.isEmpty() || !alertQueue.empty();
+    return !queue.isEmpty();
 }
 
 void UpdateClient::loop() {
+    mqtt.loop();
+    http.poll();
     processPending();
 }
 
@@ -93,7 +136,7 @@ bool UpdateClient::isReady() const {
 }
 
 void UpdateClient::processPending() {
-    if (!isReady()) {
+    if (!isReady() || uploading) {
         return;
     }
 
@@ -102,100 +145,362 @@ void UpdateClient::processPending() {
         return;
     }
 
-    if (!alertQueue.empty()) {
-        String payload = alertQueue.front();
-        if (postJson("/alerts", payload)) {
-            alertQueue.erase(alertQueue.begin());
-            scheduleNextAttempt(true);
-        } else {
-            scheduleNextAttempt(false);
-        }
+    if (!hasPending()) {
+        nextAttemptAt = now + 250;
         return;
     }
 
-    if (!pendingLogPayload.isEmpty()) {
-        if (postJson("/logs", pendingLogPayload)) {
-            pendingLogPayload = "";
-            scheduleNextAttempt(true);
-        } else {
-            scheduleNextAttempt(false);
+    if (mqtt.isConnected()) {
+        processPublish();
+    } else if (desktopAcceptsBatch) {
+        processBatch();
+    } else {
+        processSingle();
+    }
+}
+
+/**
+ * @brief Post everything pending as one /batch envelope:
+ *
+ *   {"device_id":..,"items":[{"type":"alert"|"status"|"logs","priority":N,"body":{..}},..]}
+ *
+ * Items are added highest priority first, oldest alert first, until the next one would
+ * push the envelope past UPLOAD_BATCH_MAX_BYTES; whatever is left goes in the next batch.
+ */
+void UpdateClient::processBatch() {
+    String batch;
+    batch.reserve(UPLOAD_BATCH_MAX_BYTES);
+    batch = "{\"device_id\":\"";
+    batch += deviceId;
+    batch += "\",\"items\":[";
+    size_t items = 0;
+    auto fits = [&](const char* type, const String& body) {
+        return items == 0 || batch.length() + itemOverhead(type) + body.length() + 2 <= UPLOAD_BATCH_MAX_BYTES;
+    };
+
+    size_t alerts = 0;
+    while (alerts < queue.getAlertCount() && fits("alert", queue.getAlert(alerts))) {
+        appendItem(batch, "alert", PRIORITY_ALERT, queue.getAlert(alerts));
+        alerts++;
+        items++;
+    }
+    bool allAlerts = alerts == queue.getAlertCount();
+    bool status = false;
+    if (allAlerts && !queue.getStatus().isEmpty()) {
+        String frame = statusChannel.encode(queue.getStatus(), millis());
+        if (fits("status", frame)) {
+            appendItem(batch, "status", PRIORITY_STATUS, frame);
+            status = true;
+            items++;
         }
-        return;
     }
+    size_t logs = 0;
+    if (allAlerts && (status || queue.getStatus().isEmpty())) {
+        while (logs < queue.getLogCount() && fits("logs", queue.getLogs(logs))) {
+            appendItem(batch, "logs", PRIORITY_LOGS, queue.getLogs(logs));
+            logs++;
+            items++;
+        }
+    }
+    batch += "]}";
 
-    if (!pendingStatusPayload.isEmpty()) {
-        if (postJson("/updates", pendingStatusPayload)) {
-            pendingStatusPayload = "";
-            scheduleNextAttempt(true);
-        } else {
-            scheduleNextAttempt(false);
+    TelemetryQueue::Mark sent = queue.mark(alerts, status, logs);
+    uploading = postJson("/batch", batch, [this, sent, items](int code) {
+        uploading = false;
+        bool delivered = code >= 200 && code < 300;
+        if (!delivered && (code == kNotFound || code == kMethodNotAllowed)) {
+            LOG_I("Update", "Desktop has no /batch endpoint - posting items one at a time");
+            desktopAcceptsBatch = false;
+            nextAttemptAt = 0;
+            return;
         }
-        return;
+        if (delivered) {
+            queue.retire(sent);
+            LOG_DF("Update", "Batch of %u items delivered", static_cast<unsigned>(items));
+        }
+        trackStatus(code, sent.status);
+        scheduleNextAttempt(delivered);
+    });
+    if (!uploading) {
+        scheduleNextAttempt(false);
+    }
+}
+
+void UpdateClient::processSingle() {
+    if (queue.getAlertCount() > 0) {
+        upload("/alerts", queue.getAlert(0), queue.mark(1, false, 0));
+    } else if (queue.getLogCount() > 0) {
+        upload("/logs", queue.getLogs(0), queue.mark(0, false, 1));
+    } else if (!queue.getStatus().isEmpty()) {
+        upload("/updates", statusChannel.encode(queue.getStatus(), millis()), queue.mark(0, true, 0));
+    }
+}
+
+/**
+ * @brief Publish what is pending on the broker session
+ *
+ * Status and logs are retired once written to the session. Alerts are retired when the
+ * desktop acks their seq; until then they are published once, and again on a new
+ * session or when no ack came within TELEMETRY_MQTT_ACK_TIMEOUT_MS.
+ */
+void UpdateClient::processPublish() {
+    unsigned long now = millis();
+    bool progress = false;
+
+    uint32_t acked;
+    if (mqtt.getAckedAlert(acked)) {
+        size_t count = 0;
+        while (count < queue.getAlertCount() && queue.getAlertSequence(count) <= acked) {
+            count++;
+        }
+        if (count > 0) {
+            queue.retire(queue.mark(count, false, 0));
+            alertsPublishedAt = now;
+            progress = true;
+        }
+    }
+    if (mqtt.takeNewSession() || (alertsPublished && now - alertsPublishedAt >= TELEMETRY_MQTT_ACK_TIMEOUT_MS)) {
+        alertsPublished = false;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; ok && i < queue.getAlertCount(); i++) {
+        uint32_t sequence = queue.getAlertSequence(i);
+        if (alertsPublished && sequence <= alertsPublishedThrough) {
+            continue;
+        }
+        if (!mqtt.fits("alerts", queue.getAlert(i).length())) {
+            // Can't be published at all (alert documents are bounded well below the
+            // buffer); hold it rather than lose it, and keep status and logs moving
+            break;
+        }
+        ok = mqtt.publishAlert(sequence, queue.getAlert(i));
+        if (ok) {
+            alertsPublished = true;
+            alertsPublishedThrough = sequence;
+            alertsPublishedAt = now;
+            progress = true;
+        }
+    }
+
+    if (ok && !queue.getStatus().isEmpty()) {
+        // Retained, so it must stand alone: always the full document, never a delta
+        ok = mqtt.publishStatus(statusChannel.encodeFull(queue.getStatus(), now));
+        if (ok) {
+            queue.retire(queue.mark(0, true, 0));
+            progress = true;
+        }
+    }
+
+    size_t logs = 0;
+    while (ok && logs < queue.getLogCount()) {
+        const String& chunk = queue.getLogs(logs);
+        // An oversized chunk is given up; LogSpill still has the lines
+        ok = mqtt.publishLogs(chunk) || !mqtt.fits("logs", chunk.length());
+        logs += ok ? 1 : 0;
+    }
+    if (logs > 0) {
+        queue.retire(queue.mark(0, false, logs));
+        progress = true;
+    }
+
+    if (!ok) {
+        LOG_W("Update", "Publish to the telemetry broker failed");
+        scheduleNextAttempt(false);
+    } else if (progress) {
+        scheduleNextAttempt(true);
+    } else {
+        // Only alerts waiting for their ack
+        nextAttemptAt = now + 250;
     }
+}
 
-    nextAttemptAt = now + 250;
+// One item to its own endpoint; retired once delivered
+void UpdateClient::upload(const String& path, const String& json, const TelemetryQueue::Mark& sent) {
+    uploading = postJson(path, json, [this, sent](int code) {
+        uploading = false;
+        bool delivered = code >= 200 && code < 300;
+        if (delivered) {
+            queue.retire(sent);
+        }
+        if (sent.status) {
+            trackStatus(code, true);
+        }
+        scheduleNextAttempt(delivered);
+    });
+    if (!uploading) {
+        scheduleNextAttempt(false);
+    }
 }
 
-bool UpdateClient::postJson(const String& path, const String& json) {
+void UpdateClient::trackStatus(int code, bool carriedStatus) {
+    if (code <= 0) {
+        return;
+    }
+    statusChannel.onResponse(code >= 200 && code < 300, carriedStatus, desktopStatusSequence);
+    // The desktop lost track: resend the newest state as a keyframe even if nothing changed
+    if (statusChannel.needsKeyframe() && statusChannel.hasLatest() && queue.getStatus().isEmpty()) {
+        queue.setStatus(statusChannel.getLatest());
+    }
+}
+
+bool UpdateClient::postJson(const String& path, const String& json, Completion done) {
     if (baseUrl.isEmpty()) {
         return false;
     }
 
-    HTTPClient http;
-    String url = baseUrl;
-    if (!url.endsWith("/")) {
-        url += path;
+    AsyncHttpClient::Request request;
+    request.url = baseUrl;
+    if (!request.url.endsWith("/")) {
+        request.url += path;
     } else {
-        url += path.substring(1);
+        request.url += path.substring(1);
     }
 
-    if (!http.begin(url)) {
-        LOG_W("Update", "Failed to initialize HTTP client for " + url);
+    // Queued items are kept as JSON text; the wire format is settled per request, so a
+    // desktop that changes its mind mid-backlog gets what it asks for
+    bool pack = desktopAcceptsMessagePack && json.length() <= UPLOAD_MSGPACK_MAX_BYTES && packPayload(json);
+    const uint8_t* body = pack ? packed.bytes.data() : reinterpret_cast<const uint8_t*>(json.c_str());
+    size_t size = pack ? packed.bytes.size() : json.length();
+    bool compress = desktopAcceptsHeatshrink && size >= UPLOAD_COMPRESS_MIN_BYTES && compressPayload(body, size);
+
+    request.headers.reserve(staticHeaders.size() + 4);
+    request.headers.push_back({"Content-Type", payloadContentType(pack ? PayloadEncoding::MESSAGE_PACK : PayloadEncoding::JSON)});
+    request.headers.insert(request.headers.end(), staticHeaders.begin(), staticHeaders.end());
+    if (compress) {
+        request.headers.push_back({"Content-Encoding", "heatshrink"});
+        request.headers.push_back({"X-Heatshrink-Window", String(UPLOAD_COMPRESS_WINDOW_BITS)});
+        request.headers.push_back({"X-Heatshrink-Lookahead", String(UPLOAD_COMPRESS_LOOKAHEAD_BITS)});
+        request.body.swap(compressed.bytes);
+    } else if (pack) {
+        request.body.swap(packed.bytes);
+    } else {
+        request.body.assign(body, body + size);
+    }
+
+    // The JSON is only kept for a resend in another encoding after a 415
+    String resend = pack || compress ? json : String();
+    uint32_t id = http.submit(request, HTTP_REQUEST_DEADLINE_MS,
+                              [this, path, resend, pack, compress, done](const AsyncHttpClient::Response& response) {
+                                  handleResponse(path, resend, pack, compress, response, done);
+                              });
+    if (id == 0) {
+        LOG_WF("Update", "POST %s not sent: %u requests already in flight", path.c_str(),
+               static_cast<unsigned>(http.getInFlight()));
         return false;
     }
+    return true;
+}
 
-    http.addHeader("Content-Type", "application/json");
+void UpdateClient::handleResponse(const String& path, const String& json, bool pack, bool compress,
+                                  const AsyncHttpClient::Response& response, const Completion& done) {
+    int code = response.code;
+    desktopStatusSequence = -1;
+    if (response.retried) {
+        stats.reconnects++;
+    }
+    if (code <= 0) {
+        LOG_WF("Update", "POST %s failed: %s", path.c_str(), HTTPClient::errorToString(code).c_str());
+        done(code);
+        return;
+    }
+
+    stats.requests++;
+    stats.reusedConnections += response.reused ? 1 : 0;
+    stats.lastLatencyMs = response.latencyMs;
+    stats.maxLatencyMs = std::max(stats.maxLatencyMs, response.latencyMs);
+    stats.totalLatencyMs += response.latencyMs;
+
+    // Every response restates what the desktop accepts, so a downgraded desktop is
+    // picked up on its first reply
+    desktopAcceptsHeatshrink = response.header("Accept-Encoding").indexOf("heatshrink") >= 0;
+    String statusSequence = response.header("X-Status-Seq");
+    desktopStatusSequence = statusSequence.isEmpty() ? -1 : statusSequence.toInt();
+    String acceptedTypes = response.header("Accept-Post");
+    if (!acceptedTypes.isEmpty()) {
+        desktopAcceptsMessagePack = acceptsMessagePack(acceptedTypes);
+    }
+
+    LOG_DF("Update", "POST %s -> %d in %u ms%s%s%s", path.c_str(), code, static_cast<unsigned>(response.latencyMs),
+           response.reused ? ", reused" : "", pack ? ", msgpack" : "", compress ? ", heatshrink" : "");
+    if ((compress || pack) && code == kUnsupportedMediaType) {
+        // Same payload again without the encoding it refused, compression first
+        if (compress) {
+            desktopAcceptsHeatshrink = false;
+        } else {
+            desktopAcceptsMessagePack = false;
+        }
+        if (!postJson(path, json, done)) {
+            done(code);
+        }
+        return;
+    }
+    done(code);
+}
+
+void UpdateClient::rebuildStaticHeaders() {
+    staticHeaders.clear();
     if (!authToken.isEmpty()) {
-        const String credentials = authToken;
-        const auto* input = reinterpret_cast<const unsigned char*>(credentials.c_str());
-        const size_t inputLen = credentials.length();
+        const auto* input = reinterpret_cast<const unsigned char*>(authToken.c_str());
+        const size_t inputLen = authToken.length();
         const size_t bufferLen = ((inputLen + 2) / 3) * 4 + 1; // Base64 output size (+1 for null)
         std::vector<unsigned char> buffer(bufferLen, 0);
         size_t encodedLen = 0;
         int result = mbedtls_base64_encode(buffer.data(), bufferLen, &encodedLen, input, inputLen);
         if (result == 0 && encodedLen > 0 && encodedLen < bufferLen) {
             buffer[encodedLen] = '\0';
-            http.addHeader("Authorization", "Basic " + String(reinterpret_cast<const char*>(buffer.data())));
+            staticHeaders.push_back({"Authorization", "Basic " + String(reinterpret_cast<const char*>(buffer.data()))});
         } else {
             LOG_W("Update", "Failed to encode Basic auth credentials for update client");
         }
     }
     if (!deviceId.isEmpty()) {
-        http.addHeader("X-Device-ID", deviceId);
+        staticHeaders.push_back({"X-Device-ID", deviceId});
     }
     if (!printerId.isEmpty()) {
-        http.addHeader("X-Printer-ID", printerId);
+        staticHeaders.push_back({"X-Printer-ID", printerId});
     }
     if (!printerBrand.isEmpty()) {
-        http.addHeader("X-Printer-Brand", printerBrand);
+        staticHeaders.push_back({"X-Printer-Brand", printerBrand});
     }
     if (!printerModel.isEmpty()) {
-        http.addHeader("X-Printer-Model", printerModel);
+        staticHeaders.push_back({"X-Printer-Model", printerModel});
     }
     if (!printerName.isEmpty()) {
-        http.addHeader("X-Printer-Name", printerName);
+        staticHeaders.push_back({"X-Printer-Name", printerName});
     }
+}
 
-    int code = http.POST(json);
-    if (code <= 0) {
-        LOG_W("Update", "POST " + path + " failed: " + String(http.errorToString(code)));
-        http.end();
+bool UpdateClient::packPayload(const String& json) {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, json);
+    if (error) {
+        LOG_WF("Update", "Queued payload is not valid JSON (%s) - sending it as is", error.c_str());
         return false;
     }
+    packed.bytes.clear();
+    packed.bytes.reserve(measureMsgPack(doc));
+    serializeMsgPack(doc, packed);
+    return true;
+}
 
-    LOG_D("Update", "POST " + path + " -> " + String(code));
-    http.end();
-    return code >= 200 && code < 300;
+bool UpdateClient::compressPayload(const uint8_t* body, size_t size) {
+    if (!encoder) {
+        encoder.reset(new (std::nothrow) Encoder(compressed));
+        if (!encoder) {
+            LOG_W("Update", "Not enough heap for the upload encoder - sending uncompressed");
+            desktopAcceptsHeatshrink = false;
+            return false;
+        }
+    }
+    compressed.bytes.clear();
+    compressed.bytes.reserve(size / 2);
+    encoder->reset();
+    encoder->write(body, size);
+    encoder->finish();
+    compressedBytesIn += encoder->getBytesIn();
+    compressedBytesOut += encoder->getBytesOut();
+    return true;
 }
 
 void UpdateClient::scheduleNextAttempt(bool success) {
@@ -203,7 +508,8 @@ void UpdateClient::scheduleNextAttempt(bool success) {
     if (success) {
         lastSuccessAt = now;
         consecutiveFailures = 0;
-        unsigned long delay = 200;
+        // A backlog from an outage goes out at a steady pace rather than all at once
+        unsigned long delay = queue.isEmpty() ? 200 : UPLOAD_DRAIN_INTERVAL_MS;
         nextAttemptAt = now + delay;
     } else {
         lastFailureAt = now;
@@ -1,13 +1,72 @@
 #pragma once
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <AsyncHttpClient.h>
+#include <Config.h>
+#include <Heatshrink.h>
+#include <MqttTelemetry.h>
+#include <PayloadEncoding.h>
+#include <StatusChannel.h>
+#include <TelemetryQueue.h>
+#include <functional>
+#include <memory>
 #include <vector>
 
 class UpdateClient {
 public:
+    /**
+     * @brief Request counters for the kept-alive connection to the desktop
+     *
+     * Requests are sent by AsyncHttpClient's task; loop() only submits the next upload
+     * and handles the response to the last one, so it never waits on the desktop.
+     */
+    struct ConnectionStats {
+        uint32_t requests;           // Requests that got a response
+        uint32_t reusedConnections;  // Of those, sent on a connection left open by the previous one
+        uint32_t reconnects;         // Kept connections found closed and replaced mid-request
+        uint32_t lastLatencyMs;      // Request sent to response head read
+        uint32_t maxLatencyMs;
+        uint32_t totalLatencyMs;
+    };
+
+    /**
+     * @brief Order items go out in within a batch; lower first
+     */
+    enum Priority : uint8_t {
+        PRIORITY_ALERT = 0,
+        PRIORITY_STATUS = 1,
+        PRIORITY_LOGS = 2
+    };
+
     UpdateClient();
     bool init(const String& baseUrl, const String& token, const String& deviceId);
     void setPrinterMetadata(const String& printerId, const String& brand, const String& model, const String& name);
+
+    /**
+     * @brief Journal queued alerts on the (mounted) filesystem, after recovering the ones
+     *        a previous run didn't deliver. Without it they are held in RAM only.
+     */
+    size_t attachStorage(fs::FS& fs) { return queue.begin(fs); }
+
+    /**
+     * @brief Publish to the desktop's broker ("host[:port]") instead of posting, while a
+     *        session to it is up; call after init()
+     */
+    bool attachBroker(const String& broker) { return mqtt.begin(broker, deviceId, authToken); }
+
+    /**
+     * @brief Encoding from the assignment; used until the desktop states otherwise in an
+     *        Accept-Post response header, and dropped for the session on a 415
+     */
+    void setPayloadEncoding(PayloadEncoding encoding);
+
+    /**
+     * @brief Static metadata (device, firmware, printer identity, IP) for the status
+     *        channel; sent once per session rather than with every status
+     */
+    void setSessionInfo(const JsonDocument& doc) { statusChannel.setSessionInfo(doc); }
+    // Queued items go out on the next loop() with no upload in flight, together with
+    // anything else queued before it
     void queueStatusUpdate(const JsonDocument& doc, bool force = false);
     void queueAlert(const JsonDocument& doc);
     void queueLogs(const String& logsJson);
@@ -17,8 +76,59 @@ public:
     unsigned long getLastFailureAt() const { return lastFailureAt; }
     uint8_t getConsecutiveFailures() const { return consecutiveFailures; }
     bool hasPending() const;
+    bool isUploading() const { return uploading; }
+
+    /**
+     * @brief true once the desktop has advertised heatshrink (Accept-Encoding response
+     *        header); payloads of UPLOAD_COMPRESS_MIN_BYTES or more are compressed from
+     *        then on
+     */
+    bool isCompressing() const { return desktopAcceptsHeatshrink; }
+    uint32_t getCompressedBytesIn() const { return compressedBytesIn; }
+    uint32_t getCompressedBytesOut() const { return compressedBytesOut; }
+    ConnectionStats getConnectionStats() const { return stats; }
+
+    /**
+     * @brief Pending items go out in POSTs to /batch of up to UPLOAD_BATCH_MAX_BYTES,
+     *        highest priority first; false once the desktop answered /batch with 404 or
+     *        405, and items are then posted to /alerts, /updates and /logs one at a time
+     */
+    bool isBatching() const { return desktopAcceptsBatch; }
+
+    /**
+     * @brief MESSAGE_PACK once the desktop accepts it; only uploads up to
+     *        UPLOAD_MSGPACK_MAX_BYTES are re-encoded, log batches stay JSON
+     */
+    PayloadEncoding getPayloadEncoding() const {
+        return desktopAcceptsMessagePack ? PayloadEncoding::MESSAGE_PACK : PayloadEncoding::JSON;
+    }
+    TelemetryQueue::Stats getQueueStats() const { return queue.getStats(); }
+    StatusChannel::Stats getStatusStats() const { return statusChannel.getStats(); }
+    bool isPublishing() const { return mqtt.isConnected(); }
+    MqttTelemetry::Stats getMqttStats() const { return mqtt.getStats(); }
+    size_t getQueuedAlerts() const { return queue.getAlertCount(); }
 
 private:
+    typedef HeatshrinkEncoder<UPLOAD_COMPRESS_WINDOW_BITS, UPLOAD_COMPRESS_LOOKAHEAD_BITS> Encoder;
+    // Final response code of an upload, after any resend; <= 0 when there was none
+    typedef std::function<void(int code)> Completion;
+
+    // Collects the encoder's (or serializeMsgPack's) output for the request body
+    class Body : public Print {
+    public:
+        std::vector<uint8_t> bytes;
+
+        size_t write(uint8_t c) override {
+            bytes.push_back(c);
+            return 1;
+        }
+
+        size_t write(const uint8_t* buffer, size_t size) override {
+            bytes.insert(bytes.end(), buffer, buffer + size);
+            return size;
+        }
+    };
+
     String baseUrl;
     String authToken;
     String deviceId;
@@ -27,17 +137,49 @@ private:
     String printerModel;
     String printerName;
 
-    String pendingStatusPayload;
-    std::vector<String> alertQueue;
-    String pendingLogPayload;
+    // One connection to the endpoint, kept between requests so the TCP (and TLS) session
+    // is reused while the desktop allows keep-alive
+    AsyncHttpClient http;
+    std::vector<AsyncHttpClient::Header> staticHeaders;  // Rebuilt only when the credentials or metadata change
+    ConnectionStats stats;
+    bool uploading;                     // A request is out; nothing else is sent until it completes
+
+    TelemetryQueue queue;
+    StatusChannel statusChannel;
+    long desktopStatusSequence;         // X-Status-Seq of the last response, -1 if absent
+
+    MqttTelemetry mqtt;
+    bool alertsPublished;               // Alerts up to alertsPublishedThrough are out, awaiting an ack
+    uint32_t alertsPublishedThrough;
+    unsigned long alertsPublishedAt;
 
     unsigned long nextAttemptAt;
     unsigned long lastSuccessAt;
     unsigned long lastFailureAt;
     uint8_t consecutiveFailures;
 
+    bool desktopAcceptsHeatshrink;
+    bool desktopAcceptsBatch;
+    PayloadEncoding preferredEncoding;
+    bool desktopAcceptsMessagePack;
+    Body packed;                        // The request as MessagePack
+    Body compressed;
+    std::unique_ptr<Encoder> encoder;   // Created on first use, then kept
+    uint32_t compressedBytesIn;
+    uint32_t compressedBytesOut;
+
     bool isReady() const;
-    bool postJson(const String& path, const String& json);
+    bool postJson(const String& path, const String& json, Completion done);
+    void handleResponse(const String& path, const String& json, bool pack, bool compress,
+                        const AsyncHttpClient::Response& response, const Completion& done);
+    void upload(const String& path, const String& json, const TelemetryQueue::Mark& sent);
+    void rebuildStaticHeaders();
+    bool packPayload(const String& json);
+    bool compressPayload(const uint8_t* body, size_t size);
     void processPending();
+    void processBatch();
+    void processSingle();
+    void processPublish();
+    void trackStatus(int code, bool carriedStatus);
     void scheduleNextAttempt(bool success);
 };
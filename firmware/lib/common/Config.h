@@ -17,9 +17,84 @@ static const uint8_t MOTOR_COL_PINS[MOTOR_COLS] = {17, 5, 18, 19, 13};
 #define MOTOR_DIRECTION_PIN 22
 #define MOTOR_STEP_PIN 23
 #define MOTOR_SPEED 800.0
+#define MOTOR_MAX_SPEED 2000         // steps/s ceiling for any move
+#define MOTOR_ACCELERATION 4000      // steps/s^2, used for both ramps
+#define MOTOR_STEPS_PER_SLOT 200     // nominal steps between adjacent valve positions
+#define MOTOR_STEP_TIMER 0           // hardware timer driving the STEP pin
+#define MOTOR_STEP_PULSE_US 4        // STEP high time; most drivers need >= 1-2 us
+#define MOTOR_DIR_SETUP_US 5         // DIR settle time before the first STEP edge
+#define MOTOR_CREEP_SPEED 200        // steps/s for the final approach onto a sensor
+#define MOTOR_APPROACH_STEPS (MOTOR_STEPS_PER_SLOT / 4) // steps short of the target where the ramp ends
+#define MATRIX_ROW_PERIOD_US 250     // one matrix row sampled per tick: a full scan every 1 ms
+#define MATRIX_DEBOUNCE_SCANS 2      // consecutive identical scans before a position is published
+
+// Task layout: network I/O shares core 0 with the WiFi stack, motion gets core 1 to itself
+#define NETWORK_TASK_CORE 0
+#define NETWORK_TASK_PRIORITY 1
+#define NETWORK_TASK_STACK 10240
+#define NETWORK_TASK_PERIOD_MS 10
+#define MOTION_TASK_CORE 1
+#define MOTION_TASK_PRIORITY 3
+#define MOTION_TASK_STACK 4096
 
 
 #define MAX_LOG_SIZE 8192
+// Logger's static record arena: ~65 lines of 50 chars (see LogRing.h)
+#define LOG_RING_BYTES 4096
+// Log task: queue of lines waiting to be printed and stored, ~185 bytes per slot
+#define LOG_QUEUE_DEPTH 32
+#define LOG_QUEUE_MESSAGE_BYTES 160
+#define LOG_TASK_CORE 0
+#define LOG_TASK_PRIORITY 1
+#define LOG_TASK_STACK 6144
+// /logs chunk size; must hold one fully escaped record
+#define LOG_STREAM_BATCH_BYTES 2048
+// Log batches waiting for the network task; the oldest is dropped beyond this
+#define LOG_HANDOFF_BATCHES 4
+// Log history on spiffs: ~256 KB of segments, spilled in batches (see LogSpill.h)
+#define LOG_SPILL_BATCH_BYTES 2048
+#define LOG_SPILL_INTERVAL_MS 30000
+#define LOG_SPILL_SEGMENT_BYTES 32768
+#define LOG_SPILL_SEGMENTS 8
+// Heatshrink upload compression; the encoder takes 6 << WINDOW_BITS bytes of heap
+#define UPLOAD_COMPRESS_MIN_BYTES 512
+#define UPLOAD_COMPRESS_WINDOW_BITS 10
+#define UPLOAD_COMPRESS_LOOKAHEAD_BITS 5
+// Uncompressed size cap of one POST /batch
+#define UPLOAD_BATCH_MAX_BYTES 16384
+// Largest upload re-encoded as MessagePack
+#define UPLOAD_MSGPACK_MAX_BYTES 4096
+// Uploads waiting for the desktop (see TelemetryQueue.h)
+#define TELEMETRY_QUEUE_RAM_BYTES 32768
+#define TELEMETRY_QUEUE_ALERTS 32
+#define TELEMETRY_QUEUE_JOURNAL_BYTES 16384
+#define TELEMETRY_QUEUE_LOG_CHUNKS 3
+// A backlog left after a successful upload is sent one batch per interval
+#define UPLOAD_DRAIN_INTERVAL_MS 500
+// Status goes to desktops that track sequences as deltas, with every field resent this often
+#define STATUS_KEYFRAME_INTERVAL_MS 300000UL
+// Upload task (see AsyncHttpClient.h)
+#define HTTP_TASK_CORE 0
+#define HTTP_TASK_PRIORITY 1
+#define HTTP_TASK_STACK 8192
+#define HTTP_MAX_IN_FLIGHT 2
+#define HTTP_REQUEST_DEADLINE_MS 10000
+// Telemetry over the desktop's MQTT broker (see MqttTelemetry.h)
+#define TELEMETRY_MQTT_PORT 1883
+#define TELEMETRY_MQTT_TOPIC_PREFIX "regain3d/"
+#define TELEMETRY_MQTT_KEEPALIVE_S 30
+#define TELEMETRY_MQTT_BUFFER_BYTES (MAX_LOG_SIZE + 512)
+#define TELEMETRY_MQTT_ACK_TIMEOUT_MS 10000
+// Printer alert debounce, flap window and rate limit (see AlertEngine.h)
+#define ALERT_RAISE_SAMPLES 1
+#define ALERT_CLEAR_SAMPLES 2
+#define ALERT_SUPPRESS_MS 600000UL
+#define ALERT_RATE_PER_MINUTE 6
+#define ALERT_ENGINE_KEYS 32
+// Filament alert thresholds, cleared HYSTERESIS_PERCENT above them
+#define FILAMENT_LOW_PERCENT 20
+#define FILAMENT_CRITICAL_PERCENT 5
+#define FILAMENT_HYSTERESIS_PERCENT 3
 
 // Connection timing/attempt policy differs by mode
 #ifdef APP_PROVISIONER
@@ -57,6 +132,13 @@ static const uint8_t MOTOR_COL_PINS[MOTOR_COLS] = {17, 5, 18, 19, 13};
 
 #define API_PORT 80
 #define DEFAULT_OTA_URL "http://192.168.1.100:8080/firmware/"
+// OTA download pipeline; buffers are whole 4 KB flash sectors
+#define OTA_BUFFER_BYTES 16384
+#define OTA_BUFFER_COUNT 2
+#define OTA_FLASH_TASK_CORE 1
+#define OTA_FLASH_TASK_PRIORITY 2
+#define OTA_FLASH_TASK_STACK 4096
+#define OTA_STALL_TIMEOUT_MS 30000
 
 #define NVS_WIFI_NAMESPACE "wifi_config"
 #define NVS_WIFI_SSID "ssid"
@@ -65,6 +147,8 @@ static const uint8_t MOTOR_COL_PINS[MOTOR_COLS] = {17, 5, 18, 19, 13};
 #define NVS_PRINTER_TYPE "printer_type"
 // Keep NVS keys under 15 chars (ESP32 NVS limit)
 #define NVS_PRINTER_CONN "printer_conn"
+#define NVS_PAYLOAD_ENCODING "payload_enc"
+#define NVS_TELEMETRY_BROKER "telem_broker"
 
 enum class PrinterType {
     BAMBU_LAB,
@@ -113,3 +197,12 @@ struct SystemStatus {
     #define ENABLE_MOTOR_CONTROL true
     #define ENABLE_PRINTER_COMM true
 #endif
+
+// Most verbose log level compiled in (0 error, 1 warn, 2 info, 3 debug)
+#ifndef LOG_COMPILE_LEVEL
+  #if LOG_LEVEL_DEBUG
+    #define LOG_COMPILE_LEVEL 3
+  #else
+    #define LOG_COMPILE_LEVEL 2
+  #endif
+#endif
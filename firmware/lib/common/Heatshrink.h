@@ -0,0 +1,186 @@
+#pragma once
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Streaming LZSS encoder producing the heatshrink bit stream
+ *
+ * Output is a bit stream, most significant bit first: a 1 bit followed by 8 bits is a
+ * literal byte; a 0 bit followed by WindowBits bits of (distance - 1) and LookaheadBits
+ * bits of (count - 1) copies count bytes from distance bytes back. The last byte is
+ * padded with zero bits. Any heatshrink decoder configured with the same window and
+ * lookahead sizes (-w WindowBits -l LookaheadBits) can expand it.
+ *
+ * Input is written through Print, so a JSON writer can stream straight into it; it is
+ * matched a buffer at a time and the encoded bytes go to the Print given to the
+ * constructor. Nothing is allocated: the encoder costs 2 << WindowBits bytes of buffer
+ * plus twice that for the match index, so keep it off small stacks.
+ */
+template <uint8_t WindowBits, uint8_t LookaheadBits>
+class HeatshrinkEncoder : public Print {
+public:
+    static const size_t kWindow = static_cast<size_t>(1) << WindowBits;
+    static const size_t kLookahead = static_cast<size_t>(1) << LookaheadBits;
+
+    static_assert(WindowBits >= 4 && WindowBits <= 14, "heatshrink windows are 2^4..2^14 bytes");
+    static_assert(LookaheadBits >= 3 && LookaheadBits < WindowBits, "lookahead must be smaller than the window");
+
+    explicit HeatshrinkEncoder(Print& out) : out(out) { reset(); }
+
+    /**
+     * @brief Start a new stream; the window forgets everything written before
+     */
+    void reset() {
+        history = 0;
+        pending = 0;
+        bits = 0;
+        bitCount = 0;
+        outUsed = 0;
+        bytesIn = 0;
+        bytesOut = 0;
+    }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        size_t done = 0;
+        while (done < size) {
+            size_t room = sizeof(buffer) - history - pending;
+            size_t take = size - done < room ? size - done : room;
+            memcpy(buffer + history + pending, data + done, take);
+            pending += take;
+            done += take;
+            if (history + pending == sizeof(buffer)) {
+                encode(false);
+            }
+        }
+        bytesIn += size;
+        return size;
+    }
+
+    using Print::write;
+
+    /**
+     * @brief Encode whatever is buffered and pad out the last byte; the stream is complete
+     */
+    void finish() {
+        encode(true);
+        if (bitCount > 0) {
+            emitByte(static_cast<uint8_t>(bits << (8 - bitCount)));
+            bitCount = 0;
+        }
+        flushOutput();
+    }
+
+    uint32_t getBytesIn() const { return bytesIn; }
+    uint32_t getBytesOut() const { return bytesOut; }
+
+private:
+    // A back-reference costs 1 + WindowBits + LookaheadBits bits, a literal 9 bits
+    static const size_t kMinMatch = (1 + WindowBits + LookaheadBits) / 9 + 1;
+
+    // Match every buffered position that has its full lookahead (all of them when
+    // finishing), then slide so at most one window of history stays in front
+    void encode(bool finishing) {
+        size_t end = history + pending;
+        size_t stop = finishing ? end : (end > kLookahead ? end - kLookahead : 0);
+        if (stop <= history) {
+            if (!finishing) slide(history, end);
+            return;
+        }
+        index(end);
+
+        size_t pos = history;
+        while (pos < stop) {
+            size_t limit = end - pos < kLookahead ? end - pos : kLookahead;
+            size_t bestLength = 0;
+            size_t bestDistance = 0;
+            size_t floor = pos > kWindow ? pos - kWindow : 0;
+            for (int32_t candidate = previous[pos]; candidate >= static_cast<int32_t>(floor);
+                 candidate = previous[candidate]) {
+                // The first byte matches by construction of the index
+                size_t length = 1;
+                while (length < limit && buffer[candidate + length] == buffer[pos + length]) {
+                    length++;
+                }
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = pos - candidate;
+                    if (length == limit) break;
+                }
+            }
+
+            if (bestLength >= kMinMatch) {
+                emitBits(0, 1);
+                emitBits(static_cast<uint32_t>(bestDistance - 1), WindowBits);
+                emitBits(static_cast<uint32_t>(bestLength - 1), LookaheadBits);
+                pos += bestLength;
+            } else {
+                emitBits(0x100 | buffer[pos], 9);
+                pos++;
+            }
+        }
+        slide(pos, end);
+        flushOutput();
+    }
+
+    // Keep up to one window of history before pos, plus the unencoded bytes after it
+    void slide(size_t pos, size_t end) {
+        size_t keepFrom = pos > kWindow ? pos - kWindow : 0;
+        if (keepFrom > 0) {
+            memmove(buffer, buffer + keepFrom, end - keepFrom);
+        }
+        history = pos - keepFrom;
+        pending = end - pos;
+    }
+
+    // previous[i]: the nearest earlier position holding the same byte, or -1
+    void index(size_t end) {
+        int16_t last[256];
+        memset(last, 0xFF, sizeof(last));
+        for (size_t i = 0; i < end; i++) {
+            previous[i] = last[buffer[i]];
+            last[buffer[i]] = static_cast<int16_t>(i);
+        }
+    }
+
+    void emitBits(uint32_t value, uint8_t count) {
+        for (int8_t bit = count - 1; bit >= 0; bit--) {
+            bits = static_cast<uint8_t>((bits << 1) | ((value >> bit) & 1));
+            if (++bitCount == 8) {
+                emitByte(bits);
+                bits = 0;
+                bitCount = 0;
+            }
+        }
+    }
+
+    void emitByte(uint8_t byte) {
+        outBuffer[outUsed++] = byte;
+        bytesOut++;
+        if (outUsed == sizeof(outBuffer)) flushOutput();
+    }
+
+    void flushOutput() {
+        if (outUsed > 0) {
+            out.write(outBuffer, outUsed);
+            outUsed = 0;
+        }
+    }
+
+    Print& out;
+    uint8_t buffer[2 * kWindow];      // History, then bytes not yet encoded
+    int16_t previous[2 * kWindow];
+    size_t history;
+    size_t pending;
+    uint8_t bits;
+    uint8_t bitCount;
+    uint8_t outBuffer[64];
+    size_t outUsed;
+    uint32_t bytesIn;
+    uint32_t bytesOut;
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Bounded single-producer/single-consumer ring buffer
+ *
+ * Wait-free on both sides; safe across the two ESP32 cores as long as exactly one
+ * task pushes and exactly one task pops. Capacity must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0), dropped(0) {}
+
+    /**
+     * @brief Enqueue a copy of item (producer side)
+     * @return false if the queue is full; the item is counted as dropped
+     */
+    bool push(const T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= Capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue the oldest item (consumer side)
+     * @return false if the queue is empty
+     */
+    bool pop(T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    uint32_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    T slots[Capacity];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> dropped;
+};
+
+/**
+ * @brief Bounded multi-producer/single-consumer queue (Vyukov's sequenced ring)
+ *
+ * Producers claim a slot with one CAS and publish it through the slot's sequence
+ * number, so no producer ever waits on a lock held by another task. Capacity must
+ * be a power of two.
+ */
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscQueue() : head(0), tail(0), dropped(0) {
+        for (size_t i = 0; i < Capacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Enqueue a copy of item (any producer task)
+     * @return false if the queue is full; the item is counted as dropped
+     */
+    bool push(const T& item) {
+        uint32_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & (Capacity - 1)];
+            uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+            int32_t diff = static_cast<int32_t>(seq - pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Dequeue the oldest published item (single consumer task)
+     * @return false if the queue is empty or the next slot is still being written
+     */
+    bool pop(T& item) {
+        uint32_t pos = head.load(std::memory_order_relaxed);
+        Cell& cell = cells[pos & (Capacity - 1)];
+        uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<int32_t>(seq - (pos + 1)) < 0) {
+            return false;
+        }
+        item = cell.value;
+        cell.sequence.store(pos + Capacity, std::memory_order_release);
+        head.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    uint32_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        T value;
+    };
+
+    Cell cells[Capacity];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> dropped;
+};
@@ -0,0 +1,123 @@
+#pragma once
+#include <Arduino.h>
+#include <stdarg.h>
+#include "Config.h"
+#include "Logger.h"
+
+/**
+ * @brief The /logs JSON document, written a batch of records at a time
+ *
+ * Shared by Logger (lines in RAM) and LogSpill (lines on flash) so both endpoints
+ * produce the same shape:
+ *
+ *   {"device":..,"firmware_version":..,"since":S,"oldest":O,"missed":M,
+ *    "logs":[{"seq":..,"timestamp":..,"level":..,"component":..,"message":..},..],
+ *    "log_count":N,"next":C,"dropped":D,"generated_at":T}
+ *
+ * A batch lives on the caller's stack and is flushed to a Print between records, so
+ * no whole-document buffer is ever built.
+ */
+class LogJsonBatch {
+public:
+    char data[LOG_STREAM_BATCH_BYTES];
+    size_t used;
+    bool overflow;
+
+    LogJsonBatch() : used(0), overflow(false) {}
+
+    void append(const char* text) {
+        appendBytes(text, strlen(text));
+    }
+
+    void appendBytes(const char* bytes, size_t length) {
+        if (length > sizeof(data) - used) {
+            overflow = true;
+            return;
+        }
+        memcpy(data + used, bytes, length);
+        used += length;
+    }
+
+    void appendf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(data + used, sizeof(data) - used, format, args);
+        va_end(args);
+        if (length < 0 || static_cast<size_t>(length) >= sizeof(data) - used) {
+            overflow = true;
+            return;
+        }
+        used += length;
+    }
+
+    // Quoted and escaped JSON string
+    void appendString(const char* text) {
+        append("\"");
+        for (const char* c = text; *c; c++) {
+            switch (*c) {
+                case '"': append("\\\""); break;
+                case '\\': append("\\\\"); break;
+                case '\n': append("\\n"); break;
+                case '\r': append("\\r"); break;
+                case '\t': append("\\t"); break;
+                default:
+                    if (static_cast<uint8_t>(*c) < 0x20) {
+                        appendf("\\u%04x", static_cast<unsigned>(static_cast<uint8_t>(*c)));
+                    } else {
+                        appendBytes(c, 1);
+                    }
+            }
+        }
+        append("\"");
+    }
+
+    /**
+     * @brief Append one record (anything with sequence, timestamp, level, component and
+     *        message fields), or nothing if it does not fit
+     */
+    template <typename Record>
+    bool appendRecord(const Record& record, bool separator) {
+        size_t mark = used;
+        overflow = false;
+        appendf("%s{\"seq\":%u,\"timestamp\":%u,\"level\":\"%s\",\"component\":", separator ? "," : "",
+                static_cast<unsigned>(record.sequence), static_cast<unsigned>(record.timestamp),
+                Logger::logLevelToString(static_cast<LogLevel>(record.level)).c_str());
+        appendString(record.component);
+        append(",\"message\":");
+        appendString(record.message);
+        append("}");
+        if (overflow) {
+            used = mark;
+            return false;
+        }
+        return true;
+    }
+
+    void beginDocument(uint32_t since, uint32_t oldest) {
+        append("{\"device\":");
+        appendString(DEVICE_NAME);
+        append(",\"firmware_version\":");
+        appendString(FIRMWARE_VERSION);
+        // missed: lines that were gone before this cursor caught up with them
+        appendf(",\"since\":%u,\"oldest\":%u,\"missed\":%u,\"logs\":[",
+                static_cast<unsigned>(since), static_cast<unsigned>(oldest),
+                static_cast<int32_t>(oldest - since) > 0 ? static_cast<unsigned>(oldest - since) : 0u);
+    }
+
+    void endDocument(size_t count, uint32_t next, uint32_t dropped) {
+        appendf("],\"log_count\":%u,\"next\":%u,\"dropped\":%u,\"generated_at\":%lu}",
+                static_cast<unsigned>(count), static_cast<unsigned>(next),
+                static_cast<unsigned>(dropped), millis());
+    }
+
+    void flushTo(Print& out) {
+        if (used > 0) {
+            out.write(reinterpret_cast<const uint8_t*>(data), used);
+        }
+        used = 0;
+    }
+};
+
+// Worst case: every message and component byte escaped as \u00XX, plus the fixed fields
+static_assert(LOG_STREAM_BATCH_BYTES >= 6 * (Logger::Ring::kMaxMessage + Logger::Ring::kComponentNameBytes) + 128,
+              "LOG_STREAM_BATCH_BYTES must hold one escaped record");
@@ -0,0 +1,259 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Fixed-size byte arena holding variable-length log records
+ *
+ * Each record is a 12-byte header (sequence, timestamp, level, interned component ID,
+ * length) followed by the message and a terminator, padded to 4 bytes. Appends that
+ * do not fit overwrite the oldest records whole; a record never straddles the end of
+ * the arena. Component names are interned into a small table, so a record only pays
+ * for its message. Nothing is allocated after construction: memory use is ArenaBytes
+ * plus the component table (kMaxComponents * kComponentNameBytes).
+ *
+ * Not synchronised; callers serialise appends and iteration.
+ */
+template <size_t ArenaBytes>
+class LogRing {
+public:
+    static const size_t kMaxComponents = 32;
+    static const size_t kComponentNameBytes = 16;  // Including the terminator; longer names are truncated
+    static const uint16_t kMaxMessage = 255;       // Longer messages are truncated
+    static const uint8_t kUnknownComponent = 0xFF; // Component table full
+
+private:
+    struct Header {
+        uint32_t sequence;
+        uint32_t timestamp;
+        uint8_t level;
+        uint8_t component;
+        uint16_t length;      // Message bytes, excluding the terminator; kWrapMarker ends the lap
+    };
+    static const uint16_t kWrapMarker = 0xFFFF;
+
+    static size_t recordBytes(uint16_t length) {
+        return (sizeof(Header) + length + 1 + 3) & ~static_cast<size_t>(3);
+    }
+
+    static_assert(ArenaBytes % 4 == 0, "Arena size must be a multiple of 4");
+    static_assert(ArenaBytes >= 2 * (sizeof(Header) + kMaxMessage + 1 + 3), "Arena must hold two maximum-size records");
+
+public:
+    /**
+     * @brief A record as stored in the arena; the pointers stay valid until it is overwritten
+     */
+    struct Record {
+        uint32_t sequence;     // Monotonic across the ring's lifetime, also across clear()
+        uint32_t timestamp;
+        uint8_t level;
+        const char* component;
+        const char* message;   // NUL-terminated
+        uint16_t length;
+    };
+
+    /**
+     * @brief Forward iterator from the oldest to the newest record, reading in place
+     */
+    class Iterator {
+    public:
+        Iterator(const LogRing* ring, size_t offset, size_t remaining)
+            : ring(ring), offset(offset), remaining(remaining) {
+            if (remaining) this->offset = ring->normalize(offset);
+        }
+
+        Record operator*() const { return ring->recordAt(offset); }
+        Iterator& operator++() {
+            remaining--;
+            offset = remaining ? ring->normalize(offset + recordBytes(ring->headerAt(offset).length)) : 0;
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const { return remaining != other.remaining; }
+
+    private:
+        const LogRing* ring;
+        size_t offset;
+        size_t remaining;
+    };
+
+    explicit LogRing(size_t maxRecords = SIZE_MAX)
+        : head(0), tail(0), count(0), maxRecords(maxRecords ? maxRecords : 1), nextSequence(0), components(0) {}
+
+    /**
+     * @brief Cap the number of records regardless of arena space; drops the oldest if needed
+     */
+    void setMaxRecords(size_t limit) {
+        maxRecords = limit ? limit : 1;
+        while (count > maxRecords) dropOldest();
+    }
+
+    /**
+     * @brief Append a record, overwriting the oldest ones as needed
+     * @return The record's sequence number
+     */
+    uint32_t append(uint8_t level, const char* component, const char* message, size_t length, uint32_t timestamp) {
+        uint16_t stored = static_cast<uint16_t>(length > kMaxMessage ? kMaxMessage : length);
+        size_t size = recordBytes(stored);
+        while (count >= maxRecords) dropOldest();
+        size_t offset = reserve(size);
+
+        Header header;
+        header.sequence = nextSequence++;
+        header.timestamp = timestamp;
+        header.level = level;
+        header.component = intern(component);
+        header.length = stored;
+        memcpy(arena + offset, &header, sizeof(header));
+        memcpy(arena + offset + sizeof(header), message, stored);
+        arena[offset + sizeof(header) + stored] = '\0';
+
+        head = offset + size;
+        count++;
+        return header.sequence;
+    }
+
+    /**
+     * @brief Drop every record up to and including sequence, oldest first
+     */
+    void dropThrough(uint32_t sequence) {
+        while (count > 0 && static_cast<int32_t>(headerAt(tail).sequence - sequence) <= 0) {
+            dropOldest();
+        }
+    }
+
+    /**
+     * @brief Renumber the stored records first, first + 1, ... and continue from there,
+     *        e.g. to follow on from lines persisted before a reboot
+     */
+    void renumber(uint32_t first) {
+        size_t offset = tail;
+        for (size_t i = 0; i < count; i++) {
+            offset = normalize(offset);
+            Header header = headerAt(offset);
+            header.sequence = first + static_cast<uint32_t>(i);
+            memcpy(arena + offset, &header, sizeof(header));
+            offset += recordBytes(header.length);
+        }
+        nextSequence = first + static_cast<uint32_t>(count);
+    }
+
+    void clear() {
+        head = 0;
+        tail = 0;
+        count = 0;
+    }
+
+    Iterator begin() const { return Iterator(this, tail, count); }
+    Iterator end() const { return Iterator(this, 0, 0); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacityBytes() const { return ArenaBytes; }
+    uint32_t getNextSequence() const { return nextSequence; }
+
+    /**
+     * @brief true if a maximum-size append would overwrite a record
+     */
+    bool isFull() const {
+        if (count >= maxRecords) return true;
+        if (count == 0) return false;
+        size_t need = recordBytes(kMaxMessage);
+        if (tail < head) {
+            return ArenaBytes - head < need && tail < need;
+        }
+        return tail - head < need;
+    }
+
+    /**
+     * @brief Name for an interned component ID
+     */
+    const char* componentName(uint8_t id) const {
+        return id < components ? componentNames[id] : "?";
+    }
+
+private:
+    Header headerAt(size_t offset) const {
+        Header header;
+        memcpy(&header, arena + offset, sizeof(header));
+        return header;
+    }
+
+    Record recordAt(size_t offset) const {
+        Header header = headerAt(offset);
+        Record record;
+        record.sequence = header.sequence;
+        record.timestamp = header.timestamp;
+        record.level = header.level;
+        record.component = componentName(header.component);
+        record.message = reinterpret_cast<const char*>(arena + offset + sizeof(Header));
+        record.length = header.length;
+        return record;
+    }
+
+    // Where the record at offset really starts: the next lap begins at 0 after a wrap
+    // marker, or when too little space is left at the end for a header
+    size_t normalize(size_t offset) const {
+        if (offset + sizeof(Header) > ArenaBytes || headerAt(offset).length == kWrapMarker) {
+            return 0;
+        }
+        return offset;
+    }
+
+    void dropOldest() {
+        if (count == 0) return;
+        tail = normalize(tail + recordBytes(headerAt(tail).length));
+        if (--count == 0) {
+            head = 0;
+            tail = 0;
+        }
+    }
+
+    // Find contiguous space for size bytes at the head, evicting the oldest records
+    size_t reserve(size_t size) {
+        for (;;) {
+            if (count == 0) {
+                head = 0;
+                tail = 0;
+            }
+            if (count == 0 || tail < head) {
+                // Free space runs from head to the end of the arena, then from 0 to tail
+                if (ArenaBytes - head >= size) return head;
+                if (ArenaBytes - head >= sizeof(Header)) {
+                    Header marker = {};
+                    marker.length = kWrapMarker;
+                    memcpy(arena + head, &marker, sizeof(marker));
+                }
+                head = 0;
+            } else {
+                // Free space runs from head up to the oldest record
+                if (tail - head >= size) return head;
+                dropOldest();
+            }
+        }
+    }
+
+    uint8_t intern(const char* name) {
+        if (!name) name = "";
+        for (uint8_t i = 0; i < components; i++) {
+            if (strncmp(componentNames[i], name, kComponentNameBytes - 1) == 0) {
+                return i;
+            }
+        }
+        if (components >= kMaxComponents) {
+            return kUnknownComponent;
+        }
+        strncpy(componentNames[components], name, kComponentNameBytes - 1);
+        componentNames[components][kComponentNameBytes - 1] = '\0';
+        return components++;
+    }
+
+    alignas(4) uint8_t arena[ArenaBytes];
+    size_t head;         // Offset where the next record goes
+    size_t tail;         // Offset of the oldest record
+    size_t count;
+    size_t maxRecords;
+    uint32_t nextSequence;
+    uint8_t components;
+    char componentNames[kMaxComponents][kComponentNameBytes];
+};
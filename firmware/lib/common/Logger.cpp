@@ -1,47 +1,190 @@
 #include "Logger.h"
 #include "Config.h"
-#include <ArduinoJson.h>
+#include "LockFreeQueue.h"
+#include "LogJson.h"
 #include <algorithm>
+#include <atomic>
+#include <stdarg.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 
-std::vector<LogEntry> Logger::logBuffer;
+namespace {
+// One queued line; fixed size so enqueueing never allocates
+struct LogMessage {
+    uint32_t timestamp;
+    uint8_t level;
+    char component[Logger::Ring::kComponentNameBytes];
+    char message[LOG_QUEUE_MESSAGE_BYTES];
+    uint16_t length;
+};
+
+MpscQueue<LogMessage, LOG_QUEUE_DEPTH> queue;
+std::atomic<uint32_t> queuedLines(0);   // Pushed but not yet stored, for flush()
+uint32_t reportedDrops = 0;             // Drain side only
+
+SemaphoreHandle_t ringMutex = nullptr;  // Guards the ring; held while building JSON, so not a spinlock
+SemaphoreHandle_t drainMutex = nullptr; // Held by whoever pops the queue or transmits
+SemaphoreHandle_t wakeDrain = nullptr;
+SemaphoreHandle_t spillMutex = nullptr; // Held while records are copied into the sink
+TaskHandle_t volatile drainTaskHandle = nullptr;
+TaskHandle_t volatile transmittingTask = nullptr;
+
+LogSink* sink = nullptr;
+uint32_t spillCursor = 0;                // First sequence not yet in the sink; under spillMutex
+std::atomic<uint32_t> unspilledBytes(0);  // Roughly what the next spill will write
+const uint32_t kSpillOverheadBytes = 16;  // Per line, on top of its message
+unsigned long lastSpill = 0;
+
+void createSyncObjects() {
+    if (ringMutex) return;
+    ringMutex = xSemaphoreCreateMutex();
+    drainMutex = xSemaphoreCreateMutex();
+    wakeDrain = xSemaphoreCreateBinary();
+    spillMutex = xSemaphoreCreateMutex();
+}
+
+// Print into a String, for the callers that still want the whole document
+class StringPrint : public Print {
+public:
+    String text;
+
+    size_t write(uint8_t c) override {
+        text += static_cast<char>(c);
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        text.concat(reinterpret_cast<const char*>(buffer), size);
+        return size;
+    }
+};
+}
+
+Logger::Ring Logger::ring;
 size_t Logger::maxLogSize = 100;
-size_t Logger::startIndex = 0;
-size_t Logger::logCount = 0;
 std::function<void(const String&)> Logger::transmitCallback = nullptr;
 LogLevel Logger::currentLogLevel = LOG_INFO;
-bool Logger::inTransmit = false;
-static portMUX_TYPE logMutex = portMUX_INITIALIZER_UNLOCKED;
 
 void Logger::init(size_t maxSize, LogLevel level) {
+    createSyncObjects();
     maxLogSize = maxSize;
     currentLogLevel = level;
-    // Initialize fixed-size ring buffer
-    logBuffer.clear();
-    logBuffer.resize(maxLogSize);
-    startIndex = 0;
-    logCount = 0;
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    ring.clear();
+    ring.setMaxRecords(maxLogSize);
+    xSemaphoreGive(ringMutex);
     Serial.begin(115200);
     LOG_I("Logger", "Logger initialized with max size: " + String(maxSize));
 }
 
+bool Logger::startDrainTask() {
+    createSyncObjects();
+    if (drainTaskHandle) return true;
+
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(drainTask, "log", LOG_TASK_STACK, nullptr,
+                                LOG_TASK_PRIORITY, &handle, LOG_TASK_CORE) != pdPASS) {
+        LOG_W("Logger", "Failed to create log task, logging synchronously");
+        return false;
+    }
+    drainTaskHandle = handle;
+    return true;
+}
+
+void Logger::attachSink(LogSink* newSink, uint32_t nextSequence) {
+    createSyncObjects();
+    xSemaphoreTake(spillMutex, portMAX_DELAY);
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    uint32_t oldest = ring.empty() ? ring.getNextSequence() : (*ring.begin()).sequence;
+    if (static_cast<int32_t>(oldest - nextSequence) < 0) {
+        ring.renumber(nextSequence);
+        oldest = nextSequence;
+    }
+    sink = newSink;
+    spillCursor = oldest;
+    lastSpill = millis();
+    xSemaphoreGive(ringMutex);
+    xSemaphoreGive(spillMutex);
+}
+
+void Logger::drainTask(void* param) {
+    (void)param;
+    for (;;) {
+        // The timeout picks up lines left behind when transmitLogs() held the queue
+        xSemaphoreTake(wakeDrain, pdMS_TO_TICKS(100));
+        drain();
+    }
+}
+
+bool Logger::flush(uint32_t timeoutMs) {
+    createSyncObjects();
+    unsigned long start = millis();
+    while (queuedLines.load(std::memory_order_acquire) > 0) {
+        if (millis() - start >= timeoutMs) {
+            return false;
+        }
+        if (drainTaskHandle) {
+            xSemaphoreGive(wakeDrain);
+        } else {
+            drain();
+        }
+        vTaskDelay(1);
+    }
+    spillStored();
+    return true;
+}
+
 void Logger::setTransmitCallback(std::function<void(const String&)> callback) {
     transmitCallback = callback;
 }
 
 void Logger::log(LogLevel level, const String& component, const String& message) {
     if (level > currentLogLevel) return;
+    enqueue(level, component.c_str(), message.c_str(), message.length());
+}
+
+void Logger::logf(LogLevel level, const char* component, const char* format, ...) {
+    if (level > currentLogLevel) return;
+
+    char message[LOG_QUEUE_MESSAGE_BYTES];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    if (length < 0) return;
+
+    enqueue(level, component, message, std::min<size_t>(length, sizeof(message) - 1));
+}
+
+void Logger::enqueue(LogLevel level, const char* component, const char* message, size_t length) {
+    createSyncObjects();
+
+    // Lines logged from inside the transmit callback go straight to serial: storing
+    // them would refill the buffer being transmitted and recurse into another transmit
+    if (transmittingTask && transmittingTask == xTaskGetCurrentTaskHandle()) {
+        Serial.printf("[%s] %s: %s\n", logLevelToString(level).c_str(), component, message);
+        return;
+    }
 
-    // Always print to serial for real-time insight
-    Serial.println("[" + logLevelToString(level) + "] " + component + ": " + message);
+    LogMessage line;
+    line.timestamp = millis();
+    line.level = static_cast<uint8_t>(level);
+    strncpy(line.component, component, sizeof(line.component) - 1);
+    line.component[sizeof(line.component) - 1] = '\0';
+    line.length = static_cast<uint16_t>(std::min<size_t>(length, sizeof(line.message) - 1));
+    memcpy(line.message, message, line.length);
+    line.message[line.length] = '\0';
 
-    // Avoid re-entrant logging during transmit/clear to prevent recursion and stack overflow
-    if (inTransmit) return;
+    queuedLines.fetch_add(1, std::memory_order_relaxed);
+    if (!queue.push(line)) {
+        // Counted by the queue and reported by the next drain
+        queuedLines.fetch_sub(1, std::memory_order_relaxed);
+    }
 
-    addLogEntry(level, component, message);
-    if (isLogBufferFull()) {
-        transmitLogs();
+    if (drainTaskHandle) {
+        xSemaphoreGive(wakeDrain);
+    } else {
+        drain();
     }
 }
 
@@ -61,75 +204,187 @@ void Logger::debug(const String& component, const String& message) {
     log(LOG_DEBUG, component, message);
 }
 
-void Logger::addLogEntry(LogLevel level, const String& component, const String& message) {
-    LogEntry entry;
-    entry.timestamp = millis();
-    entry.level = level;
-    entry.component = component;
-    entry.message = message;
+void Logger::drain() {
+    // Single consumer: if another task is already draining it will pick these lines up
+    if (xSemaphoreTake(drainMutex, 0) != pdTRUE) return;
 
-    if (logCount < maxLogSize) {
-        size_t idx = (startIndex + logCount) % maxLogSize;
-        logBuffer[idx] = entry;
-        logCount++;
-    } else {
-        // Overwrite oldest and advance startIndex
-        logBuffer[startIndex] = entry;
-        startIndex = (startIndex + 1) % maxLogSize;
+    LogMessage line;
+    uint32_t drained = 0;
+    while (queue.pop(line)) {
+        LogLevel level = static_cast<LogLevel>(line.level);
+        Serial.printf("[%s] %s: %s\n", logLevelToString(level).c_str(), line.component, line.message);
+        store(level, line.component, line.message, line.length, line.timestamp);
+        drained++;
     }
+
+    uint32_t dropped = queue.droppedCount();
+    if (dropped != reportedDrops) {
+        char note[64];
+        int length = snprintf(note, sizeof(note), "%u lines dropped (log queue full)",
+                              static_cast<unsigned>(dropped - reportedDrops));
+        reportedDrops = dropped;
+        Serial.printf("[WARN] Logger: %s\n", note);
+        store(LOG_WARN, "Logger", note, length, millis());
+    }
+    // Only now, so flush() also covers the drop note
+    queuedLines.fetch_sub(drained, std::memory_order_release);
+
+    if (sink && unspilledBytes.load(std::memory_order_relaxed) > 0 && millis() - lastSpill >= LOG_SPILL_INTERVAL_MS) {
+        spillStored();
+    }
+
+    xSemaphoreGive(drainMutex);
 }
 
-String Logger::getLogsAsJson() {
-    JsonDocument doc; // ArduinoJson v7
-    JsonArray logs = doc["logs"].to<JsonArray>();
+void Logger::store(LogLevel level, const char* component, const char* message, size_t length, uint32_t timestamp) {
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    ring.append(level, component, message, length, timestamp);
+    bool full = ring.isFull();
+    xSemaphoreGive(ringMutex);
 
-    for (size_t i = 0; i < logCount; ++i) {
-        size_t idx = (startIndex + i) % maxLogSize;
-        const auto& entry = logBuffer[idx];
-        JsonObject logObj = logs.add<JsonObject>();
-        logObj["timestamp"] = entry.timestamp;
-        logObj["level"] = logLevelToString(entry.level);
-        logObj["component"] = entry.component;
-        logObj["message"] = entry.message;
+    // Spill before the next append can overwrite anything, and before a transmit clears it
+    uint32_t bytes = length + kSpillOverheadBytes;
+    uint32_t pending = unspilledBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (sink && (full || pending >= LOG_SPILL_BATCH_BYTES)) {
+        spillStored();
+    }
+    if (full) {
+        transmitStored();
     }
+}
+
+void Logger::spillStored() {
+    createSyncObjects();
+    if (!sink) return;
+    xSemaphoreTake(spillMutex, portMAX_DELAY);
+    for (;;) {
+        size_t spilled = 0;
+        bool more = false;
+        xSemaphoreTake(ringMutex, portMAX_DELAY);
+        for (Ring::Record record : ring) {
+            if (static_cast<int32_t>(record.sequence - spillCursor) < 0) continue;
+            if (!sink->write(record)) {
+                more = true;
+                break;
+            }
+            spillCursor = record.sequence + 1;
+            spilled++;
+        }
+        if (!more) {
+            unspilledBytes.store(0, std::memory_order_relaxed);
+        }
+        xSemaphoreGive(ringMutex);
 
-    doc["device"] = DEVICE_NAME;
-    doc["firmware_version"] = FIRMWARE_VERSION;
-    doc["log_count"] = logCount;
-    doc["generated_at"] = millis();
+        sink->commit();
+        // spilled == 0: the sink refuses even an empty batch, so give up until next time
+        if (!more || spilled == 0) break;
+    }
+    lastSpill = millis();
+    xSemaphoreGive(spillMutex);
+}
 
-    String result;
-    serializeJson(doc, result);
-    return result;
+String Logger::getLogsAsJson() {
+    StringPrint out;
+    writeLogsJson(out);
+    return out.text;
+}
+
+uint32_t Logger::writeLogsJson(Print& out, uint32_t since, size_t limit) {
+    createSyncObjects();
+    LogJsonBatch batch;
+    uint32_t cursor = since;
+    size_t written = 0;
+
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    uint32_t oldest = ring.empty() ? ring.getNextSequence() : (*ring.begin()).sequence;
+    xSemaphoreGive(ringMutex);
+    batch.beginDocument(since, oldest);
+
+    for (;;) {
+        size_t batched = 0;
+        xSemaphoreTake(ringMutex, portMAX_DELAY);
+        for (Ring::Record record : ring) {
+            if (written + batched >= limit) break;
+            if (static_cast<int32_t>(record.sequence - cursor) < 0) continue;
+            if (!batch.appendRecord(record, written + batched > 0)) break;
+            cursor = record.sequence + 1;
+            batched++;
+        }
+        xSemaphoreGive(ringMutex);
+
+        if (batched == 0) break;
+        written += batched;
+        batch.flushTo(out);
+    }
+
+    batch.endDocument(written, cursor, queue.droppedCount());
+    batch.flushTo(out);
+    return cursor;
 }
 
 void Logger::clearLogs() {
-    portENTER_CRITICAL(&logMutex);
-    std::fill(logBuffer.begin(), logBuffer.end(), LogEntry());
-    startIndex = 0;
-    logCount = 0;
-    portEXIT_CRITICAL(&logMutex);
+    createSyncObjects();
+    spillStored();
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    ring.clear();
+    xSemaphoreGive(ringMutex);
     // Do not log from here to avoid re-entrancy
 }
 
+void Logger::clearLogsThrough(uint32_t sequence) {
+    createSyncObjects();
+    spillStored();
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    ring.dropThrough(sequence);
+    xSemaphoreGive(ringMutex);
+}
+
 size_t Logger::getLogCount() {
-    return logCount;
+    createSyncObjects();
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    size_t count = ring.size();
+    xSemaphoreGive(ringMutex);
+    return count;
 }
 
 bool Logger::isLogBufferFull() {
-    return logCount >= maxLogSize;
+    createSyncObjects();
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    bool full = ring.isFull();
+    xSemaphoreGive(ringMutex);
+    return full;
+}
+
+uint32_t Logger::getDroppedCount() {
+    return queue.droppedCount();
 }
 
 void Logger::transmitLogs() {
+    createSyncObjects();
+    // Skipped while the log task is draining; it transmits by itself once the buffer fills
+    if (xSemaphoreTake(drainMutex, 0) != pdTRUE) return;
+    transmitStored();
+    xSemaphoreGive(drainMutex);
+}
+
+void Logger::transmitStored() {
     if (!transmitCallback) return;
-    if (logCount == 0) return;
-
-    inTransmit = true;
-    String logsJson = getLogsAsJson();
-    // Call user callback outside of logger's logging to avoid recursion
-    transmitCallback(logsJson);
-    clearLogs();
-    inTransmit = false;
+
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    bool empty = ring.empty();
+    xSemaphoreGive(ringMutex);
+    if (empty) return;
+
+    // Nothing else stores while the caller holds drainMutex, so the document is exactly
+    // what gets discarded afterwards
+    StringPrint out;
+    uint32_t next = writeLogsJson(out);
+
+    transmittingTask = xTaskGetCurrentTaskHandle();
+    transmitCallback(out.text);
+    transmittingTask = nullptr;
+
+    clearLogsThrough(next - 1);
 }
 
 String Logger::logLevelToString(LogLevel level) {
@@ -1,7 +1,8 @@
 #pragma once
 #include <Arduino.h>
-#include <vector>
 #include <functional>
+#include "Config.h"
+#include "LogRing.h"
 
 enum LogLevel {
     LOG_ERROR = 0,
@@ -10,45 +11,147 @@ enum LogLevel {
     LOG_DEBUG = 3
 };
 
-struct LogEntry {
-    unsigned long timestamp;
-    LogLevel level;
-    String message;
-    String component;
+/**
+ * @brief Persistent storage that Logger copies stored lines into (see LogSpill)
+ *
+ * write() is called with the ring locked, so it must be quick; the slow part belongs in
+ * commit(), which runs after the ring is released. Neither may log: report failures
+ * through counters instead.
+ */
+class LogSink {
+public:
+    virtual ~LogSink() {}
+
+    /**
+     * @brief Stage one record
+     * @return false if the staging buffer is full; the record is offered again after commit()
+     */
+    virtual bool write(const LogRing<LOG_RING_BYTES>::Record& record) = 0;
+
+    /**
+     * @brief Persist everything staged so far
+     */
+    virtual void commit() = 0;
 };
 
 class Logger {
+public:
+    typedef LogRing<LOG_RING_BYTES> Ring;
+
 private:
-    static std::vector<LogEntry> logBuffer;
+    // Log lines live in a static byte arena; storing one never touches the heap
+    static Ring ring;
     static size_t maxLogSize;
-    // Ring buffer indices to avoid shifting and reallocation
-    static size_t startIndex;   // index of oldest element
-    static size_t logCount;     // number of valid elements
     static std::function<void(const String&)> transmitCallback;
     static LogLevel currentLogLevel;
-    static bool inTransmit;     // guard to avoid re-entrant logging during transmit/clear
     
 public:
     static void init(size_t maxSize = 100, LogLevel level = LOG_INFO);
+
+    /**
+     * @brief Hand serial output, storage and transmission over to a background task
+     *
+     * Until this is called every log() drains the queue itself, so output stays
+     * synchronous during boot and in tests. Afterwards log() only enqueues the line and
+     * never blocks; lines that find the queue full are dropped and counted.
+     */
+    static bool startDrainTask();
+
+    /**
+     * @brief Wait until every queued line has been printed and stored, then spill it if
+     *        a sink is attached
+     * @return false if the queue did not empty within timeoutMs
+     */
+    static bool flush(uint32_t timeoutMs = 1000);
+
+    /**
+     * @brief Spill stored lines to sink from now on, batched per LOG_SPILL_BATCH_BYTES and
+     *        LOG_SPILL_INTERVAL_MS and always before a line could be overwritten
+     *
+     * nextSequence is where the sink's history ends, e.g. from before a reboot; lines
+     * stored so far are renumbered to follow on from it, so sequence numbers never repeat.
+     */
+    static void attachSink(LogSink* sink, uint32_t nextSequence);
+
     static void setTransmitCallback(std::function<void(const String&)> callback);
     static void log(LogLevel level, const String& component, const String& message);
+
+    /**
+     * @brief printf-style log() that formats into a stack buffer; the message is
+     *        truncated to LOG_QUEUE_MESSAGE_BYTES
+     */
+    static void logf(LogLevel level, const char* component, const char* format, ...)
+        __attribute__((format(printf, 3, 4)));
+
+    /**
+     * @brief Cheap runtime level check, so the LOG_ macros skip building their arguments
+     */
+    static bool isEnabled(LogLevel level) { return level <= currentLogLevel; }
     static void error(const String& component, const String& message);
     static void warn(const String& component, const String& message);
     static void info(const String& component, const String& message);
     static void debug(const String& component, const String& message);
     
     static String getLogsAsJson();
+
+    /**
+     * @brief Write the stored lines with sequence >= since, at most limit of them, to out
+     *        as the /logs JSON document. Records are copied out a batch at a time; the
+     *        ring is never locked while out is being written.
+     * @return The cursor for the next call: one past the last line written
+     */
+    static uint32_t writeLogsJson(Print& out, uint32_t since = 0, size_t limit = SIZE_MAX);
+
     static void clearLogs();
+
+    /**
+     * @brief Drop stored lines up to and including sequence, e.g. once they were fetched
+     */
+    static void clearLogsThrough(uint32_t sequence);
     static size_t getLogCount();
     static bool isLogBufferFull();
     static void transmitLogs();
+
+    /**
+     * @brief Lines lost to a full queue since boot
+     */
+    static uint32_t getDroppedCount();
+
+    /**
+     * @brief Stored lines, oldest first, read in place. Records are overwritten as the
+     *        log task stores new lines, so iterate only with the drain task not running.
+     */
+    static const Ring& getRing() { return ring; }
+    static String logLevelToString(LogLevel level);
     
 private:
-    static void addLogEntry(LogLevel level, const String& component, const String& message);
-    static String logLevelToString(LogLevel level);
+    static void enqueue(LogLevel level, const char* component, const char* message, size_t length);
+    static void drain();
+    static void drainTask(void* param);
+    static void store(LogLevel level, const char* component, const char* message, size_t length, uint32_t timestamp);
+    static void transmitStored();
+    static void spillStored();
 };
 
-#define LOG_E(component, message) Logger::error(component, message)
-#define LOG_W(component, message) Logger::warn(component, message)
-#define LOG_I(component, message) Logger::info(component, message)
-#define LOG_D(component, message) Logger::debug(component, message)
+// The level is checked before the message expression is evaluated, so a filtered-out
+// "..." + String(x) chain costs a compare. Levels above LOG_COMPILE_LEVEL are
+// removed from the image altogether.
+#define LOG_AT(level, component, message) \
+    do { \
+        if ((level) <= LOG_COMPILE_LEVEL && Logger::isEnabled(level)) Logger::log(level, component, message); \
+    } while (0)
+#define LOG_ATF(level, component, ...) \
+    do { \
+        if ((level) <= LOG_COMPILE_LEVEL && Logger::isEnabled(level)) Logger::logf(level, component, __VA_ARGS__); \
+    } while (0)
+
+#define LOG_E(component, message) LOG_AT(LOG_ERROR, component, message)
+#define LOG_W(component, message) LOG_AT(LOG_WARN, component, message)
+#define LOG_I(component, message) LOG_AT(LOG_INFO, component, message)
+#define LOG_D(component, message) LOG_AT(LOG_DEBUG, component, message)
+
+// printf-style variants: LOG_IF("MQTT", "rc=%d", rc)
+#define LOG_EF(component, ...) LOG_ATF(LOG_ERROR, component, __VA_ARGS__)
+#define LOG_WF(component, ...) LOG_ATF(LOG_WARN, component, __VA_ARGS__)
+#define LOG_IF(component, ...) LOG_ATF(LOG_INFO, component, __VA_ARGS__)
+#define LOG_DF(component, ...) LOG_ATF(LOG_DEBUG, component, __VA_ARGS__)
@@ -0,0 +1,39 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @brief Wire format for telemetry documents exchanged with the desktop
+ *
+ * Documents are built with ArduinoJson either way; MESSAGE_PACK is the same tree
+ * written by serializeMsgPack. The desktop picks it with "payload_encoding":"msgpack"
+ * in the assignment, by listing application/msgpack in an Accept-Post response header
+ * (uploads), or in the Accept request header (GET /status).
+ */
+enum class PayloadEncoding : uint8_t {
+    JSON,
+    MESSAGE_PACK
+};
+
+inline const char* payloadContentType(PayloadEncoding encoding) {
+    return encoding == PayloadEncoding::MESSAGE_PACK ? "application/msgpack" : "application/json";
+}
+
+/**
+ * @brief Whether a media type list (Accept, Accept-Post) names MessagePack, under any
+ *        of the types in use for it
+ */
+inline bool acceptsMessagePack(const String& mediaTypes) {
+    String types = mediaTypes;
+    types.toLowerCase();
+    return types.indexOf("application/msgpack") >= 0 || types.indexOf("application/x-msgpack") >= 0 ||
+           types.indexOf("application/vnd.msgpack") >= 0;
+}
+
+/**
+ * @brief The assignment's "payload_encoding"; anything but "msgpack" means JSON
+ */
+inline PayloadEncoding parsePayloadEncoding(const String& name) {
+    String value = name;
+    value.toLowerCase();
+    return value == "msgpack" || value == "messagepack" ? PayloadEncoding::MESSAGE_PACK : PayloadEncoding::JSON;
+}
@@ -92,6 +92,7 @@ void Utils::printSystemInfo() {
 
 void Utils::rebootDevice(unsigned long delayMs) {
     LOG_W("System", "Rebooting device in " + String(delayMs) + "ms");
+    Logger::flush();
     delay(delayMs);
     ESP.restart();
 }
@@ -0,0 +1,250 @@
+#include "Arduino.h"
+#include "NativeAlarm.h"
+#include "esp_timer.h"
+#include "soc/gpio_struct.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+gpio_dev_t GPIO;
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+const Clock::time_point bootTime = Clock::now();
+
+const uint8_t kPinCount = 40;
+std::atomic<uint8_t> pinModes[kPinCount];
+std::atomic<uint8_t> pinOutputs[kPinCount];
+std::atomic<uint8_t> pinInputs[kPinCount];
+std::atomic<unsigned> restartCount(0);
+std::atomic<int64_t> clockSkewUs(0); // Added to millis()/micros() by advanceClock()
+
+void setRegisterBit(uint8_t pin, uint8_t level, volatile uint32_t& low, volatile uint32_t& high) {
+    uint32_t mask = 1UL << (pin & 31);
+    volatile uint32_t& reg = pin >= 32 ? high : low;
+    if (level) reg = reg | mask;
+    else reg = reg & ~mask;
+}
+}
+
+unsigned long millis() {
+    return static_cast<unsigned long>(
+        (std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime).count() + clockSkewUs.load()) / 1000);
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime).count() + clockSkewUs.load());
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    // Busy-waits like the ESP32 core, so timing-sensitive callers behave the same
+    Clock::time_point until = Clock::now() + std::chrono::microseconds(us);
+    while (Clock::now() < until) {
+    }
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= kPinCount) return;
+    pinModes[pin] = mode;
+    if (mode == INPUT_PULLUP) {
+        NativeShim::setPinInput(pin, HIGH);
+    } else if (mode == INPUT_PULLDOWN || mode == INPUT) {
+        NativeShim::setPinInput(pin, LOW);
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin >= kPinCount) return;
+    pinOutputs[pin] = val ? HIGH : LOW;
+    setRegisterBit(pin, val, GPIO.out, GPIO.out1.val);
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= kPinCount) return LOW;
+    return pinModes[pin] == OUTPUT ? pinOutputs[pin].load() : pinInputs[pin].load();
+}
+
+long random(long howbig) {
+    return howbig <= 0 ? 0 : rand() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) {
+    srand(static_cast<unsigned>(seed));
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+uint64_t EspClass::getEfuseMac() {
+    return 0x0000F6E5D4C3B2A1ULL;
+}
+
+void EspClass::restart() {
+    // Keep the process alive so benches can observe what led to the restart
+    restartCount++;
+    fprintf(stderr, "[native] ESP.restart() requested\n");
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+// Hardware timers: the counter runs at 80 MHz / divider, like the APB-clocked ESP32 timers
+struct hw_timer_s {
+    uint16_t divider;
+    void (*isr)(void);
+    uint64_t alarmTicks;
+    bool autoreload;
+    NativeAlarm alarm;
+
+    explicit hw_timer_s(uint16_t d) : divider(d ? d : 1), isr(nullptr), alarmTicks(0), autoreload(false),
+                                      alarm(std::function<void()>()) {}
+
+    std::chrono::nanoseconds ticks(uint64_t count) const {
+        return std::chrono::nanoseconds(count * divider * 25 / 2); // 12.5 ns per APB cycle
+    }
+};
+
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool countUp) {
+    (void)num;
+    (void)countUp;
+    return new hw_timer_s(divider);
+}
+
+void timerEnd(hw_timer_t* timer) {
+    delete timer;
+}
+
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge) {
+    (void)edge;
+    timer->isr = fn;
+    timer->alarm.setHandler(fn);
+}
+
+void timerDetachInterrupt(hw_timer_t* timer) {
+    timer->isr = nullptr;
+    timer->alarm.setHandler(std::function<void()>());
+}
+
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoreload) {
+    timer->alarmTicks = alarmValue;
+    timer->autoreload = autoreload;
+    timer->alarm.setPeriod(timer->ticks(alarmValue), autoreload);
+}
+
+void timerAlarmEnable(hw_timer_t* timer) {
+    timer->alarm.enable();
+}
+
+void timerAlarmDisable(hw_timer_t* timer) {
+    timer->alarm.disable();
+}
+
+void timerWrite(hw_timer_t* timer, uint64_t value) {
+    timer->alarm.restart(timer->ticks(value));
+}
+
+// esp_timer: microsecond alarms dispatched from a host thread
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    NativeAlarm alarm;
+
+    esp_timer(esp_timer_cb_t cb, void* a) : callback(cb), arg(a), alarm([this]() { callback(arg); }) {}
+};
+
+int64_t esp_timer_get_time() {
+    return static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime).count());
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    if (!args || !args->callback || !handle) return ESP_ERR_INVALID_ARG;
+    *handle = new esp_timer(args->callback, args->arg);
+    return ESP_OK;
+}
+
+static esp_err_t startTimer(esp_timer_handle_t timer, uint64_t us, bool periodic) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->alarm.isEnabled()) return ESP_ERR_INVALID_STATE;
+    timer->alarm.setPeriod(std::chrono::microseconds(us), periodic);
+    timer->alarm.restart();
+    timer->alarm.enable();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    return startTimer(timer, timeoutUs, false);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    return startTimer(timer, periodUs, true);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (!timer->alarm.isEnabled()) return ESP_ERR_INVALID_STATE;
+    timer->alarm.disable();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    delete timer;
+    return ESP_OK;
+}
+
+namespace NativeShim {
+void setPinInput(uint8_t pin, uint8_t level) {
+    if (pin >= kPinCount) return;
+    pinInputs[pin] = level ? HIGH : LOW;
+    setRegisterBit(pin, level, GPIO.in, GPIO.in1.data);
+}
+
+uint8_t getPinOutput(uint8_t pin) {
+    return pin < kPinCount ? pinOutputs[pin].load() : LOW;
+}
+
+unsigned getRestartCount() {
+    return restartCount.load();
+}
+
+void advanceClock(uint32_t ms) {
+    clockSkewUs.fetch_add(static_cast<int64_t>(ms) * 1000);
+}
+}
@@ -0,0 +1,113 @@
+#pragma once
+/**
+ * Native (Linux) stand-in for the Arduino-ESP32 core.
+ *
+ * Time comes from the host's monotonic clock, GPIO is a simulated pin array, and the
+ * hardware timers run their interrupt handlers on a host thread. Only what the firmware
+ * libraries use is provided; NativeShim:: exposes the knobs tests and benches need.
+ */
+#include <algorithm>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "WString.h"
+#include "Print.h"
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define PROGMEM
+#define F(string_literal) (string_literal)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::max;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint32_t getFreeHeap() { return 200 * 1024; }
+    uint32_t getMinFreeHeap() { return 180 * 1024; }
+    uint32_t getMaxAllocHeap() { return 110 * 1024; }
+    uint32_t getFlashChipSize() { return 4 * 1024 * 1024; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getSketchSize() { return 0; }
+    uint32_t getFreeSketchSpace() { return 1536 * 1024; }
+    const char* getChipModel() { return "native"; }
+    const char* getSdkVersion() { return "native"; }
+    uint64_t getEfuseMac();
+    void restart();
+};
+extern EspClass ESP;
+
+// Hardware timers (esp32-hal-timer). Alarms fire on a host thread, one per timer.
+struct hw_timer_s;
+typedef struct hw_timer_s hw_timer_t;
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool countUp);
+void timerEnd(hw_timer_t* timer);
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge);
+void timerDetachInterrupt(hw_timer_t* timer);
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoreload);
+void timerAlarmEnable(hw_timer_t* timer);
+void timerAlarmDisable(hw_timer_t* timer);
+void timerWrite(hw_timer_t* timer, uint64_t value);
+
+namespace NativeShim {
+    /** @brief Drive the level an input pin reads back */
+    void setPinInput(uint8_t pin, uint8_t level);
+    /** @brief Level last written to an output pin */
+    uint8_t getPinOutput(uint8_t pin);
+    /** @brief Number of restarts requested through ESP.restart() (the process keeps running) */
+    unsigned getRestartCount();
+    /**
+     * @brief Jump millis() and micros() forward, e.g. to replay recorded traffic on its
+     *        original timeline faster than real time. delay() and timers are unaffected.
+     */
+    void advanceClock(uint32_t ms);
+}
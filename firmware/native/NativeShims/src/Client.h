@@ -0,0 +1,29 @@
+#pragma once
+#include "Print.h"
+#include "IPAddress.h"
+
+/**
+ * @brief Arduino Client: the byte-stream interface PubSubClient and HTTPClient use.
+ */
+class Client : public Print {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(uint8_t c) override = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) override = 0;
+    using Print::write;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    virtual int peek() = 0;
+    virtual void flush() override = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+
+    void setTimeout(unsigned long timeoutMs) { timeout = timeoutMs; }
+    unsigned long getTimeout() const { return timeout; }
+
+protected:
+    unsigned long timeout = 1000;
+};
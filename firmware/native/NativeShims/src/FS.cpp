@@ -0,0 +1,221 @@
+#include "FS.h"
+#include "SPIFFS.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+namespace fs {
+
+class FileImpl {
+public:
+    FILE* fp = nullptr;
+    std::string path;
+    bool directory = false;
+    std::string hostDirectory;
+    std::vector<std::string> entries;
+    size_t nextEntry = 0;
+    const FS* owner = nullptr;
+
+    ~FileImpl() {
+        if (fp) fclose(fp);
+    }
+};
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!impl || !impl->fp) return 0;
+    return fwrite(buffer, 1, size, impl->fp);
+}
+
+int File::available() {
+    if (!impl || !impl->fp) return 0;
+    return static_cast<int>(size() - position());
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!impl || !impl->fp) return 0;
+    return fread(buffer, 1, size, impl->fp);
+}
+
+void File::flush() {
+    if (impl && impl->fp) fflush(impl->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!impl || !impl->fp) return false;
+    int whence = mode == SeekCur ? SEEK_CUR : mode == SeekEnd ? SEEK_END : SEEK_SET;
+    return fseek(impl->fp, pos, whence) == 0;
+}
+
+size_t File::position() const {
+    if (!impl || !impl->fp) return 0;
+    long pos = ftell(impl->fp);
+    return pos < 0 ? 0 : static_cast<size_t>(pos);
+}
+
+size_t File::size() const {
+    if (!impl || !impl->fp) return 0;
+    fflush(impl->fp);
+    struct stat info;
+    return fstat(fileno(impl->fp), &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+}
+
+void File::close() {
+    impl.reset();
+}
+
+File::operator bool() const {
+    return impl && (impl->fp || impl->directory);
+}
+
+const char* File::path() const {
+    return impl ? impl->path.c_str() : "";
+}
+
+const char* File::name() const {
+    if (!impl) return "";
+    size_t slash = impl->path.rfind('/');
+    return impl->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+bool File::isDirectory() const {
+    return impl && impl->directory;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl || !impl->directory || impl->nextEntry >= impl->entries.size()) {
+        return File();
+    }
+    std::string child = impl->path == "/" ? "/" + impl->entries[impl->nextEntry++]
+                                          : impl->path + "/" + impl->entries[impl->nextEntry++];
+    return const_cast<FS*>(impl->owner)->open(child.c_str(), mode);
+}
+
+std::string FS::hostPath(const char* path) const {
+    std::string relative = path ? path : "";
+    while (!relative.empty() && relative[0] == '/') relative.erase(0, 1);
+    return relative.empty() ? root : root + "/" + relative;
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+    (void)create;
+    if (!mounted || !path || path[0] != '/') return File();
+    std::string host = hostPath(path);
+
+    struct stat info;
+    if (stat(host.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+        std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+        impl->path = path;
+        impl->directory = true;
+        impl->owner = this;
+        if (DIR* dir = opendir(host.c_str())) {
+            while (struct dirent* entry = readdir(dir)) {
+                if (entry->d_name[0] != '.') impl->entries.push_back(entry->d_name);
+            }
+            closedir(dir);
+        }
+        std::sort(impl->entries.begin(), impl->entries.end());
+        return File(impl);
+    }
+
+    const char* hostMode = strcmp(mode, FILE_WRITE) == 0 ? "w+b" : strcmp(mode, FILE_APPEND) == 0 ? "a+b" : "rb";
+    FILE* fp = fopen(host.c_str(), hostMode);
+    if (!fp) return File();
+    std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+    impl->fp = fp;
+    impl->path = path;
+    impl->owner = this;
+    return File(impl);
+}
+
+bool FS::exists(const char* path) {
+    struct stat info;
+    return mounted && stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return mounted && unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return mounted && ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return mounted && ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+    return mounted && ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+}
+
+namespace {
+const size_t kPartitionBytes = 0x50000; // spiffs entry of partitions_two_apps.csv
+
+std::string defaultRoot() {
+    const char* root = getenv("NATIVE_FS_ROOT");
+    return root && *root ? root : "native_fs";
+}
+}
+
+SPIFFSFS SPIFFS;
+
+SPIFFSFS::SPIFFSFS() : fs::FS(defaultRoot()) {}
+
+bool SPIFFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    for (size_t slash = root.find('/', 1); ; slash = root.find('/', slash + 1)) {
+        ::mkdir(root.substr(0, slash).c_str(), 0755);
+        if (slash == std::string::npos) break;
+    }
+    struct stat info;
+    mounted = stat(root.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    return mounted;
+}
+
+bool SPIFFSFS::format() {
+    if (!mounted) return false;
+    File dir = open("/");
+    std::vector<std::string> paths;
+    for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+        paths.push_back(file.path());
+    }
+    for (const std::string& path : paths) {
+        remove(path.c_str());
+    }
+    return true;
+}
+
+size_t SPIFFSFS::totalBytes() {
+    return kPartitionBytes;
+}
+
+size_t SPIFFSFS::usedBytes() {
+    size_t used = 0;
+    File dir = open("/");
+    for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+        used += file.size();
+    }
+    return used;
+}
+
+void SPIFFSFS::end() {
+    mounted = false;
+}
@@ -0,0 +1,152 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <chrono>
+#include <condition_variable>
+#include <pthread.h>
+#include <thread>
+
+struct NativeTask {
+    TaskFunction_t function;
+    void* parameters;
+    std::mutex notifyMutex;
+    std::condition_variable notified;
+    uint32_t notifyCount = 0;
+};
+
+struct NativeSemaphore {
+    std::mutex mutex;
+    std::condition_variable available;
+    UBaseType_t count;
+    UBaseType_t maxCount;
+};
+
+static thread_local NativeTask* currentTask = nullptr;
+
+BaseType_t xPortGetCoreID() {
+    return 0;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    (void)coreId;
+    NativeTask* native = new NativeTask();
+    native->function = task;
+    native->parameters = parameters;
+    std::thread([native]() {
+        currentTask = native;
+        native->function(native->parameters);
+    }).detach();
+    if (handle) {
+        *handle = native;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                       void* parameters, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(task, name, stackDepth, parameters, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr) {
+        pthread_exit(nullptr);
+    }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (!currentTask) {
+        currentTask = new NativeTask();
+    }
+    return currentTask;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+TickType_t xTaskGetTickCount() {
+    static const auto start = std::chrono::steady_clock::now();
+    return static_cast<TickType_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count() / portTICK_PERIOD_MS);
+}
+
+void taskYieldNative() {
+    std::this_thread::yield();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::mutex> lock(task->notifyMutex);
+    task->notifyCount++;
+    task->notified.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    NativeTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->notifyMutex);
+    auto ready = [task]() { return task->notifyCount > 0; };
+    if (ticksToWait == portMAX_DELAY) {
+        task->notified.wait(lock, ready);
+    } else if (!task->notified.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready)) {
+        return 0;
+    }
+    uint32_t count = task->notifyCount;
+    task->notifyCount = clearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+static SemaphoreHandle_t createSemaphore(UBaseType_t maxCount, UBaseType_t initialCount) {
+    NativeSemaphore* semaphore = new NativeSemaphore();
+    semaphore->count = initialCount;
+    semaphore->maxCount = maxCount;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return createSemaphore(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return createSemaphore(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    return createSemaphore(maxCount, initialCount);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    auto ready = [semaphore]() { return semaphore->count > 0; };
+    if (ticksToWait == portMAX_DELAY) {
+        semaphore->available.wait(lock, ready);
+    } else if (!semaphore->available.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready)) {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->count >= semaphore->maxCount) {
+        return pdFALSE;
+    }
+    semaphore->count++;
+    semaphore->available.notify_one();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
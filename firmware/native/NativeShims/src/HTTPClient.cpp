@@ -0,0 +1,353 @@
+#include "HTTPClient.h"
+#include <poll.h>
+#include <stdlib.h>
+#include <strings.h>
+
+HTTPClient::HTTPClient()
+    : client(nullptr),
+      ownsClient(false),
+      port(80),
+      connectedPort(0),
+      userAgent("ESP32HTTPClient"),
+      reuseConnection(true),
+      serverKeepAlive(false),
+      chunked(false),
+      contentLength(-1),
+      bodyRemaining(0),
+      bodyDone(true),
+      readTimeoutMs(HTTPCLIENT_DEFAULT_TCP_TIMEOUT),
+      connectTimeoutMs(HTTPCLIENT_DEFAULT_TCP_TIMEOUT) {}
+
+HTTPClient::~HTTPClient() {
+    reuseConnection = false;
+    end();
+}
+
+bool HTTPClient::begin(const String& url) {
+    if (!client || !ownsClient) {
+        client = new WiFiClient();
+        ownsClient = true;
+    }
+    return begin(*client, url);
+}
+
+bool HTTPClient::begin(WiFiClient& c, const String& url) {
+    if (client && ownsClient && client != &c) {
+        delete client;
+    }
+    ownsClient = ownsClient && client == &c;
+    client = &c;
+
+    int schemeEnd = url.indexOf("://");
+    if (schemeEnd < 0) {
+        return false;
+    }
+    String scheme = url.substring(0, schemeEnd);
+    port = scheme.equalsIgnoreCase("https") ? 443 : 80;
+    String rest = url.substring(schemeEnd + 3);
+    int pathStart = rest.indexOf('/');
+    String authority = pathStart < 0 ? rest : rest.substring(0, pathStart);
+    uri = pathStart < 0 ? String("/") : rest.substring(pathStart);
+    int at = authority.indexOf('@');
+    if (at >= 0) {
+        authority = authority.substring(at + 1);
+    }
+    int colon = authority.indexOf(':');
+    if (colon >= 0) {
+        port = static_cast<uint16_t>(authority.substring(colon + 1).toInt());
+        authority = authority.substring(0, colon);
+    }
+    host = authority;
+    requestHeaders.clear();
+    return !host.isEmpty();
+}
+
+void HTTPClient::end() {
+    if (client) {
+        if (reuseConnection && serverKeepAlive && client->connected()) {
+            discardBody();
+        } else {
+            client->stop();
+            connectedHost = "";
+        }
+    }
+    if (!reuseConnection && client && ownsClient) {
+        delete client;
+        client = nullptr;
+        ownsClient = false;
+    }
+    requestHeaders.clear();
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+    for (auto& header : requestHeaders) {
+        if (header.name.equalsIgnoreCase(name)) {
+            header.value = value;
+            return;
+        }
+    }
+    requestHeaders.push_back({ name, value });
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+    collectKeys.clear();
+    for (size_t i = 0; i < headerKeysCount; i++) {
+        collectKeys.push_back(String(headerKeys[i]));
+    }
+}
+
+String HTTPClient::header(const char* name) {
+    for (const auto& header : responseHeaders) {
+        if (header.name.equalsIgnoreCase(name)) {
+            return header.value;
+        }
+    }
+    return String();
+}
+
+bool HTTPClient::hasHeader(const char* name) {
+    for (const auto& header : responseHeaders) {
+        if (header.name.equalsIgnoreCase(name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int HTTPClient::GET() {
+    return sendRequest("GET");
+}
+
+int HTTPClient::POST(const String& payload) {
+    return sendRequest("POST", payload);
+}
+
+int HTTPClient::POST(uint8_t* payload, size_t size) {
+    return sendRequest("POST", payload, size);
+}
+
+int HTTPClient::PUT(const String& payload) {
+    return sendRequest("PUT", payload);
+}
+
+int HTTPClient::PUT(uint8_t* payload, size_t size) {
+    return sendRequest("PUT", payload, size);
+}
+
+int HTTPClient::sendRequest(const char* method, const String& payload) {
+    return sendRequest(method, reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length());
+}
+
+bool HTTPClient::connect() {
+    if (client->connected() && connectedHost == host && connectedPort == port) {
+        return true;
+    }
+    client->stop();
+    if (!client->connect(host.c_str(), port, connectTimeoutMs)) {
+        connectedHost = "";
+        return false;
+    }
+    client->setNoDelay(true);
+    connectedHost = host;
+    connectedPort = port;
+    return true;
+}
+
+int HTTPClient::sendRequest(const char* method, const uint8_t* payload, size_t size) {
+    if (!client) {
+        return HTTPC_ERROR_NOT_CONNECTED;
+    }
+    if (!connect()) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    String head = String(method) + " " + uri + " HTTP/1.1\r\nHost: " + host;
+    if (port != 80 && port != 443) {
+        head += ":" + String(port);
+    }
+    head += "\r\nUser-Agent: " + userAgent;
+    head += reuseConnection ? "\r\nConnection: keep-alive" : "\r\nConnection: close";
+    if (payload && size > 0) {
+        head += "\r\nContent-Length: " + String(static_cast<unsigned long>(size));
+    } else if (strcmp(method, "POST") == 0 || strcmp(method, "PUT") == 0) {
+        head += "\r\nContent-Length: 0";
+    }
+    for (const auto& header : requestHeaders) {
+        head += "\r\n" + header.name + ": " + header.value;
+    }
+    head += "\r\n\r\n";
+
+    if (client->write(head.c_str(), head.length()) != head.length()) {
+        client->stop();
+        return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+    if (payload && size > 0 && client->write(payload, size) != size) {
+        client->stop();
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+    return readResponseHead();
+}
+
+int HTTPClient::readByte() {
+    unsigned long start = millis();
+    while (true) {
+        int c = client->read();
+        if (c >= 0) {
+            return c;
+        }
+        if (!client->connected() || millis() - start > readTimeoutMs) {
+            return -1;
+        }
+        pollfd pfd = { client->fd(), POLLIN, 0 };
+        poll(&pfd, 1, 10);
+    }
+}
+
+bool HTTPClient::readLine(String& line) {
+    line = "";
+    while (true) {
+        int c = readByte();
+        if (c < 0) {
+            return false;
+        }
+        if (c == '\n') {
+            if (line.endsWith("\r")) {
+                line.remove(line.length() - 1);
+            }
+            return true;
+        }
+        line += static_cast<char>(c);
+    }
+}
+
+int HTTPClient::readResponseHead() {
+    responseHeaders.clear();
+    contentLength = -1;
+    chunked = false;
+    serverKeepAlive = false;
+
+    String line;
+    int code = 0;
+    do {
+        if (!readLine(line)) {
+            client->stop();
+            return HTTPC_ERROR_READ_TIMEOUT;
+        }
+        if (!line.startsWith("HTTP/1.")) {
+            client->stop();
+            return HTTPC_ERROR_NO_HTTP_SERVER;
+        }
+        code = line.substring(9, 12).toInt();
+        serverKeepAlive = line.startsWith("HTTP/1.1");
+        while (readLine(line) && line.length() > 0) {
+            int colon = line.indexOf(':');
+            if (colon <= 0) continue;
+            Header header = { line.substring(0, colon), line.substring(colon + 1) };
+            header.value.trim();
+            if (header.name.equalsIgnoreCase("Content-Length")) {
+                contentLength = static_cast<int>(header.value.toInt());
+            } else if (header.name.equalsIgnoreCase("Transfer-Encoding")) {
+                chunked = header.value.equalsIgnoreCase("chunked");
+            } else if (header.name.equalsIgnoreCase("Connection")) {
+                serverKeepAlive = !header.value.equalsIgnoreCase("close");
+            }
+            responseHeaders.push_back(header);
+        }
+    } while (code == 100); // Skip interim responses
+
+    if (!chunked && contentLength < 0) {
+        serverKeepAlive = false; // Body runs until the server closes
+    }
+    bodyRemaining = chunked ? 0 : (contentLength > 0 ? static_cast<size_t>(contentLength) : 0);
+    bodyDone = !chunked && contentLength == 0;
+    if (code == 204 || code == 304) {
+        bodyDone = true;
+    }
+    return code;
+}
+
+size_t HTTPClient::readBody(uint8_t* buffer, size_t size) {
+    if (bodyDone) {
+        return 0;
+    }
+    if (chunked && bodyRemaining == 0) {
+        String line;
+        if (!readLine(line)) {
+            bodyDone = true;
+            return 0;
+        }
+        if (line.length() == 0 && !readLine(line)) { // CRLF after the previous chunk
+            bodyDone = true;
+            return 0;
+        }
+        bodyRemaining = strtoul(line.c_str(), nullptr, 16);
+        if (bodyRemaining == 0) {
+            while (readLine(line) && line.length() > 0) {
+            }
+            bodyDone = true;
+            return 0;
+        }
+    }
+
+    size_t wanted = size;
+    bool untilClose = !chunked && contentLength < 0;
+    if (!untilClose && wanted > bodyRemaining) {
+        wanted = bodyRemaining;
+    }
+    size_t got = 0;
+    while (got < wanted) {
+        int c = readByte();
+        if (c < 0) {
+            bodyDone = true;
+            break;
+        }
+        buffer[got++] = static_cast<uint8_t>(c);
+        int more = client->read(buffer + got, wanted - got);
+        if (more > 0) {
+            got += static_cast<size_t>(more);
+        }
+    }
+    if (!untilClose) {
+        bodyRemaining -= got;
+        if (!chunked && bodyRemaining == 0) {
+            bodyDone = true;
+        }
+    }
+    return got;
+}
+
+String HTTPClient::getString() {
+    String body;
+    if (contentLength > 0) {
+        body.reserve(contentLength);
+    }
+    uint8_t buffer[512];
+    size_t n;
+    while ((n = readBody(buffer, sizeof(buffer))) > 0) {
+        body.concat(reinterpret_cast<const char*>(buffer), static_cast<unsigned int>(n));
+    }
+    return body;
+}
+
+void HTTPClient::discardBody() {
+    uint8_t buffer[512];
+    while (readBody(buffer, sizeof(buffer)) > 0) {
+    }
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+        case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+        case HTTPC_ERROR_NO_STREAM: return "no stream";
+        case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+        case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+        case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+        case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+        case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+        default: return String();
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
+
+typedef enum {
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_CREATED = 201,
+    HTTP_CODE_ACCEPTED = 202,
+    HTTP_CODE_NO_CONTENT = 204,
+    HTTP_CODE_MOVED_PERMANENTLY = 301,
+    HTTP_CODE_FOUND = 302,
+    HTTP_CODE_NOT_MODIFIED = 304,
+    HTTP_CODE_BAD_REQUEST = 400,
+    HTTP_CODE_UNAUTHORIZED = 401,
+    HTTP_CODE_FORBIDDEN = 403,
+    HTTP_CODE_NOT_FOUND = 404,
+    HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+    HTTP_CODE_SERVICE_UNAVAILABLE = 503
+} t_http_codes;
+
+/**
+ * @brief HTTP/1.1 client with the ESP32 HTTPClient API, over a host socket.
+ *
+ * https:// URLs connect in plain TCP (see WiFiClientSecure). Responses may use
+ * Content-Length, chunked encoding or connection close. With setReuse(true) the
+ * connection is kept across requests to the same host when the server allows it.
+ */
+class HTTPClient {
+public:
+    HTTPClient();
+    ~HTTPClient();
+
+    bool begin(const String& url);
+    bool begin(WiFiClient& client, const String& url);
+    void end();
+
+    void setReuse(bool reuse) { reuseConnection = reuse; }
+    void setTimeout(uint16_t timeoutMs) { readTimeoutMs = timeoutMs; }
+    void setConnectTimeout(int32_t timeoutMs) { connectTimeoutMs = timeoutMs; }
+    void setUserAgent(const String& agent) { userAgent = agent; }
+    void addHeader(const String& name, const String& value);
+    void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+    String header(const char* name);
+    bool hasHeader(const char* name);
+
+    int GET();
+    int POST(const String& payload);
+    int POST(uint8_t* payload, size_t size);
+    int PUT(const String& payload);
+    int PUT(uint8_t* payload, size_t size);
+    int sendRequest(const char* method, const String& payload);
+    int sendRequest(const char* method, const uint8_t* payload = nullptr, size_t size = 0);
+
+    int getSize() const { return contentLength; }
+    String getString();
+    WiFiClient& getStream() { return *client; }
+    WiFiClient* getStreamPtr() { return client; }
+    bool connected() { return client && client->connected(); }
+    static String errorToString(int error);
+
+private:
+    struct Header {
+        String name;
+        String value;
+    };
+
+    bool connect();
+    int readResponseHead();
+    bool readLine(String& line);
+    int readByte();
+    size_t readBody(uint8_t* buffer, size_t size);
+    void discardBody();
+
+    WiFiClient* client;
+    bool ownsClient;
+    String host;
+    uint16_t port;
+    String uri;
+    String connectedHost;
+    uint16_t connectedPort;
+    String userAgent;
+    std::vector<Header> requestHeaders;
+    std::vector<Header> responseHeaders;
+    std::vector<String> collectKeys;
+    bool reuseConnection;
+    bool serverKeepAlive;
+    bool chunked;
+    int contentLength;
+    size_t bodyRemaining;   // Bytes left in the body (or current chunk)
+    bool bodyDone;
+    uint16_t readTimeoutMs;
+    int32_t connectTimeoutMs;
+};
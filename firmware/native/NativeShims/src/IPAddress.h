@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+#include "WString.h"
+
+class IPAddress {
+public:
+    IPAddress() : address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : address(static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+                  (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24)) {}
+    IPAddress(uint32_t raw) : address(raw) {}
+
+    bool fromString(const char* text);
+    bool fromString(const String& text) { return fromString(text.c_str()); }
+    String toString() const;
+
+    operator uint32_t() const { return address; }
+    uint8_t operator[](int index) const { return static_cast<uint8_t>(address >> (8 * index)); }
+    bool operator==(const IPAddress& other) const { return address == other.address; }
+    bool operator!=(const IPAddress& other) const { return address != other.address; }
+
+private:
+    uint32_t address; // Network byte order, like the ESP32 core
+};
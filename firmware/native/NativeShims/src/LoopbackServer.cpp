@@ -0,0 +1,145 @@
+#include "LoopbackServer.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+LoopbackServer::LoopbackServer(Handler handler)
+    : handler(handler)
+    , listenFd(socket(AF_INET, SOCK_STREAM, 0))
+    , clientFd(-1)
+    , port(0) {
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    socklen_t length = sizeof(addr);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &length);
+    port = ntohs(addr.sin_port);
+    listen(listenFd, 4);
+
+    worker = std::thread([this]() {
+        int fd;
+        while ((fd = accept(listenFd, nullptr, nullptr)) >= 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                clientFd = fd;
+            }
+            this->handler(fd);
+            std::lock_guard<std::mutex> lock(mutex);
+            close(fd);
+            clientFd = -1;
+        }
+    });
+}
+
+LoopbackServer::~LoopbackServer() {
+    drop();
+    // Wakes the blocked accept()
+    shutdown(listenFd, SHUT_RDWR);
+    close(listenFd);
+    worker.join();
+}
+
+bool LoopbackServer::send(const void* data, size_t length) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (clientFd < 0) return false;
+    return ::send(clientFd, data, length, MSG_NOSIGNAL) == static_cast<ssize_t>(length);
+}
+
+void LoopbackServer::drop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (clientFd >= 0) shutdown(clientFd, SHUT_RDWR);
+}
+
+bool LoopbackServer::readExact(int fd, void* buffer, size_t length) {
+    uint8_t* bytes = static_cast<uint8_t*>(buffer);
+    size_t got = 0;
+    while (got < length) {
+        ssize_t n = recv(fd, bytes + got, length - got, 0);
+        if (n <= 0) return false;
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+namespace {
+const char* reasonPhrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 404: return "Not Found";
+        case 503: return "Service Unavailable";
+        default: return "Status";
+    }
+}
+
+// Value of a header line in head, or empty
+std::string headerValue(const std::string& head, const char* name) {
+    std::string prefix = std::string("\r\n") + name + ": ";
+    size_t at = head.find(prefix);
+    if (at == std::string::npos) return std::string();
+    at += prefix.size();
+    return head.substr(at, head.find("\r\n", at) - at);
+}
+}
+
+HttpStandIn::HttpStandIn(Responder responder, unsigned long delayMs)
+    : responder(responder)
+    , delayMs(delayMs)
+    , server([this](int fd) { serve(fd); }) {
+}
+
+std::vector<HttpStandIn::Request> HttpStandIn::requests() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return received;
+}
+
+size_t HttpStandIn::requestCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return received.size();
+}
+
+void HttpStandIn::serve(int fd) {
+    std::string data;
+    char chunk[512];
+    while (true) {
+        size_t headerEnd;
+        while ((headerEnd = data.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return;
+            data.append(chunk, n);
+        }
+        std::string head = data.substr(0, headerEnd);
+        std::string contentLength = headerValue(head, "Content-Length");
+        size_t bodyLength = contentLength.empty() ? 0 : strtoul(contentLength.c_str(), nullptr, 10);
+        while (data.size() < headerEnd + 4 + bodyLength) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return;
+            data.append(chunk, n);
+        }
+
+        Request request;
+        size_t pathAt = head.find(' ');
+        request.method = head.substr(0, pathAt);
+        request.path = head.substr(pathAt + 1, head.find(' ', pathAt + 1) - pathAt - 1);
+        request.contentType = headerValue(head, "Content-Type");
+        request.body = data.substr(headerEnd + 4, bodyLength);
+        request.at = millis();
+        data.erase(0, headerEnd + 4 + bodyLength);
+
+        Response response = responder ? responder(request) : Response{200, std::string(), "{}"};
+        request.status = response.status;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            received.push_back(request);
+        }
+
+        delay(delayMs);
+        std::string out = "HTTP/1.1 " + std::to_string(response.status) + " " + reasonPhrase(response.status) + "\r\n" +
+                          "Content-Length: " + std::to_string(response.body.size()) + "\r\n" +
+                          response.headers + "\r\n" + response.body;
+        if (!server.send(out.data(), out.size())) return;
+    }
+}
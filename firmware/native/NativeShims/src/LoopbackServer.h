@@ -0,0 +1,83 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Peer on a loopback TCP port for host tests: serves one connection at a time from
+ *        a thread of its own, handing it to the handler until either side closes it
+ */
+class LoopbackServer {
+public:
+    typedef std::function<void(int fd)> Handler;
+
+    explicit LoopbackServer(Handler handler);
+    ~LoopbackServer();
+
+    uint16_t getPort() const { return port; }
+    String getAddress() const { return "127.0.0.1:" + String(port); }
+
+    /**
+     * @brief Write to the connection being served; false if there is none
+     */
+    bool send(const void* data, size_t length);
+
+    /**
+     * @brief Shut the connection being served down, as a peer that restarts would
+     */
+    void drop();
+
+    static bool readExact(int fd, void* buffer, size_t length);
+
+private:
+    Handler handler;
+    int listenFd;
+    int clientFd;
+    uint16_t port;
+    std::mutex mutex;   // Guards clientFd and keeps writes whole
+    std::thread worker;
+};
+
+/**
+ * @brief HTTP/1.1 server on a LoopbackServer: reads each request on a kept-alive
+ *        connection, logs it, waits delayMs and answers with what the responder returns
+ *        (200 "{}" without one)
+ */
+class HttpStandIn {
+public:
+    struct Request {
+        std::string method;
+        std::string path;
+        std::string contentType;
+        std::string body;
+        unsigned long at;   // millis() once read in full
+        int status;         // Status code it was answered with
+    };
+
+    struct Response {
+        int status;
+        std::string headers;   // Extra header lines, each ending in "\r\n"
+        std::string body;
+    };
+
+    typedef std::function<Response(const Request&)> Responder;
+
+    explicit HttpStandIn(Responder responder = nullptr, unsigned long delayMs = 0);
+
+    String url() const { return "http://" + server.getAddress(); }
+
+    std::vector<Request> requests();
+    size_t requestCount();
+
+private:
+    Responder responder;
+    unsigned long delayMs;
+    std::mutex mutex;
+    std::vector<Request> received;
+    LoopbackServer server;   // Last, so its thread is gone before the rest
+
+    void serve(int fd);
+};
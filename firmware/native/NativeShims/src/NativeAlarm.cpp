@@ -0,0 +1,92 @@
+#include "NativeAlarm.h"
+
+NativeAlarm::NativeAlarm(std::function<void()> handler)
+    : handler(handler),
+      period(std::chrono::nanoseconds(1000)),
+      base(Clock::now()),
+      generation(0),
+      autoreload(false),
+      enabled(false),
+      stopping(false),
+      thread(&NativeAlarm::run, this) {}
+
+NativeAlarm::~NativeAlarm() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        generation++;
+    }
+    changed.notify_all();
+    if (thread.joinable()) {
+        if (thread.get_id() == std::this_thread::get_id()) {
+            thread.detach();
+        } else {
+            thread.join();
+        }
+    }
+}
+
+void NativeAlarm::setHandler(std::function<void()> h) {
+    std::lock_guard<std::mutex> lock(mutex);
+    handler = h;
+    generation++;
+    changed.notify_all();
+}
+
+void NativeAlarm::setPeriod(std::chrono::nanoseconds p, bool reload) {
+    std::lock_guard<std::mutex> lock(mutex);
+    period = p;
+    autoreload = reload;
+    generation++;
+    changed.notify_all();
+}
+
+void NativeAlarm::restart(std::chrono::nanoseconds elapsed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    base = Clock::now() - elapsed;
+    generation++;
+    changed.notify_all();
+}
+
+void NativeAlarm::enable() {
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled = true;
+    generation++;
+    changed.notify_all();
+}
+
+void NativeAlarm::disable() {
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled = false;
+    generation++;
+    changed.notify_all();
+}
+
+bool NativeAlarm::isEnabled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return enabled;
+}
+
+void NativeAlarm::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (!enabled || !handler) {
+            changed.wait(lock);
+            continue;
+        }
+        unsigned long seen = generation;
+        Clock::time_point deadline = base + period;
+        if (changed.wait_until(lock, deadline, [this, seen]() { return generation != seen; })) {
+            continue; // Reprogrammed while waiting
+        }
+        if (autoreload) {
+            base = deadline;
+        } else {
+            enabled = false;
+        }
+        std::function<void()> fire = handler;
+        lock.unlock();
+        fire();
+        lock.lock();
+    }
+}
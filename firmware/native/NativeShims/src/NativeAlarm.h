@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief A host thread that calls a handler when an alarm expires, optionally reloading.
+ *
+ * Backs the hardware timer and esp_timer shims. The handler runs without the alarm's
+ * lock held, so it may reprogram the alarm (as the step ISR does).
+ */
+class NativeAlarm {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit NativeAlarm(std::function<void()> handler);
+    ~NativeAlarm();
+
+    void setHandler(std::function<void()> handler);
+    /** @brief Period from the last expiry (or restart()) to the next one */
+    void setPeriod(std::chrono::nanoseconds period, bool autoreload);
+    /** @brief Restart the current period from now, minus elapsed */
+    void restart(std::chrono::nanoseconds elapsed = std::chrono::nanoseconds(0));
+    void enable();
+    void disable();
+    bool isEnabled();
+
+private:
+    void run();
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::function<void()> handler;
+    std::chrono::nanoseconds period;
+    Clock::time_point base;
+    unsigned long generation;
+    bool autoreload;
+    bool enabled;
+    bool stopping;
+    std::thread thread;
+};
@@ -0,0 +1,106 @@
+#include "Preferences.h"
+#include <map>
+#include <mutex>
+
+namespace {
+// NVS keys are limited to 15 characters
+const size_t kMaxKeyLength = 15;
+
+std::mutex storeMutex;
+std::map<std::string, std::map<std::string, std::string> >& store() {
+    static std::map<std::string, std::map<std::string, std::string> > namespaces;
+    return namespaces;
+}
+
+bool validKey(const char* key) {
+    return key && *key && strlen(key) <= kMaxKeyLength;
+}
+}
+
+bool Preferences::begin(const char* name, bool ro, const char* partitionLabel) {
+    (void)partitionLabel;
+    if (opened || !validKey(name)) {
+        return false;
+    }
+    space = name;
+    readOnly = ro;
+    opened = true;
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly) return false;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    store()[space].clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || readOnly || !validKey(key)) return false;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    return store()[space].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    std::string raw;
+    return getRaw(key, raw);
+}
+
+size_t Preferences::putRaw(const char* key, const void* value, size_t len) {
+    if (!opened || readOnly || !validKey(key) || (!value && len)) return 0;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    store()[space][key] = std::string(static_cast<const char*>(value), len);
+    return len;
+}
+
+bool Preferences::getRaw(const char* key, std::string& value) {
+    if (!opened || !validKey(key)) return false;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto ns = store().find(space);
+    if (ns == store().end()) return false;
+    auto entry = ns->second.find(key);
+    if (entry == ns->second.end()) return false;
+    value = entry->second;
+    return true;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    if (!value) return 0;
+    // Stored with its terminator, as NVS does
+    return putRaw(key, value, strlen(value) + 1) ? strlen(value) : 0;
+}
+
+String Preferences::getString(const char* key, String defaultValue) {
+    std::string raw;
+    if (!getRaw(key, raw) || raw.empty() || raw.back() != '\0') {
+        return defaultValue;
+    }
+    return String(raw.c_str());
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    std::string raw;
+    if (!value || !getRaw(key, raw) || raw.size() > maxLen) {
+        return 0;
+    }
+    memcpy(value, raw.data(), raw.size());
+    return raw.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    std::string raw;
+    return getRaw(key, raw) ? raw.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    std::string raw;
+    if (!buf || !getRaw(key, raw) || raw.size() > maxLen) {
+        return 0;
+    }
+    memcpy(buf, raw.data(), raw.size());
+    return raw.size();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @brief NVS-backed Preferences on the host: namespaces live in process memory and
+ *        persist across begin()/end() (and across Preferences instances) until exit.
+ */
+class Preferences {
+public:
+    Preferences() : readOnly(true), opened(false) {}
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+    size_t freeEntries() { return 500; }
+
+    size_t putChar(const char* key, int8_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putShort(const char* key, int16_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putULong(const char* key, uint32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putLong64(const char* key, int64_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putULong64(const char* key, uint64_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putDouble(const char* key, double value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t len) { return putRaw(key, value, len); }
+
+    int8_t getChar(const char* key, int8_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int16_t getShort(const char* key, int16_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int32_t getLong(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int64_t getLong64(const char* key, int64_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return getValue(key, defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) { return getValue(key, defaultValue); }
+    double getDouble(const char* key, double defaultValue = NAN) { return getValue(key, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+    String getString(const char* key, String defaultValue = String());
+    size_t getString(const char* key, char* value, size_t maxLen);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+    size_t putRaw(const char* key, const void* value, size_t len);
+    bool getRaw(const char* key, std::string& value);
+
+    template <typename T>
+    T getValue(const char* key, T defaultValue) {
+        std::string raw;
+        if (!getRaw(key, raw) || raw.size() != sizeof(T)) {
+            return defaultValue;
+        }
+        T value;
+        memcpy(&value, raw.data(), sizeof(T));
+        return value;
+    }
+
+    std::string space;
+    bool readOnly;
+    bool opened;
+};
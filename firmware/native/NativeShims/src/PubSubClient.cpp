@@ -0,0 +1,394 @@
+#include "PubSubClient.h"
+#include <stdlib.h>
+
+#define MQTT_MAX_HEADER_SIZE 5
+
+PubSubClient::PubSubClient()
+    : client(nullptr),
+      buffer(nullptr),
+      bufferSize(0),
+      keepAlive(MQTT_KEEPALIVE),
+      socketTimeout(MQTT_SOCKET_TIMEOUT),
+      nextMsgId(1),
+      lastOutActivity(0),
+      lastInActivity(0),
+      pingOutstanding(false),
+      callback(nullptr),
+      port(0),
+      clientState(MQTT_DISCONNECTED) {
+    setBufferSize(MQTT_MAX_PACKET_SIZE);
+}
+
+PubSubClient::PubSubClient(Client& c) : PubSubClient() {
+    client = &c;
+}
+
+PubSubClient::~PubSubClient() {
+    free(buffer);
+}
+
+PubSubClient& PubSubClient::setServer(const char* d, uint16_t p) {
+    domain = d;
+    port = p;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setServer(IPAddress address, uint16_t p) {
+    domain = "";
+    ip = address;
+    port = p;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+    this->callback = callback;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setClient(Client& c) {
+    client = &c;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setKeepAlive(uint16_t k) {
+    keepAlive = k;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setSocketTimeout(uint16_t t) {
+    socketTimeout = t;
+    return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+    if (size == 0) {
+        return false;
+    }
+    uint8_t* resized = static_cast<uint8_t*>(realloc(buffer, size));
+    if (!resized) {
+        return false;
+    }
+    buffer = resized;
+    bufferSize = size;
+    return true;
+}
+
+bool PubSubClient::connect(const char* id) {
+    return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    return connect(id, user, pass, nullptr, 0, false, nullptr, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass,
+                           const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage,
+                           bool cleanSession) {
+    if (!client) {
+        clientState = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    if (connected()) {
+        return true;
+    }
+
+    int result = domain.isEmpty() ? client->connect(ip, port) : client->connect(domain.c_str(), port);
+    if (result != 1) {
+        clientState = MQTT_CONNECT_FAILED;
+        return false;
+    }
+
+    nextMsgId = 1;
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    const uint8_t protocol[7] = { 0x00, 0x04, 'M', 'Q', 'T', 'T', MQTT_VERSION_3_1_1 };
+    memcpy(buffer + length, protocol, sizeof(protocol));
+    length += sizeof(protocol);
+
+    uint8_t flags = cleanSession ? 0x02 : 0x00;
+    if (willTopic) {
+        flags |= 0x04 | (willQos << 3) | (willRetain ? 0x20 : 0x00);
+    }
+    if (user && *user) {
+        flags |= 0x80;
+        if (pass && *pass) {
+            flags |= 0x40;
+        }
+    }
+    buffer[length++] = flags;
+    buffer[length++] = keepAlive >> 8;
+    buffer[length++] = keepAlive & 0xFF;
+
+    length = writeString(id, buffer, length);
+    if (willTopic) {
+        length = writeString(willTopic, buffer, length);
+        length = writeString(willMessage, buffer, length);
+    }
+    if (flags & 0x80) {
+        length = writeString(user, buffer, length);
+        if (flags & 0x40) {
+            length = writeString(pass, buffer, length);
+        }
+    }
+    if (length == 0 || !write(MQTTCONNECT, buffer, length - MQTT_MAX_HEADER_SIZE)) {
+        client->stop();
+        clientState = MQTT_CONNECT_FAILED;
+        return false;
+    }
+
+    lastInActivity = lastOutActivity = millis();
+    while (!client->available()) {
+        if (millis() - lastInActivity >= socketTimeout * 1000UL) {
+            clientState = MQTT_CONNECTION_TIMEOUT;
+            client->stop();
+            return false;
+        }
+        delay(1);
+    }
+
+    uint8_t headerLength;
+    uint32_t packetLength = readPacket(&headerLength);
+    if (packetLength == 4 && (buffer[0] & 0xF0) == MQTTCONNACK) {
+        if (buffer[3] == 0) {
+            lastInActivity = millis();
+            pingOutstanding = false;
+            clientState = MQTT_CONNECTED;
+            return true;
+        }
+        clientState = buffer[3];
+    } else {
+        clientState = MQTT_CONNECT_FAILED;
+    }
+    client->stop();
+    return false;
+}
+
+bool PubSubClient::readByte(uint8_t* value) {
+    unsigned long start = millis();
+    while (!client->available()) {
+        if (!client->connected() || millis() - start >= socketTimeout * 1000UL) {
+            return false;
+        }
+        delay(1);
+    }
+    int c = client->read();
+    if (c < 0) {
+        return false;
+    }
+    *value = static_cast<uint8_t>(c);
+    return true;
+}
+
+uint32_t PubSubClient::readPacket(uint8_t* headerLength) {
+    uint16_t len = 0;
+    if (!readByte(&buffer[len++])) {
+        return 0;
+    }
+    uint32_t multiplier = 1;
+    uint32_t length = 0;
+    uint8_t digit = 0;
+    do {
+        if (len == MQTT_MAX_HEADER_SIZE) {
+            return 0; // Malformed remaining length
+        }
+        if (!readByte(&digit)) {
+            return 0;
+        }
+        buffer[len++] = digit;
+        length += (digit & 127) * multiplier;
+        multiplier <<= 7;
+    } while ((digit & 128) != 0);
+    *headerLength = static_cast<uint8_t>(len);
+
+    // Oversized packets are read and dropped, like the Arduino library
+    for (uint32_t i = 0; i < length; i++) {
+        uint8_t byte;
+        if (!readByte(&byte)) {
+            return 0;
+        }
+        if (len < bufferSize) {
+            buffer[len] = byte;
+        }
+        len++;
+    }
+    lastInActivity = millis();
+    return len <= bufferSize ? len : 0;
+}
+
+bool PubSubClient::loop() {
+    if (!connected()) {
+        return false;
+    }
+    unsigned long now = millis();
+    if (keepAlive && (now - lastInActivity > keepAlive * 1000UL || now - lastOutActivity > keepAlive * 1000UL)) {
+        if (pingOutstanding) {
+            clientState = MQTT_CONNECTION_TIMEOUT;
+            client->stop();
+            return false;
+        }
+        buffer[0] = MQTTPINGREQ;
+        buffer[1] = 0;
+        client->write(buffer, 2);
+        lastOutActivity = lastInActivity = now;
+        pingOutstanding = true;
+    }
+
+    while (client->available()) {
+        uint8_t headerLength;
+        uint32_t length = readPacket(&headerLength);
+        if (length == 0) {
+            continue;
+        }
+        uint8_t type = buffer[0] & 0xF0;
+        if (type == MQTTPUBLISH) {
+            if (!callback) continue;
+            uint16_t topicLength = (buffer[headerLength] << 8) + buffer[headerLength + 1];
+            // Shift the topic down one byte to null-terminate it in place
+            memmove(buffer + headerLength + 1, buffer + headerLength + 2, topicLength);
+            buffer[headerLength + 1 + topicLength] = 0;
+            char* topic = reinterpret_cast<char*>(buffer + headerLength + 1);
+            uint32_t payloadStart = headerLength + topicLength + 2;
+            if ((buffer[0] & 0x06) == 0x02) { // QoS 1: message id, then PUBACK
+                uint16_t msgId = (buffer[payloadStart] << 8) + buffer[payloadStart + 1];
+                payloadStart += 2;
+                callback(topic, buffer + payloadStart, length - payloadStart);
+                uint8_t ack[4] = { MQTTPUBACK, 2, static_cast<uint8_t>(msgId >> 8), static_cast<uint8_t>(msgId & 0xFF) };
+                client->write(ack, 4);
+                lastOutActivity = millis();
+            } else {
+                callback(topic, buffer + payloadStart, length - payloadStart);
+            }
+        } else if (type == MQTTPINGREQ) {
+            buffer[0] = MQTTPINGRESP;
+            buffer[1] = 0;
+            client->write(buffer, 2);
+        } else if (type == MQTTPINGRESP) {
+            pingOutstanding = false;
+        }
+    }
+    return true;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+    return publish(topic, reinterpret_cast<const uint8_t*>(payload), payload ? strlen(payload) : 0, false);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+    return publish(topic, reinterpret_cast<const uint8_t*>(payload), payload ? strlen(payload) : 0, retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length) {
+    return publish(topic, payload, length, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+    if (!connected()) {
+        return false;
+    }
+    if (MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + length > bufferSize) {
+        return false;
+    }
+    uint16_t pos = writeString(topic, buffer, MQTT_MAX_HEADER_SIZE);
+    if (length) {
+        memcpy(buffer + pos, payload, length);
+        pos += length;
+    }
+    uint8_t header = MQTTPUBLISH;
+    if (retained) {
+        header |= 1;
+    }
+    return write(header, buffer, pos - MQTT_MAX_HEADER_SIZE);
+}
+
+bool PubSubClient::subscribe(const char* topic) {
+    return subscribe(topic, 0);
+}
+
+bool PubSubClient::subscribe(const char* topic, uint8_t qos) {
+    if (!topic || qos > 1 || bufferSize < 9 + strlen(topic) || !connected()) {
+        return false;
+    }
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    if (++nextMsgId == 0) nextMsgId = 1;
+    buffer[length++] = nextMsgId >> 8;
+    buffer[length++] = nextMsgId & 0xFF;
+    length = writeString(topic, buffer, length);
+    buffer[length++] = qos;
+    return write(MQTTSUBSCRIBE | 0x02, buffer, length - MQTT_MAX_HEADER_SIZE);
+}
+
+bool PubSubClient::unsubscribe(const char* topic) {
+    if (!topic || bufferSize < 9 + strlen(topic) || !connected()) {
+        return false;
+    }
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    if (++nextMsgId == 0) nextMsgId = 1;
+    buffer[length++] = nextMsgId >> 8;
+    buffer[length++] = nextMsgId & 0xFF;
+    length = writeString(topic, buffer, length);
+    return write(MQTTUNSUBSCRIBE | 0x02, buffer, length - MQTT_MAX_HEADER_SIZE);
+}
+
+void PubSubClient::disconnect() {
+    if (client && client->connected()) {
+        buffer[0] = MQTTDISCONNECT;
+        buffer[1] = 0;
+        client->write(buffer, 2);
+        client->stop();
+    }
+    clientState = MQTT_DISCONNECTED;
+    lastInActivity = lastOutActivity = millis();
+}
+
+bool PubSubClient::connected() {
+    if (!client) {
+        return false;
+    }
+    if (client->connected()) {
+        return clientState == MQTT_CONNECTED;
+    }
+    if (clientState == MQTT_CONNECTED) {
+        clientState = MQTT_CONNECTION_LOST;
+        client->stop();
+    }
+    return false;
+}
+
+uint16_t PubSubClient::writeString(const char* string, uint8_t* buf, uint16_t pos) {
+    size_t length = string ? strlen(string) : 0;
+    if (pos == 0 || pos + 2 + length > bufferSize) { // pos 0: an earlier field overflowed
+        return 0;
+    }
+    buf[pos++] = static_cast<uint8_t>(length >> 8);
+    buf[pos++] = static_cast<uint8_t>(length & 0xFF);
+    if (length) {
+        memcpy(buf + pos, string, length);
+    }
+    return static_cast<uint16_t>(pos + length);
+}
+
+size_t PubSubClient::buildHeader(uint8_t header, uint8_t* buf, uint16_t length) {
+    uint8_t lengthBytes[4];
+    uint8_t count = 0;
+    uint16_t remaining = length;
+    do {
+        uint8_t digit = remaining & 127;
+        remaining >>= 7;
+        if (remaining > 0) digit |= 0x80;
+        lengthBytes[count++] = digit;
+    } while (remaining > 0 && count < 4);
+
+    // The header is written right-aligned into the reserved MQTT_MAX_HEADER_SIZE bytes
+    buf[MQTT_MAX_HEADER_SIZE - 1 - count] = header;
+    for (uint8_t i = 0; i < count; i++) {
+        buf[MQTT_MAX_HEADER_SIZE - count + i] = lengthBytes[i];
+    }
+    return count + 1;
+}
+
+bool PubSubClient::write(uint8_t header, uint8_t* buf, uint16_t length) {
+    size_t headerLength = buildHeader(header, buf, length);
+    size_t total = length + headerLength;
+    size_t written = client->write(buf + (MQTT_MAX_HEADER_SIZE - headerLength), total);
+    lastOutActivity = millis();
+    return written == total;
+}
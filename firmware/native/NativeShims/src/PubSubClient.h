@@ -0,0 +1,95 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#include "Client.h"
+
+#define MQTT_VERSION_3_1_1 4
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_KEEPALIVE 15
+#define MQTT_SOCKET_TIMEOUT 15
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+#define MQTT_CONNECT_BAD_PROTOCOL 1
+#define MQTT_CONNECT_BAD_CLIENT_ID 2
+#define MQTT_CONNECT_UNAVAILABLE 3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED 5
+
+#define MQTTCONNECT 1 << 4
+#define MQTTCONNACK 2 << 4
+#define MQTTPUBLISH 3 << 4
+#define MQTTPUBACK 4 << 4
+#define MQTTSUBSCRIBE 8 << 4
+#define MQTTSUBACK 9 << 4
+#define MQTTUNSUBSCRIBE 10 << 4
+#define MQTTUNSUBACK 11 << 4
+#define MQTTPINGREQ 12 << 4
+#define MQTTPINGRESP 13 << 4
+#define MQTTDISCONNECT 14 << 4
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+/**
+ * @brief MQTT 3.1.1 client with the PubSubClient API (QoS 0 publish, QoS 0/1 receive).
+ *
+ * Same contract as the Arduino library: one packet buffer of setBufferSize() bytes,
+ * connect() blocks for CONNACK, loop() services keep-alive and dispatches PUBLISH.
+ */
+class PubSubClient {
+public:
+    PubSubClient();
+    explicit PubSubClient(Client& client);
+    ~PubSubClient();
+
+    PubSubClient& setServer(const char* domain, uint16_t port);
+    PubSubClient& setServer(IPAddress ip, uint16_t port);
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+    PubSubClient& setClient(Client& client);
+    PubSubClient& setKeepAlive(uint16_t keepAlive);
+    PubSubClient& setSocketTimeout(uint16_t timeout);
+    bool setBufferSize(uint16_t size);
+    uint16_t getBufferSize() const { return bufferSize; }
+
+    bool connect(const char* id);
+    bool connect(const char* id, const char* user, const char* pass);
+    bool connect(const char* id, const char* user, const char* pass,
+                 const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage,
+                 bool cleanSession = true);
+    void disconnect();
+    bool publish(const char* topic, const char* payload);
+    bool publish(const char* topic, const char* payload, bool retained);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained);
+    bool subscribe(const char* topic);
+    bool subscribe(const char* topic, uint8_t qos);
+    bool unsubscribe(const char* topic);
+    bool loop();
+    bool connected();
+    int state() const { return clientState; }
+
+private:
+    bool readByte(uint8_t* value);
+    uint32_t readPacket(uint8_t* headerLength);
+    bool write(uint8_t header, uint8_t* buf, uint16_t length);
+    uint16_t writeString(const char* string, uint8_t* buf, uint16_t pos);
+    size_t buildHeader(uint8_t header, uint8_t* buf, uint16_t length);
+
+    Client* client;
+    uint8_t* buffer;
+    uint16_t bufferSize;
+    uint16_t keepAlive;
+    uint16_t socketTimeout;
+    uint16_t nextMsgId;
+    unsigned long lastOutActivity;
+    unsigned long lastInActivity;
+    bool pingOutstanding;
+    MQTT_CALLBACK_SIGNATURE;
+    String domain;
+    IPAddress ip;
+    uint16_t port;
+    int clientState;
+};
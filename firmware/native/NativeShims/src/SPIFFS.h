@@ -0,0 +1,23 @@
+#pragma once
+#include "FS.h"
+
+/**
+ * @brief The spiffs partition on the host: a directory named by $NATIVE_FS_ROOT, or
+ *        ./native_fs, created by begin(). Its contents outlive the process, like flash.
+ */
+class SPIFFSFS : public fs::FS {
+public:
+    SPIFFSFS();
+    /** @brief A second partition at root, e.g. a scratch directory for a test */
+    explicit SPIFFSFS(const std::string& root) : fs::FS(root) {}
+
+    bool begin(bool formatOnFail = false, const char* basePath = "/spiffs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = nullptr);
+    /** @brief Remove every file */
+    bool format();
+    size_t totalBytes();
+    size_t usedBytes();
+    void end();
+};
+
+extern SPIFFSFS SPIFFS;
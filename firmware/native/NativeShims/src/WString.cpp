@@ -0,0 +1,171 @@
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+
+namespace {
+std::string formatUnsigned(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    if (value == 0) return "0";
+    char digits[65];
+    int pos = 64;
+    digits[pos] = '\0';
+    while (value > 0 && pos > 0) {
+        unsigned digit = static_cast<unsigned>(value % base);
+        digits[--pos] = static_cast<char>(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    }
+    return std::string(&digits[pos]);
+}
+
+std::string formatSigned(long long value, unsigned char base) {
+    // Arduino only prints a sign in base 10; other bases show the two's complement
+    if (base == 10 && value < 0) {
+        return "-" + formatUnsigned(0ULL - static_cast<unsigned long long>(value), 10);
+    }
+    return formatUnsigned(static_cast<unsigned long long>(value), base);
+}
+
+std::string formatFloat(double value, unsigned int decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+    return std::string(buf);
+}
+}
+
+String::String(unsigned char value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(int value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(long long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(float value, unsigned int decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= buffer.size()) {
+        dummy = 0;
+        return dummy;
+    }
+    return buffer[index];
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    return buffer.size() == other.buffer.size() && strcasecmp(buffer.c_str(), other.buffer.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+    if (offset > buffer.size() || prefix.buffer.size() > buffer.size() - offset) return false;
+    return buffer.compare(offset, prefix.buffer.size(), prefix.buffer) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    if (suffix.buffer.size() > buffer.size()) return false;
+    return buffer.compare(buffer.size() - suffix.buffer.size(), suffix.buffer.size(), suffix.buffer) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = buffer.find(c, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+    size_t pos = buffer.find(str.buffer, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(char c) const {
+    return lastIndexOf(c, buffer.empty() ? 0 : static_cast<unsigned int>(buffer.size() - 1));
+}
+
+int String::lastIndexOf(char c, unsigned int from) const {
+    size_t pos = buffer.rfind(c, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(const String& str) const {
+    size_t pos = buffer.rfind(str.buffer);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(const String& str, unsigned int from) const {
+    size_t pos = buffer.rfind(str.buffer, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+String String::substring(unsigned int beginIndex) const {
+    return substring(beginIndex, static_cast<unsigned int>(buffer.size()));
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if (beginIndex > endIndex) {
+        unsigned int tmp = beginIndex;
+        beginIndex = endIndex;
+        endIndex = tmp;
+    }
+    if (beginIndex >= buffer.size()) return String();
+    if (endIndex > buffer.size()) endIndex = static_cast<unsigned int>(buffer.size());
+    return String(buffer.substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::replace(char find, char replacement) {
+    for (size_t i = 0; i < buffer.size(); i++) {
+        if (buffer[i] == find) buffer[i] = replacement;
+    }
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.buffer.empty()) return;
+    size_t pos = 0;
+    while ((pos = buffer.find(find.buffer, pos)) != std::string::npos) {
+        buffer.replace(pos, find.buffer.size(), replacement.buffer);
+        pos += replacement.buffer.size();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < buffer.size()) buffer.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < buffer.size()) buffer.erase(index, count);
+}
+
+void String::toLowerCase() {
+    for (size_t i = 0; i < buffer.size(); i++) buffer[i] = static_cast<char>(tolower(static_cast<unsigned char>(buffer[i])));
+}
+
+void String::toUpperCase() {
+    for (size_t i = 0; i < buffer.size(); i++) buffer[i] = static_cast<char>(toupper(static_cast<unsigned char>(buffer[i])));
+}
+
+void String::trim() {
+    size_t first = 0;
+    while (first < buffer.size() && isspace(static_cast<unsigned char>(buffer[first]))) first++;
+    size_t last = buffer.size();
+    while (last > first && isspace(static_cast<unsigned char>(buffer[last - 1]))) last--;
+    buffer = buffer.substr(first, last - first);
+}
+
+long String::toInt() const { return atol(buffer.c_str()); }
+float String::toFloat() const { return static_cast<float>(atof(buffer.c_str())); }
+double String::toDouble() const { return atof(buffer.c_str()); }
+
+void String::toCharArray(char* buf, unsigned int bufsize, unsigned int index) const {
+    getBytes(reinterpret_cast<unsigned char*>(buf), bufsize, index);
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+    if (!buf || bufsize == 0) return;
+    if (index >= buffer.size()) {
+        buf[0] = 0;
+        return;
+    }
+    size_t n = buffer.size() - index;
+    if (n > bufsize - 1) n = bufsize - 1;
+    buffer.copy(reinterpret_cast<char*>(buf), n, index);
+    buf[n] = 0;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief Arduino String on top of std::string.
+ *
+ * Covers the subset of the Arduino-ESP32 API the firmware uses; semantics (indices,
+ * -1 for "not found", toInt() on garbage returning 0) follow the Arduino core.
+ */
+class String {
+public:
+    String() {}
+    String(const char* cstr) : buffer(cstr ? cstr : "") {}
+    String(const char* cstr, size_t length) : buffer(cstr ? std::string(cstr, length) : std::string()) {}
+    String(const String& other) : buffer(other.buffer) {}
+    String(String&& other) : buffer(std::move(other.buffer)) {}
+    explicit String(const std::string& str) : buffer(str) {}
+    explicit String(char c) : buffer(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+
+    String& operator=(const String& other) { buffer = other.buffer; return *this; }
+    String& operator=(String&& other) { buffer = std::move(other.buffer); return *this; }
+    String& operator=(const char* cstr) { buffer = cstr ? cstr : ""; return *this; }
+
+    unsigned int length() const { return static_cast<unsigned int>(buffer.size()); }
+    bool isEmpty() const { return buffer.empty(); }
+    const char* c_str() const { return buffer.c_str(); }
+    bool reserve(unsigned int size) { buffer.reserve(size); return true; }
+    const char* begin() const { return buffer.c_str(); }
+    const char* end() const { return buffer.c_str() + buffer.size(); }
+
+    bool concat(const String& str) { buffer += str.buffer; return true; }
+    bool concat(const char* cstr) { if (!cstr) return false; buffer += cstr; return true; }
+    bool concat(const char* cstr, unsigned int length) { if (!cstr) return false; buffer.append(cstr, length); return true; }
+    bool concat(char c) { buffer += c; return true; }
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    bool concat(T value) { return concat(String(value)); }
+
+    String& operator+=(const String& str) { concat(str); return *this; }
+    String& operator+=(const char* cstr) { concat(cstr); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    String& operator+=(T value) { concat(String(value)); return *this; }
+
+    char charAt(unsigned int index) const { return index < buffer.size() ? buffer[index] : 0; }
+    void setCharAt(unsigned int index, char c) { if (index < buffer.size()) buffer[index] = c; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index);
+
+    int compareTo(const String& other) const { return buffer.compare(other.buffer); }
+    bool equals(const String& other) const { return buffer == other.buffer; }
+    bool equals(const char* cstr) const { return buffer == (cstr ? cstr : ""); }
+    bool equalsIgnoreCase(const String& other) const;
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& other) const { return buffer < other.buffer; }
+    bool operator>(const String& other) const { return buffer > other.buffer; }
+
+    bool startsWith(const String& prefix) const { return startsWith(prefix, 0); }
+    bool startsWith(const String& prefix, unsigned int offset) const;
+    bool endsWith(const String& suffix) const;
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(char c, unsigned int from) const;
+    int lastIndexOf(const String& str) const;
+    int lastIndexOf(const String& str, unsigned int from) const;
+    String substring(unsigned int beginIndex) const;
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(char find, char replacement);
+    void replace(const String& find, const String& replacement);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+    void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const;
+    void getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const;
+
+    const std::string& str() const { return buffer; }
+
+private:
+    std::string buffer;
+};
+
+inline String operator+(const String& lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, const char* rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const char* lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, char rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(char lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+inline String operator+(const String& lhs, T rhs) { String r(lhs); r += String(rhs); return r; }
+inline bool operator==(const char* lhs, const String& rhs) { return rhs.equals(lhs); }
+inline bool operator!=(const char* lhs, const String& rhs) { return !rhs.equals(lhs); }
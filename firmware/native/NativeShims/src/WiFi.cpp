@@ -0,0 +1,205 @@
+#include "WiFi.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+bool IPAddress::fromString(const char* text) {
+    in_addr parsed;
+    if (!text || inet_pton(AF_INET, text, &parsed) != 1) return false;
+    address = parsed.s_addr;
+    return true;
+}
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+}
+
+wl_status_t WiFiClass::begin(const char* name, const char* passphrase) {
+    (void)passphrase;
+    ssid = name ? name : "";
+    currentStatus = WL_CONNECTED;
+    return currentStatus;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    (void)wifiOff;
+    (void)eraseAp;
+    currentStatus = WL_DISCONNECTED;
+    return true;
+}
+
+bool WiFiClass::reconnect() {
+    currentStatus = WL_CONNECTED;
+    return true;
+}
+
+int WiFiClass::hostByName(const char* host, IPAddress& result) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* info = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &info) != 0 || !info) {
+        return 0;
+    }
+    result = IPAddress(reinterpret_cast<sockaddr_in*>(info->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(info);
+    return 1;
+}
+
+WiFiClient::WiFiClient() : socketFd(-1), peerClosed(false) {}
+
+WiFiClient::~WiFiClient() {
+    stop();
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    return connect(ip.toString().c_str(), port, static_cast<int32_t>(timeout));
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    return connect(host, port, static_cast<int32_t>(timeout));
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    stop();
+    IPAddress ip;
+    if (!WiFi.hostByName(host, ip)) {
+        return 0;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = static_cast<uint32_t>(ip);
+
+    // Non-blocking connect so the timeout applies, then back to blocking for I/O
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    int rc = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    if (rc < 0 && errno == EINPROGRESS) {
+        pollfd pfd = { fd, POLLOUT, 0 };
+        rc = poll(&pfd, 1, timeoutMs > 0 ? timeoutMs : 1000) == 1 ? 0 : -1;
+        if (rc == 0) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+            rc = error == 0 ? 0 : -1;
+        }
+    }
+    if (rc < 0) {
+        close(fd);
+        return 0;
+    }
+    fcntl(fd, F_SETFL, flags);
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+    socketFd = fd;
+    peerClosed = false;
+    return 1;
+}
+
+int WiFiClient::setNoDelay(bool noDelay) {
+    if (socketFd < 0) return -1;
+    int value = noDelay ? 1 : 0;
+    return setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+}
+
+size_t WiFiClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (socketFd < 0) return 0;
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = send(socketFd, buffer + sent, size - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            peerClosed = true;
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return sent;
+}
+
+int WiFiClient::available() {
+    if (socketFd < 0) return 0;
+    int count = 0;
+    if (ioctl(socketFd, FIONREAD, &count) < 0) {
+        return 0;
+    }
+    if (count == 0) {
+        // Distinguish "nothing yet" from an orderly shutdown by the peer
+        pollfd pfd = { socketFd, POLLIN, 0 };
+        if (poll(&pfd, 1, 0) == 1 && (pfd.revents & (POLLIN | POLLHUP))) {
+            uint8_t probe;
+            if (recv(socketFd, &probe, 1, MSG_PEEK | MSG_DONTWAIT) == 0) {
+                peerClosed = true;
+            }
+        }
+    }
+    return count;
+}
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    if (socketFd < 0) return -1;
+    ssize_t n = recv(socketFd, buffer, size, MSG_DONTWAIT);
+    if (n == 0) {
+        peerClosed = true;
+        return -1;
+    }
+    if (n < 0) {
+        return -1;
+    }
+    return static_cast<int>(n);
+}
+
+int WiFiClient::peek() {
+    if (socketFd < 0) return -1;
+    uint8_t c;
+    return recv(socketFd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+void WiFiClient::stop() {
+    if (socketFd >= 0) {
+        close(socketFd);
+        socketFd = -1;
+    }
+    peerClosed = false;
+}
+
+uint8_t WiFiClient::connected() {
+    if (socketFd < 0) return 0;
+    if (!peerClosed) {
+        available(); // Refreshes peerClosed
+    }
+    if (peerClosed) {
+        // Like the ESP32 core: still "connected" while unread data remains
+        int count = 0;
+        ioctl(socketFd, FIONREAD, &count);
+        return count > 0;
+    }
+    return 1;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+#include "IPAddress.h"
+#include "WiFiClient.h"
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+/**
+ * @brief The host's network stands in for the station interface. It reports connected
+ *        until disconnect() or setConnected(false) is called.
+ */
+class WiFiClass {
+public:
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    bool reconnect();
+    bool mode(wifi_mode_t m) { currentMode = m; return true; }
+    wifi_mode_t getMode() const { return currentMode; }
+    wl_status_t status() const { return currentStatus; }
+    bool isConnected() const { return currentStatus == WL_CONNECTED; }
+    void setConnected(bool connected) { currentStatus = connected ? WL_CONNECTED : WL_DISCONNECTED; }
+    bool setAutoReconnect(bool autoReconnect) { (void)autoReconnect; return true; }
+    bool setHostname(const char* name) { hostname = name; return true; }
+    const char* getHostname() const { return hostname.c_str(); }
+    void setSleep(bool enabled) { (void)enabled; }
+
+    IPAddress localIP() const { return IPAddress(127, 0, 0, 1); }
+    IPAddress gatewayIP() const { return IPAddress(127, 0, 0, 1); }
+    IPAddress subnetMask() const { return IPAddress(255, 0, 0, 0); }
+    String SSID() const { return ssid; }
+    int8_t RSSI() const { return -50; }
+    String macAddress() const { return "02:00:00:00:00:01"; }
+
+    int hostByName(const char* host, IPAddress& result);
+
+private:
+    wl_status_t currentStatus = WL_CONNECTED;
+    wifi_mode_t currentMode = WIFI_STA;
+    String ssid = "native";
+    String hostname = "native";
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,35 @@
+#pragma once
+#include "Client.h"
+
+/**
+ * @brief TCP client over a host socket.
+ */
+class WiFiClient : public Client {
+public:
+    WiFiClient();
+    ~WiFiClient() override;
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(const char* host, uint16_t port, int32_t timeoutMs);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+
+    int fd() const { return socketFd; }
+    int setNoDelay(bool noDelay);
+
+protected:
+    int socketFd;
+    bool peerClosed;
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include "WiFi.h" // As in the ESP32 core, which callers rely on for wl_status_t
+
+/**
+ * @brief Plain TCP on the host: TLS is not emulated. Point the firmware at a
+ *        non-TLS endpoint (e.g. a local broker) when running natively.
+ */
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+    void setCACert(const char* rootCA) { (void)rootCA; }
+    void setCertificate(const char* cert) { (void)cert; }
+    void setPrivateKey(const char* key) { (void)key; }
+    void setSSLHostname(const char* hostname) { (void)hostname; }
+    void setHandshakeTimeout(unsigned long seconds) { (void)seconds; }
+    int lastError(char* buf, const size_t size) {
+        if (buf && size) buf[0] = '\0';
+        return 0;
+    }
+};
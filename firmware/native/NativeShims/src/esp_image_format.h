@@ -0,0 +1,4 @@
+#pragma once
+#include <stdint.h>
+
+#define ESP_IMAGE_HEADER_MAGIC 0xE9
@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// No flash partitions on the host: lookups return nullptr, operations ESP_ERR_NOT_SUPPORTED
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_APP_FACTORY = 0x00,
+    ESP_PARTITION_SUBTYPE_APP_OTA_0 = 0x10,
+    ESP_PARTITION_SUBTYPE_APP_OTA_1 = 0x11,
+    ESP_PARTITION_SUBTYPE_DATA_NVS = 0x02,
+    ESP_PARTITION_SUBTYPE_DATA_SPIFFS = 0x82,
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+inline const esp_partition_t* esp_partition_find_first(esp_partition_type_t, esp_partition_subtype_t, const char*) {
+    return nullptr;
+}
+inline esp_err_t esp_partition_read(const esp_partition_t*, size_t, void*, size_t) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+inline esp_err_t esp_partition_write(const esp_partition_t*, size_t, const void*, size_t) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+inline esp_err_t esp_partition_erase_range(const esp_partition_t*, size_t, size_t) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "FreeRTOS.h"
+
+struct NativeTask;
+typedef NativeTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId);
+BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                       void* parameters, UBaseType_t priority, TaskHandle_t* handle);
+/** @brief Only deleting the calling task (nullptr) is supported: it ends the calling thread */
+void vTaskDelete(TaskHandle_t task);
+/** @brief The calling thread's task; threads not started by xTaskCreate get one on first call */
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+void taskYieldNative();
+#define taskYIELD() taskYieldNative()
+
+// Direct-to-task notifications used as a counting semaphore
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+#define portYIELD_FROM_ISR(...) ((void)0)
@@ -0,0 +1,195 @@
+#include "mbedtls/base64.h"
+#include "mbedtls/error.h"
+#include "mbedtls/md.h"
+#include <stdio.h>
+#include <string.h>
+
+struct mbedtls_md_info_t {
+    mbedtls_md_type_t type;
+    unsigned char size;
+};
+
+namespace {
+const mbedtls_md_info_t md5Info = { MBEDTLS_MD_MD5, 16 };
+
+// RFC 1321
+const uint32_t kSine[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+const uint8_t kShift[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21,
+};
+
+void md5Block(uint32_t state[4], const uint8_t block[64]) {
+    uint32_t m[16];
+    for (int i = 0; i < 16; i++) {
+        m[i] = block[i * 4] | (block[i * 4 + 1] << 8) | (block[i * 4 + 2] << 16) | (static_cast<uint32_t>(block[i * 4 + 3]) << 24);
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    for (int i = 0; i < 64; i++) {
+        uint32_t f;
+        int g;
+        if (i < 16) {
+            f = (b & c) | (~b & d);
+            g = i;
+        } else if (i < 32) {
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) % 16;
+        } else if (i < 48) {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) % 16;
+        } else {
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+        }
+        uint32_t rotated = a + f + kSine[i] + m[g];
+        a = d;
+        d = c;
+        c = b;
+        b = b + ((rotated << kShift[i]) | (rotated >> (32 - kShift[i])));
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+const char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int base64Value(unsigned char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+}
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t type) {
+    return type == MBEDTLS_MD_MD5 ? &md5Info : nullptr;
+}
+
+void mbedtls_md_init(mbedtls_md_context_t* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_md_free(mbedtls_md_context_t* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_md_setup(mbedtls_md_context_t* ctx, const mbedtls_md_info_t* info, int hmac) {
+    if (!ctx || !info || hmac) return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    ctx->info = info;
+    return 0;
+}
+
+int mbedtls_md_starts(mbedtls_md_context_t* ctx) {
+    if (!ctx || !ctx->info) return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    ctx->state[0] = 0x67452301;
+    ctx->state[1] = 0xefcdab89;
+    ctx->state[2] = 0x98badcfe;
+    ctx->state[3] = 0x10325476;
+    ctx->length = 0;
+    return 0;
+}
+
+int mbedtls_md_update(mbedtls_md_context_t* ctx, const unsigned char* input, size_t ilen) {
+    if (!ctx || !ctx->info) return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    size_t used = static_cast<size_t>(ctx->length % 64);
+    ctx->length += ilen;
+    while (ilen > 0) {
+        size_t take = 64 - used < ilen ? 64 - used : ilen;
+        memcpy(ctx->block + used, input, take);
+        used += take;
+        input += take;
+        ilen -= take;
+        if (used == 64) {
+            md5Block(ctx->state, ctx->block);
+            used = 0;
+        }
+    }
+    return 0;
+}
+
+int mbedtls_md_finish(mbedtls_md_context_t* ctx, unsigned char* output) {
+    if (!ctx || !ctx->info) return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    uint64_t bits = ctx->length * 8;
+    size_t used = static_cast<size_t>(ctx->length % 64);
+    ctx->block[used++] = 0x80;
+    if (used > 56) {
+        memset(ctx->block + used, 0, 64 - used);
+        md5Block(ctx->state, ctx->block);
+        used = 0;
+    }
+    memset(ctx->block + used, 0, 56 - used);
+    for (int i = 0; i < 8; i++) {
+        ctx->block[56 + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+    md5Block(ctx->state, ctx->block);
+    for (int i = 0; i < 16; i++) {
+        output[i] = static_cast<uint8_t>(ctx->state[i / 4] >> (8 * (i % 4)));
+    }
+    return 0;
+}
+
+unsigned char mbedtls_md_get_size(const mbedtls_md_info_t* info) {
+    return info ? info->size : 0;
+}
+
+int mbedtls_base64_encode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen) {
+    size_t needed = ((slen + 2) / 3) * 4;
+    if (!dst || dlen < needed + 1) {
+        *olen = needed + 1;
+        return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+    }
+    size_t out = 0;
+    for (size_t i = 0; i < slen; i += 3) {
+        uint32_t triple = src[i] << 16;
+        if (i + 1 < slen) triple |= src[i + 1] << 8;
+        if (i + 2 < slen) triple |= src[i + 2];
+        dst[out++] = kBase64[(triple >> 18) & 0x3F];
+        dst[out++] = kBase64[(triple >> 12) & 0x3F];
+        dst[out++] = i + 1 < slen ? kBase64[(triple >> 6) & 0x3F] : '=';
+        dst[out++] = i + 2 < slen ? kBase64[triple & 0x3F] : '=';
+    }
+    dst[out] = 0;
+    *olen = out;
+    return 0;
+}
+
+int mbedtls_base64_decode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen) {
+    uint32_t accumulator = 0;
+    int bits = 0;
+    size_t out = 0;
+    for (size_t i = 0; i < slen; i++) {
+        if (src[i] == '=' || src[i] == '\r' || src[i] == '\n') continue;
+        int value = base64Value(src[i]);
+        if (value < 0) return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+        accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            if (dst && out < dlen) dst[out] = static_cast<unsigned char>(accumulator >> bits);
+            out++;
+        }
+    }
+    *olen = out;
+    return (!dst || out > dlen) ? MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL : 0;
+}
+
+void mbedtls_strerror(int errnum, char* buffer, size_t buflen) {
+    if (buffer && buflen) {
+        snprintf(buffer, buflen, "mbedtls error -0x%04X", errnum < 0 ? -errnum : errnum);
+    }
+}
@@ -0,0 +1,4 @@
+#pragma once
+#include <stddef.h>
+
+void mbedtls_strerror(int errnum, char* buffer, size_t buflen);
@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+
+// Register view of the simulated GPIO bank. Writes through w1ts/w1tc are not reflected
+// into digitalRead(); NativeShim::setPinInput() keeps in/in1 in sync with input pins.
+typedef struct {
+    volatile uint32_t out;
+    volatile uint32_t out_w1ts;
+    volatile uint32_t out_w1tc;
+    volatile uint32_t in;
+    struct { volatile uint32_t val; } out1;
+    struct { volatile uint32_t val; } out1_w1ts;
+    struct { volatile uint32_t val; } out1_w1tc;
+    struct { volatile uint32_t data; } in1;
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
@@ -0,0 +1,99 @@
+"""
+Record a Bambu printer's device/<serial>/report traffic for the replay bench
+(src/replay, env:replay_bambu).
+
+Each message is written as one line: "<ms since start>\t<topic>\t<payload>".
+Report payloads are JSON, so the only raw newlines they can contain are
+whitespace and are folded into spaces.
+
+Usage:
+  pip install paho-mqtt
+  python scripts/capture_bambu_reports.py PRINTER_IP SERIAL ACCESS_CODE capture.log
+      [--minutes 30] [--pushall-every 0] [--port 8883] [--no-tls]
+
+--pushall-every N requests a full status report every N seconds (0: only once
+at start), which is how the firmware's heartbeat drives the printer.
+"""
+
+import argparse
+import json
+import ssl
+import sys
+import time
+
+import paho.mqtt.client as mqtt
+
+
+def make_client():
+    # paho-mqtt 2.x wants the callback API version; 1.x does not know the argument
+    if hasattr(mqtt, "CallbackAPIVersion"):
+        return mqtt.Client(mqtt.CallbackAPIVersion.VERSION1)
+    return mqtt.Client()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("ip")
+    parser.add_argument("serial")
+    parser.add_argument("access_code")
+    parser.add_argument("output")
+    parser.add_argument("--port", type=int, default=8883)
+    parser.add_argument("--no-tls", action="store_true")
+    parser.add_argument("--minutes", type=float, default=30.0)
+    parser.add_argument("--pushall-every", type=float, default=0.0)
+    args = parser.parse_args()
+
+    report_topic = "device/%s/report" % args.serial
+    request_topic = "device/%s/request" % args.serial
+    pushall = json.dumps({"pushing": {"sequence_id": "0", "command": "pushall"}})
+
+    out = open(args.output, "w", encoding="utf-8", newline="\n")
+    out.write("# capture of %s from %s started %s\n" % (report_topic, args.ip, time.strftime("%Y-%m-%d %H:%M:%S")))
+    start = time.monotonic()
+    count = [0]
+
+    def on_connect(client, userdata, flags, rc):
+        if rc != 0:
+            print("connect failed: rc=%d" % rc, file=sys.stderr)
+            return
+        client.subscribe(report_topic)
+        client.publish(request_topic, pushall)
+        print("connected, recording %s" % report_topic)
+
+    def on_message(client, userdata, message):
+        elapsed = int((time.monotonic() - start) * 1000)
+        payload = message.payload.decode("utf-8", errors="replace").replace("\r", " ").replace("\n", " ")
+        out.write("%d\t%s\t%s\n" % (elapsed, message.topic, payload))
+        count[0] += 1
+
+    client = make_client()
+    client.username_pw_set("bblp", args.access_code)
+    if not args.no_tls:
+        # Bambu printers present a self-signed certificate
+        client.tls_set(cert_reqs=ssl.CERT_NONE)
+        client.tls_insecure_set(True)
+    client.on_connect = on_connect
+    client.on_message = on_message
+    client.connect(args.ip, args.port, keepalive=15)
+    client.loop_start()
+
+    deadline = start + args.minutes * 60
+    next_pushall = start + args.pushall_every if args.pushall_every > 0 else None
+    try:
+        while time.monotonic() < deadline:
+            time.sleep(0.2)
+            if next_pushall is not None and time.monotonic() >= next_pushall:
+                client.publish(request_topic, pushall)
+                next_pushall += args.pushall_every
+    except KeyboardInterrupt:
+        pass
+    finally:
+        client.loop_stop()
+        client.disconnect()
+        out.close()
+
+    print("recorded %d messages to %s" % (count[0], args.output))
+
+
+if __name__ == "__main__":
+    main()
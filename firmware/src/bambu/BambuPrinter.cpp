@@ -1,10 +1,37 @@
 #include "BambuPrinter.h"
+#include <Crc32.h>
 #include <Utils.h>
 
+namespace {
+// Every key read by parsePrintStatus/parseAMSStatus/parseHMSErrors/parseUpgradeStatus.
+// Anything not listed here is skipped during deserialization, so a parser that starts
+// reading a new key must add it here as well.
+constexpr char kReportFilterJson[] = R"json({
+    "print": {
+        "gcode_state": true,
+        "print_error": true,
+        "layer_num": true,
+        "total_layer_num": true,
+        "msg": true,
+        "mc_percent": true,
+        "mc_remaining_time": true
+    },
+    "ams": {
+        "ams_status": true,
+        "ams_rfid_status": true,
+        "tray": [{ "id": true, "tray_type": true, "remain": true, "tag_uid": true, "tray_now": true }]
+    },
+    "hms": [{ "code": true, "severity": true, "msg": true }],
+    "upgrade": { "status": true, "progress": true }
+})json";
+}
+
 BambuPrinter::BambuPrinter(MotorController* motor) :
     BasePrinter(),
     motorController(motor),
     mixedWasteValve(20),
+    reportCount(0),
+    reportErrors(0),
     lastHeartbeat(0),
     lastStatusUpdate(0),
     activeValvePosition(-1),
@@ -34,13 +61,6 @@ BambuPrinter::BambuPrinter(MotorController* motor) :
         amsStatus.remaining[i] = 0;
         amsStatus.tagUIDs[i] = "";
     }
-    
-    // Register Bambu-specific commands
-    commandHandlers["VALVE_ACTIVATE"] = [this](const String& p) { cmdValveActivate(p); };
-    commandHandlers["VALVE_DEACTIVATE"] = [this](const String& p) { cmdValveDeactivate(p); };
-    commandHandlers["ROUTE_PURE_WASTE"] = [this](const String& p) { cmdRoutePureWaste(p); };
-    commandHandlers["ROUTE_MIXED_WASTE"] = [this](const String& p) { cmdRouteMixedWaste(p); };
-    commandHandlers["MATERIAL_CHANGE"] = [this](const String& p) { cmdMaterialChange(p); };
 }
 
 BambuPrinter::~BambuPrinter() {
@@ -142,17 +162,18 @@ bool BambuPrinter::loadConfigFromProvisioning() {
     String raw = p.getString(NVS_PRINTER_CONN, "");
     p.end();
 
-    LOG_I("Bambu", "Loaded printer meta: brand='" + printer_brand + "' model='" + printer_model + "' name='" + printer_name + "' id='" + printer_id + "'");
+    LOG_IF("Bambu", "Loaded printer meta: brand='%s' model='%s' name='%s' id='%s'",
+           printer_brand.c_str(), printer_model.c_str(), printer_name.c_str(), printer_id.c_str());
 
     if (raw.isEmpty()) {
-        LOG_E("Bambu", "No printer_connection_data found under '" + String(NVS_PRINTER_CONN) + "'");
+        LOG_EF("Bambu", "No printer_connection_data found under '%s'", NVS_PRINTER_CONN);
         return false;
     }
 
     JsonDocument doc;
     auto jsonErr = deserializeJson(doc, raw);
     if (jsonErr != DeserializationError::Ok) {
-        LOG_E("Bambu", String("Failed to parse printer_connection_data: ") + jsonErr.c_str());
+        LOG_EF("Bambu", "Failed to parse printer_connection_data: %s", jsonErr.c_str());
         return false;
     }
 
@@ -169,11 +190,9 @@ bool BambuPrinter::loadConfigFromProvisioning() {
         config.useTLS = true; // default for Bambu MQTT
     }
 
-    LOG_I("Bambu", "Connection params: ip=" + config.printerIP + 
-                  ", serial=" + config.serialNumber + 
-                  ", port=" + String(config.mqttPort) + 
-                  ", tls=" + String(config.useTLS ? "true" : "false") +
-                  ", access code=" + String(config.accessCode));
+    LOG_IF("Bambu", "Connection params: ip=%s, serial=%s, port=%d, tls=%s, access code=%s",
+           config.printerIP.c_str(), config.serialNumber.c_str(), config.mqttPort,
+           config.useTLS ? "true" : "false", config.accessCode.c_str());
     if (config.accessCode.isEmpty()) {
         LOG_W("Bambu", "Access code is missing; MQTT auth will likely fail (rc=5)");
     }
@@ -198,6 +217,7 @@ void BambuPrinter::disconnect() {
 void BambuPrinter::loop() {
     unsigned long currentTime = millis();
 
+    runDeferredActions();
     mqttService.loop();
     if (mqttService.isConnected()) {
         connectionState = ConnectionState::CONNECTED;
@@ -372,64 +392,76 @@ void BambuPrinter::configure(const BambuConfig& cfg) {
     config = cfg;
     reportTopic = "device/" + config.serialNumber + "/report";
     commandTopic = "device/" + config.serialNumber + "/request";
-    LOG_I("Bambu", "Configured for printer: " + config.serialNumber);
+    LOG_IF("Bambu", "Configured for printer: %s", config.serialNumber.c_str());
 }
 
 void BambuPrinter::configureValveMappings(const std::vector<ValveMapping>& mappings) {
     valveMappings = mappings;
-    LOG_I("Bambu", "Configured " + String(mappings.size()) + " valve mappings");
+    LOG_IF("Bambu", "Configured %u valve mappings", static_cast<unsigned>(mappings.size()));
     
     for (const auto& mapping : mappings) {
-        LOG_D("Bambu", "AMS Slot " + String(mapping.amsSlot) + " (" + mapping.material + 
-              ") -> Valve " + String(mapping.valvePosition) + 
-              " (" + (mapping.isPureWaste ? "PURE" : "MIXED") + ")");
+        LOG_DF("Bambu", "AMS Slot %d (%s) -> Valve %d (%s)", mapping.amsSlot, mapping.material.c_str(),
+               mapping.valvePosition, mapping.isPureWaste ? "PURE" : "MIXED");
     }
 }
 
+bool BambuPrinter::dispatchDriverCommand(const CommandArg& command, const CommandArg& params) {
+    static constexpr CommandEntry<BambuPrinter> kCommands[] = {
+        ESP32_COMMAND("VALVE_ACTIVATE", &BambuPrinter::cmdValveActivate),
+        ESP32_COMMAND("VALVE_DEACTIVATE", &BambuPrinter::cmdValveDeactivate),
+        ESP32_COMMAND("ROUTE_PURE_WASTE", &BambuPrinter::cmdRoutePureWaste),
+        ESP32_COMMAND("ROUTE_MIXED_WASTE", &BambuPrinter::cmdRouteMixedWaste),
+        ESP32_COMMAND("MATERIAL_CHANGE", &BambuPrinter::cmdMaterialChange),
+    };
+    static constexpr auto kCommandTable = makeCommandTable(kCommands);
+    static_assert(kCommandTable.seed != command_table::kNoSeed, "No perfect hash seed for Bambu commands");
+
+    return kCommandTable.dispatch(*this, command, params);
+}
+
 // Override command handlers
 
-void BambuPrinter::cmdStartingPurge(const String& params) {
+void BambuPrinter::cmdStartingPurge(const CommandArg& params) {
     BasePrinter::cmdStartingPurge(params);
     
     // Unpause printer after 1 second
-    delay(1000);
-    resumePrint();
+    scheduleResume(1000);
 }
 
-void BambuPrinter::cmdWasteBallComplete(const String& params) {
+void BambuPrinter::cmdWasteBallComplete(const CommandArg& params) {
     BasePrinter::cmdWasteBallComplete(params);
-    cmdRoutePureWaste("");
+    cmdRoutePureWaste(CommandArg());
 }
 
-void BambuPrinter::cmdCleanBallComplete(const String& params) {
+void BambuPrinter::cmdCleanBallComplete(const CommandArg& params) {
     BasePrinter::cmdCleanBallComplete(params);
-    cmdRouteMixedWaste("");
+    cmdRouteMixedWaste(CommandArg());
 }
 
-void BambuPrinter::cmdPauseForESP(const String& params) {
+void BambuPrinter::cmdPauseForESP(const CommandArg& params) {
     BasePrinter::cmdPauseForESP(params);
     
-    // Check if motor is ready and unpause
-    if (motorController && motorController->getState() == MotorController::MotorState::IDLE) {
-        delay(500);
-        resumePrint();
-        commandState.isPaused = false;
+    // Check if motor is ready and unpause; a move queued earlier in this report counts
+    // as busy even before the motion task has picked it up
+    if (motorController && motorController->getState() == MotorController::MotorState::IDLE &&
+        !motorController->isBusy()) {
+        scheduleResume(500, [this]() { commandState.isPaused = false; });
     }
 }
 
 // Bambu-specific command handlers
 
-void BambuPrinter::cmdValveActivate(const String& params) {
+void BambuPrinter::cmdValveActivate(const CommandArg& params) {
     int position = params.toInt();
     if (position >= 1 && position <= 20) {
         logAction("Activating valve " + String(position));
         activateValve(position);
     } else {
-        LOG_E("Bambu", "Invalid valve position: " + params);
+        LOG_EF("Bambu", "Invalid valve position: %.*s", static_cast<int>(params.length), params.data);
     }
 }
 
-void BambuPrinter::cmdValveDeactivate(const String& params) {
+void BambuPrinter::cmdValveDeactivate(const CommandArg& params) {
     int position = params.toInt();
     if (position == activeValvePosition) {
         logAction("Deactivating valve " + String(position));
@@ -437,7 +469,7 @@ void BambuPrinter::cmdValveDeactivate(const String& params) {
     }
 }
 
-void BambuPrinter::cmdRoutePureWaste(const String& params) {
+void BambuPrinter::cmdRoutePureWaste(const CommandArg& params) {
     if (amsStatus.activeSlot >= 0) {
         int valvePos = findValveForSlot(amsStatus.activeSlot, true);
         if (valvePos > 0) {
@@ -445,17 +477,17 @@ void BambuPrinter::cmdRoutePureWaste(const String& params) {
                      " to Valve " + String(valvePos));
             activateValve(valvePos);
         } else {
-            LOG_W("Bambu", "No pure waste valve mapping for slot " + String(amsStatus.activeSlot));
+            LOG_WF("Bambu", "No pure waste valve mapping for slot %d", amsStatus.activeSlot);
         }
     }
 }
 
-void BambuPrinter::cmdRouteMixedWaste(const String& params) {
+void BambuPrinter::cmdRouteMixedWaste(const CommandArg& params) {
     logAction("Routing mixed waste to Valve " + String(mixedWasteValve));
     activateValve(mixedWasteValve);
 }
 
-void BambuPrinter::cmdMaterialChange(const String& params) {
+void BambuPrinter::cmdMaterialChange(const CommandArg& params) {
     String oldMat, newMat;
     parseMaterialChangeParams(params, oldMat, newMat);
     
@@ -479,28 +511,36 @@ void BambuPrinter::cmdMaterialChange(const String& params) {
 
 // MQTT callback
 void BambuPrinter::mqttCallback(char* topic, uint8_t* payload, unsigned int length) {
-    // Convert payload to string
-    String message;
-    message.reserve(length + 1);
-    for (unsigned int i = 0; i < length; i++) {
-        message += (char)payload[i];
-    }
-    
-    LOG_D("Bambu", "MQTT message received on " + String(topic));
-    
-    // Parse JSON using a static non-deprecated document to avoid heap churn
-    static JsonDocument doc; // ArduinoJson v7; static persists capacity across calls
+    LOG_DF("Bambu", "MQTT message received on %s", topic);
+    ingestReport(payload, length);
+}
+
+void BambuPrinter::ingestReport(const uint8_t* payload, unsigned int length) {
+    // Deserialize straight from PubSubClient's receive buffer. The filter keeps only
+    // the keys the parsers below read, so a multi-KB pushall ends up as a small DOM.
+    static JsonDocument doc; // ArduinoJson v7
     doc.clear();
-    DeserializationError error = deserializeJson(doc, message);
+    DeserializationError error = deserializeJson(doc, reinterpret_cast<const char*>(payload), length,
+                                                 DeserializationOption::Filter(reportFilter()));
     
     if (error) {
-        LOG_E("Bambu", "Failed to parse MQTT JSON: " + String(error.c_str()));
+        reportErrors++;
+        LOG_EF("Bambu", "Failed to parse MQTT JSON: %s", error.c_str());
         return;
     }
     
+    reportCount++;
     parseReportMessage(doc);
 }
 
+const JsonDocument& BambuPrinter::reportFilter() {
+    static JsonDocument filter;
+    if (filter.isNull()) {
+        deserializeJson(filter, kReportFilterJson);
+    }
+    return filter;
+}
+
 // Message Parsing
 
 void BambuPrinter::parseReportMessage(const JsonDocument& doc) {
@@ -546,13 +586,13 @@ void BambuPrinter::parsePrintStatus(const JsonObjectConst& print) {
         currentStatus.totalLayers = print["total_layer_num"];
     }
     
-    // Check for ESP32 commands in msg field
-    if (print["msg"].is<String>()) {
-        String msg = print["msg"].as<String>();
+    // Check for ESP32 commands in msg field; the command is sliced out of the JSON buffer
+    if (print["msg"].is<const char*>()) {
+        CommandArg msg(print["msg"].as<const char*>());
         if (!msg.isEmpty()) {
-            String command = extractESP32Command(msg);
+            CommandArg command = extractESP32Command(msg);
             if (!command.isEmpty()) {
-                LOG_I("Bambu", "ESP32 command detected: " + command);
+                LOG_IF("Bambu", "ESP32 command detected: %.*s", static_cast<int>(command.length), command.data);
                 parseESP32CommandFromMessage(command);
             }
         }
@@ -574,65 +614,108 @@ void BambuPrinter::parsePrintStatus(const JsonObjectConst& print) {
 }
 
 void BambuPrinter::parseAMSStatus(const JsonObjectConst& ams) {
-    // Reset AMS state to avoid stale entries
-    amsStatus.activeSlot = -1;
-    for (int i = 0; i < 4; i++) {
-        amsStatus.loaded[i] = false;
-        amsStatus.materials[i] = "";
-        amsStatus.remaining[i] = 0;
-        amsStatus.tagUIDs[i] = "";
+    // Bambu mostly sends partial reports, so merge instead of rebuilding the slots
+    uint32_t changed = mergeAMSStatus(amsStatus, ams);
+    if (changed != 0) {
+        onAMSChanged(changed);
     }
+    // Every report counts toward clearing a level alert, not just ones that change it
+    monitorFilamentLevels();
+}
+
+uint32_t BambuPrinter::mergeAMSStatus(AMSStatus& state, const JsonObjectConst& ams) {
+    uint32_t changed = 0;
+
     if (ams["ams_status"].is<int>()) {
-        amsStatus.status = ams["ams_status"];
+        int status = ams["ams_status"];
+        if (status != state.status) {
+            state.status = status;
+            changed |= AMS_STATUS_CHANGED;
+        }
     }
     
     if (ams["ams_rfid_status"].is<int>()) {
-        amsStatus.rfidStatus = ams["ams_rfid_status"];
-    }
-    
-    // Parse tray information
-    if (ams["tray"].is<JsonArray>() || ams["tray"].is<JsonArrayConst>()) {
-        JsonArrayConst trays = ams["tray"];
-        for (JsonVariantConst trayVar : trays) {
-            JsonObjectConst tray = trayVar.as<JsonObjectConst>();
-            
-            if (!tray["id"].isNull()) {
-                int slotId = -1;
-                if (tray["id"].is<int>()) {
-                    slotId = tray["id"].as<int>();
-                } else if (tray["id"].is<String>()) {
-                    slotId = tray["id"].as<String>().toInt();
-                }
-                if (slotId >= 0 && slotId < 4) {
-                    amsStatus.loaded[slotId] = true;
-                    
-                    if (tray["tray_type"].is<String>()) {
-                        amsStatus.materials[slotId] = tray["tray_type"].as<String>();
-                    }
-                    
-                    if (tray["remain"].is<int>()) {
-                        amsStatus.remaining[slotId] = tray["remain"];
-                        monitorFilamentLevel(slotId, amsStatus.remaining[slotId]);
-                    }
-                    
-                    if (tray["tag_uid"].is<String>()) {
-                        amsStatus.tagUIDs[slotId] = tray["tag_uid"].as<String>();
-                    }
-                    
-                    if (tray["tray_now"].is<bool>() && tray["tray_now"]) {
-                        amsStatus.activeSlot = slotId;
-                        currentStatus.currentMaterial = amsStatus.materials[slotId];
-                    }
-                }
+        int rfidStatus = ams["ams_rfid_status"];
+        if (rfidStatus != state.rfidStatus) {
+            state.rfidStatus = rfidStatus;
+            changed |= AMS_RFID_STATUS_CHANGED;
+        }
+    }
+    
+    // Parse tray information; a missing "tray" array leaves every slot untouched
+    JsonArrayConst trays = ams["tray"];
+    for (JsonVariantConst trayVar : trays) {
+        JsonObjectConst tray = trayVar.as<JsonObjectConst>();
+        
+        int slotId = -1;
+        if (tray["id"].is<int>()) {
+            slotId = tray["id"].as<int>();
+        } else if (tray["id"].is<const char*>()) {
+            slotId = atoi(tray["id"].as<const char*>());
+        }
+        if (slotId < 0 || slotId >= 4) {
+            continue;
+        }
+
+        if (!state.loaded[slotId]) {
+            state.loaded[slotId] = true;
+            changed |= amsSlotBit(slotId, AMS_SLOT_LOADED);
+        }
+        
+        // Compare against the JSON buffer first so unchanged fields cost no String copy
+        if (tray["tray_type"].is<const char*>()) {
+            const char* material = tray["tray_type"];
+            if (state.materials[slotId] != material) {
+                state.materials[slotId] = material;
+                changed |= amsSlotBit(slotId, AMS_SLOT_MATERIAL);
+            }
+        }
+        
+        if (tray["remain"].is<int>()) {
+            int remaining = tray["remain"];
+            if (remaining != state.remaining[slotId]) {
+                state.remaining[slotId] = remaining;
+                changed |= amsSlotBit(slotId, AMS_SLOT_REMAINING);
+            }
+        }
+        
+        if (tray["tag_uid"].is<const char*>()) {
+            const char* tagUID = tray["tag_uid"];
+            if (state.tagUIDs[slotId] != tagUID) {
+                state.tagUIDs[slotId] = tagUID;
+                changed |= amsSlotBit(slotId, AMS_SLOT_TAG_UID);
+            }
+        }
+        
+        if (tray["tray_now"].is<bool>()) {
+            bool inUse = tray["tray_now"];
+            if (inUse && state.activeSlot != slotId) {
+                state.activeSlot = slotId;
+                changed |= AMS_ACTIVE_SLOT_CHANGED;
+            } else if (!inUse && state.activeSlot == slotId) {
+                state.activeSlot = -1;
+                changed |= AMS_ACTIVE_SLOT_CHANGED;
             }
         }
     }
     
-    checkFilamentLevels();
+    return changed;
+}
+
+void BambuPrinter::onAMSChanged(uint32_t changed) {
+    int active = amsStatus.activeSlot;
+    if (active >= 0 && (changed & (AMS_ACTIVE_SLOT_CHANGED | amsSlotBit(active, AMS_SLOT_MATERIAL)))) {
+        currentStatus.currentMaterial = amsStatus.materials[active];
+    }
+
+    // One diffed push per report; notifyStatusUpdate() drops it if nothing published changed
+    notifyStatusUpdate(currentStatus);
 }
 
 void BambuPrinter::parseHMSErrors(const JsonArrayConst& hms) {
     activeErrors.clear();
+    // The report lists every active error; those missing from it have cleared
+    alertEngine.beginSweep(AlertEngine::SOURCE_HMS);
     
     for (JsonVariantConst errorVar : hms) {
         JsonObjectConst error = errorVar.as<JsonObjectConst>();
@@ -653,6 +736,9 @@ void BambuPrinter::parseHMSErrors(const JsonArrayConst& hms) {
         
         handleHMSError(hmsError.code, hmsError.severity, hmsError.message);
     }
+    alertEngine.endSweep(AlertEngine::SOURCE_HMS, [this](const AlertEngine::Key& key, AlertEngine::Transition) {
+        logAlertCleared(key);
+    });
 }
 
 void BambuPrinter::parseUpgradeStatus(const JsonObjectConst& upgrade) {
@@ -660,11 +746,11 @@ void BambuPrinter::parseUpgradeStatus(const JsonObjectConst& upgrade) {
     int progress = upgrade["progress"];
     
     if (status == "downloading" || status == "installing") {
-        LOG_I("Bambu", "Firmware upgrade in progress: " + status + " (" + String(progress) + "%)");
+        LOG_IF("Bambu", "Firmware upgrade in progress: %s (%d%%)", status.c_str(), progress);
     }
 }
 
-String BambuPrinter::extractESP32Command(const String& msg) {
+CommandArg BambuPrinter::extractESP32Command(const CommandArg& msg) {
     if (msg.startsWith("ESP32:")) {
         return msg;
     }
@@ -675,7 +761,7 @@ String BambuPrinter::extractESP32Command(const String& msg) {
         return msg.substring(idx);
     }
     
-    return "";
+    return CommandArg();
 }
 
 // State Management
@@ -691,8 +777,12 @@ void BambuPrinter::updatePrinterState(const String& gcode) {
 }
 
 void BambuPrinter::updatePrintError(int errorCode) {
+    // Every report repeats print_error: a changed code forces a status snapshot, while the
+    // alert for it goes through the engine's flap window and rate limit
+    bool newError = errorCode != currentStatus.printError;
     currentStatus.printError = errorCode;
-    
+
+    alertEngine.beginSweep(AlertEngine::SOURCE_PRINT_ERROR);
     if (errorCode != 0) {
         String errorMsg;
         BasePrinter::AlertLevel level = BasePrinter::AlertLevel::ALERT_HIGH;
@@ -724,19 +814,16 @@ void BambuPrinter::updatePrintError(int errorCode) {
         }
         
         currentStatus.errorMessage = errorMsg;
-        onError(errorCode, errorMsg);
-        sendAlert(level, "Print Error", errorMsg);
-    }
-}
-
-void BambuPrinter::checkFilamentLevels() {
-    for (int i = 0; i < 4; i++) {
-        if (amsStatus.loaded[i]) {
-            monitorFilamentLevel(i, amsStatus.remaining[i]);
+        if (newError) {
+            onError(errorCode, errorMsg);
+        }
+        if (alertRaised({AlertEngine::SOURCE_PRINT_ERROR, static_cast<uint32_t>(errorCode), -1}, level)) {
+            sendAlert(level, "Print Error", errorMsg);
         }
-
-        notifyStatusUpdate(currentStatus, true);
     }
+    alertEngine.endSweep(AlertEngine::SOURCE_PRINT_ERROR, [this](const AlertEngine::Key& key, AlertEngine::Transition) {
+        logAlertCleared(key);
+    });
 }
 
 void BambuPrinter::handleHMSError(const String& code, const String& severity, const String& msg) {
@@ -745,23 +832,35 @@ void BambuPrinter::handleHMSError(const String& code, const String& severity, co
     }
     
     BasePrinter::AlertLevel level = hmsToAlertLevel(severity);
+    if (code.startsWith("HMS_03")) {
+        level = BasePrinter::AlertLevel::ALERT_CRITICAL;
+    } else if (code.startsWith("HMS_07") || code.startsWith("HMS_12")) {
+        level = BasePrinter::AlertLevel::ALERT_HIGH;
+    } else if (code.startsWith("HMS_0C")) {
+        level = BasePrinter::AlertLevel::ALERT_MEDIUM;
+    }
+    AlertEngine::Key key = {AlertEngine::SOURCE_HMS,
+                            crc32(0, reinterpret_cast<const uint8_t*>(code.c_str()), code.length()), -1};
+    if (!alertRaised(key, level)) {
+        return;
+    }
     
     // Parse HMS code for category
     if (code.startsWith("HMS_03")) {
         // Temperature system error
-        sendAlert(BasePrinter::AlertLevel::ALERT_CRITICAL, "Temperature System Error", msg);
+        sendAlert(level, "Temperature System Error", msg);
     } else if (code.startsWith("HMS_05")) {
         // Communication error
         sendAlert(level, "Communication Error", msg);
     } else if (code.startsWith("HMS_07")) {
         // Motion system error
-        sendAlert(BasePrinter::AlertLevel::ALERT_HIGH, "Motion System Error", msg);
+        sendAlert(level, "Motion System Error", msg);
     } else if (code.startsWith("HMS_0C")) {
         // First layer issues
-        sendAlert(BasePrinter::AlertLevel::ALERT_MEDIUM, "First Layer Issue", msg);
+        sendAlert(level, "First Layer Issue", msg);
     } else if (code.startsWith("HMS_12")) {
         // Filament/AMS system error
-        sendAlert(BasePrinter::AlertLevel::ALERT_HIGH, "AMS System Error", msg);
+        sendAlert(level, "AMS System Error", msg);
     } else {
         // Generic HMS error
         sendAlert(level, "HMS Error " + code, msg);
@@ -772,7 +871,7 @@ void BambuPrinter::handleHMSError(const String& code, const String& severity, co
 
 void BambuPrinter::activateValve(int position) {
     if (position < 1 || position > 20) {
-        LOG_E("Bambu", "Invalid valve position: " + String(position));
+        LOG_EF("Bambu", "Invalid valve position: %d", position);
         return;
     }
     
@@ -780,7 +879,7 @@ void BambuPrinter::activateValve(int position) {
         if (activeValvePosition != position) {
             motorController->moveToPosition(position);
             activeValvePosition = position;
-            LOG_I("Bambu", "Activated valve at position " + String(position));
+            LOG_IF("Bambu", "Activated valve at position %d", position);
         }
     } else {
         LOG_W("Bambu", "No motor controller available");
@@ -790,7 +889,7 @@ void BambuPrinter::activateValve(int position) {
 void BambuPrinter::deactivateValve() {
     if (motorController && activeValvePosition > 0) {
         motorController->stop();
-        LOG_I("Bambu", "Deactivated valve at position " + String(activeValvePosition));
+        LOG_IF("Bambu", "Deactivated valve at position %d", activeValvePosition);
         activeValvePosition = -1;
     }
 }
@@ -816,18 +915,34 @@ int BambuPrinter::findValveForMaterial(const String& material, bool isPureWaste)
 // Alert Management
 
 void BambuPrinter::checkAndSendAlerts() {
-    // Check for critical AMS status
+    // Check for critical AMS status; at most one is active, the others clear
+    alertEngine.beginSweep(AlertEngine::SOURCE_AMS);
+    AlertEngine::Key ams = {AlertEngine::SOURCE_AMS, static_cast<uint32_t>(amsStatus.status), -1};
     if (amsStatus.status == 3) {
-        sendAlert(BasePrinter::AlertLevel::ALERT_HIGH, "AMS Error", "Filament jammed in AMS");
+        if (alertRaised(ams, BasePrinter::AlertLevel::ALERT_HIGH)) {
+            sendAlert(BasePrinter::AlertLevel::ALERT_HIGH, "AMS Error", "Filament jammed in AMS");
+        }
     } else if (amsStatus.status == 4) {
-        sendAlert(BasePrinter::AlertLevel::ALERT_MEDIUM, "AMS Warning", "RFID read error");
+        if (alertRaised(ams, BasePrinter::AlertLevel::ALERT_MEDIUM)) {
+            sendAlert(BasePrinter::AlertLevel::ALERT_MEDIUM, "AMS Warning", "RFID read error");
+        }
     } else if (amsStatus.status == 5) {
-        sendAlert(BasePrinter::AlertLevel::ALERT_MEDIUM, "AMS Warning", "Humidity too high");
+        if (alertRaised(ams, BasePrinter::AlertLevel::ALERT_MEDIUM)) {
+            sendAlert(BasePrinter::AlertLevel::ALERT_MEDIUM, "AMS Warning", "Humidity too high");
+        }
     }
+    alertEngine.endSweep(AlertEngine::SOURCE_AMS, [this](const AlertEngine::Key& key, AlertEngine::Transition) {
+        logAlertCleared(key);
+    });
     
     // Check connection status
+    AlertEngine::Key connection = {AlertEngine::SOURCE_CONNECTION, 0, -1};
     if (!isConnected() && connectionState == ConnectionState::ERROR) {
-        sendAlert(BasePrinter::AlertLevel::ALERT_HIGH, "Connection Lost", "Unable to connect to printer");
+        if (alertRaised(connection, BasePrinter::AlertLevel::ALERT_HIGH)) {
+            sendAlert(BasePrinter::AlertLevel::ALERT_HIGH, "Connection Lost", "Unable to connect to printer");
+        }
+    } else {
+        alertAbsent(connection);
     }
 }
 
@@ -843,18 +958,43 @@ BasePrinter::AlertLevel BambuPrinter::hmsToAlertLevel(const String& severity) {
     }
 }
 
-void BambuPrinter::monitorFilamentLevel(int slot, int remaining) {
-    String materialName = amsStatus.materials[slot];
-    
-    if (remaining == 0) {
-        sendAlert(BasePrinter::AlertLevel::ALERT_CRITICAL, "Filament Empty",
-                  "Slot " + String(slot) + " (" + materialName + ") is empty");
-    } else if (remaining < 5) {
-        sendAlert(BasePrinter::AlertLevel::ALERT_HIGH, "Filament Critical",
-                  "Slot " + String(slot) + " (" + materialName + ") has " + String(remaining) + "% remaining");
-    } else if (remaining < 20) {
-        sendAlert(BasePrinter::AlertLevel::ALERT_MEDIUM, "Filament Low",
-                  "Slot " + String(slot) + " (" + materialName + ") has " + String(remaining) + "% remaining");
+void BambuPrinter::monitorFilamentLevels() {
+    // Severity 1 below FILAMENT_LOW_PERCENT, 2 below FILAMENT_CRITICAL_PERCENT, 3 at 0%
+    static const int kThresholds[] = {FILAMENT_LOW_PERCENT, FILAMENT_CRITICAL_PERCENT, 1};
+    static const BasePrinter::AlertLevel kLevels[] = {
+        BasePrinter::AlertLevel::ALERT_MEDIUM,
+        BasePrinter::AlertLevel::ALERT_HIGH,
+        BasePrinter::AlertLevel::ALERT_CRITICAL
+    };
+
+    for (int slot = 0; slot < 4; slot++) {
+        AlertEngine::Key key = {AlertEngine::SOURCE_FILAMENT, 0, static_cast<int8_t>(slot)};
+        int remaining = amsStatus.remaining[slot];
+        // Spools without a Bambu tag report -1: the level is unknown, not low
+        if (!amsStatus.loaded[slot] || remaining < 0) {
+            alertAbsent(key);
+            continue;
+        }
+
+        uint8_t current = alertEngine.getSeverity(key);
+        uint8_t severity = AlertEngine::fallingSeverity(remaining, kThresholds, 3, current > 0 ? current - 1 : 0,
+                                                        FILAMENT_HYSTERESIS_PERCENT);
+        if (severity == 0) {
+            alertAbsent(key);
+            continue;
+        }
+        BasePrinter::AlertLevel level = kLevels[severity - 1];
+        if (!alertRaised(key, level)) {
+            continue;
+        }
+
+        String materialName = amsStatus.materials[slot];
+        if (remaining == 0) {
+            sendAlert(level, "Filament Empty", "Slot " + String(slot) + " (" + materialName + ") is empty");
+        } else {
+            sendAlert(level, severity == 1 ? "Filament Low" : "Filament Critical",
+                      "Slot " + String(slot) + " (" + materialName + ") has " + String(remaining) + "% remaining");
+        }
     }
 }
 
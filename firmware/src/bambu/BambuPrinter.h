@@ -31,6 +31,26 @@ public:
         int rfidStatus;
     };
 
+    /**
+     * @brief Per-field change bits produced when an AMS report is merged
+     *
+     * Slot fields occupy AMS_SLOT_FIELD_COUNT bits per slot (use amsSlotBit());
+     * the AMS-wide fields sit above the slot bits.
+     */
+    enum AMSSlotField : uint8_t {
+        AMS_SLOT_LOADED = 0,
+        AMS_SLOT_MATERIAL,
+        AMS_SLOT_REMAINING,
+        AMS_SLOT_TAG_UID,
+        AMS_SLOT_FIELD_COUNT
+    };
+    static constexpr uint32_t amsSlotBit(int slot, AMSSlotField field) {
+        return 1UL << (slot * AMS_SLOT_FIELD_COUNT + field);
+    }
+    static constexpr uint32_t AMS_ACTIVE_SLOT_CHANGED = 1UL << 16;
+    static constexpr uint32_t AMS_STATUS_CHANGED = 1UL << 17;
+    static constexpr uint32_t AMS_RFID_STATUS_CHANGED = 1UL << 18;
+
     struct ValveMapping {
         int amsSlot;        // AMS slot (0-3)
         int valvePosition;  // Motor position (1-20)
@@ -55,6 +75,8 @@ private:
     MqttService mqttService;
     String reportTopic;
     String commandTopic;
+    uint32_t reportCount;   // Reports parsed since boot
+    uint32_t reportErrors;  // Reports that failed to parse
 
     // Printer state
     PrintStatus currentStatus;
@@ -101,20 +123,49 @@ public:
     AMSStatus getAMSStatus() const { return amsStatus; }
     std::vector<HMSError> getActiveErrors() const { return activeErrors; }
     bool hasActiveErrors() const { return !activeErrors.empty(); }
+
+    /**
+     * @brief Parse a raw report payload as if it had arrived on the report topic
+     *
+     * The MQTT callback funnels through here; the replay bench feeds recorded
+     * traffic in directly.
+     */
+    void ingestReport(const uint8_t* payload, unsigned int length);
+    uint32_t getReportCount() const { return reportCount; }
+    uint32_t getReportErrorCount() const { return reportErrors; }
+
+    /**
+     * @brief ArduinoJson filter holding only the report fields the parsers consume
+     * @return Shared filter document, built on first use
+     */
+    static const JsonDocument& reportFilter();
+
+    /**
+     * @brief Merge a (possibly partial) AMS report into an existing AMS state
+     *
+     * Only keys present in the report are applied; absent keys keep their value.
+     * @param state AMS state to update in place
+     * @param ams The report's "ams" object
+     * @return Bitmask of the fields whose value actually changed
+     */
+    static uint32_t mergeAMSStatus(AMSStatus& state, const JsonObjectConst& ams);
     
 protected:
+    // Bambu-only ESP32: commands, looked up before the standard ones
+    bool dispatchDriverCommand(const CommandArg& command, const CommandArg& params) override;
+
     // Override command handlers for Bambu-specific behavior
-    void cmdStartingPurge(const String& params) override;
-    void cmdWasteBallComplete(const String& params) override;
-    void cmdCleanBallComplete(const String& params) override;
-    void cmdPauseForESP(const String& params) override;
+    void cmdStartingPurge(const CommandArg& params) override;
+    void cmdWasteBallComplete(const CommandArg& params) override;
+    void cmdCleanBallComplete(const CommandArg& params) override;
+    void cmdPauseForESP(const CommandArg& params) override;
     
     // Bambu-specific command handlers
-    void cmdValveActivate(const String& params);
-    void cmdValveDeactivate(const String& params);
-    void cmdRoutePureWaste(const String& params);
-    void cmdRouteMixedWaste(const String& params);
-    void cmdMaterialChange(const String& params);
+    void cmdValveActivate(const CommandArg& params);
+    void cmdValveDeactivate(const CommandArg& params);
+    void cmdRoutePureWaste(const CommandArg& params);
+    void cmdRouteMixedWaste(const CommandArg& params);
+    void cmdMaterialChange(const CommandArg& params);
     
 private:
     // MQTT functions
@@ -128,12 +179,12 @@ private:
     void parseAMSStatus(const JsonObjectConst& ams);
     void parseHMSErrors(const JsonArrayConst& hms);
     void parseUpgradeStatus(const JsonObjectConst& upgrade);
-    String extractESP32Command(const String& msg);
+    CommandArg extractESP32Command(const CommandArg& msg);
     
     // State management
     void updatePrinterState(const String& gcodeState);
     void updatePrintError(int errorCode);
-    void checkFilamentLevels();
+    void onAMSChanged(uint32_t changed);
     void handleHMSError(const String& code, const String& severity, const String& msg);
     
     // Valve control
@@ -145,7 +196,7 @@ private:
     // Alert management
     void checkAndSendAlerts();
     BasePrinter::AlertLevel hmsToAlertLevel(const String& severity);
-    void monitorFilamentLevel(int slot, int remaining);
+    void monitorFilamentLevels();
     
     // Utility
     String formatMQTTPayload(const String& command, const JsonDocument& params);
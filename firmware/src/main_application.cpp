@@ -21,6 +21,7 @@ MotorController* motor = nullptr;
 
 void setup() {
     Logger::init(200, LOG_INFO);
+    Logger::startDrainTask();
     LOG_I("Main", "Starting ESP32 3D Waste Controller - Application");
     
     Utils::printSystemInfo();
@@ -52,9 +53,19 @@ void setup() {
     #endif
     
     LOG_I("Main", "Application setup complete");
+
+    // 5. Hand network I/O and motion over to their pinned tasks
+    if (!appManager->startTasks()) {
+        LOG_W("Main", "Running network and motion from the Arduino loop");
+    }
 }
 
 void loop() {
+    if (appManager && appManager->tasksRunning()) {
+        // Everything runs in the pinned tasks now
+        vTaskDelete(nullptr);
+    }
+
     if (appManager) {
         appManager->loop();
     }
@@ -0,0 +1,37 @@
+#include <Arduino.h>
+#include <Logger.h>
+#include <MotorController.h>
+#include "bambu/BambuPrinter.h"
+
+// Host entry point for the native env: runs the Bambu driver and the motor state
+// machine in one loop, without the web API, OTA or BLE (those need the ESP32 core).
+//
+//   .pio/build/native/program IP:PORT:SERIAL:ACCESS_CODE
+//
+// TLS is not emulated on the host, so point it at a plain MQTT broker.
+
+int main(int argc, char** argv) {
+    Logger::init(200, LOG_INFO);
+    Logger::startDrainTask();
+    LOG_I("Main", "Starting 3D Waste Controller - native host build");
+
+    MotorController* motor = new MotorController();
+    if (!motor->begin()) {
+        LOG_E("Main", "Failed to start motor position sensing");
+    }
+
+    BambuPrinter* printer = new BambuPrinter(motor);
+    if (!printer->init()) {
+        LOG_E("Main", "Failed to initialize printer driver");
+        return 1;
+    }
+    if (!printer->connect(argc > 1 ? String(argv[1]) : String())) {
+        LOG_W("Main", "Printer not connected yet; the driver will keep retrying");
+    }
+
+    for (;;) {
+        printer->loop();
+        motor->loop();
+        delay(1);
+    }
+}
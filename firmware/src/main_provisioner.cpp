@@ -7,6 +7,7 @@ ProvisioningManager* provisioningManager = nullptr;
 
 void setup() {
     Logger::init(50, LOG_INFO);
+    Logger::startDrainTask();
     LOG_I("Main", "Starting ESP32 3D Waste Controller - Provisioner");
     
     Utils::printSystemInfo();
@@ -20,6 +20,7 @@ void PrusaPrinter::disconnect() {
 }
 
 void PrusaPrinter::loop() {
+    runDeferredActions();
     // Prusa-specific loop logic
 }
 
@@ -0,0 +1,419 @@
+#include <Arduino.h>
+#include <Logger.h>
+#include <MotorController.h>
+#include <PubSubClient.h>
+#include <WiFi.h>
+#include "bambu/BambuPrinter.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Replays a recorded device/<serial>/report capture into BambuPrinter and reports, per
+// message, the ingest latency, heap allocations, status pushes and alerts it caused.
+//
+//   .pio/build/replay_bambu/program CAPTURE [--speed 1,10,max] [--csv FILE]
+//                                           [--broker HOST:PORT] [--quiet]
+//
+// Captures come from scripts/capture_bambu_reports.py: one message per line as
+// "<ms since start>\t<topic>\t<payload>"; blank lines and lines starting with '#' are
+// skipped.
+//
+// Without --broker, payloads go straight into BambuPrinter::ingestReport() and the
+// printer's clock is advanced along the capture's timeline, so time-based behaviour
+// (5 s alert checks, deferred resumes) fires as it would live at any replay speed.
+// With --broker, the printer connects to a plain MQTT broker (e.g. a local mosquitto)
+// and the bench publishes the capture to it; latency then includes the MQTT client
+// read, and payloads larger than the printer's MQTT buffer show up as dropped.
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace {
+// Allocation counters, only advanced on the thread that is being measured
+thread_local bool tracking = false;
+thread_local uint32_t allocCount = 0;
+thread_local uint64_t allocBytes = 0;
+
+inline void countAllocation(size_t size) {
+    if (tracking) {
+        allocCount++;
+        allocBytes += size;
+    }
+}
+}
+
+extern "C" {
+void* malloc(size_t size) {
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+}
+
+namespace {
+typedef std::chrono::steady_clock WallClock;
+
+const uint32_t kBrokerTimeoutMs = 2000; // A published report not ingested by then counts as dropped
+
+struct Record {
+    uint32_t ms;
+    std::string topic;
+    std::string payload;
+};
+
+struct Sample {
+    uint32_t parseUs;
+    uint32_t allocs;
+    uint64_t allocBytes;
+    uint32_t statusPushes;
+    uint32_t alerts;
+    const char* result; // "ok", "error" or "dropped"
+};
+
+struct Options {
+    std::string capturePath;
+    std::vector<double> speeds; // 0 means as fast as possible
+    std::string csvPath;
+    String brokerHost;
+    uint16_t brokerPort = 0;
+    bool quiet = false;
+};
+
+uint32_t statusPushes = 0;
+uint32_t alertsFired = 0;
+
+bool loadCapture(const std::string& path, std::vector<Record>& records) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        size_t tab1 = line.find('\t');
+        size_t tab2 = tab1 == std::string::npos ? std::string::npos : line.find('\t', tab1 + 1);
+        if (tab2 == std::string::npos) {
+            fprintf(stderr, "Skipping malformed capture line %zu\n", records.size() + 1);
+            continue;
+        }
+        Record record;
+        record.ms = static_cast<uint32_t>(strtoul(line.c_str(), nullptr, 10));
+        record.topic = line.substr(tab1 + 1, tab2 - tab1 - 1);
+        record.payload = line.substr(tab2 + 1);
+        records.push_back(record);
+    }
+    return true;
+}
+
+// "device/<serial>/report" -> "<serial>"
+String serialFromTopic(const std::string& topic) {
+    size_t first = topic.find('/');
+    size_t second = first == std::string::npos ? std::string::npos : topic.find('/', first + 1);
+    if (second == std::string::npos) {
+        return String();
+    }
+    return String(topic.substr(first + 1, second - first - 1).c_str());
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--speed" && hasValue) {
+            std::string list = argv[++i];
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t comma = list.find(',', start);
+                std::string item = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+                double speed = item == "max" ? 0 : atof(item.c_str());
+                if (speed < 0 || (speed == 0 && item != "max")) {
+                    return false;
+                }
+                options.speeds.push_back(speed);
+                if (comma == std::string::npos) break;
+                start = comma + 1;
+            }
+        } else if (arg == "--csv" && hasValue) {
+            options.csvPath = argv[++i];
+        } else if (arg == "--broker" && hasValue) {
+            std::string broker = argv[++i];
+            size_t colon = broker.rfind(':');
+            options.brokerHost = String(broker.substr(0, colon).c_str());
+            options.brokerPort = colon == std::string::npos ? 1883 : atoi(broker.c_str() + colon + 1);
+        } else if (arg == "--quiet") {
+            options.quiet = true;
+        } else if (arg[0] != '-' && options.capturePath.empty()) {
+            options.capturePath = arg;
+        } else {
+            return false;
+        }
+    }
+    if (options.speeds.empty()) {
+        options.speeds.push_back(0);
+    }
+    return !options.capturePath.empty();
+}
+
+// Lets the motor task drain the valve commands the printer queued
+void serviceMotor(MotorController& motor) {
+    motor.loop();
+    MotorController::Event event;
+    while (motor.pollEvent(event)) {
+    }
+}
+
+void waitUntil(WallClock::time_point wallTarget) {
+    std::this_thread::sleep_until(wallTarget);
+}
+
+uint32_t percentile(std::vector<uint32_t> values, double fraction) {
+    if (values.empty()) return 0;
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+String speedLabel(double speed) {
+    return speed == 0 ? String("max") : String(speed, 0) + "x";
+}
+
+void beginSample(Sample& sample) {
+    sample = Sample();
+    allocCount = 0;
+    allocBytes = 0;
+    statusPushes = 0;
+    alertsFired = 0;
+    tracking = true;
+}
+
+void endSample(Sample& sample, WallClock::time_point started) {
+    tracking = false;
+    sample.parseUs = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(WallClock::now() - started).count());
+    sample.allocs = allocCount;
+    sample.allocBytes = allocBytes;
+}
+
+bool runDirect(BambuPrinter& printer, MotorController& motor, const std::vector<Record>& records,
+               double speed, std::vector<Sample>& samples) {
+    WiFi.setConnected(false); // Keeps MqttService from trying to reach a printer
+    WallClock::time_point wallStart = WallClock::now();
+    unsigned long clockStart = millis();
+
+    for (const Record& record : records) {
+        uint32_t offset = record.ms - records.front().ms;
+        if (speed > 0) {
+            waitUntil(wallStart + std::chrono::microseconds(static_cast<uint64_t>(offset * 1000.0 / speed)));
+        }
+        unsigned long now = millis();
+        if (clockStart + offset > now) {
+            NativeShim::advanceClock(clockStart + offset - now);
+        }
+
+        Sample sample;
+        beginSample(sample);
+        uint32_t errorsBefore = printer.getReportErrorCount();
+        WallClock::time_point started = WallClock::now();
+        printer.ingestReport(reinterpret_cast<const uint8_t*>(record.payload.data()), record.payload.size());
+        endSample(sample, started);
+        sample.result = printer.getReportErrorCount() != errorsBefore ? "error" : "ok";
+
+        // Pushes and alerts from the loop pass that follows still belong to this message
+        printer.loop();
+        serviceMotor(motor);
+        sample.statusPushes = statusPushes;
+        sample.alerts = alertsFired;
+        samples.push_back(sample);
+    }
+    return true;
+}
+
+bool runBroker(BambuPrinter& printer, MotorController& motor, const std::vector<Record>& records,
+               double speed, const Options& options, const String& serial, std::vector<Sample>& samples) {
+    WiFi.setConnected(true);
+    String params = options.brokerHost + ":" + String(options.brokerPort) + ":" + serial + ":replay:0";
+    if (!printer.connect(params)) {
+        fprintf(stderr, "Printer could not connect to %s:%u\n", options.brokerHost.c_str(), options.brokerPort);
+        return false;
+    }
+
+    WiFiClient publisherNet;
+    PubSubClient publisher(publisherNet);
+    publisher.setServer(options.brokerHost.c_str(), options.brokerPort);
+    publisher.setBufferSize(UINT16_MAX);
+    if (!publisher.connect("replay-bench")) {
+        fprintf(stderr, "Publisher could not connect to %s:%u\n", options.brokerHost.c_str(), options.brokerPort);
+        printer.disconnect();
+        return false;
+    }
+
+    WallClock::time_point wallStart = WallClock::now();
+    for (const Record& record : records) {
+        uint32_t offset = record.ms - records.front().ms;
+        if (speed > 0) {
+            waitUntil(wallStart + std::chrono::microseconds(static_cast<uint64_t>(offset * 1000.0 / speed)));
+        }
+
+        uint32_t handledBefore = printer.getReportCount() + printer.getReportErrorCount();
+        uint32_t errorsBefore = printer.getReportErrorCount();
+        publisher.publish(record.topic.c_str(), reinterpret_cast<const uint8_t*>(record.payload.data()),
+                          record.payload.size());
+
+        Sample sample;
+        beginSample(sample);
+        WallClock::time_point deadline = WallClock::now() + std::chrono::milliseconds(kBrokerTimeoutMs);
+        bool handled = false;
+        while (!handled && WallClock::now() < deadline) {
+            WallClock::time_point started = WallClock::now();
+            printer.loop();
+            handled = printer.getReportCount() + printer.getReportErrorCount() != handledBefore;
+            if (handled) {
+                endSample(sample, started);
+            } else {
+                // Only the pass that delivered the report counts towards latency
+                tracking = false;
+                publisher.loop();
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                tracking = true;
+            }
+        }
+        if (!handled) {
+            endSample(sample, WallClock::now());
+            sample.result = "dropped";
+        } else {
+            sample.result = printer.getReportErrorCount() != errorsBefore ? "error" : "ok";
+        }
+        serviceMotor(motor);
+        sample.statusPushes = statusPushes;
+        sample.alerts = alertsFired;
+        samples.push_back(sample);
+    }
+
+    publisher.disconnect();
+    printer.disconnect();
+    return true;
+}
+
+void printSummary(double speed, const std::vector<Record>& records, const std::vector<Sample>& samples,
+                  double wallSeconds) {
+    std::vector<uint32_t> latencies;
+    std::vector<uint32_t> allocs;
+    uint64_t totalBytes = 0;
+    uint32_t pushes = 0, alerts = 0, errors = 0, dropped = 0;
+    for (const Sample& sample : samples) {
+        if (strcmp(sample.result, "dropped") == 0) {
+            dropped++;
+            continue;
+        }
+        if (strcmp(sample.result, "error") == 0) errors++;
+        latencies.push_back(sample.parseUs);
+        allocs.push_back(sample.allocs);
+        totalBytes += sample.allocBytes;
+        pushes += sample.statusPushes;
+        alerts += sample.alerts;
+    }
+    uint64_t allocTotal = 0;
+    for (uint32_t a : allocs) allocTotal += a;
+
+    printf("\n== Replay at %s: %zu messages in %.2f s (%.0f msg/s)\n", speedLabel(speed).c_str(),
+           records.size(), wallSeconds, wallSeconds > 0 ? records.size() / wallSeconds : 0.0);
+    printf("   parse errors %u, dropped %u\n", errors, dropped);
+    printf("   ingest us    p50 %u  p95 %u  p99 %u  max %u\n", percentile(latencies, 0.50),
+           percentile(latencies, 0.95), percentile(latencies, 0.99), percentile(latencies, 1.0));
+    printf("   allocations  mean %.1f  max %u  bytes/msg %.0f\n",
+           allocs.empty() ? 0.0 : static_cast<double>(allocTotal) / allocs.size(), percentile(allocs, 1.0),
+           allocs.empty() ? 0.0 : static_cast<double>(totalBytes) / allocs.size());
+    printf("   status pushes %u, alerts %u\n", pushes, alerts);
+}
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: %s CAPTURE [--speed 1,10,max] [--csv FILE] [--broker HOST:PORT] [--quiet]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<Record> records;
+    if (!loadCapture(options.capturePath, records)) {
+        fprintf(stderr, "Cannot read %s\n", options.capturePath.c_str());
+        return 1;
+    }
+    if (records.empty()) {
+        fprintf(stderr, "No messages in %s\n", options.capturePath.c_str());
+        return 1;
+    }
+    String serial = serialFromTopic(records.front().topic);
+
+    Logger::init(200, options.quiet ? LOG_ERROR : LOG_INFO);
+
+    FILE* csv = nullptr;
+    if (!options.csvPath.empty()) {
+        csv = fopen(options.csvPath.c_str(), "w");
+        if (!csv) {
+            fprintf(stderr, "Cannot write %s\n", options.csvPath.c_str());
+            return 1;
+        }
+        fprintf(csv, "speed,index,capture_ms,bytes,ingest_us,allocs,alloc_bytes,status_pushes,alerts,result\n");
+    }
+
+    // The step generator owns a hardware timer, so a single motor serves every run
+    MotorController motor;
+    motor.begin();
+
+    int status = 0;
+    for (double speed : options.speeds) {
+        BambuPrinter printer(&motor);
+        printer.init();
+        printer.setStatusCallback([](const BasePrinter::PrintStatus&) { statusPushes++; });
+        printer.setAlertCallback([](BasePrinter::AlertLevel, const String&, const String&) { alertsFired++; });
+
+        std::vector<Sample> samples;
+        samples.reserve(records.size());
+        WallClock::time_point started = WallClock::now();
+        bool ok = options.brokerHost.length() > 0
+            ? runBroker(printer, motor, records, speed, options, serial, samples)
+            : runDirect(printer, motor, records, speed, samples);
+        double wallSeconds = std::chrono::duration<double>(WallClock::now() - started).count();
+        if (!ok) {
+            status = 1;
+            continue;
+        }
+
+        printSummary(speed, records, samples, wallSeconds);
+        if (csv) {
+            for (size_t i = 0; i < samples.size(); i++) {
+                const Sample& s = samples[i];
+                fprintf(csv, "%s,%zu,%u,%zu,%u,%u,%llu,%u,%u,%s\n", speedLabel(speed).c_str(), i,
+                        records[i].ms, records[i].payload.size(), s.parseUs, s.allocs,
+                        static_cast<unsigned long long>(s.allocBytes), s.statusPushes, s.alerts, s.result);
+            }
+        }
+    }
+
+    if (csv) {
+        fclose(csv);
+    }
+    return status;
+}
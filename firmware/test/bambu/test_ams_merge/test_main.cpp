@@ -0,0 +1,177 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include "bambu/BambuPrinter.h"
+
+using AMSStatus = BambuPrinter::AMSStatus;
+
+// Recorded sequence: one full report followed by the partial reports Bambu sends in between
+static const char* const kReplay[] = {
+    R"json({"ams_status": 0, "ams_rfid_status": 6, "tray": [
+        {"id": "0", "tray_type": "PLA", "remain": 78, "tag_uid": "A1B2C3D4E5F60708", "tray_now": false},
+        {"id": "1", "tray_type": "PLA", "remain": 14, "tag_uid": "1122334455667788", "tray_now": true},
+        {"id": "2", "tray_type": "PETG", "remain": 55, "tag_uid": "0000000000000000", "tray_now": false},
+        {"id": "3", "tray_type": "TPU", "remain": 3, "tag_uid": "99AABBCCDDEEFF00", "tray_now": false}]})json",
+    R"json({"ams_status": 768})json",
+    R"json({"tray": [{"id": "1", "remain": 13}]})json",
+    R"json({"tray": [{"id": "1", "remain": 13}]})json",
+    R"json({"tray": [{"id": "1", "tray_now": false}, {"id": "2", "tray_now": true}]})json",
+    R"json({"ams_rfid_status": 2, "tray": [{"id": 3, "tray_type": "PLA", "tag_uid": "0102030405060708", "remain": 100}]})json",
+    R"json({"tray": [{"id": "2", "remain": 54}, {"id": "0", "remain": 78}]})json",
+    R"json({"ams_status": 0, "ams_rfid_status": 2, "tray": [
+        {"id": "0", "tray_type": "PLA", "remain": 78, "tag_uid": "A1B2C3D4E5F60708", "tray_now": false},
+        {"id": "1", "tray_type": "PLA", "remain": 13, "tag_uid": "1122334455667788", "tray_now": false},
+        {"id": "2", "tray_type": "PETG", "remain": 54, "tag_uid": "0000000000000000", "tray_now": true},
+        {"id": "3", "tray_type": "PLA", "remain": 100, "tag_uid": "0102030405060708", "tray_now": false}]})json",
+};
+
+static AMSStatus emptyStatus() {
+    AMSStatus s;
+    s.activeSlot = -1;
+    s.status = 0;
+    s.rfidStatus = 0;
+    for (int i = 0; i < 4; i++) {
+        s.loaded[i] = false;
+        s.materials[i] = "";
+        s.remaining[i] = 0;
+        s.tagUIDs[i] = "";
+    }
+    return s;
+}
+
+// Reference: the previous parseAMSStatus, which rebuilt every slot from each report
+static void legacyFullReset(AMSStatus& s, JsonObjectConst ams) {
+    s.activeSlot = -1;
+    for (int i = 0; i < 4; i++) {
+        s.loaded[i] = false;
+        s.materials[i] = "";
+        s.remaining[i] = 0;
+        s.tagUIDs[i] = "";
+    }
+    if (ams["ams_status"].is<int>()) s.status = ams["ams_status"];
+    if (ams["ams_rfid_status"].is<int>()) s.rfidStatus = ams["ams_rfid_status"];
+    for (JsonVariantConst trayVar : ams["tray"].as<JsonArrayConst>()) {
+        JsonObjectConst tray = trayVar.as<JsonObjectConst>();
+        if (tray["id"].isNull()) continue;
+        int slotId = tray["id"].is<int>() ? tray["id"].as<int>() : tray["id"].as<String>().toInt();
+        if (slotId < 0 || slotId >= 4) continue;
+        s.loaded[slotId] = true;
+        if (tray["tray_type"].is<String>()) s.materials[slotId] = tray["tray_type"].as<String>();
+        if (tray["remain"].is<int>()) s.remaining[slotId] = tray["remain"];
+        if (tray["tag_uid"].is<String>()) s.tagUIDs[slotId] = tray["tag_uid"].as<String>();
+        if (tray["tray_now"].is<bool>() && tray["tray_now"]) s.activeSlot = slotId;
+    }
+}
+
+// Apply a partial report onto the accumulated full report, matching trays by id
+static void applyDelta(JsonObject full, JsonObjectConst delta) {
+    for (JsonPairConst kv : delta) {
+        if (kv.key() != "tray") {
+            full[kv.key()] = kv.value();
+            continue;
+        }
+        JsonArray fullTrays = full["tray"].is<JsonArray>() ? full["tray"].as<JsonArray>()
+                                                           : full["tray"].to<JsonArray>();
+        for (JsonObjectConst tray : kv.value().as<JsonArrayConst>()) {
+            String id = tray["id"].as<String>();
+            JsonObject target;
+            for (JsonObject existing : fullTrays) {
+                if (existing["id"].as<String>() == id) {
+                    target = existing;
+                    break;
+                }
+            }
+            if (target.isNull()) {
+                target = fullTrays.add<JsonObject>();
+            }
+            for (JsonPairConst field : tray) {
+                target[field.key()] = field.value();
+            }
+        }
+    }
+}
+
+static uint32_t expectedChanges(const AMSStatus& before, const AMSStatus& after) {
+    uint32_t mask = 0;
+    for (int i = 0; i < 4; i++) {
+        if (before.loaded[i] != after.loaded[i]) mask |= BambuPrinter::amsSlotBit(i, BambuPrinter::AMS_SLOT_LOADED);
+        if (before.materials[i] != after.materials[i]) mask |= BambuPrinter::amsSlotBit(i, BambuPrinter::AMS_SLOT_MATERIAL);
+        if (before.remaining[i] != after.remaining[i]) mask |= BambuPrinter::amsSlotBit(i, BambuPrinter::AMS_SLOT_REMAINING);
+        if (before.tagUIDs[i] != after.tagUIDs[i]) mask |= BambuPrinter::amsSlotBit(i, BambuPrinter::AMS_SLOT_TAG_UID);
+    }
+    if (before.activeSlot != after.activeSlot) mask |= BambuPrinter::AMS_ACTIVE_SLOT_CHANGED;
+    if (before.status != after.status) mask |= BambuPrinter::AMS_STATUS_CHANGED;
+    if (before.rfidStatus != after.rfidStatus) mask |= BambuPrinter::AMS_RFID_STATUS_CHANGED;
+    return mask;
+}
+
+static void assertSameState(const AMSStatus& expected, const AMSStatus& actual, size_t step) {
+    char msg[48];
+    snprintf(msg, sizeof(msg), "replay step %u", (unsigned)step);
+    TEST_ASSERT_EQUAL_MESSAGE(expected.activeSlot, actual.activeSlot, msg);
+    TEST_ASSERT_EQUAL_MESSAGE(expected.status, actual.status, msg);
+    TEST_ASSERT_EQUAL_MESSAGE(expected.rfidStatus, actual.rfidStatus, msg);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_MESSAGE(expected.loaded[i], actual.loaded[i], msg);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(expected.materials[i].c_str(), actual.materials[i].c_str(), msg);
+        TEST_ASSERT_EQUAL_MESSAGE(expected.remaining[i], actual.remaining[i], msg);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(expected.tagUIDs[i].c_str(), actual.tagUIDs[i].c_str(), msg);
+    }
+}
+
+static void test_replay_matches_full_reset() {
+    JsonDocument fullReport;
+    JsonObject full = fullReport.to<JsonObject>();
+    AMSStatus merged = emptyStatus();
+    AMSStatus reference = emptyStatus();
+
+    for (size_t step = 0; step < sizeof(kReplay) / sizeof(kReplay[0]); ++step) {
+        JsonDocument delta;
+        TEST_ASSERT_FALSE(deserializeJson(delta, kReplay[step]));
+
+        AMSStatus before = merged;
+        uint32_t changed = BambuPrinter::mergeAMSStatus(merged, delta.as<JsonObjectConst>());
+
+        applyDelta(full, delta.as<JsonObjectConst>());
+        legacyFullReset(reference, full);
+
+        assertSameState(reference, merged, step);
+        TEST_ASSERT_EQUAL_HEX32_MESSAGE(expectedChanges(before, merged), changed, "change bits");
+    }
+}
+
+static void test_repeated_report_emits_no_changes() {
+    AMSStatus state = emptyStatus();
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, kReplay[0]));
+    TEST_ASSERT_NOT_EQUAL(0, BambuPrinter::mergeAMSStatus(state, doc.as<JsonObjectConst>()));
+    TEST_ASSERT_EQUAL_HEX32(0, BambuPrinter::mergeAMSStatus(state, doc.as<JsonObjectConst>()));
+}
+
+static void test_partial_report_touches_only_named_fields() {
+    AMSStatus state = emptyStatus();
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, kReplay[0]));
+    BambuPrinter::mergeAMSStatus(state, doc.as<JsonObjectConst>());
+
+    TEST_ASSERT_FALSE(deserializeJson(doc, R"json({"tray": [{"id": "1", "remain": 12}]})json"));
+    uint32_t changed = BambuPrinter::mergeAMSStatus(state, doc.as<JsonObjectConst>());
+
+    TEST_ASSERT_EQUAL_HEX32(BambuPrinter::amsSlotBit(1, BambuPrinter::AMS_SLOT_REMAINING), changed);
+    TEST_ASSERT_EQUAL(12, state.remaining[1]);
+    TEST_ASSERT_EQUAL(1, state.activeSlot);
+    TEST_ASSERT_EQUAL_STRING("PETG", state.materials[2].c_str());
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_matches_full_reset);
+    RUN_TEST(test_repeated_report_emits_no_changes);
+    RUN_TEST(test_partial_report_touches_only_named_fields);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,258 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <algorithm>
+#include "bambu/BambuPrinter.h"
+
+// Representative X1C pushall response (~4 KB). Only a handful of these fields are
+// consumed by BambuPrinter; the rest is what the filter is expected to skip.
+static const char kPushallReport[] = R"json({
+  "print": {
+    "upload": {"status": "idle", "progress": 0, "message": ""},
+    "nozzle_temper": 219.9, "nozzle_target_temper": 220, "bed_temper": 55.1, "bed_target_temper": 55,
+    "chamber_temper": 31, "mc_print_stage": "2", "heatbreak_fan_speed": "15", "cooling_fan_speed": "15",
+    "big_fan1_speed": "0", "big_fan2_speed": "0", "mc_percent": 42, "mc_remaining_time": 5321,
+    "ams_status": 768, "ams_rfid_status": 6, "hw_switch_state": 1, "spd_mag": 100, "spd_lvl": 2,
+    "print_error": 0, "lifecycle": "product", "wifi_signal": "-52dBm", "gcode_state": "RUNNING",
+    "gcode_file_prepare_percent": "100", "queue_number": 0, "queue_total": 0, "queue_est": 0,
+    "queue_sts": 0, "project_id": "0", "profile_id": "0", "task_id": "0", "subtask_id": "0",
+    "subtask_name": "regain3d_calibration_cube_multicolor_v3", "gcode_file": "/data/Metadata/plate_1.gcode",
+    "stg": [2, 14, 1, 4, 3], "stg_cur": 0, "print_type": "local", "home_flag": 6312328,
+    "mc_print_line_number": "184221", "mc_print_sub_stage": 0, "sdcard": true, "force_upgrade": false,
+    "mess_production_state": "active", "layer_num": 118, "total_layer_num": 284,
+    "s_obj": [], "filam_bak": [], "fan_gear": 12345, "nozzle_diameter": "0.4", "nozzle_type": "hardened_steel",
+    "msg": "ESP32:WASTE_BALL_COMPLETE",
+    "lights_report": [{"node": "chamber_light", "mode": "on"}, {"node": "work_light", "mode": "flashing"}],
+    "ipcam": {"ipcam_dev": "1", "ipcam_record": "enable", "timelapse": "disable", "resolution": "1080p",
+              "tutk_server": "disable", "mode_bits": 3},
+    "xcam": {"allow_skip_parts": false, "buildplate_marker_detector": true, "first_layer_inspector": true,
+             "halt_print_sensitivity": "medium", "print_halt": true, "printing_monitor": true,
+             "spaghetti_detector": true},
+    "net": {"conf": 16, "info": [{"ip": 1677830336, "mask": 16777215}, {"ip": 0, "mask": 0}]},
+    "online": {"ahb": false, "rfid": false, "version": 1054581467},
+    "upgrade_state": {"sequence_id": 0, "progress": "", "status": "", "consistency_request": false,
+                      "dis_state": 0, "err_code": 0, "force_upgrade": false, "message": "0%, 0B/s",
+                      "module": "", "new_version_state": 2, "cur_state_code": 0, "idx2": 0,
+                      "new_ver_list": []},
+    "command": "push_status", "sequence_id": "1983"
+  },
+  "ams": {
+    "ams_status": 0, "ams_rfid_status": 6, "ams_exist_bits": "1", "tray_exist_bits": "f",
+    "tray_is_bbl_bits": "f", "tray_tar": "1", "tray_pre": "0", "tray_read_done_bits": "f",
+    "tray_reading_bits": "0", "version": 8, "insert_flag": true, "power_on_flag": false,
+    "humidity": "4", "temp": "27.6",
+    "tray": [
+      {"id": "0", "remain": 78, "k": 0.02, "n": 1, "tag_uid": "A1B2C3D4E5F60708", "tray_id_name": "A00-W1",
+       "tray_info_idx": "GFA00", "tray_type": "PLA", "tray_sub_brands": "PLA Basic", "tray_color": "FFFFFFFF",
+       "tray_weight": "1000", "tray_diameter": "1.75", "tray_temp": "55", "tray_time": "8",
+       "bed_temp_type": "1", "bed_temp": "35", "nozzle_temp_max": "230", "nozzle_temp_min": "190",
+       "xcam_info": "AC0DE803E8030000000000", "tray_uuid": "0123456789ABCDEF0123456789ABCDEF",
+       "cols": ["FFFFFFFF"], "ctype": 0, "tray_now": false},
+      {"id": "1", "remain": 14, "k": 0.02, "n": 1, "tag_uid": "1122334455667788", "tray_id_name": "A00-K0",
+       "tray_info_idx": "GFA00", "tray_type": "PLA", "tray_sub_brands": "PLA Basic", "tray_color": "000000FF",
+       "tray_weight": "1000", "tray_diameter": "1.75", "tray_temp": "55", "tray_time": "8",
+       "bed_temp_type": "1", "bed_temp": "35", "nozzle_temp_max": "230", "nozzle_temp_min": "190",
+       "xcam_info": "AC0DE803E8030000000000", "tray_uuid": "FEDCBA9876543210FEDCBA9876543210",
+       "cols": ["000000FF"], "ctype": 0, "tray_now": true},
+      {"id": "2", "remain": 55, "k": 0.025, "n": 1, "tag_uid": "0000000000000000", "tray_id_name": "",
+       "tray_info_idx": "GFG99", "tray_type": "PETG", "tray_sub_brands": "", "tray_color": "FF6A13FF",
+       "tray_weight": "1000", "tray_diameter": "1.75", "tray_temp": "70", "tray_time": "8",
+       "bed_temp_type": "1", "bed_temp": "70", "nozzle_temp_max": "260", "nozzle_temp_min": "230",
+       "xcam_info": "000000000000000000000000", "tray_uuid": "00000000000000000000000000000000",
+       "cols": ["FF6A13FF"], "ctype": 0, "tray_now": false},
+      {"id": "3", "remain": 3, "k": 0.03, "n": 1, "tag_uid": "99AABBCCDDEEFF00", "tray_id_name": "T50-R0",
+       "tray_info_idx": "GFU01", "tray_type": "TPU", "tray_sub_brands": "TPU 95A", "tray_color": "C12E1FFF",
+       "tray_weight": "1000", "tray_diameter": "1.75", "tray_temp": "45", "tray_time": "8",
+       "bed_temp_type": "1", "bed_temp": "35", "nozzle_temp_max": "240", "nozzle_temp_min": "220",
+       "xcam_info": "000000000000000000000000", "tray_uuid": "11111111111111111111111111111111",
+       "cols": ["C12E1FFF"], "ctype": 0, "tray_now": false}
+    ]
+  },
+  "hms": [
+    {"attr": 50331904, "code": "HMS_0300_0100_0001_0001", "severity": "WARNING", "msg": "Heatbed temperature is abnormal"},
+    {"attr": 117506048, "code": "HMS_0700_2000_0002_0001", "severity": "SERIOUS", "msg": "AMS slot 2 filament has run out"}
+  ],
+  "upgrade": {"status": "idle", "progress": 0, "module": "ota", "sequence_id": 0}
+})json";
+
+// Typical partial report: progress tick plus a few temperatures
+static const char kPartialReport[] = R"json({
+  "print": {"nozzle_temper": 220.1, "bed_temper": 55.0, "mc_percent": 43, "mc_remaining_time": 5202,
+            "layer_num": 121, "wifi_signal": "-53dBm", "command": "push_status", "msg": 0, "sequence_id": "1984"}
+})json";
+
+/**
+ * Allocator that tracks live and peak bytes handed out to a JsonDocument.
+ * Each block carries its size in a small header so reallocate/deallocate can account for it.
+ */
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+    void* allocate(size_t size) override {
+        size_t* block = static_cast<size_t*>(malloc(size + sizeof(size_t)));
+        if (!block) return nullptr;
+        *block = size;
+        grow(size);
+        return block + 1;
+    }
+
+    void deallocate(void* ptr) override {
+        if (!ptr) return;
+        size_t* block = static_cast<size_t*>(ptr) - 1;
+        current -= *block;
+        free(block);
+    }
+
+    void* reallocate(void* ptr, size_t newSize) override {
+        if (!ptr) return allocate(newSize);
+        size_t* block = static_cast<size_t*>(ptr) - 1;
+        size_t oldSize = *block;
+        size_t* resized = static_cast<size_t*>(realloc(block, newSize + sizeof(size_t)));
+        if (!resized) return nullptr;
+        *resized = newSize;
+        current -= oldSize;
+        grow(newSize);
+        return resized + 1;
+    }
+
+    void reset() { current = 0; peak = 0; }
+    void grow(size_t size) {
+        current += size;
+        if (current > peak) peak = current;
+    }
+
+    size_t current = 0;
+    size_t peak = 0;
+};
+
+struct IngestResult {
+    unsigned long avgMicros;
+    size_t peakBytes;
+};
+
+// Previous mqttCallback: copy the payload into a String, then build the full DOM
+static IngestResult ingestLegacy(const uint8_t* payload, unsigned int length, int iterations) {
+    CountingAllocator allocator;
+    size_t peak = 0;
+    unsigned long start = micros();
+    for (int i = 0; i < iterations; ++i) {
+        {
+            String message;
+            message.reserve(length + 1);
+            for (unsigned int j = 0; j < length; j++) {
+                message += (char)payload[j];
+            }
+            JsonDocument doc(&allocator);
+            DeserializationError error = deserializeJson(doc, message);
+            TEST_ASSERT_FALSE(error);
+        }
+        // The String copy is alive for the whole parse
+        peak = std::max(peak, allocator.peak + length + 1);
+        allocator.reset();
+    }
+    return { (micros() - start) / iterations, peak };
+}
+
+// Current mqttCallback: parse in place from the receive buffer through the report filter
+static IngestResult ingestFiltered(const uint8_t* payload, unsigned int length, int iterations) {
+    CountingAllocator allocator;
+    size_t peak = 0;
+    unsigned long start = micros();
+    for (int i = 0; i < iterations; ++i) {
+        {
+            JsonDocument doc(&allocator);
+            DeserializationError error = deserializeJson(doc, reinterpret_cast<const char*>(payload), length,
+                                                         DeserializationOption::Filter(BambuPrinter::reportFilter()));
+            TEST_ASSERT_FALSE(error);
+        }
+        peak = std::max(peak, allocator.peak);
+        allocator.reset();
+    }
+    return { (micros() - start) / iterations, peak };
+}
+
+static void reportBenchmark(const char* name, const IngestResult& legacy, const IngestResult& filtered) {
+    char line[160];
+    snprintf(line, sizeof(line), "%s: legacy %lu us / %u B peak, filtered %lu us / %u B peak",
+             name, legacy.avgMicros, (unsigned)legacy.peakBytes,
+             filtered.avgMicros, (unsigned)filtered.peakBytes);
+    TEST_MESSAGE(line);
+}
+
+static void test_filtered_parse_keeps_consumed_fields() {
+    JsonDocument full;
+    TEST_ASSERT_FALSE(deserializeJson(full, kPushallReport));
+
+    JsonDocument filtered;
+    TEST_ASSERT_FALSE(deserializeJson(filtered, kPushallReport, sizeof(kPushallReport) - 1,
+                                      DeserializationOption::Filter(BambuPrinter::reportFilter())));
+
+    const char* printKeys[] = {"gcode_state", "print_error", "layer_num", "total_layer_num",
+                               "msg", "mc_percent", "mc_remaining_time"};
+    for (const char* key : printKeys) {
+        TEST_ASSERT_TRUE_MESSAGE(full["print"][key].as<JsonVariantConst>() == filtered["print"][key].as<JsonVariantConst>(), key);
+    }
+
+    TEST_ASSERT_EQUAL(full["ams"]["ams_status"].as<int>(), filtered["ams"]["ams_status"].as<int>());
+    TEST_ASSERT_EQUAL(full["ams"]["ams_rfid_status"].as<int>(), filtered["ams"]["ams_rfid_status"].as<int>());
+    TEST_ASSERT_EQUAL(4, filtered["ams"]["tray"].size());
+    const char* trayKeys[] = {"id", "tray_type", "remain", "tag_uid", "tray_now"};
+    for (size_t i = 0; i < 4; ++i) {
+        for (const char* key : trayKeys) {
+            TEST_ASSERT_TRUE_MESSAGE(full["ams"]["tray"][i][key].as<JsonVariantConst>() == filtered["ams"]["tray"][i][key].as<JsonVariantConst>(), key);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(2, filtered["hms"].size());
+    for (size_t i = 0; i < 2; ++i) {
+        TEST_ASSERT_EQUAL_STRING(full["hms"][i]["code"].as<const char*>(), filtered["hms"][i]["code"].as<const char*>());
+        TEST_ASSERT_EQUAL_STRING(full["hms"][i]["severity"].as<const char*>(), filtered["hms"][i]["severity"].as<const char*>());
+        TEST_ASSERT_EQUAL_STRING(full["hms"][i]["msg"].as<const char*>(), filtered["hms"][i]["msg"].as<const char*>());
+    }
+
+    TEST_ASSERT_EQUAL_STRING("idle", filtered["upgrade"]["status"].as<const char*>());
+}
+
+static void test_filter_drops_unused_fields() {
+    JsonDocument filtered;
+    TEST_ASSERT_FALSE(deserializeJson(filtered, kPushallReport, sizeof(kPushallReport) - 1,
+                                      DeserializationOption::Filter(BambuPrinter::reportFilter())));
+
+    TEST_ASSERT_TRUE(filtered["print"]["nozzle_temper"].isNull());
+    TEST_ASSERT_TRUE(filtered["print"]["lights_report"].isNull());
+    TEST_ASSERT_TRUE(filtered["print"]["upgrade_state"].isNull());
+    TEST_ASSERT_TRUE(filtered["ams"]["humidity"].isNull());
+    TEST_ASSERT_TRUE(filtered["ams"]["tray"][0]["tray_uuid"].isNull());
+    TEST_ASSERT_TRUE(filtered["hms"][0]["attr"].isNull());
+}
+
+static void test_benchmark_pushall_report() {
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(kPushallReport);
+    const unsigned int length = sizeof(kPushallReport) - 1;
+    IngestResult legacy = ingestLegacy(payload, length, 50);
+    IngestResult filtered = ingestFiltered(payload, length, 50);
+    reportBenchmark("pushall", legacy, filtered);
+    TEST_ASSERT_LESS_THAN(legacy.peakBytes / 4, filtered.peakBytes);
+}
+
+static void test_benchmark_partial_report() {
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(kPartialReport);
+    const unsigned int length = sizeof(kPartialReport) - 1;
+    IngestResult legacy = ingestLegacy(payload, length, 200);
+    IngestResult filtered = ingestFiltered(payload, length, 200);
+    reportBenchmark("partial", legacy, filtered);
+    TEST_ASSERT_LESS_THAN(legacy.peakBytes, filtered.peakBytes);
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+    UNITY_BEGIN();
+    RUN_TEST(test_filtered_parse_keeps_consumed_fields);
+    RUN_TEST(test_filter_drops_unused_fields);
+    RUN_TEST(test_benchmark_pushall_report);
+    RUN_TEST(test_benchmark_partial_report);
+    UNITY_END();
+}
+
+void loop() {}
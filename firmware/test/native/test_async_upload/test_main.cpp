@@ -0,0 +1,123 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <AsyncHttpClient.h>
+#include <Config.h>
+#include <LoopbackServer.h>
+#include <UpdateClient.h>
+#include <algorithm>
+#include <vector>
+
+// Host test for uploads off the network loop: a desktop stand-in on a loopback socket
+// that sits on every request for a set time before answering, as one does while it is
+// busy or on a congested link.
+
+namespace {
+AsyncHttpClient::Request request(const String& url) {
+    AsyncHttpClient::Request request;
+    request.url = url + "/updates";
+    request.headers.push_back({"Content-Type", "application/json"});
+    const char* body = "{\"state\":\"RUNNING\"}";
+    request.body.assign(body, body + strlen(body));
+    return request;
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_loop_period_stays_flat_while_the_desktop_is_slow() {
+    const unsigned long desktopDelayMs = 1500;
+    HttpStandIn desktop(nullptr, desktopDelayMs);
+    UpdateClient client;
+    TEST_ASSERT_TRUE(client.init(desktop.url(), "user:secret", "dev1"));
+
+    JsonDocument alert;
+    alert["type"] = "filament_low";
+    client.queueAlert(alert);
+
+    // The network loop's own period, with everything else it does taking no time
+    unsigned long longest = 0;
+    unsigned long loops = 0;
+    unsigned long start = millis();
+    while ((client.hasPending() || client.isUploading()) && millis() - start < 5000) {
+        unsigned long before = millis();
+        client.loop();
+        longest = std::max(longest, millis() - before);
+        loops++;
+        delay(NETWORK_TASK_PERIOD_MS);
+    }
+
+    char line[96];
+    snprintf(line, sizeof(line), "%lu loops over %lu ms, longest loop() %lu ms, desktop answers in %lu ms",
+             loops, millis() - start, longest, desktopDelayMs);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_FALSE(client.hasPending());
+    TEST_ASSERT_EQUAL(0, client.getConsecutiveFailures());
+    TEST_ASSERT_TRUE(longest < 20);
+    TEST_ASSERT_TRUE(loops > desktopDelayMs / NETWORK_TASK_PERIOD_MS / 2);
+    TEST_ASSERT_TRUE(client.getConnectionStats().lastLatencyMs >= desktopDelayMs - 10);
+}
+
+void test_deadline_fails_a_request_the_desktop_sits_on() {
+    HttpStandIn desktop(nullptr, 2000);
+    AsyncHttpClient http;
+    TEST_ASSERT_TRUE(http.start());
+
+    int code = 0;
+    bool done = false;
+    AsyncHttpClient::Request first = request(desktop.url());
+    unsigned long start = millis();
+    TEST_ASSERT_TRUE(http.submit(first, 300, [&](const AsyncHttpClient::Response& response) {
+        code = response.code;
+        done = true;
+    }) != 0);
+    while (!done && millis() - start < 3000) {
+        http.poll();
+        delay(5);
+    }
+
+    TEST_ASSERT_TRUE(done);
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_READ_TIMEOUT, code);
+    TEST_ASSERT_TRUE(millis() - start < 600);
+}
+
+void test_in_flight_requests_are_bounded() {
+    HttpStandIn desktop(nullptr, 400);
+    AsyncHttpClient http;
+    TEST_ASSERT_TRUE(http.start());
+
+    // The first goes on the wire; the second waits behind it and runs out of time there
+    std::vector<int> codes;
+    auto record = [&](const AsyncHttpClient::Response& response) { codes.push_back(response.code); };
+    AsyncHttpClient::Request sent = request(desktop.url());
+    TEST_ASSERT_TRUE(http.submit(sent, 2000, record) != 0);
+    for (int i = 1; i < HTTP_MAX_IN_FLIGHT; i++) {
+        AsyncHttpClient::Request waiting = request(desktop.url());
+        TEST_ASSERT_TRUE(http.submit(waiting, 200, record) != 0);
+    }
+    AsyncHttpClient::Request extra = request(desktop.url());
+    TEST_ASSERT_EQUAL(0, http.submit(extra, 2000, record));
+    TEST_ASSERT_EQUAL(HTTP_MAX_IN_FLIGHT, http.getInFlight());
+
+    unsigned long start = millis();
+    while (codes.size() < HTTP_MAX_IN_FLIGHT && millis() - start < 3000) {
+        http.poll();
+        delay(5);
+    }
+    TEST_ASSERT_EQUAL(HTTP_MAX_IN_FLIGHT, codes.size());
+    TEST_ASSERT_EQUAL(200, codes[0]);
+    for (size_t i = 1; i < codes.size(); i++) {
+        TEST_ASSERT_EQUAL(HTTPC_ERROR_READ_TIMEOUT, codes[i]);
+    }
+    TEST_ASSERT_EQUAL(1, desktop.requestCount());
+    TEST_ASSERT_EQUAL(0, http.getInFlight());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_loop_period_stays_flat_while_the_desktop_is_slow);
+    RUN_TEST(test_deadline_fails_a_request_the_desktop_sits_on);
+    RUN_TEST(test_in_flight_requests_are_bounded);
+    return UNITY_END();
+}
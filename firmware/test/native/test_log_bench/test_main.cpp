@@ -0,0 +1,227 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <Logger.h>
+#include <chrono>
+#include <vector>
+
+// Host benchmark: cost of storing one log line in the LogRing arena against the
+// previous std::vector<LogEntry> ring of String pairs, and of a LOG_ call site whose
+// level is filtered out or whose message is built, with heap allocations counted by
+// interposing malloc.
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+static bool tracking = false;
+static uint32_t allocCount = 0;
+
+extern "C" {
+void* malloc(size_t size) {
+    if (tracking) allocCount++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    if (tracking) allocCount++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (tracking) allocCount++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+}
+
+namespace {
+const size_t kRecords = 200;   // As configured by the application image
+const int kIterations = 200000;
+
+// The storage Logger used before the arena: one heap String pair per line
+struct LegacyEntry {
+    unsigned long timestamp;
+    LogLevel level;
+    String message;
+    String component;
+};
+
+class LegacyRing {
+public:
+    LegacyRing() : startIndex(0), count(0) { entries.resize(kRecords); }
+
+    void add(LogLevel level, const String& component, const String& message) {
+        LegacyEntry entry;
+        entry.timestamp = millis();
+        entry.level = level;
+        entry.component = component;
+        entry.message = message;
+        if (count < kRecords) {
+            entries[(startIndex + count) % kRecords] = entry;
+            count++;
+        } else {
+            entries[startIndex] = entry;
+            startIndex = (startIndex + 1) % kRecords;
+        }
+    }
+
+private:
+    std::vector<LegacyEntry> entries;
+    size_t startIndex;
+    size_t count;
+};
+
+struct Result {
+    double nsPerLog;
+    double allocsPerLog;
+};
+
+const char* const kComponents[] = { "Bambu", "MQTT", "Motor", "API" };
+const char* const kMessages[] = {
+    "MQTT message received on device/01S00C123456789/report",
+    "Reached position 7 in 412 ms (expected 398 ms)",
+    "Routing pure waste from AMS Slot 2 to Valve 3",
+    "ESP32 command detected: STARTING_PURGE",
+};
+
+template <typename Store>
+Result measure(Store store) {
+    std::vector<String> components;
+    std::vector<String> messages;
+    for (size_t i = 0; i < 4; i++) {
+        components.push_back(kComponents[i]);
+        messages.push_back(kMessages[i]);
+    }
+
+    // Warm up until the ring has wrapped, so both are measured in steady state
+    for (size_t i = 0; i < 2 * kRecords; i++) {
+        store(components[i % 4], messages[i % 4]);
+    }
+
+    allocCount = 0;
+    tracking = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        store(components[i % 4], messages[i % 4]);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    tracking = false;
+
+    Result result;
+    result.nsPerLog = std::chrono::duration<double, std::nano>(elapsed).count() / kIterations;
+    result.allocsPerLog = static_cast<double>(allocCount) / kIterations;
+    return result;
+}
+
+LegacyRing legacy;
+Logger::Ring arena(kRecords);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_arena_vs_legacy_store() {
+    Result before = measure([](const String& component, const String& message) {
+        legacy.add(LOG_INFO, component, message);
+    });
+    Result after = measure([](const String& component, const String& message) {
+        arena.append(LOG_INFO, component.c_str(), message.c_str(), message.length(), millis());
+    });
+
+    char line[160];
+    snprintf(line, sizeof(line), "legacy vector<LogEntry>: %.1f ns/log, %.2f allocations/log",
+             before.nsPerLog, before.allocsPerLog);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "LogRing<%u> arena:      %.1f ns/log, %.2f allocations/log",
+             static_cast<unsigned>(LOG_RING_BYTES), after.nsPerLog, after.allocsPerLog);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "arena holds %u of %u lines at this size; static footprint %u bytes",
+             static_cast<unsigned>(arena.size()), static_cast<unsigned>(kRecords),
+             static_cast<unsigned>(sizeof(Logger::Ring)));
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, static_cast<float>(after.allocsPerLog));
+    // Short component names fit String's small-buffer storage, so the legacy cost is
+    // mostly the message copy
+    TEST_ASSERT_TRUE(before.allocsPerLog >= 1.0);
+}
+
+template <typename Call>
+Result measureCall(Call call) {
+    allocCount = 0;
+    tracking = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        call(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    tracking = false;
+
+    Result result;
+    result.nsPerLog = std::chrono::duration<double, std::nano>(elapsed).count() / kIterations;
+    result.allocsPerLog = static_cast<double>(allocCount) / kIterations;
+    return result;
+}
+
+void report(const char* label, const Result& result) {
+    char line[160];
+    snprintf(line, sizeof(line), "%-34s %6.1f ns/call, %.2f allocations/call",
+             label, result.nsPerLog, result.allocsPerLog);
+    TEST_MESSAGE(line);
+}
+
+volatile size_t sink;
+
+void test_filtered_and_formatted_call_sites() {
+    Logger::init(10, LOG_INFO);
+    const char* topic = "device/01S00C123456789/report";
+
+    // BambuPrinter::mqttCallback's debug line, at the application's INFO level
+    Result eager = measureCall([topic](int) {
+        Logger::debug("Bambu", "MQTT message received on " + String(topic));
+    });
+    Result lazy = measureCall([topic](int) {
+        LOG_D("Bambu", "MQTT message received on " + String(topic));
+    });
+    Result lazyFormatted = measureCall([topic](int) {
+        LOG_DF("Bambu", "MQTT message received on %s", topic);
+    });
+
+    // Building an enabled line: operator+ chain against formatting into a stack buffer
+    String material = "PETG";
+    Result concatenated = measureCall([&material](int i) {
+        String message = "AMS Slot " + String(i & 3) + " (" + material + ") -> Valve " + String(i % 20) + " (" +
+                         ((i & 1) ? "PURE" : "MIXED") + ")";
+        sink = message.length();
+    });
+    Result formatted = measureCall([&material](int i) {
+        char message[LOG_QUEUE_MESSAGE_BYTES];
+        sink = snprintf(message, sizeof(message), "AMS Slot %d (%s) -> Valve %d (%s)", i & 3, material.c_str(),
+                        i % 20, (i & 1) ? "PURE" : "MIXED");
+    });
+
+    report("filtered, argument built first", eager);
+    report("filtered, LOG_D", lazy);
+    report("filtered, LOG_DF", lazyFormatted);
+    report("message by String operator+", concatenated);
+    report("message by snprintf to stack", formatted);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, static_cast<float>(lazy.allocsPerLog));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, static_cast<float>(lazyFormatted.allocsPerLog));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, static_cast<float>(formatted.allocsPerLog));
+    TEST_ASSERT_TRUE(eager.allocsPerLog >= 1.0);
+    TEST_ASSERT_TRUE(lazy.nsPerLog < eager.nsPerLog);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_arena_vs_legacy_store);
+    RUN_TEST(test_filtered_and_formatted_call_sites);
+    return UNITY_END();
+}
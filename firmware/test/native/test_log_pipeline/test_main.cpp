@@ -0,0 +1,114 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <Logger.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Host test for Logger's background drain: several producer threads log at once while
+// the log task prints, stores and transmits.
+
+namespace {
+const int kProducers = 4;
+const int kLinesPerProducer = 40;
+
+void produce(int producer, int lines) {
+    for (int i = 0; i < lines; i++) {
+        LOG_I("P" + String(producer), String(i));
+    }
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_producers_interleave_without_loss_or_reordering() {
+    Logger::setTransmitCallback(nullptr);
+    Logger::init(1000, LOG_INFO);
+    TEST_ASSERT_TRUE(Logger::startDrainTask());
+    TEST_ASSERT_TRUE(Logger::flush());
+    Logger::clearLogs();
+    uint32_t droppedBefore = Logger::getDroppedCount();
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.push_back(std::thread(produce, p, kLinesPerProducer));
+        // Stagger the starts so the queue, not the scheduler, sets the pace
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    TEST_ASSERT_TRUE(Logger::flush());
+
+    // Every line is either stored, in per-producer order, or counted as dropped
+    int next[kProducers] = {};
+    size_t stored = 0;
+    size_t notes = 0;
+    for (Logger::Ring::Record record : Logger::getRing()) {
+        if (strcmp(record.component, "Logger") == 0) {
+            notes++;
+            continue;
+        }
+        int producer = record.component[1] - '0';
+        int line = atoi(record.message);
+        TEST_ASSERT_TRUE(producer >= 0 && producer < kProducers);
+        TEST_ASSERT_TRUE(line >= next[producer]);
+        next[producer] = line + 1;
+        stored++;
+    }
+    uint32_t dropped = Logger::getDroppedCount() - droppedBefore;
+    TEST_ASSERT_EQUAL(kProducers * kLinesPerProducer, stored + dropped);
+    TEST_ASSERT_EQUAL(dropped > 0 ? 1 : 0, notes > 0 ? 1 : 0);
+}
+
+void test_full_queue_drops_instead_of_blocking() {
+    // Stall the log task inside the transmit callback, then flood the queue
+    std::atomic<bool> release(false);
+    std::atomic<bool> stalled(false);
+    Logger::setTransmitCallback([&](const String&) {
+        stalled = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    Logger::init(1000, LOG_INFO);
+    TEST_ASSERT_TRUE(Logger::flush());
+
+    // Long lines fill the arena, which triggers the transmit
+    String filler;
+    while (filler.length() < LOG_QUEUE_MESSAGE_BYTES - 1) {
+        filler += "x";
+    }
+    unsigned long start = millis();
+    while (!stalled && millis() - start < 1000) {
+        LOG_I("Fill", filler);
+        delay(1);
+    }
+    TEST_ASSERT_TRUE(stalled);
+
+    uint32_t droppedBefore = Logger::getDroppedCount();
+    start = millis();
+    produce(1, 4 * LOG_QUEUE_DEPTH);
+    TEST_ASSERT_TRUE(millis() - start < 500);
+    TEST_ASSERT_TRUE(Logger::getDroppedCount() - droppedBefore >= 3 * LOG_QUEUE_DEPTH);
+
+    release = true;
+    TEST_ASSERT_TRUE(Logger::flush());
+
+    // The drop is reported in the log itself
+    bool reported = false;
+    for (Logger::Ring::Record record : Logger::getRing()) {
+        if (strcmp(record.component, "Logger") == 0 && strstr(record.message, "dropped")) {
+            reported = true;
+        }
+    }
+    TEST_ASSERT_TRUE(reported);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_producers_interleave_without_loss_or_reordering);
+    RUN_TEST(test_full_queue_drops_instead_of_blocking);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <LogSpill.h>
+#include <Logger.h>
+#include <SPIFFS.h>
+#include <string>
+
+// Host test for the log spill: segments on the SPIFFS shim, which maps the partition
+// onto a scratch directory, so "rebooting" is constructing a second LogSpill over it.
+
+namespace {
+SPIFFSFS flash(".pio/test_log_spill_fs");
+Logger::Ring source;
+
+// Stage lines seq..seq + count - 1 from a scratch ring and commit them as one batch
+void spill(LogSpill& spill, uint32_t count, const char* text = "line") {
+    for (uint32_t i = 0; i < count; i++) {
+        char message[Logger::Ring::kMaxMessage + 1];
+        int length = snprintf(message, sizeof(message), "%s %u", text, static_cast<unsigned>(source.getNextSequence()));
+        source.append(LOG_INFO, "Test", message, length, millis());
+    }
+    for (Logger::Ring::Record record : source) {
+        if (!spill.write(record)) {
+            spill.commit();
+            TEST_ASSERT_TRUE(spill.write(record));
+        }
+    }
+    spill.commit();
+    source.clear();
+}
+
+class StringOut : public Print {
+public:
+    std::string text;
+
+    size_t write(uint8_t c) override {
+        text += static_cast<char>(c);
+        return 1;
+    }
+};
+
+uint32_t fieldValue(const std::string& json, const char* field) {
+    size_t at = json.find(std::string("\"") + field + "\":");
+    return at == std::string::npos ? UINT32_MAX : strtoul(json.c_str() + at + strlen(field) + 3, nullptr, 10);
+}
+}
+
+void setUp(void) {
+    TEST_ASSERT_TRUE(flash.begin(true));
+    flash.format();
+    source.clear();
+    source.renumber(0);
+}
+
+void tearDown(void) {}
+
+void test_lines_survive_a_reboot() {
+    {
+        LogSpill before(flash);
+        TEST_ASSERT_EQUAL_UINT32(0, before.begin());
+        spill(before, 10);
+        TEST_ASSERT_EQUAL_UINT32(10, before.getNextSequence());
+    }
+
+    LogSpill after(flash);
+    TEST_ASSERT_EQUAL_UINT32(10, after.begin());
+    StringOut out;
+    TEST_ASSERT_EQUAL_UINT32(10, after.writeJson(out));
+    TEST_ASSERT_EQUAL_UINT32(10, fieldValue(out.text, "log_count"));
+    TEST_ASSERT_TRUE(out.text.find("\"message\":\"line 9\"") != std::string::npos);
+
+    // Each boot starts a fresh segment rather than appending after a possibly torn tail
+    source.renumber(10);
+    spill(after, 5);
+    TEST_ASSERT_EQUAL(2, after.getSegmentCount());
+}
+
+void test_range_read_starts_at_since() {
+    LogSpill log(flash);
+    log.begin();
+    // Big enough lines that the history spans several segments
+    std::string filler(200, 'x');
+    for (int batch = 0; batch < 40; batch++) {
+        spill(log, 10, filler.c_str());
+    }
+    TEST_ASSERT_TRUE(log.getSegmentCount() > 2);
+
+    StringOut out;
+    uint32_t next = log.writeJson(out, 395, 3);
+    TEST_ASSERT_EQUAL_UINT32(398, next);
+    TEST_ASSERT_EQUAL_UINT32(3, fieldValue(out.text, "log_count"));
+    TEST_ASSERT_EQUAL_UINT32(395, fieldValue(out.text, "seq"));
+    TEST_ASSERT_EQUAL_UINT32(0, fieldValue(out.text, "missed"));
+}
+
+void test_oldest_segment_rotates_out() {
+    LogSpill log(flash);
+    log.begin();
+    std::string filler(250, 'y');
+    uint32_t lines = 0;
+    while (log.getOldestSequence() == 0 && lines < 10000) {
+        spill(log, 10, filler.c_str());
+        lines += 10;
+    }
+    TEST_ASSERT_TRUE(log.getOldestSequence() > 0);
+    TEST_ASSERT_EQUAL(LOG_SPILL_SEGMENTS, log.getSegmentCount());
+    TEST_ASSERT_TRUE(flash.usedBytes() <= LOG_SPILL_SEGMENTS * LOG_SPILL_SEGMENT_BYTES);
+
+    // Asking for what was rotated out reports the gap and carries on from the oldest line
+    StringOut out;
+    log.writeJson(out, 0, 1);
+    TEST_ASSERT_EQUAL_UINT32(log.getOldestSequence(), fieldValue(out.text, "missed"));
+    TEST_ASSERT_EQUAL_UINT32(log.getOldestSequence(), fieldValue(out.text, "seq"));
+}
+
+void test_torn_record_is_dropped_by_crc() {
+    {
+        LogSpill before(flash);
+        before.begin();
+        spill(before, 8);
+    }
+
+    // Flip a byte in the last record's message, as a reset in mid-write could leave it
+    File root = flash.open("/");
+    File segment = root.openNextFile();
+    TEST_ASSERT_TRUE(segment);
+    std::string path = segment.path();
+    std::string bytes(segment.size(), '\0');
+    segment.read(reinterpret_cast<uint8_t*>(&bytes[0]), bytes.size());
+    segment.close();
+    root.close();
+    bytes[bytes.size() - 1] ^= 0x20;
+    File file = flash.open(path.c_str(), FILE_WRITE);
+    file.write(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    file.close();
+
+    LogSpill after(flash);
+    TEST_ASSERT_EQUAL_UINT32(7, after.begin());
+    TEST_ASSERT_EQUAL_UINT32(1, after.getCorruptRecords());
+    StringOut out;
+    TEST_ASSERT_EQUAL_UINT32(7, after.writeJson(out));
+    TEST_ASSERT_EQUAL_UINT32(7, fieldValue(out.text, "log_count"));
+}
+
+void test_logger_spills_before_the_ring_overwrites() {
+    LogSpill log(flash);
+    Logger::setTransmitCallback(nullptr);
+    Logger::init(20, LOG_INFO);
+    Logger::attachSink(&log, log.begin());
+    for (int i = 0; i < 100; i++) {
+        LOG_IF("Spill", "line %d", i);
+    }
+    TEST_ASSERT_TRUE(Logger::flush());
+
+    // The ring only holds the last 20, the flash has all of them
+    TEST_ASSERT_TRUE(Logger::getLogCount() <= 20);
+    StringOut out;
+    log.writeJson(out);
+    TEST_ASSERT_TRUE(out.text.find("\"message\":\"line 0\"") != std::string::npos);
+    TEST_ASSERT_TRUE(out.text.find("\"message\":\"line 99\"") != std::string::npos);
+    TEST_ASSERT_EQUAL_UINT32(0, fieldValue(out.text, "missed"));
+    Logger::attachSink(nullptr, 0);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lines_survive_a_reboot);
+    RUN_TEST(test_range_read_starts_at_since);
+    RUN_TEST(test_oldest_segment_rotates_out);
+    RUN_TEST(test_torn_record_is_dropped_by_crc);
+    RUN_TEST(test_logger_spills_before_the_ring_overwrites);
+    return UNITY_END();
+}
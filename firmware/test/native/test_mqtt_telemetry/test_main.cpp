@@ -0,0 +1,243 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <Config.h>
+#include <LoopbackServer.h>
+#include <UpdateClient.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Host test for telemetry over MQTT: a broker stand-in on a loopback socket that records
+// what the controller connects with and publishes, and can ack alerts or drop the session
+// the way a restarted mosquitto would.
+
+namespace {
+struct Published {
+    std::string topic;
+    std::string payload;
+    bool retained;
+};
+
+class FakeBroker {
+public:
+    FakeBroker()
+        : sessions(0)
+        , willRetained(false)
+        , willQos(0)
+        , server([this](int fd) { serve(fd); }) {
+    }
+
+    String broker() const { return server.getAddress(); }
+
+    // Publish to the controller, as the desktop would through the broker
+    void publish(const std::string& topic, const std::string& payload) {
+        std::string packet;
+        packet += static_cast<char>(0x30);
+        packet += static_cast<char>(2 + topic.size() + payload.size());
+        packet += static_cast<char>(topic.size() >> 8);
+        packet += static_cast<char>(topic.size() & 0xFF);
+        packet += topic;
+        packet += payload;
+        server.send(packet.data(), packet.size());
+    }
+
+    void drop() { server.drop(); }
+
+    std::vector<Published> on(const std::string& topic) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Published> matching;
+        for (const Published& message : published) {
+            if (message.topic == topic) matching.push_back(message);
+        }
+        return matching;
+    }
+
+    int sessions;
+    std::string willTopic;
+    std::string willMessage;
+    bool willRetained;
+    int willQos;
+    std::string subscribed;
+
+private:
+    static std::string takeString(const std::string& body, size_t& at) {
+        size_t length = (static_cast<uint8_t>(body[at]) << 8) | static_cast<uint8_t>(body[at + 1]);
+        std::string value = body.substr(at + 2, length);
+        at += 2 + length;
+        return value;
+    }
+
+    void serve(int fd) {
+        for (;;) {
+            uint8_t header;
+            if (!LoopbackServer::readExact(fd, &header, 1)) return;
+            uint32_t length = 0;
+            uint8_t digit;
+            int shift = 0;
+            do {
+                if (!LoopbackServer::readExact(fd, &digit, 1)) return;
+                length |= static_cast<uint32_t>(digit & 0x7F) << shift;
+                shift += 7;
+            } while (digit & 0x80);
+            std::string body(length, '\0');
+            if (length && !LoopbackServer::readExact(fd, reinterpret_cast<uint8_t*>(&body[0]), length)) return;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            switch (header >> 4) {
+                case 1: {  // CONNECT
+                    size_t at = 0;
+                    takeString(body, at);  // Protocol name
+                    at++;                  // Level
+                    uint8_t flags = body[at];
+                    at += 3;               // Flags, keep-alive
+                    takeString(body, at);  // Client id
+                    if (flags & 0x04) {
+                        willTopic = takeString(body, at);
+                        willMessage = takeString(body, at);
+                        willQos = (flags >> 3) & 0x03;
+                        willRetained = (flags & 0x20) != 0;
+                    }
+                    sessions++;
+                    const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+                    server.send(connack, sizeof(connack));
+                    break;
+                }
+                case 3: {  // PUBLISH (QoS 0)
+                    size_t at = 0;
+                    Published message;
+                    message.topic = takeString(body, at);
+                    message.payload = body.substr(at);
+                    message.retained = (header & 0x01) != 0;
+                    published.push_back(message);
+                    break;
+                }
+                case 8: {  // SUBSCRIBE
+                    size_t at = 2;
+                    subscribed = takeString(body, at);
+                    const uint8_t suback[] = {0x90, 0x03, static_cast<uint8_t>(body[0]), static_cast<uint8_t>(body[1]), 0x00};
+                    server.send(suback, sizeof(suback));
+                    break;
+                }
+                case 12: {  // PINGREQ
+                    const uint8_t pingresp[] = {0xD0, 0x00};
+                    server.send(pingresp, sizeof(pingresp));
+                    break;
+                }
+                case 14:  // DISCONNECT
+                    return;
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<Published> published;
+    LoopbackServer server;   // Last, so its thread is gone before the rest
+};
+
+// Nothing listens on port 1: every POST fails, so anything delivered went over MQTT
+const char kNoDesktop[] = "http://127.0.0.1:1";
+
+template <typename Done>
+bool runUntil(UpdateClient& client, unsigned long timeoutMs, Done done) {
+    unsigned long start = millis();
+    while (!done() && millis() - start < timeoutMs) {
+        client.loop();
+        delay(NETWORK_TASK_PERIOD_MS);
+    }
+    return done();
+}
+
+void queueAlert(UpdateClient& client, const char* type) {
+    JsonDocument alert;
+    alert["type"] = type;
+    client.queueAlert(alert);
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_session_announces_presence_and_retains_status() {
+    FakeBroker broker;
+    UpdateClient client;
+    TEST_ASSERT_TRUE(client.init(kNoDesktop, "dev1:secret", "dev1"));
+    TEST_ASSERT_TRUE(client.attachBroker(broker.broker()));
+    TEST_ASSERT_TRUE(client.isPublishing());
+
+    TEST_ASSERT_EQUAL_STRING("regain3d/dev1/presence", broker.willTopic.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"online\":false}", broker.willMessage.c_str());
+    TEST_ASSERT_TRUE(broker.willRetained);
+    TEST_ASSERT_EQUAL(1, broker.willQos);
+    TEST_ASSERT_EQUAL_STRING("regain3d/dev1/ack", broker.subscribed.c_str());
+
+    JsonDocument status;
+    status["state"] = "RUNNING";
+    status["progress"] = 42;
+    client.queueStatusUpdate(status, true);
+    TEST_ASSERT_TRUE(runUntil(client, 2000, [&]() { return broker.on("regain3d/dev1/status").size() == 1; }));
+    TEST_ASSERT_FALSE(client.hasPending());
+
+    std::vector<Published> presence = broker.on("regain3d/dev1/presence");
+    TEST_ASSERT_EQUAL(1, presence.size());
+    TEST_ASSERT_TRUE(presence[0].retained);
+    TEST_ASSERT_TRUE(presence[0].payload.find("\"online\":true") != std::string::npos);
+
+    std::vector<Published> published = broker.on("regain3d/dev1/status");
+    TEST_ASSERT_EQUAL(1, published.size());
+    TEST_ASSERT_TRUE(published[0].retained);
+    TEST_ASSERT_TRUE(published[0].payload.find("\"progress\":42") != std::string::npos);
+    TEST_ASSERT_EQUAL(0, client.getConnectionStats().requests);
+    TEST_ASSERT_EQUAL(0, client.getConsecutiveFailures());
+}
+
+void test_alert_stays_queued_until_acked() {
+    FakeBroker broker;
+    UpdateClient client;
+    TEST_ASSERT_TRUE(client.init(kNoDesktop, "dev1:secret", "dev1"));
+    TEST_ASSERT_TRUE(client.attachBroker(broker.broker()));
+
+    queueAlert(client, "filament_low");
+    TEST_ASSERT_TRUE(runUntil(client, 2000, [&]() { return broker.on("regain3d/dev1/alerts").size() == 1; }));
+    std::vector<Published> alerts = broker.on("regain3d/dev1/alerts");
+    TEST_ASSERT_FALSE(alerts[0].retained);
+    TEST_ASSERT_TRUE(alerts[0].payload.find("\"seq\":0,\"body\":{") == 1);
+    TEST_ASSERT_TRUE(alerts[0].payload.find("filament_low") != std::string::npos);
+
+    // Published once, then held for the ack
+    runUntil(client, 1000, []() { return false; });
+    TEST_ASSERT_TRUE(client.hasPending());
+    TEST_ASSERT_EQUAL(1, broker.on("regain3d/dev1/alerts").size());
+
+    broker.publish("regain3d/dev1/ack", "0");
+    TEST_ASSERT_TRUE(runUntil(client, 2000, [&]() { return !client.hasPending(); }));
+    TEST_ASSERT_EQUAL(1, broker.on("regain3d/dev1/alerts").size());
+}
+
+void test_unacked_alert_is_published_again_on_a_new_session() {
+    FakeBroker broker;
+    UpdateClient client;
+    TEST_ASSERT_TRUE(client.init(kNoDesktop, "dev1:secret", "dev1"));
+    TEST_ASSERT_TRUE(client.attachBroker(broker.broker()));
+
+    queueAlert(client, "print_error");
+    TEST_ASSERT_TRUE(runUntil(client, 2000, [&]() { return broker.on("regain3d/dev1/alerts").size() == 1; }));
+
+    // The broker restarts before the desktop acked; the session comes back on its own
+    broker.drop();
+    TEST_ASSERT_TRUE(runUntil(client, 15000, [&]() { return broker.on("regain3d/dev1/alerts").size() == 2; }));
+    TEST_ASSERT_EQUAL(2, broker.sessions);
+    TEST_ASSERT_EQUAL(2, broker.on("regain3d/dev1/presence").size());
+    TEST_ASSERT_EQUAL(2, client.getMqttStats().sessions);
+
+    broker.publish("regain3d/dev1/ack", "0");
+    TEST_ASSERT_TRUE(runUntil(client, 2000, [&]() { return !client.hasPending(); }));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_session_announces_presence_and_retains_status);
+    RUN_TEST(test_alert_stays_queued_until_acked);
+    RUN_TEST(test_unacked_alert_is_published_again_on_a_new_session);
+    return UNITY_END();
+}
@@ -0,0 +1,282 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <HTTPClient.h>
+#include <Logger.h>
+#include <MotorController.h>
+#include <Preferences.h>
+#include <PubSubClient.h>
+#include <WiFi.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// One-shot loopback server: accepts a single connection and hands it to a handler thread
+class LoopbackServer {
+public:
+    template <typename Handler>
+    explicit LoopbackServer(Handler handler) : port(0) {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t length = sizeof(addr);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &length);
+        port = ntohs(addr.sin_port);
+        listen(listenFd, 1);
+        worker = std::thread([this, handler]() {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd >= 0) {
+                handler(fd);
+                close(fd);
+            }
+        });
+    }
+
+    ~LoopbackServer() {
+        worker.join();
+        close(listenFd);
+    }
+
+    uint16_t port;
+
+private:
+    int listenFd;
+    std::thread worker;
+};
+
+static std::string readUntil(int fd, const char* marker) {
+    std::string data;
+    char c;
+    while (data.find(marker) == std::string::npos && recv(fd, &c, 1, 0) == 1) {
+        data += c;
+    }
+    return data;
+}
+
+static bool readExact(int fd, uint8_t* buffer, size_t length) {
+    size_t got = 0;
+    while (got < length) {
+        ssize_t n = recv(fd, buffer + got, length - got, 0);
+        if (n <= 0) return false;
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Reads one MQTT packet; returns its type nibble, or -1 on EOF
+static int readMqttPacket(int fd, std::string& body) {
+    uint8_t header;
+    if (!readExact(fd, &header, 1)) return -1;
+    uint32_t length = 0;
+    uint8_t digit;
+    int shift = 0;
+    do {
+        if (!readExact(fd, &digit, 1)) return -1;
+        length |= static_cast<uint32_t>(digit & 0x7F) << shift;
+        shift += 7;
+    } while (digit & 0x80);
+    body.assign(length, '\0');
+    if (length && !readExact(fd, reinterpret_cast<uint8_t*>(&body[0]), length)) return -1;
+    return header >> 4;
+}
+
+void test_string_basics() {
+    String s("Hello");
+    s += ", ";
+    s += 42;
+    TEST_ASSERT_EQUAL_STRING("Hello, 42", s.c_str());
+    TEST_ASSERT_EQUAL(7, s.indexOf("42"));
+    TEST_ASSERT_TRUE(s.startsWith("Hell"));
+    TEST_ASSERT_EQUAL_STRING("42", s.substring(7).c_str());
+    TEST_ASSERT_EQUAL(42, s.substring(7).toInt());
+    TEST_ASSERT_EQUAL_STRING("ff", String(255, HEX).c_str());
+    TEST_ASSERT_EQUAL_STRING("1.50", String(1.5f).c_str());
+
+    String padded("  trim me \n");
+    padded.trim();
+    TEST_ASSERT_EQUAL_STRING("trim me", padded.c_str());
+    padded.replace("me", "you");
+    TEST_ASSERT_TRUE(padded == "trim you");
+}
+
+void test_preferences_persist_across_instances() {
+    {
+        Preferences prefs;
+        TEST_ASSERT_TRUE(prefs.begin("native_test"));
+        prefs.clear();
+        prefs.putInt("count", 7);
+        prefs.putString("name", "valve");
+        prefs.end();
+    }
+    Preferences prefs;
+    TEST_ASSERT_TRUE(prefs.begin("native_test", true));
+    TEST_ASSERT_EQUAL(7, prefs.getInt("count", 0));
+    TEST_ASSERT_EQUAL_STRING("valve", prefs.getString("name", "").c_str());
+    TEST_ASSERT_EQUAL(3, prefs.getInt("missing", 3));
+    TEST_ASSERT_FALSE(prefs.isKey("missing"));
+    prefs.end();
+}
+
+void test_logger_json() {
+    Logger::init(4, LOG_INFO);
+    Logger::info("Native", "hello from the host");
+    Logger::debug("Native", "filtered out");
+    TEST_ASSERT_EQUAL(2, Logger::getLogCount()); // Includes the init message
+
+    String json = Logger::getLogsAsJson();
+    TEST_ASSERT_TRUE(json.indexOf("hello from the host") >= 0);
+    TEST_ASSERT_TRUE(json.indexOf("filtered out") < 0);
+    Logger::clearLogs();
+}
+
+void test_http_get_chunked() {
+    LoopbackServer server([](int fd) {
+        std::string request = readUntil(fd, "\r\n\r\n");
+        if (request.find("GET /status HTTP/1.1") != 0) return;
+        const char* response =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/json\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "6\r\n{\"ok\":\r\n"
+            "5\r\ntrue}\r\n"
+            "0\r\n\r\n";
+        send(fd, response, strlen(response), 0);
+    });
+
+    HTTPClient http;
+    TEST_ASSERT_TRUE(http.begin("http://127.0.0.1:" + String(server.port) + "/status"));
+    TEST_ASSERT_EQUAL(200, http.GET());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":true}", http.getString().c_str());
+    http.end();
+}
+
+void test_http_connection_refused() {
+    HTTPClient http;
+    http.setConnectTimeout(500);
+    TEST_ASSERT_TRUE(http.begin("http://127.0.0.1:1/"));
+    TEST_ASSERT_TRUE(http.GET() < 0);
+    http.end();
+}
+
+void test_mqtt_connect_publish_receive() {
+    std::string published;
+    LoopbackServer broker([&published](int fd) {
+        std::string body;
+        if (readMqttPacket(fd, body) != 1) return; // CONNECT
+        const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+        send(fd, connack, sizeof(connack), 0);
+
+        if (readMqttPacket(fd, body) != 8) return; // SUBSCRIBE
+        const uint8_t suback[] = { 0x90, 0x03, static_cast<uint8_t>(body[0]), static_cast<uint8_t>(body[1]), 0x00 };
+        send(fd, suback, sizeof(suback), 0);
+
+        if (readMqttPacket(fd, body) != 3) return; // PUBLISH
+        published = body;
+
+        // Echo a message on the subscribed topic, then wait for the client to hang up
+        const char topic[] = "device/cmd";
+        const char payload[] = "move";
+        std::string packet;
+        packet += static_cast<char>(0x30);
+        packet += static_cast<char>(2 + strlen(topic) + strlen(payload));
+        packet += '\0';
+        packet += static_cast<char>(strlen(topic));
+        packet += topic;
+        packet += payload;
+        send(fd, packet.data(), packet.size(), 0);
+        while (readMqttPacket(fd, body) >= 0 && body.size() != 0) {
+        }
+    });
+
+    static String receivedTopic;
+    static String receivedPayload;
+    WiFiClient net;
+    PubSubClient mqtt(net);
+    mqtt.setServer("127.0.0.1", broker.port);
+    mqtt.setCallback([](char* topic, uint8_t* payload, unsigned int length) {
+        receivedTopic = topic;
+        receivedPayload = String(reinterpret_cast<const char*>(payload), length);
+    });
+
+    TEST_ASSERT_TRUE(mqtt.connect("native-test"));
+    TEST_ASSERT_TRUE(mqtt.subscribe("device/cmd"));
+    TEST_ASSERT_TRUE(mqtt.publish("device/status", "idle"));
+
+    unsigned long start = millis();
+    while (receivedPayload.length() == 0 && millis() - start < 2000) {
+        mqtt.loop();
+        delay(1);
+    }
+    mqtt.disconnect();
+
+    TEST_ASSERT_EQUAL_STRING("device/cmd", receivedTopic.c_str());
+    TEST_ASSERT_EQUAL_STRING("move", receivedPayload.c_str());
+    TEST_ASSERT_TRUE(published.find("device/status") != std::string::npos);
+    TEST_ASSERT_TRUE(published.find("idle") != std::string::npos);
+}
+
+void test_motor_state_machine() {
+    MotorController motor(MOTOR_STEP_PIN, MOTOR_DIRECTION_PIN, MOTOR_ROW_PINS, MOTOR_COL_PINS);
+    TEST_ASSERT_TRUE(motor.begin());
+    TEST_ASSERT_EQUAL(MotorController::IDLE, motor.getState());
+
+    TEST_ASSERT_FALSE(motor.moveToPosition(0));
+    TEST_ASSERT_FALSE(motor.isBusy());
+
+    // A queued move wakes the motion task and counts as busy before loop() applies it
+    motor.setWakeTask(xTaskGetCurrentTaskHandle());
+    TEST_ASSERT_TRUE(motor.moveToPosition(3));
+    TEST_ASSERT_EQUAL(MotorController::IDLE, motor.getState());
+    TEST_ASSERT_TRUE(motor.isBusy());
+    TEST_ASSERT_EQUAL(1, ulTaskNotifyTake(pdTRUE, 0));
+    motor.loop();
+    TEST_ASSERT_EQUAL(MotorController::SEEKING, motor.getState());
+    TEST_ASSERT_TRUE(motor.isBusy());
+
+    // No sensor ever trips on the host, so the motor seeks blind until stopped
+    for (int i = 0; i < 20; i++) {
+        motor.loop();
+        delay(1);
+    }
+    TEST_ASSERT_EQUAL(MotorController::SEEKING, motor.getState());
+
+    TEST_ASSERT_TRUE(motor.stop());
+    motor.loop();
+    TEST_ASSERT_EQUAL(MotorController::IDLE, motor.getState());
+    TEST_ASSERT_FALSE(motor.isBusy());
+    motor.setWakeTask(nullptr);
+
+    MotorController::Event event;
+    int stateChanges = 0;
+    while (motor.pollEvent(event)) {
+        if (event.type == MotorController::Event::STATE_CHANGED) stateChanges++;
+    }
+    TEST_ASSERT_EQUAL(2, stateChanges);
+
+    MotorController::MoveReport report = motor.getLastMove();
+    TEST_ASSERT_FALSE(report.completed);
+    TEST_ASSERT_EQUAL(3, report.to);
+    TEST_ASSERT_TRUE(report.actualSteps > 0);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_string_basics);
+    RUN_TEST(test_preferences_persist_across_instances);
+    RUN_TEST(test_logger_json);
+    RUN_TEST(test_http_get_chunked);
+    RUN_TEST(test_http_connection_refused);
+    RUN_TEST(test_mqtt_connect_publish_receive);
+    RUN_TEST(test_motor_state_machine);
+    return UNITY_END();
+}
@@ -0,0 +1,190 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <Config.h>
+#include <PayloadEncoding.h>
+#include <chrono>
+#include <string>
+
+// Host comparison of the two upload encodings on representative documents: bytes on the
+// wire and the time ArduinoJson takes to write them, plus the negotiation helpers.
+
+namespace {
+// Roughly ApplicationManager::enqueueStatusUpdate's document
+void representativeStatus(JsonDocument& doc) {
+    doc["device_id"] = "A1B2C3D4E5F6";
+    doc["timestamp"] = 123456;
+    doc["state"] = "RUNNING";
+    doc["uptime_ms"] = 123456;
+    doc["free_heap_percent"] = 61.5;
+    doc["connected"] = true;
+    doc["ip_address"] = "192.168.1.57";
+    doc["assigned"] = true;
+    doc["motor_state"] = 0;
+    doc["motor_position"] = 7;
+    doc["motor_loop_max_us"] = 212;
+    doc["motor_loop_last_us"] = 35;
+    doc["http_requests"] = 4211;
+    doc["http_reused"] = 4180;
+    doc["http_latency_ms"] = 18;
+    doc["http_latency_max_ms"] = 412;
+    doc["queued_alerts"] = 0;
+    doc["alerts_dropped"] = 0;
+    doc["log_chunks_dropped"] = 0;
+    doc["printer_state"] = "PRINTING";
+    doc["progress"] = 42;
+    doc["current_layer"] = 118;
+    doc["total_layers"] = 300;
+    doc["remaining_time_s"] = 5400;
+    doc["current_material"] = "PLA Basic";
+    doc["print_error"] = 0;
+    doc["printer_connected"] = true;
+    doc["printer_id"] = "01S00C123456789";
+    doc["printer_brand"] = "Bambu Lab";
+    doc["printer_model"] = "X1C";
+    doc["printer_name"] = "Farm 12";
+}
+
+// ApplicationManager::handlePrinterAlert's document
+void representativeAlert(JsonDocument& doc) {
+    doc["timestamp"] = 987654;
+    doc["device_id"] = "A1B2C3D4E5F6";
+    doc["printer_type"] = "BAMBU_LAB";
+    doc["printer_id"] = "01S00C123456789";
+    doc["printer_brand"] = "Bambu Lab";
+    doc["printer_model"] = "X1C";
+    doc["alert_level"] = 2;
+    doc["message"] = "Filament low";
+    doc["details"] = "AMS slot 3 at 8%";
+}
+
+// BambuPrinter::getStatusJson's document, with a full AMS
+void representativePrinterStatus(JsonDocument& doc) {
+    doc["connected"] = true;
+    doc["printer_type"] = "BAMBU_LAB";
+    doc["serial_number"] = "01S00C123456789";
+    doc["state"] = "PRINTING";
+    doc["progress"] = 42;
+    doc["current_layer"] = 118;
+    doc["total_layers"] = 300;
+    doc["remaining_time"] = 5400;
+    doc["current_material"] = "PLA Basic";
+    JsonObject ams = doc["ams"].to<JsonObject>();
+    ams["active_slot"] = 1;
+    ams["status"] = "idle";
+    JsonArray slots = ams["slots"].to<JsonArray>();
+    for (int i = 0; i < 4; i++) {
+        JsonObject slot = slots.add<JsonObject>();
+        slot["id"] = i;
+        slot["material"] = "PLA";
+        slot["remaining"] = 90 - i * 20;
+    }
+    doc["active_valve"] = 2;
+}
+
+struct Measurement {
+    size_t jsonBytes;
+    size_t packBytes;
+    double jsonUs;
+    double packUs;
+};
+
+Measurement measure(const JsonDocument& doc) {
+    const int rounds = 2000;
+    Measurement result = {};
+    std::string out;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        out.clear();
+        result.jsonBytes = serializeJson(doc, out);
+    }
+    result.jsonUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        out.clear();
+        result.packBytes = serializeMsgPack(doc, out);
+    }
+    result.packUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+    return result;
+}
+
+void report(const char* name, const Measurement& m) {
+    char line[160];
+    snprintf(line, sizeof(line), "%-15s JSON %4u bytes %6.2f us | MessagePack %4u bytes (%.0f%%) %6.2f us",
+             name, static_cast<unsigned>(m.jsonBytes), m.jsonUs, static_cast<unsigned>(m.packBytes),
+             100.0 * m.packBytes / m.jsonBytes, m.packUs);
+    TEST_MESSAGE(line);
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_message_pack_is_smaller_on_every_payload() {
+    JsonDocument status;
+    representativeStatus(status);
+    JsonDocument alert;
+    representativeAlert(alert);
+    JsonDocument printer;
+    representativePrinterStatus(printer);
+
+    Measurement statusSize = measure(status);
+    Measurement alertSize = measure(alert);
+    Measurement printerSize = measure(printer);
+    report("/updates", statusSize);
+    report("/alerts", alertSize);
+    report("/status (AMS)", printerSize);
+
+    TEST_ASSERT_TRUE(statusSize.packBytes < statusSize.jsonBytes);
+    TEST_ASSERT_TRUE(alertSize.packBytes < alertSize.jsonBytes);
+    TEST_ASSERT_TRUE(printerSize.packBytes < printerSize.jsonBytes);
+    // Status uploads are all the device sends between events; they must fit the cap
+    TEST_ASSERT_TRUE(statusSize.jsonBytes <= UPLOAD_MSGPACK_MAX_BYTES);
+}
+
+void test_queued_json_transcodes_to_the_same_document() {
+    // UpdateClient keeps JSON text and re-encodes it when the desktop wants MessagePack
+    JsonDocument original;
+    representativePrinterStatus(original);
+    std::string text;
+    serializeJson(original, text);
+
+    JsonDocument parsed;
+    TEST_ASSERT_FALSE(deserializeJson(parsed, text));
+    std::string packed;
+    serializeMsgPack(parsed, packed);
+
+    std::string direct;
+    serializeMsgPack(original, direct);
+    TEST_ASSERT_TRUE(packed == direct);
+
+    JsonDocument back;
+    TEST_ASSERT_FALSE(deserializeMsgPack(back, packed));
+    std::string again;
+    serializeJson(back, again);
+    TEST_ASSERT_TRUE(again == text);
+}
+
+void test_negotiation_helpers() {
+    TEST_ASSERT_TRUE(acceptsMessagePack("application/msgpack, application/json"));
+    TEST_ASSERT_TRUE(acceptsMessagePack("Application/X-MsgPack"));
+    TEST_ASSERT_TRUE(acceptsMessagePack("application/json;q=0.5, application/vnd.msgpack"));
+    TEST_ASSERT_FALSE(acceptsMessagePack("application/json"));
+    TEST_ASSERT_FALSE(acceptsMessagePack(""));
+
+    TEST_ASSERT_TRUE(parsePayloadEncoding("msgpack") == PayloadEncoding::MESSAGE_PACK);
+    TEST_ASSERT_TRUE(parsePayloadEncoding("MsgPack") == PayloadEncoding::MESSAGE_PACK);
+    TEST_ASSERT_TRUE(parsePayloadEncoding("json") == PayloadEncoding::JSON);
+    TEST_ASSERT_TRUE(parsePayloadEncoding("cbor") == PayloadEncoding::JSON);
+    TEST_ASSERT_EQUAL_STRING("application/msgpack", payloadContentType(PayloadEncoding::MESSAGE_PACK));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_message_pack_is_smaller_on_every_payload);
+    RUN_TEST(test_queued_json_transcodes_to_the_same_document);
+    RUN_TEST(test_negotiation_helpers);
+    return UNITY_END();
+}
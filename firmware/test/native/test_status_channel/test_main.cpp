@@ -0,0 +1,169 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <Config.h>
+#include <StatusChannel.h>
+
+// Host test for the status frames: what a legacy desktop gets, what a sequence-tracking
+// desktop gets, and how a desktop that lost frames is brought back with a keyframe.
+
+namespace {
+String statusFields(int progress, int layer) {
+    JsonDocument doc;
+    doc["state"] = "RUNNING";
+    doc["free_heap_percent"] = 62;
+    doc["printer_state"] = "PRINTING";
+    doc["progress"] = progress;
+    doc["current_layer"] = layer;
+    doc["total_layers"] = 300;
+    doc["current_material"] = "PLA Basic";
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
+
+void sessionInfo(JsonDocument& doc) {
+    doc["device_id"] = "A1B2C3D4E5F6";
+    doc["firmware_version"] = FIRMWARE_VERSION;
+    doc["ip_address"] = "192.168.1.57";
+    doc["printer_id"] = "01S00C123456789";
+    doc["printer_model"] = "X1C";
+}
+
+JsonDocument parse(const String& body) {
+    JsonDocument doc;
+    deserializeJson(doc, body);
+    return doc;
+}
+
+// A channel whose first full document has been answered with X-Status-Seq
+void startTracking(StatusChannel& channel) {
+    JsonDocument session;
+    sessionInfo(session);
+    channel.setSessionInfo(session);
+    channel.encode(statusFields(0, 0), 1000);
+    channel.onResponse(true, true, 0);
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_legacy_desktop_gets_the_full_document() {
+    StatusChannel channel;
+    JsonDocument session;
+    sessionInfo(session);
+    channel.setSessionInfo(session);
+
+    for (int i = 0; i < 3; i++) {
+        JsonDocument doc = parse(channel.encode(statusFields(10 + i, 20 + i), 1000 + i));
+        channel.onResponse(true, true, -1);
+        TEST_ASSERT_TRUE(doc["seq"].isNull());
+        TEST_ASSERT_EQUAL_STRING("A1B2C3D4E5F6", doc["device_id"].as<const char*>());
+        TEST_ASSERT_EQUAL_STRING("X1C", doc["printer_model"].as<const char*>());
+        TEST_ASSERT_EQUAL(1000 + i, doc["timestamp"].as<long>());
+        TEST_ASSERT_EQUAL(10 + i, doc["progress"].as<int>());
+    }
+    TEST_ASSERT_FALSE(channel.isDeltaEnabled());
+}
+
+void test_deltas_carry_only_what_changed() {
+    StatusChannel channel;
+    startTracking(channel);
+    TEST_ASSERT_TRUE(channel.isDeltaEnabled());
+
+    // The first frame is a keyframe with every field and the session
+    JsonDocument keyframe = parse(channel.encode(statusFields(10, 20), 2000));
+    TEST_ASSERT_TRUE(keyframe["keyframe"].as<bool>());
+    TEST_ASSERT_EQUAL(7, keyframe["fields"].size());
+    TEST_ASSERT_EQUAL_STRING("A1B2C3D4E5F6", keyframe["session"]["device_id"].as<const char*>());
+    channel.onResponse(true, true, keyframe["seq"].as<long>());
+
+    JsonDocument delta = parse(channel.encode(statusFields(11, 21), 3000));
+    TEST_ASSERT_FALSE(delta["keyframe"].as<bool>());
+    TEST_ASSERT_EQUAL(keyframe["seq"].as<long>(), delta["base"].as<long>());
+    TEST_ASSERT_EQUAL(2, delta["fields"].size());
+    TEST_ASSERT_EQUAL(11, delta["fields"]["progress"].as<int>());
+    TEST_ASSERT_EQUAL(21, delta["fields"]["current_layer"].as<int>());
+    TEST_ASSERT_TRUE(delta["session"].isNull());
+    channel.onResponse(true, true, delta["seq"].as<long>());
+
+    // A field that disappears is listed, not resent
+    JsonDocument fields = parse(statusFields(11, 21));
+    fields.remove("current_material");
+    String json;
+    serializeJson(fields, json);
+    JsonDocument removal = parse(channel.encode(json, 4000));
+    TEST_ASSERT_EQUAL(0, removal["fields"].size());
+    TEST_ASSERT_EQUAL_STRING("current_material", removal["removed"][0].as<const char*>());
+
+    StatusChannel::Stats stats = channel.getStats();
+    TEST_ASSERT_EQUAL(1, stats.keyframes);
+    TEST_ASSERT_EQUAL(2, stats.deltas);
+    TEST_ASSERT_TRUE(stats.sentBytes < stats.fullBytes);
+}
+
+void test_gap_brings_back_a_keyframe_and_session() {
+    StatusChannel channel;
+    startTracking(channel);
+    JsonDocument keyframe = parse(channel.encode(statusFields(10, 20), 2000));
+    channel.onResponse(true, true, keyframe["seq"].as<long>());
+    channel.encode(statusFields(11, 21), 3000);
+
+    // The desktop restarted: it answers with 0 instead of the frame just sent
+    channel.onResponse(true, true, 0);
+    TEST_ASSERT_TRUE(channel.needsKeyframe());
+    TEST_ASSERT_TRUE(channel.hasLatest());
+    TEST_ASSERT_EQUAL(11, parse(channel.getLatest())["progress"].as<int>());
+    TEST_ASSERT_EQUAL(1, channel.getStats().gaps);
+
+    JsonDocument resync = parse(channel.encode(channel.getLatest(), 4000));
+    TEST_ASSERT_TRUE(resync["keyframe"].as<bool>());
+    TEST_ASSERT_EQUAL(7, resync["fields"].size());
+    TEST_ASSERT_FALSE(resync["session"].isNull());
+    channel.onResponse(true, true, resync["seq"].as<long>());
+    TEST_ASSERT_FALSE(channel.needsKeyframe());
+}
+
+void test_failed_request_is_not_a_gap() {
+    StatusChannel channel;
+    startTracking(channel);
+    JsonDocument keyframe = parse(channel.encode(statusFields(10, 20), 2000));
+    channel.onResponse(true, true, keyframe["seq"].as<long>());
+
+    // Lost in a 503; the next frame is still a delta against the acknowledged one
+    channel.encode(statusFields(11, 21), 3000);
+    channel.onResponse(false, true, keyframe["seq"].as<long>());
+    JsonDocument retry = parse(channel.encode(statusFields(12, 22), 3500));
+    TEST_ASSERT_FALSE(retry["keyframe"].as<bool>());
+    TEST_ASSERT_EQUAL(keyframe["seq"].as<long>(), retry["base"].as<long>());
+    TEST_ASSERT_EQUAL(0, channel.getStats().gaps);
+}
+
+void test_keyframe_every_interval() {
+    StatusChannel channel;
+    startTracking(channel);
+    JsonDocument first = parse(channel.encode(statusFields(10, 20), 2000));
+    channel.onResponse(true, true, first["seq"].as<long>());
+
+    JsonDocument early = parse(channel.encode(statusFields(10, 20), 2000 + STATUS_KEYFRAME_INTERVAL_MS - 1));
+    TEST_ASSERT_FALSE(early["keyframe"].as<bool>());
+    TEST_ASSERT_EQUAL(0, early["fields"].size());
+    channel.onResponse(true, true, early["seq"].as<long>());
+
+    JsonDocument due = parse(channel.encode(statusFields(10, 20), 2000 + STATUS_KEYFRAME_INTERVAL_MS));
+    TEST_ASSERT_TRUE(due["keyframe"].as<bool>());
+    TEST_ASSERT_EQUAL(7, due["fields"].size());
+    // The session only comes back when it changes or the desktop lost it
+    TEST_ASSERT_TRUE(due["session"].isNull());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_legacy_desktop_gets_the_full_document);
+    RUN_TEST(test_deltas_carry_only_what_changed);
+    RUN_TEST(test_gap_brings_back_a_keyframe_and_session);
+    RUN_TEST(test_failed_request_is_not_a_gap);
+    RUN_TEST(test_keyframe_every_interval);
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <SPIFFS.h>
+#include <TelemetryQueue.h>
+#include <string>
+
+// Host test for the telemetry queue: the alert journal lives on the SPIFFS shim, so
+// "rebooting" is constructing a second queue over the same directory.
+
+namespace {
+SPIFFSFS flash(".pio/test_telemetry_queue_fs");
+
+String alert(int id) {
+    return "{\"alert\":" + String(id) + "}";
+}
+
+String filler(size_t size, const char* tag) {
+    String text = "{\"tag\":\"";
+    text += tag;
+    text += "\",\"fill\":\"";
+    while (text.length() < size - 2) {
+        text += 'x';
+    }
+    text += "\"}";
+    return text;
+}
+}
+
+void setUp(void) {
+    TEST_ASSERT_TRUE(flash.begin(true));
+    flash.format();
+}
+
+void tearDown(void) {}
+
+void test_undelivered_alerts_survive_a_reboot() {
+    {
+        TelemetryQueue before;
+        TEST_ASSERT_EQUAL(0, before.begin(flash));
+        for (int i = 0; i < 5; i++) {
+            before.pushAlert(alert(i));
+        }
+        // Delivered before the desktop went away
+        before.popAlerts(2);
+    }
+
+    TelemetryQueue after;
+    after.pushAlert(alert(5));   // Raised before storage was attached
+    TEST_ASSERT_EQUAL(3, after.begin(flash));
+    TEST_ASSERT_EQUAL(4, after.getAlertCount());
+    TEST_ASSERT_EQUAL_STRING(alert(2).c_str(), after.getAlert(0).c_str());
+    TEST_ASSERT_EQUAL_STRING(alert(4).c_str(), after.getAlert(2).c_str());
+    TEST_ASSERT_EQUAL_STRING(alert(5).c_str(), after.getAlert(3).c_str());
+
+    // Once all are delivered the journal goes away
+    after.popAlerts(4);
+    TEST_ASSERT_FALSE(flash.exists("/telemetry.q"));
+    TelemetryQueue again;
+    TEST_ASSERT_EQUAL(0, again.begin(flash));
+}
+
+void test_journal_compacts_and_survives_a_torn_tail() {
+    {
+        TelemetryQueue queue;
+        queue.begin(flash);
+        // Enough churn that the journal is rewritten several times
+        for (int i = 0; i < 200; i++) {
+            queue.pushAlert(alert(i) + String(filler(200, "a")));
+            if (queue.getAlertCount() > 6) queue.popAlerts(3);
+        }
+        TEST_ASSERT_TRUE(flash.open("/telemetry.q").size() <= TELEMETRY_QUEUE_JOURNAL_BYTES);
+        TEST_ASSERT_EQUAL(0, queue.getStats().journalFailures);
+        TEST_ASSERT_EQUAL(0, queue.getStats().alertsDropped);
+        queue.pushAlert(alert(1000));
+    }
+
+    // Cut the last record short, as a reset in mid-write would
+    File file = flash.open("/telemetry.q");
+    std::string bytes(file.size(), '\0');
+    file.read(reinterpret_cast<uint8_t*>(&bytes[0]), bytes.size());
+    file.close();
+    bytes.resize(bytes.size() - 3);
+    file = flash.open("/telemetry.q", FILE_WRITE);
+    file.write(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    file.close();
+
+    TelemetryQueue after;
+    size_t recovered = after.begin(flash);
+    TEST_ASSERT_TRUE(recovered > 0);
+    TEST_ASSERT_TRUE(after.getAlert(recovered - 1).startsWith(alert(199)));
+}
+
+void test_status_compacts_and_logs_thin() {
+    TelemetryQueue queue;
+    queue.setStatus("{\"state\":\"IDLE\"}");
+    queue.setStatus("{\"state\":\"RUNNING\"}");
+    TEST_ASSERT_EQUAL_STRING("{\"state\":\"RUNNING\"}", queue.getStatus().c_str());
+    TEST_ASSERT_EQUAL(1, queue.getStats().statusReplaced);
+
+    for (int i = 0; i < 8; i++) {
+        queue.pushLogs("{\"chunk\":" + String(i) + "}");
+    }
+    TEST_ASSERT_TRUE(queue.getLogCount() <= TELEMETRY_QUEUE_LOG_CHUNKS);
+    TEST_ASSERT_EQUAL(8 - queue.getLogCount(), queue.getStats().logChunksDropped);
+    // Still spans the whole outage: the first chunk and the newest are kept
+    TEST_ASSERT_EQUAL_STRING("{\"chunk\":0}", queue.getLogs(0).c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"chunk\":7}", queue.getLogs(queue.getLogCount() - 1).c_str());
+}
+
+void test_logs_then_status_give_way_before_alerts() {
+    TelemetryQueue queue;
+    queue.setStatus(filler(5000, "status"));
+    for (int i = 0; i < 3; i++) {
+        queue.pushLogs(filler(TELEMETRY_QUEUE_RAM_BYTES / 4, "logs"));
+    }
+    TEST_ASSERT_EQUAL(0, queue.getStats().logChunksDropped);
+
+    // Alerts crowd out the logs, then the status, but never each other until those are gone
+    size_t alertSize = TELEMETRY_QUEUE_RAM_BYTES / TELEMETRY_QUEUE_ALERTS;
+    for (int i = 0; i < TELEMETRY_QUEUE_ALERTS - 4; i++) {
+        queue.pushAlert(filler(alertSize, "alert"));
+        if (queue.getLogCount() > 0 || !queue.getStatus().isEmpty()) {
+            TEST_ASSERT_EQUAL(0, queue.getStats().alertsDropped);
+        }
+    }
+    TEST_ASSERT_EQUAL(0, queue.getLogCount());
+    TEST_ASSERT_TRUE(queue.getStatus().isEmpty());
+    TEST_ASSERT_EQUAL(1, queue.getStats().statusDropped);
+    TEST_ASSERT_EQUAL(0, queue.getStats().alertsDropped);
+    TEST_ASSERT_EQUAL(TELEMETRY_QUEUE_ALERTS - 4, queue.getAlertCount());
+    TEST_ASSERT_TRUE(queue.getBytes() <= TELEMETRY_QUEUE_RAM_BYTES);
+
+    // Past the count limit the oldest alert goes
+    for (int i = 0; i < 8; i++) {
+        queue.pushAlert(alert(i));
+    }
+    TEST_ASSERT_EQUAL(TELEMETRY_QUEUE_ALERTS, queue.getAlertCount());
+    TEST_ASSERT_EQUAL(4, queue.getStats().alertsDropped);
+    TEST_ASSERT_EQUAL_STRING(alert(7).c_str(), queue.getAlert(TELEMETRY_QUEUE_ALERTS - 1).c_str());
+}
+
+void test_retire_leaves_what_changed_while_in_flight() {
+    TelemetryQueue queue;
+    for (int i = 0; i < 3; i++) {
+        queue.pushAlert(alert(i));
+    }
+    queue.setStatus("{\"state\":1}");
+    queue.pushLogs(filler(100, "log0"));
+    queue.pushLogs(filler(100, "log1"));
+    TelemetryQueue::Mark sent = queue.mark(2, true, 2);
+
+    // Queued while the request was out: a new alert, a newer status, and logs that
+    // thin the ones sent
+    queue.pushAlert(alert(3));
+    queue.setStatus("{\"state\":2}");
+    queue.pushLogs(filler(100, "log2"));
+    queue.pushLogs(filler(100, "log3"));
+    queue.retire(sent);
+
+    TEST_ASSERT_EQUAL(2, queue.getAlertCount());
+    TEST_ASSERT_EQUAL_STRING(alert(2).c_str(), queue.getAlert(0).c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"state\":2}", queue.getStatus().c_str());
+    TEST_ASSERT_EQUAL(2, queue.getLogCount());
+    TEST_ASSERT_TRUE(queue.getLogs(0).indexOf("log2") >= 0);
+
+    queue.retire(queue.mark(0, true, 0));
+    TEST_ASSERT_TRUE(queue.getStatus().isEmpty());
+    TEST_ASSERT_EQUAL(2, queue.getAlertCount());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_undelivered_alerts_survive_a_reboot);
+    RUN_TEST(test_journal_compacts_and_survives_a_torn_tail);
+    RUN_TEST(test_status_compacts_and_logs_thin);
+    RUN_TEST(test_logs_then_status_give_way_before_alerts);
+    RUN_TEST(test_retire_leaves_what_changed_while_in_flight);
+    return UNITY_END();
+}
@@ -0,0 +1,228 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <Config.h>
+#include <LoopbackServer.h>
+#include <UpdateClient.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Host test for the /batch envelope, against a desktop stand-in on a loopback socket
+// that records every POST and serves either both the batch and per-item endpoints or,
+// like older desktop builds, only the per-item ones.
+
+namespace {
+typedef HttpStandIn::Request Post;
+
+class DesktopStandIn {
+public:
+    explicit DesktopStandIn(bool acceptsBatch, const char* acceptPost = nullptr)
+        : available(true)
+        , acceptsBatch(acceptsBatch)
+        , acceptPost(acceptPost)
+        , server([this](const Post& post) { return respond(post); }) {
+    }
+
+    // The requests it stored: not those to unknown paths or answered while unavailable
+    std::vector<Post> posts() {
+        std::vector<Post> stored;
+        for (const Post& post : server.requests()) {
+            if (post.status == 200) stored.push_back(post);
+        }
+        return stored;
+    }
+
+    String url() const { return server.url(); }
+
+    std::atomic<bool> available;   // false: every request gets 503, as while the app restarts
+
+private:
+    HttpStandIn::Response respond(const Post& post) {
+        if (!available) {
+            return {503, std::string(), std::string()};
+        }
+        bool known = post.path == "/alerts" || post.path == "/updates" || post.path == "/logs" ||
+                     (acceptsBatch && post.path == "/batch");
+        std::string headers = acceptPost ? std::string("Accept-Post: ") + acceptPost + "\r\n" : std::string();
+        return known ? HttpStandIn::Response{200, headers, "{}"} : HttpStandIn::Response{404, headers, std::string()};
+    }
+
+    bool acceptsBatch;
+    const char* acceptPost;   // Accept-Post response header, if any
+    HttpStandIn server;
+};
+
+void queueBurst(UpdateClient& client, int alerts, const String& logs) {
+    for (int i = 0; i < alerts; i++) {
+        JsonDocument alert;
+        alert["type"] = "filament_low";
+        alert["slot"] = i;
+        client.queueAlert(alert);
+    }
+    JsonDocument status;
+    status["state"] = "RUNNING";
+    client.queueStatusUpdate(status, true);
+    client.queueLogs(logs);
+}
+
+// Loops the client the way ApplicationManager does until everything is delivered
+void drain(UpdateClient& client) {
+    unsigned long start = millis();
+    while (client.hasPending() && millis() - start < 5000) {
+        client.loop();
+        delay(5);
+    }
+    TEST_ASSERT_FALSE(client.hasPending());
+}
+
+size_t count(const std::string& text, const std::string& what) {
+    size_t found = 0;
+    for (size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + 1)) {
+        found++;
+    }
+    return found;
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_burst_goes_out_as_one_batch() {
+    DesktopStandIn desktop(true);
+    UpdateClient client;
+    TEST_ASSERT_TRUE(client.init(desktop.url(), "user:secret", "dev1"));
+    queueBurst(client, 3, "{\"logs\":[]}");
+    drain(client);
+
+    std::vector<Post> posts = desktop.posts();
+    TEST_ASSERT_EQUAL(1, posts.size());
+    TEST_ASSERT_EQUAL_STRING("/batch", posts[0].path.c_str());
+    const std::string& body = posts[0].body;
+    TEST_ASSERT_EQUAL(3, count(body, "\"type\":\"alert\",\"priority\":0"));
+    TEST_ASSERT_EQUAL(1, count(body, "\"type\":\"status\",\"priority\":1"));
+    TEST_ASSERT_EQUAL(1, count(body, "\"type\":\"logs\",\"priority\":2"));
+    // Highest priority first, alerts in the order they were raised
+    TEST_ASSERT_TRUE(body.find("\"slot\":2") < body.find("\"type\":\"status\""));
+    TEST_ASSERT_TRUE(body.find("\"slot\":0") < body.find("\"slot\":1"));
+    TEST_ASSERT_TRUE(body.find("\"type\":\"status\"") < body.find("\"type\":\"logs\""));
+    TEST_ASSERT_TRUE(client.isBatching());
+}
+
+void test_desktop_without_batch_gets_every_item() {
+    DesktopStandIn desktop(false);
+    UpdateClient client;
+    TEST_ASSERT_TRUE(client.init(desktop.url(), "user:secret", "dev1"));
+    queueBurst(client, 2, "{\"logs\":[]}");
+    drain(client);
+
+    TEST_ASSERT_FALSE(client.isBatching());
+    std::vector<Post> posts = desktop.posts();
+    TEST_ASSERT_EQUAL(4, posts.size());
+    TEST_ASSERT_EQUAL_STRING("/alerts", posts[0].path.c_str());
+    TEST_ASSERT_EQUAL_STRING("/alerts", posts[1].path.c_str());
+    size_t logs = 0;
+    size_t updates = 0;
+    for (const Post& post : posts) {
+        logs += post.path == "/logs";
+        updates += post.path == "/updates";
+    }
+    TEST_ASSERT_EQUAL(1, logs);
+    TEST_ASSERT_EQUAL(1, updates);
+    TEST_ASSERT_EQUAL(0, client.getConsecutiveFailures());
+}
+
+void test_size_cap_splits_the_batch() {
+    DesktopStandIn desktop(true);
+    UpdateClient client;
+    TEST_ASSERT_TRUE(client.init(desktop.url(), "user:secret", "dev1"));
+    // Logs that only fit in a batch of their own
+    String logs = "{\"logs\":\"";
+    while (logs.length() < UPLOAD_BATCH_MAX_BYTES - 100) {
+        logs += "filler text ";
+    }
+    logs += "\"}";
+    queueBurst(client, 1, logs);
+    drain(client);
+
+    std::vector<Post> posts = desktop.posts();
+    TEST_ASSERT_EQUAL(2, posts.size());
+    for (const Post& post : posts) {
+        TEST_ASSERT_EQUAL_STRING("/batch", post.path.c_str());
+        TEST_ASSERT_TRUE(post.body.size() <= UPLOAD_BATCH_MAX_BYTES);
+    }
+    TEST_ASSERT_EQUAL(1, count(posts[0].body, "\"type\":\"alert\""));
+    TEST_ASSERT_EQUAL(1, count(posts[0].body, "\"type\":\"status\""));
+    TEST_ASSERT_EQUAL(0, count(posts[0].body, "\"type\":\"logs\""));
+    TEST_ASSERT_EQUAL(1, count(posts[1].body, "\"type\":\"logs\""));
+}
+
+void test_outage_backlog_drains_at_a_steady_pace() {
+    DesktopStandIn desktop(true);
+    desktop.available = false;
+    UpdateClient client;
+    TEST_ASSERT_TRUE(client.init(desktop.url(), "user:secret", "dev1"));
+
+    // An outage long enough to fill several batches; every alert must survive it
+    String logs = "{\"logs\":\"";
+    while (logs.length() < UPLOAD_BATCH_MAX_BYTES / 2) {
+        logs += "filler text ";
+    }
+    logs += "\"}";
+    for (int round = 0; round < 3; round++) {
+        queueBurst(client, 4, logs);
+        client.loop();
+    }
+    // The 503 comes back on a later loop()
+    unsigned long refused = millis();
+    while (client.getConsecutiveFailures() == 0 && millis() - refused < 2000) {
+        client.loop();
+        delay(5);
+    }
+    TEST_ASSERT_TRUE(client.getConsecutiveFailures() > 0);
+    TEST_ASSERT_EQUAL(0, desktop.posts().size());
+
+    desktop.available = true;
+    unsigned long start = millis();
+    while (client.hasPending() && millis() - start < 15000) {
+        client.loop();
+        delay(5);
+    }
+    TEST_ASSERT_FALSE(client.hasPending());
+
+    std::vector<Post> posts = desktop.posts();
+    TEST_ASSERT_TRUE(posts.size() >= 3);
+    TEST_ASSERT_EQUAL(12, count(posts[0].body, "\"type\":\"alert\""));
+    for (size_t i = 1; i < posts.size(); i++) {
+        TEST_ASSERT_TRUE(posts[i].at - posts[i - 1].at >= UPLOAD_DRAIN_INTERVAL_MS - 10);
+    }
+}
+
+void test_message_pack_once_the_desktop_lists_it() {
+    DesktopStandIn desktop(true, "application/msgpack, application/json");
+    UpdateClient client;
+    TEST_ASSERT_TRUE(client.init(desktop.url(), "user:secret", "dev1"));
+    queueBurst(client, 1, "{\"logs\":[]}");
+    drain(client);
+    TEST_ASSERT_TRUE(client.getPayloadEncoding() == PayloadEncoding::MESSAGE_PACK);
+    queueBurst(client, 1, "{\"logs\":[]}");
+    drain(client);
+
+    std::vector<Post> posts = desktop.posts();
+    TEST_ASSERT_EQUAL(2, posts.size());
+    TEST_ASSERT_EQUAL_STRING("application/json", posts[0].contentType.c_str());
+    TEST_ASSERT_EQUAL_STRING("application/msgpack", posts[1].contentType.c_str());
+    // The envelope is a two-entry map: device_id and items
+    TEST_ASSERT_EQUAL_HEX8(0x82, static_cast<uint8_t>(posts[1].body[0]));
+    TEST_ASSERT_TRUE(posts[1].body.size() < posts[0].body.size());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_burst_goes_out_as_one_batch);
+    RUN_TEST(test_desktop_without_batch_gets_every_item);
+    RUN_TEST(test_size_cap_splits_the_batch);
+    RUN_TEST(test_outage_backlog_drains_at_a_steady_pace);
+    RUN_TEST(test_message_pack_once_the_desktop_lists_it);
+    return UNITY_END();
+}
@@ -0,0 +1,159 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <Config.h>
+#include <Heatshrink.h>
+#include <Logger.h>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+
+// Host test for the upload encoder: round trips through a reference heatshrink decoder,
+// and the size and time it takes on representative /logs and status payloads.
+
+namespace {
+typedef HeatshrinkEncoder<UPLOAD_COMPRESS_WINDOW_BITS, UPLOAD_COMPRESS_LOOKAHEAD_BITS> Encoder;
+
+class StringOut : public Print {
+public:
+    std::string text;
+
+    size_t write(uint8_t c) override {
+        text += static_cast<char>(c);
+        return 1;
+    }
+};
+
+// Straight from the format description: tag bit, then a literal or (distance, count)
+std::string expand(const std::string& packed, uint8_t windowBits, uint8_t lookaheadBits) {
+    size_t bit = 0;
+    auto read = [&](uint8_t count, uint32_t& value) {
+        if (bit + count > packed.size() * 8) return false;
+        value = 0;
+        for (uint8_t i = 0; i < count; i++, bit++) {
+            value = (value << 1) | ((static_cast<uint8_t>(packed[bit / 8]) >> (7 - bit % 8)) & 1);
+        }
+        return true;
+    };
+
+    std::string text;
+    uint32_t tag;
+    while (read(1, tag)) {
+        uint32_t value;
+        if (tag) {
+            if (!read(8, value)) break;
+            text += static_cast<char>(value);
+        } else {
+            uint32_t count;
+            if (!read(windowBits, value) || !read(lookaheadBits, count)) break;
+            size_t from = text.size() - (value + 1);
+            for (uint32_t i = 0; i <= count; i++) {
+                text += text[from + i];
+            }
+        }
+    }
+    return text;
+}
+
+std::string compress(const std::string& text, size_t chunk = SIZE_MAX) {
+    StringOut out;
+    std::unique_ptr<Encoder> encoder(new Encoder(out));
+    for (size_t at = 0; at < text.size(); at += chunk) {
+        size_t size = std::min(chunk, text.size() - at);
+        encoder->write(reinterpret_cast<const uint8_t*>(text.data() + at), size);
+    }
+    encoder->finish();
+    return out.text;
+}
+
+// What ApplicationManager hands to UpdateClient::queueLogs once the ring fills
+std::string representativeLogs() {
+    Logger::setTransmitCallback(nullptr);
+    Logger::init(200, LOG_INFO);
+    for (int i = 0; i < 60; i++) {
+        LOG_IF("Bambu", "AMS %d tray %d: PLA %d%% remaining", i % 4, i % 4, 90 - i);
+        LOG_IF("MQTT", "Report %d bytes, %d fields changed", 3000 + i * 7, i % 9);
+        LOG_IF("Motor", "Reached position %d in %d ms (expected %d ms)", i % 20 + 1, 410 + i, 400);
+    }
+    Logger::flush();
+    return Logger::getLogsAsJson().c_str();
+}
+
+// Roughly enqueueStatusUpdate's document
+std::string representativeStatus() {
+    return "{\"device_id\":\"A1B2C3D4E5F6\",\"timestamp\":123456,\"state\":\"RUNNING\",\"uptime_ms\":123456,"
+           "\"free_heap_percent\":61.5,\"connected\":true,\"ip_address\":\"192.168.1.57\",\"assigned\":true,"
+           "\"motor_state\":0,\"motor_position\":7,\"motor_loop_max_us\":212,\"motor_loop_last_us\":35,"
+           "\"printer_state\":\"PRINTING\",\"progress\":42,\"current_layer\":118,\"total_layers\":300,"
+           "\"remaining_time_s\":5400,\"current_material\":\"PLA Basic\",\"print_error\":0,"
+           "\"printer_connected\":true,\"printer_id\":\"01S00C123456789\",\"printer_brand\":\"Bambu Lab\","
+           "\"printer_model\":\"X1C\",\"printer_name\":\"Farm 12\"}";
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_round_trips_in_any_write_size() {
+    std::string logs = representativeLogs();
+    TEST_ASSERT_TRUE(logs.size() > 4 * Encoder::kWindow);
+    for (size_t chunk : {static_cast<size_t>(1), static_cast<size_t>(37), static_cast<size_t>(LOG_STREAM_BATCH_BYTES), SIZE_MAX}) {
+        std::string packed = compress(logs, chunk);
+        TEST_ASSERT_TRUE(expand(packed, UPLOAD_COMPRESS_WINDOW_BITS, UPLOAD_COMPRESS_LOOKAHEAD_BITS) == logs);
+    }
+}
+
+void test_round_trips_incompressible_and_empty_input() {
+    std::mt19937 random(7);
+    std::string noise;
+    for (int i = 0; i < 5000; i++) {
+        noise += static_cast<char>(random());
+    }
+    std::string packed = compress(noise);
+    TEST_ASSERT_TRUE(expand(packed, UPLOAD_COMPRESS_WINDOW_BITS, UPLOAD_COMPRESS_LOOKAHEAD_BITS) == noise);
+    // Worst case is a 9-bit literal per byte
+    TEST_ASSERT_TRUE(packed.size() <= noise.size() * 9 / 8 + 1);
+
+    TEST_ASSERT_EQUAL(0, compress("").size());
+
+    StringOut out;
+    std::unique_ptr<Encoder> encoder(new Encoder(out));
+    encoder->print("counted both ways, counted both ways");
+    encoder->finish();
+    TEST_ASSERT_EQUAL(36, encoder->getBytesIn());
+    TEST_ASSERT_EQUAL(out.text.size(), encoder->getBytesOut());
+
+    std::string run(3000, 'a');
+    TEST_ASSERT_TRUE(expand(compress(run), UPLOAD_COMPRESS_WINDOW_BITS, UPLOAD_COMPRESS_LOOKAHEAD_BITS) == run);
+}
+
+void test_representative_payloads_shrink() {
+    std::string logs = representativeLogs();
+    std::string status = representativeStatus();
+
+    auto start = std::chrono::steady_clock::now();
+    std::string packedLogs = compress(logs);
+    double logsUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::string packedStatus = compress(status);
+
+    char line[128];
+    snprintf(line, sizeof(line), "/logs:    %u -> %u bytes (%.0f%%), %.0f us on the host",
+             static_cast<unsigned>(logs.size()), static_cast<unsigned>(packedLogs.size()),
+             100.0 * packedLogs.size() / logs.size(), logsUs);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "/updates: %u -> %u bytes (%.0f%%)", static_cast<unsigned>(status.size()),
+             static_cast<unsigned>(packedStatus.size()), 100.0 * packedStatus.size() / status.size());
+    TEST_MESSAGE(line);
+
+    // Keys repeat on every record, so the log document should at least halve
+    TEST_ASSERT_TRUE(packedLogs.size() * 2 < logs.size());
+    TEST_ASSERT_TRUE(packedStatus.size() < status.size());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trips_in_any_write_size);
+    RUN_TEST(test_round_trips_incompressible_and_empty_input);
+    RUN_TEST(test_representative_payloads_shrink);
+    return UNITY_END();
+}
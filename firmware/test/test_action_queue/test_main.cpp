@@ -0,0 +1,274 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <BasePrinter.h>
+
+// Virtual clock driven by the tests
+static unsigned long virtualNow = 0;
+static unsigned long virtualMillis() { return virtualNow; }
+
+// Minimal driver whose purge/pause handlers sequence the resume the way BambuPrinter does
+class TestPrinter : public BasePrinter {
+public:
+    int resumeCalls = 0;
+    unsigned long lastResumeAt = 0;
+
+    using BasePrinter::parseESP32CommandFromMessage;
+
+    TestPrinter() { deferredActions.setClock(virtualMillis); }
+
+    bool init() override { return true; }
+    bool connect(const String&) override { return true; }
+    void disconnect() override {}
+    void loop() override { runDeferredActions(); }
+    bool isConnected() const override { return true; }
+    PrintStatus getPrintStatus() const override { return PrintStatus(); }
+    int getMaterialInfo(std::vector<MaterialInfo>& materials) const override { materials.clear(); return 0; }
+    bool sendCommand(const String&) override { return true; }
+    void parseMessage(const String&) override {}
+    String getStatusJson() const override { return "{}"; }
+    String getPrinterType() const override { return "Test"; }
+    String getPrinterInfo() const override { return "{}"; }
+    bool saveConfiguration(const String&) override { return true; }
+
+    bool resumePrint() override {
+        resumeCalls++;
+        lastResumeAt = virtualNow;
+        return true;
+    }
+
+    size_t pendingActions() const { return deferredActions.pending(); }
+
+protected:
+    void cmdStartingPurge(const CommandArg& params) override {
+        BasePrinter::cmdStartingPurge(params);
+        scheduleResume(1000);
+    }
+
+    void cmdPauseForESP(const CommandArg& params) override {
+        BasePrinter::cmdPauseForESP(params);
+        scheduleResume(500, [this]() { commandState.isPaused = false; });
+    }
+};
+
+void setUp(void) {
+    virtualNow = 0;
+}
+
+void tearDown(void) {}
+
+void test_action_fires_once_when_due() {
+    ActionQueue queue(virtualMillis);
+    int fired = 0;
+    queue.schedule(1000, [&fired]() { fired++; });
+
+    virtualNow = 999;
+    queue.run();
+    TEST_ASSERT_EQUAL(0, fired);
+
+    virtualNow = 1000;
+    queue.run();
+    queue.run();
+    TEST_ASSERT_EQUAL(1, fired);
+    TEST_ASSERT_EQUAL(0, queue.pending());
+}
+
+void test_due_actions_fire_in_time_order() {
+    ActionQueue queue(virtualMillis);
+    String order;
+    queue.schedule(300, [&order]() { order += "c"; });
+    queue.schedule(100, [&order]() { order += "a"; });
+    queue.schedule(200, [&order]() { order += "b"; });
+
+    virtualNow = 500;
+    queue.run();
+    TEST_ASSERT_EQUAL_STRING("abc", order.c_str());
+}
+
+void test_chained_action_waits_for_predecessor() {
+    ActionQueue queue(virtualMillis);
+    String order;
+    ActionQueue::Handle first = queue.schedule(100, [&order]() { order += "1"; });
+    ActionQueue::Handle second = queue.then(first, 50, [&order]() { order += "2"; });
+    TEST_ASSERT_NOT_EQUAL(ActionQueue::kInvalidHandle, second);
+
+    // The chained delay counts from when the first action fires, not from scheduling
+    virtualNow = 120;
+    queue.run();
+    TEST_ASSERT_EQUAL_STRING("1", order.c_str());
+
+    virtualNow = 160;
+    queue.run();
+    TEST_ASSERT_EQUAL_STRING("1", order.c_str());
+
+    virtualNow = 170;
+    queue.run();
+    TEST_ASSERT_EQUAL_STRING("12", order.c_str());
+}
+
+void test_cancel_drops_chain() {
+    ActionQueue queue(virtualMillis);
+    int fired = 0;
+    ActionQueue::Handle first = queue.schedule(100, [&fired]() { fired++; });
+    queue.then(first, 0, [&fired]() { fired++; });
+    TEST_ASSERT_EQUAL(2, queue.pending());
+
+    TEST_ASSERT_TRUE(queue.cancel(first));
+    TEST_ASSERT_FALSE(queue.cancel(first));
+    TEST_ASSERT_EQUAL(0, queue.pending());
+
+    virtualNow = 1000;
+    queue.run();
+    TEST_ASSERT_EQUAL(0, fired);
+}
+
+void test_chain_after_fired_keeps_tag() {
+    ActionQueue queue(virtualMillis);
+    int fired = 0;
+    ActionQueue::Handle first = queue.schedule(100, [&fired]() { fired++; }, 3);
+    virtualNow = 100;
+    queue.run();
+    TEST_ASSERT_EQUAL(1, fired);
+
+    // No tag left to inherit, so the untagged form refuses rather than escape cancelTagged()
+    TEST_ASSERT_EQUAL(ActionQueue::kInvalidHandle, queue.then(first, 50, [&fired]() { fired++; }));
+
+    ActionQueue::Handle second = queue.then(first, 50, [&fired]() { fired++; }, 3);
+    TEST_ASSERT_NOT_EQUAL(ActionQueue::kInvalidHandle, second);
+    TEST_ASSERT_EQUAL(1, queue.cancelTagged(3));
+
+    // And when left alone the delay counts from now
+    queue.then(first, 50, [&fired]() { fired++; }, 3);
+    virtualNow = 140;
+    queue.run();
+    TEST_ASSERT_EQUAL(1, fired);
+    virtualNow = 150;
+    queue.run();
+    TEST_ASSERT_EQUAL(2, fired);
+}
+
+void test_cancel_tagged_only_drops_tag() {
+    ActionQueue queue(virtualMillis);
+    int fired = 0;
+    queue.schedule(100, [&fired]() { fired += 1; }, 1);
+    queue.schedule(100, [&fired]() { fired += 10; }, 2);
+
+    TEST_ASSERT_EQUAL(1, queue.cancelTagged(1));
+    virtualNow = 100;
+    queue.run();
+    TEST_ASSERT_EQUAL(10, fired);
+}
+
+void test_full_queue_rejects_schedule() {
+    ActionQueue queue(virtualMillis);
+    for (size_t i = 0; i < ActionQueue::kCapacity; i++) {
+        TEST_ASSERT_NOT_EQUAL(ActionQueue::kInvalidHandle, queue.schedule(100, []() {}));
+    }
+    TEST_ASSERT_EQUAL(ActionQueue::kInvalidHandle, queue.schedule(100, []() {}));
+
+    virtualNow = 100;
+    queue.run();
+    TEST_ASSERT_NOT_EQUAL(ActionQueue::kInvalidHandle, queue.schedule(100, []() {}));
+}
+
+void test_clock_wraparound() {
+    ActionQueue queue(virtualMillis);
+    int fired = 0;
+    virtualNow = ~0UL - 100;
+    queue.schedule(200, [&fired]() { fired++; });
+
+    virtualNow = ~0UL;
+    queue.run();
+    TEST_ASSERT_EQUAL(0, fired);
+
+    virtualNow = 99;
+    queue.run();
+    TEST_ASSERT_EQUAL(1, fired);
+}
+
+// Simulated main loop: the motor keeps getting serviced every tick while the
+// purge resume is pending, instead of stalling for the old delay(1000)
+void test_purge_resume_does_not_block_loop() {
+    TestPrinter printer;
+    const unsigned long tickMs = 5;
+    unsigned long motorTicks = 0;
+
+    unsigned long start = micros();
+    printer.parseESP32CommandFromMessage(CommandArg("ESP32:STARTING_PURGE"));
+    unsigned long handlerUs = micros() - start;
+
+    TEST_ASSERT_TRUE(printer.getCommandState().isPurging);
+    TEST_ASSERT_EQUAL(0, printer.resumeCalls);
+    TEST_ASSERT_LESS_THAN(5000UL, handlerUs);
+
+    while (printer.resumeCalls == 0 && virtualNow < 5000) {
+        virtualNow += tickMs;
+        motorTicks++;
+        printer.loop();
+    }
+
+    TEST_ASSERT_EQUAL(1, printer.resumeCalls);
+    TEST_ASSERT_EQUAL(1000, printer.lastResumeAt);
+    TEST_ASSERT_EQUAL(1000 / tickMs, motorTicks);
+
+    char message[96];
+    snprintf(message, sizeof(message), "handler returned in %lu us, motor serviced %lu times during the wait",
+             handlerUs, motorTicks);
+    TEST_MESSAGE(message);
+}
+
+void test_repeated_pause_resumes_once() {
+    TestPrinter printer;
+    printer.parseESP32CommandFromMessage(CommandArg("ESP32:PAUSE_FOR_ESP"));
+    virtualNow = 300;
+    printer.loop();
+    printer.parseESP32CommandFromMessage(CommandArg("ESP32:PAUSE_FOR_ESP"));
+    TEST_ASSERT_TRUE(printer.getCommandState().isPaused);
+
+    for (virtualNow = 300; virtualNow <= 2000; virtualNow += 10) {
+        printer.loop();
+    }
+
+    TEST_ASSERT_EQUAL(1, printer.resumeCalls);
+    TEST_ASSERT_EQUAL(800, printer.lastResumeAt);
+    TEST_ASSERT_FALSE(printer.getCommandState().isPaused);
+    TEST_ASSERT_EQUAL(0, printer.pendingActions());
+}
+
+void test_print_end_cancels_pending_resume() {
+    TestPrinter printer;
+    printer.parseESP32CommandFromMessage(CommandArg("ESP32:PAUSE_FOR_ESP"));
+
+    // Entering PAUSED is part of the sequence and must not cancel the resume
+    printer.onStateChange(BasePrinter::PrinterState::PRINTING, BasePrinter::PrinterState::PAUSED);
+    TEST_ASSERT_EQUAL(2, printer.pendingActions());
+
+    printer.onStateChange(BasePrinter::PrinterState::PAUSED, BasePrinter::PrinterState::CANCELLED);
+    TEST_ASSERT_EQUAL(0, printer.pendingActions());
+
+    virtualNow = 2000;
+    printer.loop();
+    TEST_ASSERT_EQUAL(0, printer.resumeCalls);
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+    Logger::init(20, LOG_ERROR);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_action_fires_once_when_due);
+    RUN_TEST(test_due_actions_fire_in_time_order);
+    RUN_TEST(test_chained_action_waits_for_predecessor);
+    RUN_TEST(test_cancel_drops_chain);
+    RUN_TEST(test_chain_after_fired_keeps_tag);
+    RUN_TEST(test_cancel_tagged_only_drops_tag);
+    RUN_TEST(test_full_queue_rejects_schedule);
+    RUN_TEST(test_clock_wraparound);
+    RUN_TEST(test_purge_resume_does_not_block_loop);
+    RUN_TEST(test_repeated_pause_resumes_once);
+    RUN_TEST(test_print_end_cancels_pending_resume);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,176 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <AlertEngine.h>
+
+// Virtual clock driven by the tests
+static unsigned long virtualNow = 0;
+static unsigned long virtualMillis() { return virtualNow; }
+
+static const AlertEngine::Key kJam = {AlertEngine::SOURCE_AMS, 3, -1};
+
+static AlertEngine::Key slotKey(int8_t slot) {
+    return {AlertEngine::SOURCE_FILAMENT, 0, slot};
+}
+
+void setUp(void) {
+    virtualNow = 1000;
+}
+
+void tearDown(void) {}
+
+static void test_repeats_are_counted_not_sent() {
+    AlertEngine engine(virtualMillis);
+
+    TEST_ASSERT_EQUAL(AlertEngine::RAISED, engine.observe(kJam, 3));
+    for (int i = 0; i < 20; i++) {
+        virtualNow += 5000;
+        TEST_ASSERT_EQUAL(AlertEngine::NONE, engine.observe(kJam, 3));
+    }
+
+    TEST_ASSERT_EQUAL(20, engine.getRepeats(kJam));
+    AlertEngine::Stats stats = engine.getStats();
+    TEST_ASSERT_EQUAL(1, stats.sent);
+    TEST_ASSERT_EQUAL(20, stats.duplicates);
+}
+
+static void test_clear_needs_consecutive_samples() {
+    AlertEngine engine(virtualMillis);
+    engine.observe(kJam, 3);
+
+    // A single report without the condition is noise
+    for (int i = 1; i < ALERT_CLEAR_SAMPLES; i++) {
+        TEST_ASSERT_EQUAL(AlertEngine::NONE, engine.observe(kJam, 0));
+    }
+    TEST_ASSERT_EQUAL(AlertEngine::NONE, engine.observe(kJam, 3));
+    TEST_ASSERT_EQUAL(3, engine.getSeverity(kJam));
+
+    for (int i = 1; i < ALERT_CLEAR_SAMPLES; i++) {
+        engine.observe(kJam, 0);
+    }
+    TEST_ASSERT_EQUAL(AlertEngine::CLEARED, engine.observe(kJam, 0));
+    TEST_ASSERT_EQUAL(0, engine.getSeverity(kJam));
+    TEST_ASSERT_EQUAL(1, engine.getStats().cleared);
+}
+
+static void test_flapping_is_suppressed_within_window() {
+    AlertEngine engine(virtualMillis);
+    TEST_ASSERT_EQUAL(AlertEngine::RAISED, engine.observe(kJam, 3));
+
+    for (int cycle = 0; cycle < 5; cycle++) {
+        virtualNow += 10000;
+        AlertEngine::Transition cleared = AlertEngine::NONE;
+        for (int i = 0; i < ALERT_CLEAR_SAMPLES; i++) {
+            cleared = engine.observe(kJam, 0);
+        }
+        TEST_ASSERT_EQUAL(AlertEngine::CLEARED, cleared);
+        TEST_ASSERT_EQUAL(AlertEngine::NONE, engine.observe(kJam, 3));
+    }
+    TEST_ASSERT_EQUAL(5, engine.getStats().flapped);
+
+    // Worse than what was sent is not a flap
+    TEST_ASSERT_EQUAL(AlertEngine::ESCALATED, engine.observe(kJam, 4));
+
+    // Nor is coming back once the window has passed
+    for (int i = 0; i < ALERT_CLEAR_SAMPLES; i++) {
+        engine.observe(kJam, 0);
+    }
+    virtualNow += ALERT_SUPPRESS_MS;
+    TEST_ASSERT_EQUAL(AlertEngine::RAISED, engine.observe(kJam, 3));
+    TEST_ASSERT_EQUAL(3, engine.getStats().sent);
+}
+
+static void test_rate_limit_holds_raises_until_budget_refills() {
+    AlertEngine engine(virtualMillis);
+
+    for (int8_t slot = 0; slot < ALERT_RATE_PER_MINUTE; slot++) {
+        TEST_ASSERT_EQUAL(AlertEngine::RAISED, engine.observe(slotKey(slot), 2));
+    }
+    AlertEngine::Key held = slotKey(ALERT_RATE_PER_MINUTE);
+    TEST_ASSERT_EQUAL(AlertEngine::NONE, engine.observe(held, 2));
+    TEST_ASSERT_EQUAL(1, engine.getStats().rateLimited);
+
+    // Still pending: goes out with the next observation once a token is back
+    virtualNow += 60000UL / ALERT_RATE_PER_MINUTE;
+    TEST_ASSERT_EQUAL(AlertEngine::RAISED, engine.observe(held, 2));
+    TEST_ASSERT_EQUAL(AlertEngine::NONE, engine.observe(held, 2));
+    TEST_ASSERT_EQUAL(ALERT_RATE_PER_MINUTE + 1, engine.getStats().sent);
+}
+
+static void test_sweep_clears_what_the_report_no_longer_lists() {
+    AlertEngine engine(virtualMillis);
+    AlertEngine::Key motion = {AlertEngine::SOURCE_HMS, 0x0700, -1};
+    AlertEngine::Key layer = {AlertEngine::SOURCE_HMS, 0x0C00, -1};
+
+    engine.beginSweep(AlertEngine::SOURCE_HMS);
+    engine.observe(motion, 3);
+    engine.observe(layer, 2);
+    engine.endSweep(AlertEngine::SOURCE_HMS, [](const AlertEngine::Key&, AlertEngine::Transition) {});
+
+    int cleared = 0;
+    for (int report = 0; report < ALERT_CLEAR_SAMPLES; report++) {
+        engine.beginSweep(AlertEngine::SOURCE_HMS);
+        engine.observe(motion, 3);
+        engine.endSweep(AlertEngine::SOURCE_HMS, [&](const AlertEngine::Key& key, AlertEngine::Transition transition) {
+            TEST_ASSERT_EQUAL(0x0C00, key.code);
+            TEST_ASSERT_EQUAL(AlertEngine::CLEARED, transition);
+            cleared++;
+        });
+    }
+    TEST_ASSERT_EQUAL(1, cleared);
+    TEST_ASSERT_EQUAL(3, engine.getSeverity(motion));
+    TEST_ASSERT_EQUAL(0, engine.getSeverity(layer));
+}
+
+static void test_falling_severity_has_hysteresis() {
+    const int thresholds[] = {20, 5, 1};
+    const int margin = 3;
+
+    TEST_ASSERT_EQUAL(0, AlertEngine::fallingSeverity(21, thresholds, 3, 0, margin));
+    TEST_ASSERT_EQUAL(1, AlertEngine::fallingSeverity(19, thresholds, 3, 0, margin));
+    // Wobbling around the threshold keeps it set until the margin is cleared
+    TEST_ASSERT_EQUAL(1, AlertEngine::fallingSeverity(21, thresholds, 3, 1, margin));
+    TEST_ASSERT_EQUAL(0, AlertEngine::fallingSeverity(23, thresholds, 3, 1, margin));
+    TEST_ASSERT_EQUAL(2, AlertEngine::fallingSeverity(4, thresholds, 3, 1, margin));
+    TEST_ASSERT_EQUAL(2, AlertEngine::fallingSeverity(6, thresholds, 3, 2, margin));
+    TEST_ASSERT_EQUAL(1, AlertEngine::fallingSeverity(8, thresholds, 3, 2, margin));
+    TEST_ASSERT_EQUAL(3, AlertEngine::fallingSeverity(0, thresholds, 3, 2, margin));
+    // A refill straight from empty clears at once
+    TEST_ASSERT_EQUAL(0, AlertEngine::fallingSeverity(100, thresholds, 3, 3, margin));
+}
+
+static void test_full_table_reuses_cleared_keys() {
+    AlertEngine engine(virtualMillis);
+
+    for (size_t i = 0; i < AlertEngine::kCapacity; i++) {
+        AlertEngine::Key key = {AlertEngine::SOURCE_HMS, static_cast<uint32_t>(i), -1};
+        engine.observe(key, 1);
+        virtualNow += 60000;
+    }
+    AlertEngine::Key extra = {AlertEngine::SOURCE_HMS, 1000, -1};
+    TEST_ASSERT_EQUAL(AlertEngine::NONE, engine.observe(extra, 1));
+    TEST_ASSERT_EQUAL(1, engine.getStats().untracked);
+
+    AlertEngine::Key first = {AlertEngine::SOURCE_HMS, 0, -1};
+    for (int i = 0; i < ALERT_CLEAR_SAMPLES; i++) {
+        engine.observe(first, 0);
+    }
+    TEST_ASSERT_EQUAL(AlertEngine::RAISED, engine.observe(extra, 1));
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_repeats_are_counted_not_sent);
+    RUN_TEST(test_clear_needs_consecutive_samples);
+    RUN_TEST(test_flapping_is_suppressed_within_window);
+    RUN_TEST(test_rate_limit_holds_raises_until_budget_refills);
+    RUN_TEST(test_sweep_clears_what_the_report_no_longer_lists);
+    RUN_TEST(test_falling_severity_has_hysteresis);
+    RUN_TEST(test_full_table_reuses_cleared_keys);
+    UNITY_END();
+}
+
+void loop() {}
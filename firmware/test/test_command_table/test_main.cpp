@@ -0,0 +1,190 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <BasePrinter.h>
+#include <map>
+
+// Minimal driver used to exercise BasePrinter's ESP32: command path
+class TestPrinter : public BasePrinter {
+public:
+    int layerCalls = 0;
+    long lastLayer = -1;
+    int printStartCalls = 0;
+    int flushCalls = 0;
+    String lastFlushParams;
+
+    using BasePrinter::parseESP32CommandFromMessage;
+
+    bool init() override { return true; }
+    bool connect(const String&) override { return true; }
+    void disconnect() override {}
+    void loop() override {}
+    bool isConnected() const override { return true; }
+    PrintStatus getPrintStatus() const override { return PrintStatus(); }
+    int getMaterialInfo(std::vector<MaterialInfo>& materials) const override { materials.clear(); return 0; }
+    bool sendCommand(const String&) override { return true; }
+    void parseMessage(const String&) override {}
+    String getStatusJson() const override { return "{}"; }
+    String getPrinterType() const override { return "Test"; }
+    String getPrinterInfo() const override { return "{}"; }
+    bool saveConfiguration(const String&) override { return true; }
+
+protected:
+    // Standard command overridden without logging so the benchmark measures dispatch only
+    void cmdLayerChange(const CommandArg& params) override {
+        layerCalls++;
+        lastLayer = params.toInt();
+    }
+
+    void cmdPrintStart(const CommandArg& params) override {
+        printStartCalls++;
+    }
+
+    void cmdPurgeFlush(const CommandArg& params) {
+        flushCalls++;
+        lastFlushParams = params.toString();
+    }
+
+    bool dispatchDriverCommand(const CommandArg& command, const CommandArg& params) override {
+        static constexpr CommandEntry<TestPrinter> kCommands[] = {
+            ESP32_COMMAND("PURGE_FLUSH", &TestPrinter::cmdPurgeFlush),
+        };
+        static constexpr auto kCommandTable = makeCommandTable(kCommands);
+        static_assert(kCommandTable.seed != command_table::kNoSeed, "No perfect hash seed");
+        return kCommandTable.dispatch(*this, command, params);
+    }
+};
+
+static const char* const kCommandNames[] = {
+    "FILAMENT_CHANGE_START", "STARTING_PURGE", "WASTE_BALL_COMPLETE", "CLEAN_BALL_COMPLETE",
+    "MOVING_TO_WIPE", "WIPE_COMPLETE", "RESUMING_PRINT", "PAUSE_FOR_ESP", "PRINT_START",
+    "LAYER_CHANGE", "PRINT_PAUSE", "PRINT_RESUME", "PRINT_COMPLETE", "PRINT_CANCEL",
+    "ERROR_DETECTED", "RECOVERY_START", "RECOVERY_SUCCESS", "MANUAL_INTERVENTION",
+    "CALIBRATION_START", "CALIBRATION_COMPLETE", "MAINTENANCE_MODE", "SYSTEM_CHECK",
+    "VALVE_ACTIVATE", "VALVE_DEACTIVATE", "ROUTE_PURE_WASTE", "ROUTE_MIXED_WASTE", "MATERIAL_CHANGE",
+};
+
+// The previous dispatcher: std::map of std::function plus substring parsing
+class LegacyDispatcher {
+public:
+    int calls = 0;
+
+    LegacyDispatcher() {
+        for (const char* name : kCommandNames) {
+            commandHandlers[name] = [this](const String& p) { calls += p.length() > 0 ? 1 : 0; };
+        }
+    }
+
+    bool parseESP32CommandFromMessage(const String& message) {
+        if (message.startsWith("ESP32:")) {
+            int colonPos = message.indexOf(':', 6);
+            if (colonPos > 0) {
+                String command = message.substring(6, colonPos);
+                String params = message.substring(colonPos + 1);
+                processESP32Command(command, params);
+            } else {
+                String command = message.substring(6);
+                processESP32Command(command, "");
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    std::map<String, std::function<void(const String&)>> commandHandlers;
+
+    void processESP32Command(const String& command, const String& params) {
+        auto it = commandHandlers.find(command);
+        if (it != commandHandlers.end()) {
+            it->second(params);
+        }
+    }
+};
+
+static void test_standard_command_with_params() {
+    TestPrinter printer;
+    TEST_ASSERT_TRUE(printer.parseESP32CommandFromMessage(CommandArg("ESP32:LAYER_CHANGE:118")));
+    TEST_ASSERT_EQUAL(1, printer.layerCalls);
+    TEST_ASSERT_EQUAL(118, printer.lastLayer);
+}
+
+static void test_standard_command_without_params() {
+    TestPrinter printer;
+    TEST_ASSERT_TRUE(printer.parseESP32CommandFromMessage(CommandArg("ESP32:PRINT_START")));
+    TEST_ASSERT_EQUAL(1, printer.printStartCalls);
+}
+
+static void test_driver_command_table_extends_standard_set() {
+    TestPrinter printer;
+    TEST_ASSERT_TRUE(printer.parseESP32CommandFromMessage(CommandArg("ESP32:PURGE_FLUSH:PLA:PETG")));
+    TEST_ASSERT_EQUAL(1, printer.flushCalls);
+    TEST_ASSERT_EQUAL_STRING("PLA:PETG", printer.lastFlushParams.c_str());
+}
+
+static void test_unknown_and_foreign_messages() {
+    TestPrinter printer;
+    TEST_ASSERT_FALSE(printer.parseESP32CommandFromMessage(CommandArg("M117 Layer 4")));
+    // Prefix present but no such command: consumed, no handler runs
+    TEST_ASSERT_TRUE(printer.parseESP32CommandFromMessage(CommandArg("ESP32:LAYER_CHANG:1")));
+    TEST_ASSERT_TRUE(printer.parseESP32CommandFromMessage(CommandArg("ESP32:LAYER_CHANGE_:1")));
+    TEST_ASSERT_EQUAL(0, printer.layerCalls);
+}
+
+static void test_views_slice_without_copy() {
+    const char* msg = "ESP32:MATERIAL_CHANGE:PLA:PETG";
+    CommandArg arg(msg);
+    CommandArg body = arg.substring(6);
+    int colon = body.indexOf(':');
+    CommandArg params = body.substring(colon + 1);
+    TEST_ASSERT_TRUE(body.substring(0, colon).equals("MATERIAL_CHANGE"));
+    TEST_ASSERT_TRUE(params.data == msg + 22);
+    TEST_ASSERT_EQUAL(8, params.length);
+}
+
+static void test_benchmark_against_map_dispatch() {
+    const int iterations = 20000;
+    const char* message = "ESP32:LAYER_CHANGE:118";
+
+    LegacyDispatcher legacy;
+    String legacyMessage(message);
+    unsigned long start = micros();
+    for (int i = 0; i < iterations; ++i) {
+        legacy.parseESP32CommandFromMessage(legacyMessage);
+    }
+    unsigned long legacyMicros = micros() - start;
+
+    TestPrinter printer;
+    CommandArg view(message);
+    start = micros();
+    for (int i = 0; i < iterations; ++i) {
+        printer.parseESP32CommandFromMessage(view);
+    }
+    unsigned long tableMicros = micros() - start;
+
+    TEST_ASSERT_EQUAL(iterations, legacy.calls);
+    TEST_ASSERT_EQUAL(iterations, printer.layerCalls);
+
+    char line[128];
+    snprintf(line, sizeof(line), "parse+dispatch: map %lu ns/msg, perfect hash %lu ns/msg",
+             (unsigned long)(legacyMicros * 1000UL / iterations), (unsigned long)(tableMicros * 1000UL / iterations));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN(legacyMicros, tableMicros);
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+    // Keep handler logging out of the ring buffer
+    Logger::init(20, LOG_ERROR);
+    UNITY_BEGIN();
+    RUN_TEST(test_standard_command_with_params);
+    RUN_TEST(test_standard_command_without_params);
+    RUN_TEST(test_driver_command_table_extends_standard_set);
+    RUN_TEST(test_unknown_and_foreign_messages);
+    RUN_TEST(test_views_slice_without_copy);
+    RUN_TEST(test_benchmark_against_map_dispatch);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <LockFreeQueue.h>
+
+static const uint32_t kItemsPerProducer = 50000;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_spsc_fifo_and_full() {
+    SpscQueue<int, 4> queue;
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(queue.push(i));
+    }
+    TEST_ASSERT_FALSE(queue.push(99));
+    TEST_ASSERT_EQUAL(1, queue.droppedCount());
+    TEST_ASSERT_EQUAL(4, queue.size());
+
+    int value = -1;
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(queue.pop(value));
+        TEST_ASSERT_EQUAL(i, value);
+    }
+    TEST_ASSERT_FALSE(queue.pop(value));
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_mpsc_fifo_and_full() {
+    MpscQueue<int, 4> queue;
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(queue.push(i));
+    }
+    TEST_ASSERT_FALSE(queue.push(99));
+    TEST_ASSERT_EQUAL(1, queue.droppedCount());
+
+    // Wrap the ring a few times
+    int value = -1;
+    for (int round = 0; round < 3; round++) {
+        TEST_ASSERT_TRUE(queue.pop(value));
+        TEST_ASSERT_EQUAL(round, value);
+        TEST_ASSERT_TRUE(queue.push(100 + round));
+    }
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL(3, value);
+    for (int round = 0; round < 3; round++) {
+        TEST_ASSERT_TRUE(queue.pop(value));
+        TEST_ASSERT_EQUAL(100 + round, value);
+    }
+    TEST_ASSERT_FALSE(queue.pop(value));
+}
+
+// Cross-core stress: producers on core 0, consumer on core 1
+
+struct Item {
+    uint32_t producer;
+    uint32_t sequence;
+};
+
+static SpscQueue<Item, 64> spscQueue;
+static MpscQueue<Item, 64> mpscQueue;
+
+static void spscProducer(void*) {
+    for (uint32_t i = 0; i < kItemsPerProducer; i++) {
+        Item item = { 0, i };
+        while (!spscQueue.push(item)) {
+            taskYIELD();
+        }
+    }
+    vTaskDelete(nullptr);
+}
+
+static void mpscProducer(void* param) {
+    uint32_t id = reinterpret_cast<uintptr_t>(param);
+    for (uint32_t i = 0; i < kItemsPerProducer; i++) {
+        Item item = { id, i };
+        while (!mpscQueue.push(item)) {
+            taskYIELD();
+        }
+    }
+    vTaskDelete(nullptr);
+}
+
+void test_spsc_across_cores() {
+    xTaskCreatePinnedToCore(spscProducer, "spsc", 4096, nullptr, 1, nullptr, 0);
+
+    uint32_t expected = 0;
+    uint32_t outOfOrder = 0;
+    unsigned long start = micros();
+    while (expected < kItemsPerProducer) {
+        Item item;
+        if (spscQueue.pop(item)) {
+            if (item.sequence != expected) outOfOrder++;
+            expected++;
+        }
+    }
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_EQUAL(0, outOfOrder);
+    TEST_ASSERT_TRUE(spscQueue.empty());
+
+    char message[96];
+    snprintf(message, sizeof(message), "SPSC: %lu items in %lu us (%.2f us/item)",
+             (unsigned long)kItemsPerProducer, elapsed, (double)elapsed / kItemsPerProducer);
+    TEST_MESSAGE(message);
+}
+
+void test_mpsc_across_cores() {
+    static const uint32_t kProducers = 2;
+    for (uint32_t p = 0; p < kProducers; p++) {
+        xTaskCreatePinnedToCore(mpscProducer, "mpsc", 4096, reinterpret_cast<void*>(p), 1, nullptr, 0);
+    }
+
+    uint32_t next[kProducers] = { 0 };
+    uint32_t received = 0;
+    uint32_t outOfOrder = 0;
+    unsigned long start = micros();
+    while (received < kProducers * kItemsPerProducer) {
+        Item item;
+        if (mpscQueue.pop(item)) {
+            // Per-producer order must be preserved; producers may interleave
+            if (item.producer >= kProducers || item.sequence != next[item.producer]) outOfOrder++;
+            else next[item.producer]++;
+            received++;
+        }
+    }
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_EQUAL(0, outOfOrder);
+    for (uint32_t p = 0; p < kProducers; p++) {
+        TEST_ASSERT_EQUAL(kItemsPerProducer, next[p]);
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "MPSC: %lu items from %lu producers in %lu us",
+             (unsigned long)received, (unsigned long)kProducers, elapsed);
+    TEST_MESSAGE(message);
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_spsc_fifo_and_full);
+    RUN_TEST(test_mpsc_fifo_and_full);
+    RUN_TEST(test_spsc_across_cores);
+    RUN_TEST(test_mpsc_across_cores);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,137 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <LogRing.h>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+typedef LogRing<1024> SmallRing;
+static const uint8_t kInfo = 2;
+
+static void appendNumbered(SmallRing& ring, int n, size_t length) {
+    char message[300];
+    int prefix = snprintf(message, sizeof(message), "m%d-", n);
+    for (size_t i = prefix; i < length && i < sizeof(message) - 1; i++) {
+        message[i] = 'x';
+    }
+    size_t total = length > static_cast<size_t>(prefix) ? length : prefix;
+    message[total] = '\0';
+    ring.append(kInfo, "T", message, total, n * 10);
+}
+
+void test_append_and_iterate_in_order() {
+    SmallRing ring;
+    ring.append(1, "Bambu", "first", 5, 100);
+    ring.append(2, "MQTT", "second", 6, 200);
+    ring.append(3, "Bambu", "third", 5, 300);
+
+    TEST_ASSERT_EQUAL(3, ring.size());
+    const char* expected[] = { "first", "second", "third" };
+    const char* components[] = { "Bambu", "MQTT", "Bambu" };
+    int i = 0;
+    for (SmallRing::Record record : ring) {
+        TEST_ASSERT_EQUAL_UINT32(i, record.sequence);
+        TEST_ASSERT_EQUAL_UINT32((i + 1) * 100, record.timestamp);
+        TEST_ASSERT_EQUAL(i + 1, record.level);
+        TEST_ASSERT_EQUAL_STRING(components[i], record.component);
+        TEST_ASSERT_EQUAL_STRING(expected[i], record.message);
+        i++;
+    }
+    TEST_ASSERT_EQUAL(3, i);
+}
+
+void test_wrap_overwrites_whole_records() {
+    SmallRing ring;
+    // Odd sizes so records land at every alignment and the wrap point moves around
+    for (int n = 0; n < 200; n++) {
+        appendNumbered(ring, n, 20 + (n * 37) % 90);
+
+        uint32_t expected = 0;
+        bool first = true;
+        size_t seen = 0;
+        for (SmallRing::Record record : ring) {
+            if (first) {
+                expected = record.sequence;
+                first = false;
+            }
+            TEST_ASSERT_EQUAL_UINT32(expected, record.sequence);
+            char prefix[16];
+            snprintf(prefix, sizeof(prefix), "m%u-", static_cast<unsigned>(record.sequence));
+            TEST_ASSERT_EQUAL_INT(0, strncmp(prefix, record.message, strlen(prefix)));
+            TEST_ASSERT_EQUAL(strlen(record.message), record.length);
+            expected++;
+            seen++;
+        }
+        TEST_ASSERT_EQUAL(ring.size(), seen);
+        TEST_ASSERT_EQUAL_UINT32(n + 1, expected); // The newest record is always kept
+    }
+    TEST_ASSERT_TRUE(ring.size() > 5);
+    TEST_ASSERT_TRUE(ring.size() < 200);
+}
+
+void test_truncates_long_messages() {
+    SmallRing ring;
+    char message[400];
+    memset(message, 'a', sizeof(message) - 1);
+    message[sizeof(message) - 1] = '\0';
+    ring.append(0, "T", message, strlen(message), 0);
+
+    SmallRing::Record record = *ring.begin();
+    TEST_ASSERT_EQUAL(SmallRing::kMaxMessage, record.length);
+    TEST_ASSERT_EQUAL(SmallRing::kMaxMessage, strlen(record.message));
+}
+
+void test_record_cap_and_full() {
+    SmallRing ring(3);
+    TEST_ASSERT_FALSE(ring.isFull());
+    for (int n = 0; n < 5; n++) {
+        appendNumbered(ring, n, 8);
+    }
+    TEST_ASSERT_EQUAL(3, ring.size());
+    TEST_ASSERT_TRUE(ring.isFull());
+    TEST_ASSERT_EQUAL_UINT32(2, (*ring.begin()).sequence);
+
+    // Sequence numbers keep counting across clear()
+    ring.clear();
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_FALSE(ring.isFull());
+    appendNumbered(ring, 5, 8);
+    TEST_ASSERT_EQUAL_UINT32(5, (*ring.begin()).sequence);
+}
+
+void test_component_interning() {
+    SmallRing ring;
+    char name[24];
+    for (size_t i = 0; i < SmallRing::kMaxComponents + 2; i++) {
+        snprintf(name, sizeof(name), "component-%u", static_cast<unsigned>(i));
+        ring.append(0, name, "m", 1, 0);
+    }
+    ring.append(0, "a-very-long-component-name", "m", 1, 0);
+
+    size_t index = 0;
+    for (SmallRing::Record record : ring) {
+        if (index < SmallRing::kMaxComponents) {
+            snprintf(name, sizeof(name), "component-%u", static_cast<unsigned>(index));
+            TEST_ASSERT_EQUAL_STRING(name, record.component);
+        } else {
+            TEST_ASSERT_EQUAL_STRING("?", record.component); // Table full
+        }
+        index++;
+    }
+    TEST_ASSERT_EQUAL(SmallRing::kMaxComponents + 3, index);
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+    UNITY_BEGIN();
+    RUN_TEST(test_append_and_iterate_in_order);
+    RUN_TEST(test_wrap_overwrites_whole_records);
+    RUN_TEST(test_truncates_long_messages);
+    RUN_TEST(test_record_cap_and_full);
+    RUN_TEST(test_component_interning);
+    UNITY_END();
+}
+
+void loop() {}
@@ -64,6 +64,50 @@ static void test_transmit_not_called_when_empty() {
     TEST_ASSERT_FALSE(invoked);
 }
 
+class CapturePrint : public Print {
+public:
+    String text;
+    size_t write(uint8_t c) override {
+        text += static_cast<char>(c);
+        return 1;
+    }
+};
+
+static void test_cursor_fetch_returns_only_new_lines() {
+    Logger::setTransmitCallback(nullptr);
+    Logger::init(50, LOG_DEBUG); // Stores the init line first
+    LOG_I("T", "one");
+    LOG_I("T", "two");
+
+    CapturePrint first;
+    uint32_t next = Logger::writeLogsJson(first, 0, 2);
+    JsonDocument doc;
+    TEST_ASSERT_EQUAL_MESSAGE(DeserializationError::Ok, deserializeJson(doc, first.text), "JSON parse failed");
+    TEST_ASSERT_EQUAL(2, doc["logs"].size());
+    TEST_ASSERT_EQUAL_STRING("one", doc["logs"][1]["message"].as<String>().c_str());
+    TEST_ASSERT_EQUAL_UINT32(next, doc["next"].as<uint32_t>());
+
+    LOG_I("T", "quote \" backslash \\ newline \n");
+    CapturePrint second;
+    uint32_t after = Logger::writeLogsJson(second, next);
+    TEST_ASSERT_EQUAL_MESSAGE(DeserializationError::Ok, deserializeJson(doc, second.text), "JSON parse failed");
+    TEST_ASSERT_EQUAL(2, doc["logs"].size());
+    TEST_ASSERT_EQUAL_STRING("two", doc["logs"][0]["message"].as<String>().c_str());
+    TEST_ASSERT_EQUAL_STRING("quote \" backslash \\ newline \n", doc["logs"][1]["message"].as<String>().c_str());
+    TEST_ASSERT_EQUAL(0, doc["missed"].as<int>());
+    TEST_ASSERT_EQUAL_UINT32(next + 2, after);
+
+    // Nothing new: an empty page with the same cursor
+    CapturePrint third;
+    TEST_ASSERT_EQUAL_UINT32(after, Logger::writeLogsJson(third, after));
+    TEST_ASSERT_EQUAL_MESSAGE(DeserializationError::Ok, deserializeJson(doc, third.text), "JSON parse failed");
+    TEST_ASSERT_EQUAL(0, doc["logs"].size());
+
+    // Dropping what was fetched keeps the rest
+    Logger::clearLogsThrough(next - 1);
+    TEST_ASSERT_EQUAL_UINT(2, Logger::getLogCount());
+}
+
 void setup() {
     delay(2000);
     Serial.begin(115200);
@@ -72,6 +116,7 @@ void setup() {
     RUN_TEST(test_ring_buffer_overwrite);
     RUN_TEST(test_transmit_no_reentrancy_and_clear);
     RUN_TEST(test_transmit_not_called_when_empty);
+    RUN_TEST(test_cursor_fetch_returns_only_new_lines);
     UNITY_END();
 }
 
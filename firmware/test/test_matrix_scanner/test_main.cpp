@@ -0,0 +1,143 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <Config.h>
+#include <MatrixScanner.h>
+
+// Drives the scanner's debounce with synthetic input registers; the timer is never started
+
+typedef MatrixScanner<MOTOR_ROWS, MOTOR_COLS> Scanner;
+
+static const uint8_t kBankRows[8] = {2, 4, 5, 12, 13, 14, 15, 16};
+static const uint8_t kBankCols[8] = {17, 18, 19, 21, 32, 33, 34, 35};
+typedef MatrixScanner<8, 8> BankScanner;
+
+// One full scan with the given switches closed (0 terminates the list)
+template <uint8_t Rows, uint8_t Cols>
+static void scan(MatrixScanner<Rows, Cols>& scanner, const uint8_t colPins[Cols],
+                 const int* closed, uint32_t nowUs) {
+    for (uint8_t r = 0; r < Rows; r++) {
+        uint32_t inLow = 0, inHigh = 0;
+        for (const int* p = closed; *p; p++) {
+            if ((*p - 1) / Cols != r) continue;
+            uint8_t pin = colPins[(*p - 1) % Cols];
+            if (pin >= 32) inHigh |= 1UL << (pin - 32);
+            else inLow |= 1UL << pin;
+        }
+        scanner.sampleRow(r, inLow, inHigh, nowUs);
+    }
+}
+
+static void scanOne(Scanner& scanner, int position, uint32_t nowUs) {
+    int closed[2] = { position, 0 };
+    scan(scanner, MOTOR_COL_PINS, closed, nowUs);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_publishes_after_debounce() {
+    Scanner scanner(MOTOR_ROW_PINS, MOTOR_COL_PINS, MATRIX_ROW_PERIOD_US, 2);
+    TEST_ASSERT_EQUAL(-1, scanner.getPosition());
+
+    scanOne(scanner, 7, 1000);
+    TEST_ASSERT_EQUAL(-1, scanner.getPosition());
+    scanOne(scanner, 7, 2000);
+    TEST_ASSERT_EQUAL(7, scanner.getPosition());
+
+    Scanner::Reading reading = scanner.read();
+    TEST_ASSERT_EQUAL(7, reading.position);
+    TEST_ASSERT_EQUAL(2000, reading.changedUs);
+    TEST_ASSERT_EQUAL(2, reading.scans);
+
+    // Holding steady keeps the original timestamp
+    scanOne(scanner, 7, 3000);
+    TEST_ASSERT_EQUAL(2000, scanner.read().changedUs);
+}
+
+void test_every_position_maps_row_major() {
+    for (int position = 1; position <= Scanner::kPositions; position++) {
+        Scanner scanner(MOTOR_ROW_PINS, MOTOR_COL_PINS, MATRIX_ROW_PERIOD_US, 1);
+        scanOne(scanner, position, 0);
+        TEST_ASSERT_EQUAL(position, scanner.getPosition());
+    }
+}
+
+void test_bounce_is_ignored() {
+    Scanner scanner(MOTOR_ROW_PINS, MOTOR_COL_PINS, MATRIX_ROW_PERIOD_US, 3);
+    const int contacts[] = { 4, 0, 4, 4, 0, 4, 4, 4 };
+    for (int i = 0; i < 7; i++) {
+        scanOne(scanner, contacts[i], i * 1000);
+        TEST_ASSERT_EQUAL(-1, scanner.getPosition());
+    }
+    scanOne(scanner, contacts[7], 7000);
+    TEST_ASSERT_EQUAL(4, scanner.getPosition());
+
+    // Release is debounced too
+    scanOne(scanner, 0, 8000);
+    scanOne(scanner, 0, 9000);
+    TEST_ASSERT_EQUAL(4, scanner.getPosition());
+    scanOne(scanner, 0, 10000);
+    TEST_ASSERT_EQUAL(-1, scanner.getPosition());
+    TEST_ASSERT_EQUAL(10000, scanner.read().changedUs);
+}
+
+void test_lowest_closed_position_wins() {
+    Scanner scanner(MOTOR_ROW_PINS, MOTOR_COL_PINS, MATRIX_ROW_PERIOD_US, 1);
+    int closed[] = { 18, 9, 12, 0 };
+    scan(scanner, MOTOR_COL_PINS, closed, 0);
+    TEST_ASSERT_EQUAL(9, scanner.getPosition());
+}
+
+void test_larger_bank_with_high_gpio_columns() {
+    BankScanner scanner(kBankRows, kBankCols, MATRIX_ROW_PERIOD_US, 2);
+    TEST_ASSERT_EQUAL(64, BankScanner::kPositions);
+    TEST_ASSERT_EQUAL(8 * MATRIX_ROW_PERIOD_US, scanner.getScanPeriodUs());
+
+    // Row 7, column 6 sits on GPIO34, read from the second input register
+    int closed[] = { 7 * 8 + 6 + 1, 0 };
+    scan(scanner, kBankCols, closed, 100);
+    scan(scanner, kBankCols, closed, 200);
+    TEST_ASSERT_EQUAL(63, scanner.getPosition());
+
+    int low[] = { 3, 0 };
+    scan(scanner, kBankCols, low, 300);
+    scan(scanner, kBankCols, low, 400);
+    TEST_ASSERT_EQUAL(3, scanner.getPosition());
+}
+
+void test_read_is_cheap() {
+    Scanner scanner(MOTOR_ROW_PINS, MOTOR_COL_PINS, MATRIX_ROW_PERIOD_US, 1);
+    scanOne(scanner, 5, 0);
+
+    const int iterations = 10000;
+    volatile int sink = 0;
+    unsigned long start = micros();
+    for (int i = 0; i < iterations; i++) {
+        sink += scanner.getPosition();
+    }
+    unsigned long elapsed = micros() - start;
+    TEST_ASSERT_EQUAL(5 * iterations, sink);
+
+    // The old getCurrentPosition() busy-waited 50 us per row
+    char message[128];
+    snprintf(message, sizeof(message), "Cached read: %.3f us/call (was >= %d us per synchronous scan)",
+             (double)elapsed / iterations, 50 * MOTOR_ROWS);
+    TEST_MESSAGE(message);
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_publishes_after_debounce);
+    RUN_TEST(test_every_position_maps_row_major);
+    RUN_TEST(test_bounce_is_ignored);
+    RUN_TEST(test_lowest_closed_position_wins);
+    RUN_TEST(test_larger_bank_with_high_gpio_columns);
+    RUN_TEST(test_read_is_cheap);
+    UNITY_END();
+}
+
+void loop() {}
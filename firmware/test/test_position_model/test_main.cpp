@@ -0,0 +1,250 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <Config.h>
+#include <PositionModel.h>
+
+// Simulates the valve carousel: real gaps differ from the nominal MOTOR_STEPS_PER_SLOT,
+// and the model has to learn them from sensor edges seen while moving
+
+static const int kSlots = MOTOR_ROWS * MOTOR_COLS;
+typedef PositionModel<kSlots> Model;
+
+struct Carousel {
+    uint32_t gaps[kSlots];   // Real steps from position i+1 to its forward neighbour
+    uint32_t sensorAt[kSlots];
+    uint32_t circumference;
+    uint32_t x;              // Absolute step position on the ring
+    uint32_t odometer;
+
+    void init() {
+        circumference = 0;
+        for (int i = 0; i < kSlots; i++) {
+            // 170..235 steps, deterministic but uneven
+            gaps[i] = MOTOR_STEPS_PER_SLOT - 30 + (uint32_t)((i * 37) % 66);
+            sensorAt[i] = circumference;
+            circumference += gaps[i];
+        }
+        x = 0;
+        odometer = 0;
+    }
+
+    // Position whose sensor is at the current step, or -1
+    int sensed() const {
+        for (int i = 0; i < kSlots; i++) {
+            if (sensorAt[i] == x) return i + 1;
+        }
+        return -1;
+    }
+
+    // One step; returns the position if a sensor edge was crossed
+    int step(bool forward) {
+        x = forward ? (x + 1) % circumference : (x + circumference - 1) % circumference;
+        odometer++;
+        return sensed();
+    }
+};
+
+struct MoveOutcome {
+    Model::Plan plan;
+    uint32_t steps;
+    uint64_t actualUs;
+    uint32_t expectedMs;
+    bool arrived;
+};
+
+// Runs one move the way MotorController does: a ramp of plan.rampSteps, then a creep
+// until the target trips. Every edge along the way is fed back to the model.
+static MoveOutcome runMove(Model& model, Carousel& carousel, int from, int to) {
+    MoveOutcome outcome;
+    outcome.plan = model.plan(from, to);
+    outcome.steps = 0;
+    outcome.actualUs = 0;
+    outcome.expectedMs = Model::expectedMoveMs(outcome.plan, MOTOR_MAX_SPEED, MOTOR_ACCELERATION, MOTOR_CREEP_SPEED);
+    outcome.arrived = false;
+    model.forgetEdge();
+    model.observe(from, carousel.odometer, outcome.plan.forward);
+
+    StepProfile profile;
+    profile.configure(MOTOR_MAX_SPEED, MOTOR_ACCELERATION);
+    profile.start(outcome.plan.rampSteps);
+    uint32_t interval;
+    bool ramping = outcome.plan.rampSteps > 0;
+    const uint32_t creepUs = 1000000UL / MOTOR_CREEP_SPEED;
+    while (outcome.steps < 2 * carousel.circumference) {
+        if (ramping) {
+            interval = profile.nextIntervalUs();
+            if (interval == 0) {
+                ramping = false;
+                continue;
+            }
+        } else {
+            interval = creepUs;
+        }
+        outcome.actualUs += interval;
+        outcome.steps++;
+        int edge = carousel.step(outcome.plan.forward);
+        if (edge > 0) {
+            model.observe(edge, carousel.odometer, outcome.plan.forward);
+            if (edge == to) {
+                outcome.arrived = true;
+                break;
+            }
+        }
+    }
+    return outcome;
+}
+
+static void moveTo(Carousel& carousel, int position) {
+    carousel.x = carousel.sensorAt[position - 1];
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_picks_shorter_direction_for_every_pair() {
+    Model model(MOTOR_STEPS_PER_SLOT, MOTOR_APPROACH_STEPS);
+    for (int from = 1; from <= kSlots; from++) {
+        for (int to = 1; to <= kSlots; to++) {
+            Model::Plan plan = model.plan(from, to);
+            int forwardSlots = (to - from + kSlots) % kSlots;
+            int backwardSlots = (kSlots - forwardSlots) % kSlots;
+            int shortest = forwardSlots < backwardSlots ? forwardSlots : backwardSlots;
+            TEST_ASSERT_EQUAL(shortest, plan.slots);
+            TEST_ASSERT_TRUE(plan.slots <= kSlots / 2);
+            TEST_ASSERT_EQUAL((uint32_t)shortest * MOTOR_STEPS_PER_SLOT, plan.estimatedSteps);
+            TEST_ASSERT_EQUAL(plan.estimatedSteps, plan.rampSteps + plan.creepSteps);
+        }
+    }
+
+    // 1 -> 20 is a single slot backwards across the wrap, not 19 forward
+    Model::Plan wrap = model.plan(1, kSlots);
+    TEST_ASSERT_FALSE(wrap.forward);
+    TEST_ASSERT_EQUAL(1, wrap.slots);
+    Model::Plan wrapForward = model.plan(kSlots, 2);
+    TEST_ASSERT_TRUE(wrapForward.forward);
+    TEST_ASSERT_EQUAL(2, wrapForward.slots);
+    // Ties go forward
+    TEST_ASSERT_TRUE(model.plan(1, 1 + kSlots / 2).forward);
+}
+
+void test_ramp_stops_short_of_target() {
+    Model model(MOTOR_STEPS_PER_SLOT, MOTOR_APPROACH_STEPS);
+    Model::Plan plan = model.plan(3, 7);
+    TEST_ASSERT_EQUAL(MOTOR_APPROACH_STEPS, plan.creepSteps);
+    TEST_ASSERT_EQUAL(4 * MOTOR_STEPS_PER_SLOT - MOTOR_APPROACH_STEPS, plan.rampSteps);
+
+    // Neighbours closer than the approach distance are crept all the way
+    Model tight(MOTOR_APPROACH_STEPS / 2, MOTOR_APPROACH_STEPS);
+    Model::Plan creepOnly = tight.plan(3, 4);
+    TEST_ASSERT_EQUAL(0, creepOnly.rampSteps);
+    TEST_ASSERT_EQUAL(MOTOR_APPROACH_STEPS / 2, creepOnly.creepSteps);
+}
+
+void test_learns_uneven_gaps() {
+    Carousel carousel;
+    carousel.init();
+    Model model(MOTOR_STEPS_PER_SLOT, MOTOR_APPROACH_STEPS);
+
+    // A few full sweeps each way, as valve changes would produce over a print
+    int position = 1;
+    moveTo(carousel, position);
+    for (int sweep = 0; sweep < 10; sweep++) {
+        for (int i = 0; i < kSlots; i++) {
+            int target = Model::next(position, sweep % 2 == 0);
+            MoveOutcome outcome = runMove(model, carousel, position, target);
+            TEST_ASSERT_TRUE(outcome.arrived);
+            position = target;
+        }
+    }
+
+    uint32_t worstError = 0;
+    for (int p = 1; p <= kSlots; p++) {
+        uint32_t real = carousel.gaps[p - 1];
+        uint32_t learned = model.gapSteps(p, true);
+        uint32_t error = learned > real ? learned - real : real - learned;
+        if (error > worstError) worstError = error;
+        // Both directions describe the same gap
+        TEST_ASSERT_EQUAL(learned, model.gapSteps(Model::next(p, true), false));
+    }
+    TEST_ASSERT_TRUE(worstError <= 3);
+
+    char message[96];
+    snprintf(message, sizeof(message), "Worst learned gap error after 10 sweeps: %lu steps", (unsigned long)worstError);
+    TEST_MESSAGE(message);
+}
+
+void test_ignores_outliers() {
+    Model model(MOTOR_STEPS_PER_SLOT, MOTOR_APPROACH_STEPS);
+    model.observe(4, 1000, true);
+    model.observe(5, 1000 + 3 * MOTOR_STEPS_PER_SLOT, true); // Missed a sensor in between
+    TEST_ASSERT_EQUAL(MOTOR_STEPS_PER_SLOT, model.gapSteps(4, true));
+
+    model.observe(6, 1000 + 3 * MOTOR_STEPS_PER_SLOT + 220, true);
+    TEST_ASSERT_TRUE(model.gapSteps(5, true) > MOTOR_STEPS_PER_SLOT);
+
+    // Direction change without a fresh edge must not be measured
+    uint32_t before = model.gapSteps(5, false);
+    model.observe(5, 1000 + 3 * MOTOR_STEPS_PER_SLOT + 400, false);
+    TEST_ASSERT_EQUAL(before, model.gapSteps(5, false));
+}
+
+void test_expected_time_tracks_actual() {
+    Carousel carousel;
+    carousel.init();
+    Model model(MOTOR_STEPS_PER_SLOT, MOTOR_APPROACH_STEPS);
+
+    // Cold model, long move: error comes from the unlearned gaps
+    moveTo(carousel, 2);
+    MoveOutcome cold = runMove(model, carousel, 2, 12);
+    TEST_ASSERT_TRUE(cold.arrived);
+    TEST_ASSERT_EQUAL(10, cold.plan.slots);
+
+    // Warm it up, then repeat the same move
+    int position = 12;
+    for (int sweep = 0; sweep < 6; sweep++) {
+        for (int i = 0; i < kSlots; i++) {
+            int target = Model::next(position, sweep % 2 == 1);
+            runMove(model, carousel, position, target);
+            position = target;
+        }
+    }
+    moveTo(carousel, 2);
+    MoveOutcome warm = runMove(model, carousel, 2, 12);
+    TEST_ASSERT_TRUE(warm.arrived);
+
+    double coldMs = cold.actualUs / 1000.0;
+    double warmMs = warm.actualUs / 1000.0;
+    double coldError = fabs(coldMs - cold.expectedMs) / coldMs;
+    double warmError = fabs(warmMs - warm.expectedMs) / warmMs;
+    TEST_ASSERT_TRUE(warmError < 0.05);
+    TEST_ASSERT_TRUE(warmError <= coldError);
+
+    // Versus the old behaviour: one direction only, constant MOTOR_SPEED all the way
+    uint32_t oneWaySteps = 0;
+    for (int p = 2; p != 12; p = Model::next(p, false)) {
+        oneWaySteps += carousel.gaps[Model::next(p, false) - 1];
+    }
+    double constantMs = oneWaySteps * 1000.0 / MOTOR_SPEED;
+
+    char message[160];
+    snprintf(message, sizeof(message), "2->12: cold %.0f ms (expected %lu), warm %.0f ms (expected %lu); "
+             "backward at constant speed %.0f ms", coldMs, (unsigned long)cold.expectedMs,
+             warmMs, (unsigned long)warm.expectedMs, constantMs);
+    TEST_MESSAGE(message);
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_picks_shorter_direction_for_every_pair);
+    RUN_TEST(test_ramp_stops_short_of_target);
+    RUN_TEST(test_learns_uneven_gaps);
+    RUN_TEST(test_ignores_outliers);
+    RUN_TEST(test_expected_time_tracks_actual);
+    UNITY_END();
+}
+
+void loop() {}
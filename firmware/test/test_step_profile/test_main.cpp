@@ -0,0 +1,155 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <Config.h>
+#include <StepProfile.h>
+
+// Simulates the step timer ISR: walks a profile to completion and records its timing
+
+struct MoveResult {
+    uint32_t steps;
+    uint64_t totalUs;
+    uint32_t minIntervalUs;
+    uint32_t maxIntervalUs;
+    uint32_t accelSteps;   // Steps before the interval stopped shrinking
+    bool rampsMonotonic;   // Intervals only shrink, then hold, then only grow
+};
+
+static MoveResult simulate(StepProfile& profile) {
+    MoveResult result = { 0, 0, 0xFFFFFFFFUL, 0, 0, true };
+    uint32_t previous = 0;
+    bool decelerating = false;
+    uint32_t interval;
+    while ((interval = profile.nextIntervalUs()) != 0) {
+        if (result.steps > 0) {
+            if (interval < previous) {
+                if (decelerating) result.rampsMonotonic = false;
+                result.accelSteps = result.steps;
+            } else if (interval > previous) {
+                decelerating = true;
+            }
+        }
+        result.steps++;
+        result.totalUs += interval;
+        if (interval < result.minIntervalUs) result.minIntervalUs = interval;
+        if (interval > result.maxIntervalUs) result.maxIntervalUs = interval;
+        previous = interval;
+    }
+    return result;
+}
+
+// Ideal trapezoid (or triangle) duration for a move of the given length
+static double idealMoveUs(double steps, double speed, double accel) {
+    if (steps >= speed * speed / accel) {
+        return (steps / speed + speed / accel) * 1e6;
+    }
+    return 2.0 * sqrt(steps / accel) * 1e6;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_full_jump_1_to_20() {
+    const uint32_t steps = 19 * MOTOR_STEPS_PER_SLOT;
+    StepProfile profile;
+    profile.configure(MOTOR_MAX_SPEED, MOTOR_ACCELERATION);
+    profile.start(steps);
+
+    MoveResult result = simulate(profile);
+    double ideal = idealMoveUs(steps, MOTOR_MAX_SPEED, MOTOR_ACCELERATION);
+
+    TEST_ASSERT_EQUAL(steps, result.steps);
+    TEST_ASSERT_FALSE(profile.isRunning());
+    TEST_ASSERT_TRUE(result.rampsMonotonic);
+    // Reaches cruise speed exactly and never exceeds it
+    TEST_ASSERT_EQUAL(1000000UL / MOTOR_MAX_SPEED, result.minIntervalUs);
+    // Ramp length close to v^2 / 2a
+    uint32_t idealRamp = (uint32_t)MOTOR_MAX_SPEED * MOTOR_MAX_SPEED / (2 * MOTOR_ACCELERATION);
+    TEST_ASSERT_UINT32_WITHIN(idealRamp / 20 + 2, idealRamp, result.accelSteps);
+    // Total move time within 2% of the ideal trapezoid
+    TEST_ASSERT_FLOAT_WITHIN(ideal * 0.02, ideal, (double)result.totalUs);
+
+    // Baseline: runSpeed() from a 50 ms loop issued at most one step per iteration
+    double loopBoundUs = steps * 50000.0;
+    char message[128];
+    snprintf(message, sizeof(message), "1->20 (%lu steps): %.1f ms (ideal %.1f ms), loop-driven runSpeed %.1f s",
+             (unsigned long)steps, result.totalUs / 1000.0, ideal / 1000.0, loopBoundUs / 1e6);
+    TEST_MESSAGE(message);
+}
+
+void test_short_move_is_triangular() {
+    const uint32_t steps = MOTOR_STEPS_PER_SLOT;
+    StepProfile profile;
+    profile.configure(MOTOR_MAX_SPEED, MOTOR_ACCELERATION);
+    profile.start(steps);
+
+    MoveResult result = simulate(profile);
+    double ideal = idealMoveUs(steps, MOTOR_MAX_SPEED, MOTOR_ACCELERATION);
+
+    TEST_ASSERT_EQUAL(steps, result.steps);
+    TEST_ASSERT_TRUE(result.rampsMonotonic);
+    // Too short to reach cruise: peaks below max speed, roughly at the midpoint
+    TEST_ASSERT_GREATER_THAN(1000000UL / MOTOR_MAX_SPEED, result.minIntervalUs);
+    TEST_ASSERT_UINT32_WITHIN(2, steps / 2, result.accelSteps);
+    TEST_ASSERT_FLOAT_WITHIN(ideal * 0.10, ideal, (double)result.totalUs);
+}
+
+void test_first_interval_from_acceleration() {
+    StepProfile profile;
+    profile.configure(MOTOR_MAX_SPEED, MOTOR_ACCELERATION);
+    profile.start(10);
+    uint32_t expected = (uint32_t)(0.676 * sqrt(2.0 / MOTOR_ACCELERATION) * 1e6 + 0.5);
+    uint32_t first = profile.nextIntervalUs();
+    TEST_ASSERT_UINT32_WITHIN(1, expected, first);
+}
+
+void test_continuous_run_decelerates_on_stop() {
+    StepProfile profile;
+    profile.configure(MOTOR_SPEED, MOTOR_ACCELERATION);
+    profile.start(StepProfile::kContinuous);
+
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_NOT_EQUAL(0, profile.nextIntervalUs());
+    }
+    TEST_ASSERT_UINT32_WITHIN(2, (uint32_t)MOTOR_SPEED, profile.currentSpeed());
+
+    uint32_t expectedStop = profile.stepsToStop();
+    TEST_ASSERT_UINT32_WITHIN(3, (uint32_t)(MOTOR_SPEED * MOTOR_SPEED / (2 * MOTOR_ACCELERATION)), expectedStop);
+
+    profile.stop();
+    uint32_t previous = 0;
+    uint32_t stopSteps = 0;
+    uint32_t interval;
+    while ((interval = profile.nextIntervalUs()) != 0) {
+        TEST_ASSERT_TRUE(interval >= previous);
+        previous = interval;
+        stopSteps++;
+    }
+    TEST_ASSERT_UINT32_WITHIN(1, expectedStop, stopSteps);
+    TEST_ASSERT_FALSE(profile.isRunning());
+}
+
+void test_abort_stops_immediately() {
+    StepProfile profile;
+    profile.configure(MOTOR_MAX_SPEED, MOTOR_ACCELERATION);
+    profile.start(StepProfile::kContinuous);
+    profile.nextIntervalUs();
+    profile.abort();
+    TEST_ASSERT_EQUAL(0, profile.nextIntervalUs());
+    TEST_ASSERT_EQUAL(0, profile.currentSpeed());
+}
+
+void setup() {
+    delay(2000);
+    Serial.begin(115200);
+    delay(200);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_full_jump_1_to_20);
+    RUN_TEST(test_short_move_is_triangular);
+    RUN_TEST(test_first_interval_from_acceleration);
+    RUN_TEST(test_continuous_run_decelerates_on_stop);
+    RUN_TEST(test_abort_stops_immediately);
+    UNITY_END();
+}
+
+void loop() {}